@@ -0,0 +1,595 @@
+/// @file LeyEngine/Allocators.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// 組み合わせ可能なアロケータを提供します。
+/// 各アロケータはAllocatorと同じ契約を満たし、Array等のアロケータとしてそのまま使用できます。
+/// 組み合わせはすべてコンパイル時に解決され、仮想関数呼び出しは発生しません。
+#ifndef _LEYENGINE_ALLOCATORS_HPP
+#define _LEYENGINE_ALLOCATORS_HPP
+
+#include <atomic>
+#include "LeyEngine/Memory.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine 
+{
+    /// スタックアロケータが使用するバッファです。
+    /// 関数内のローカル変数等として配置し、StackAllocatorに渡します。
+    /// @tparam SIZE バッファのバイトサイズです。
+    template<USize SIZE>
+    struct StackBuffer
+    {
+        /// バッファのバイトサイズです。
+        static constexpr USize BUFFER_SIZE = SIZE;
+
+        /// バッファです。
+        alignas(alignof(std::max_align_t)) U8 buffer[SIZE];
+
+        /// 使用済みのバイトサイズです。
+        USize used;
+
+        /// コンストラクタです。
+        StackBuffer() noexcept
+            : used(0)
+        {}
+
+        StackBuffer(const StackBuffer<SIZE> &origin) = delete;
+        StackBuffer<SIZE> &operator=(const StackBuffer<SIZE> &origin) = delete;
+    };
+
+    /// StackBufferから後入れ先出しでメモリを確保するアロケータです。
+    /// 最後に確保したメモリのみ解放時に再利用され、それ以外はバッファの破棄時にまとめて解放されます。
+    /// コピーしたアロケータは同じバッファを共有します。
+    /// @tparam T 要素の型です。
+    /// @tparam SIZE バッファのバイトサイズです。
+    template<typename T, USize SIZE>
+    struct StackAllocator
+    {
+        /// 要素の型です。
+        using TElement = T;
+
+        /// メモリ確保時のエラー型です。
+        using TAllocateError = EAllocateError;
+
+        /// メモリ解放時のエラー型です。
+        using TDeallocateError = EDeallocateError;
+
+    private:
+
+        StackBuffer<SIZE> *m_pBuffer; // バッファ
+
+    public:
+
+        /// コンストラクタです。
+        /// @param buffer 確保に使用するバッファです。
+        StackAllocator(StackBuffer<SIZE> &buffer) noexcept
+            : m_pBuffer(&buffer)
+        {}
+
+        /// メモリを確保します。
+        /// @param count 要素数です。
+        /// @return 確保したポインタ、または、エラーです。
+        Result<TElement*, TAllocateError> Allocate(USize count) noexcept
+        {
+            if (count == 0) return EAllocateError::ZERO_SIZE;
+            Var top = AlignUp(this->m_pBuffer->used, alignof(TElement));
+            Var size = sizeof(TElement) * count;
+            if (size / sizeof(TElement) != count || top > SIZE || SIZE - top < size)
+            {
+                return EAllocateError::BAD_ALLOCATE;
+            }
+            this->m_pBuffer->used = top + size;
+            return Cast<TElement*>(&this->m_pBuffer->buffer[top]);
+        }
+
+        /// メモリを解放します。
+        /// 最後に確保したメモリの場合のみ再利用できるようになります。
+        /// @param count 要素数です。
+        /// @param pointer 解放するポインタです。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TDeallocateError> Deallocate(USize count, TElement *pointer) noexcept
+        {
+            if (count == 0) return EDeallocateError::ZERO_SIZE;
+            if (!this->Owns(pointer)) return EDeallocateError::BAD_DEALLOCATE;
+            Var top = static_cast<USize>(Cast<U8*>(pointer) - this->m_pBuffer->buffer);
+            if (top + sizeof(TElement) * count == this->m_pBuffer->used)
+            {
+                this->m_pBuffer->used = top;
+            }
+            return SUCCESS;
+        }
+
+        /// ポインタがこのアロケータのバッファを指すか判定します。
+        /// @param pointer 判定するポインタです。
+        /// @retval true バッファを指します。
+        /// @retval false バッファを指しません。
+        Bool Owns(const TElement *pointer) const noexcept
+        {
+            Var adr = Cast<USize>(pointer);
+            Var min = Cast<USize>(&this->m_pBuffer->buffer[0]);
+            return min <= adr && adr < min + SIZE;
+        }
+    };
+
+    /// スクラッチアロケータのブロックの標準バイトサイズです。
+    /// これより大きい確保には確保するサイズに合わせたブロックを使用します。
+    constexpr USize SCRATCH_BLOCK_SIZE = 256 * 1024;
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// スクラッチアロケータのブロックです。
+        struct _ScratchBlock
+        {
+            _ScratchBlock *pPrevious; // 前のブロック
+            USize size;               // ヘッダを含むバイトサイズ
+        };
+
+        /// スレッド毎のスクラッチアロケータのスタックです。
+        struct _ScratchStack
+        {
+            _ScratchBlock *pTop;    // 使用中のブロックの先頭
+            USize used;             // 先頭のブロックの、ヘッダを含む使用済みのバイトサイズ
+            _ScratchBlock *pSpare;  // 再利用待ちのブロック
+            USize scopeDepth;       // ScratchScopeの入れ子の深さ
+
+            /// コンストラクタです。
+            _ScratchStack() noexcept
+                : pTop(NONE)
+                , used(0)
+                , pSpare(NONE)
+                , scopeDepth(0)
+            {}
+
+            _ScratchStack(const _ScratchStack&) = delete;
+            _ScratchStack &operator=(const _ScratchStack&) = delete;
+
+            /// デストラクタです。
+            ~_ScratchStack() noexcept
+            {
+                this->Rewind(NONE, 0);
+                while (this->pSpare != NONE)
+                {
+                    Var pBlock = this->pSpare;
+                    this->pSpare = pBlock->pPrevious;
+                    (Void)LeyEngine::Deallocate(pBlock->size, pBlock);
+                }
+            }
+
+            /// メモリを確保します。
+            /// @param size バイトサイズです。
+            /// @param alignment アライメントです。
+            /// @return 確保したメモリ、または、NONEです。
+            Void *Allocate(USize size, USize alignment) noexcept
+            {
+                if (this->pTop != NONE)
+                {
+                    Var top = AlignUp(Cast<USize>(this->pTop) + this->used, alignment) - Cast<USize>(this->pTop);
+                    if (top <= this->pTop->size && this->pTop->size - top >= size)
+                    {
+                        this->used = top + size;
+                        return Cast<U8*>(this->pTop) + top;
+                    }
+                }
+
+                // 先頭のブロックに収まらない場合は次のブロックへ進みます
+                Var header = AlignUp(sizeof(_ScratchBlock), alignof(std::max_align_t));
+                if (size > USIZE_MAX - header - alignment) return NONE;
+                Var required = header + size + alignment;
+                _ScratchBlock *pBlock = NONE;
+                for (Var ppSpare = &this->pSpare; *ppSpare != NONE; ppSpare = &(*ppSpare)->pPrevious)
+                {
+                    if ((*ppSpare)->size >= required)
+                    {
+                        pBlock = *ppSpare;
+                        *ppSpare = pBlock->pPrevious;
+                        break;
+                    }
+                }
+                if (pBlock == NONE)
+                {
+                    Var blockSize = required < SCRATCH_BLOCK_SIZE ? SCRATCH_BLOCK_SIZE : required;
+                    Var res = LeyEngine::Allocate(blockSize);
+                    if (res.IsFailure()) return NONE;
+                    pBlock = Cast<_ScratchBlock*>(res.Value());
+                    pBlock->size = blockSize;
+                }
+                pBlock->pPrevious = this->pTop;
+                this->pTop = pBlock;
+                Var top = AlignUp(Cast<USize>(pBlock) + header, alignment) - Cast<USize>(pBlock);
+                this->used = top + size;
+                return Cast<U8*>(pBlock) + top;
+            }
+
+            /// 最後に確保したメモリの場合、再利用できるようにします。
+            /// @param size バイトサイズです。
+            /// @param pointer 解放するポインタです。
+            Void Deallocate(USize size, Void *pointer) noexcept
+            {
+                if (this->pTop == NONE) return;
+                if (Cast<U8*>(pointer) + size == Cast<U8*>(this->pTop) + this->used)
+                {
+                    this->used = static_cast<USize>(Cast<U8*>(pointer) - Cast<U8*>(this->pTop));
+                }
+            }
+
+            /// 指定した位置まで巻き戻し、以降に確保したブロックを再利用待ちにします。
+            /// @param pTop 巻き戻す位置の先頭のブロックです。
+            /// @param used 巻き戻す位置の使用済みのバイトサイズです。
+            Void Rewind(_ScratchBlock *pTop, USize used) noexcept
+            {
+                while (this->pTop != pTop)
+                {
+                    Var pBlock = this->pTop;
+                    this->pTop = pBlock->pPrevious;
+                    pBlock->pPrevious = this->pSpare;
+                    this->pSpare = pBlock;
+                }
+                this->used = used;
+            }
+
+            /// ポインタが使用中のブロックを指すか判定します。
+            /// @param pointer 判定するポインタです。
+            /// @retval true 使用中のブロックを指します。
+            /// @retval false 使用中のブロックを指しません。
+            Bool Owns(const Void *pointer) const noexcept
+            {
+                Var adr = Cast<USize>(pointer);
+                for (Var pBlock = this->pTop; pBlock != NONE; pBlock = pBlock->pPrevious)
+                {
+                    Var min = Cast<USize>(pBlock);
+                    if (min <= adr && adr < min + pBlock->size) return YES;
+                }
+                return NO;
+            }
+        };
+
+        /// 現在のスレッドのスクラッチアロケータのスタックを返します。
+        inline _ScratchStack &_CurrentScratchStack() noexcept
+        {
+            thread_local _ScratchStack t_stack;
+            return t_stack;
+        }
+    }
+    /// @endcond
+
+    /// 現在のスレッドのスクラッチアロケータの位置を記録し、破棄時にその位置まで巻き戻します。
+    /// スコープ内でScratchAllocatorから確保したメモリは、個別に解放しなくてもまとめて解放されます。
+    /// ブロックはスレッドの終了まで保持し、次のスコープで再利用します。
+    /// スコープは作成と逆順に破棄する必要があり、他のスレッドへ渡してはいけません。
+    struct ScratchScope
+    {
+    private:
+
+        _Internal::_ScratchBlock *m_pTop; // 作成時の先頭のブロック
+        USize m_used;                     // 作成時の使用済みのバイトサイズ
+
+    public:
+
+        /// 現在の位置を記録します。
+        ScratchScope() noexcept
+        {
+            Var &stack = _Internal::_CurrentScratchStack();
+            this->m_pTop = stack.pTop;
+            this->m_used = stack.used;
+            stack.scopeDepth += 1;
+        }
+
+        ScratchScope(const ScratchScope&) = delete;
+        ScratchScope &operator=(const ScratchScope&) = delete;
+
+        /// 記録した位置まで巻き戻します。
+        ~ScratchScope() noexcept
+        {
+            Var &stack = _Internal::_CurrentScratchStack();
+            stack.Rewind(this->m_pTop, this->m_used);
+            stack.scopeDepth -= 1;
+        }
+    };
+
+    /// 現在のスレッドのスタックから後入れ先出しでメモリを確保するアロケータです。
+    /// 確保は先頭のブロックの位置を進めるのみで、解放はScratchScopeの破棄時にまとめて行います。
+    /// 最後に確保したメモリのみ解放時に再利用されます。
+    /// 実行時にサイズが決まる一時的な作業用バッファに使用し、ScratchScopeの外では確保できません。
+    /// @tparam T 要素の型です。
+    template<typename T>
+    struct ScratchAllocator
+    {
+        /// 要素の型です。
+        using TElement = T;
+
+        /// メモリ確保時のエラー型です。
+        using TAllocateError = EAllocateError;
+
+        /// メモリ解放時のエラー型です。
+        using TDeallocateError = EDeallocateError;
+
+        /// コンストラクタです。
+        ScratchAllocator() noexcept
+        {}
+
+        /// メモリを確保します。
+        /// @param count 要素数です。
+        /// @return 確保したポインタ、または、エラーです。
+        Result<TElement*, TAllocateError> Allocate(USize count) noexcept
+        {
+            if (count == 0) return EAllocateError::ZERO_SIZE;
+            Var &stack = _Internal::_CurrentScratchStack();
+            Var size = sizeof(TElement) * count;
+            if (stack.scopeDepth == 0 || size / sizeof(TElement) != count) return EAllocateError::BAD_ALLOCATE;
+            Var ptr = stack.Allocate(size, alignof(TElement));
+            if (ptr == NONE) return EAllocateError::BAD_ALLOCATE;
+            return Cast<TElement*>(ptr);
+        }
+
+        /// メモリを解放します。
+        /// 最後に確保したメモリの場合のみ再利用できるようになります。
+        /// @param count 要素数です。
+        /// @param pointer 解放するポインタです。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TDeallocateError> Deallocate(USize count, TElement *pointer) noexcept
+        {
+            if (count == 0) return EDeallocateError::ZERO_SIZE;
+            if (pointer == NONE) return EDeallocateError::BAD_DEALLOCATE;
+            _Internal::_CurrentScratchStack().Deallocate(sizeof(TElement) * count, pointer);
+            return SUCCESS;
+        }
+
+        /// ポインタが現在のスレッドの使用中のブロックを指すか判定します。
+        /// @param pointer 判定するポインタです。
+        /// @retval true 使用中のブロックを指します。
+        /// @retval false 使用中のブロックを指しません。
+        Bool Owns(const TElement *pointer) const noexcept
+        {
+            return _Internal::_CurrentScratchStack().Owns(pointer);
+        }
+    };
+
+    /// 一次アロケータで確保し、失敗した場合に予備アロケータで確保するアロケータです。
+    /// 一次アロケータはOwnsを実装する必要があります。
+    /// @tparam P 一次アロケータです。
+    /// @tparam F 予備アロケータです。
+    template<typename P, typename F>
+    struct FallbackAllocator
+    {
+        static_assert(std::is_same_v<typename P::TElement, typename F::TElement>, "Allocators must have the same element type.");
+        static_assert(std::is_same_v<typename P::TAllocateError, typename F::TAllocateError>, "Allocators must have the same allocate error type.");
+        static_assert(std::is_same_v<typename P::TDeallocateError, typename F::TDeallocateError>, "Allocators must have the same deallocate error type.");
+
+        /// 要素の型です。
+        using TElement = typename P::TElement;
+
+        /// メモリ確保時のエラー型です。
+        using TAllocateError = typename P::TAllocateError;
+
+        /// メモリ解放時のエラー型です。
+        using TDeallocateError = typename P::TDeallocateError;
+
+    private:
+
+        P m_primary;  // 一次アロケータ
+        F m_fallback; // 予備アロケータ
+
+    public:
+
+        /// コンストラクタです。
+        /// @param primary 一次アロケータです。
+        /// @param fallback 予備アロケータです。
+        FallbackAllocator(const P &primary, const F &fallback = F()) noexcept
+            : m_primary(primary)
+            , m_fallback(fallback)
+        {}
+
+        /// メモリを確保します。
+        /// @param count 要素数です。
+        /// @return 確保したポインタ、または、エラーです。
+        Result<TElement*, TAllocateError> Allocate(USize count) noexcept
+        {
+            Var res = this->m_primary.Allocate(count);
+            if (res.IsSuccess()) return res;
+            return this->m_fallback.Allocate(count);
+        }
+
+        /// メモリを解放します。
+        /// @param count 要素数です。
+        /// @param pointer 解放するポインタです。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TDeallocateError> Deallocate(USize count, TElement *pointer) noexcept
+        {
+            if (this->m_primary.Owns(pointer)) return this->m_primary.Deallocate(count, pointer);
+            else                               return this->m_fallback.Deallocate(count, pointer);
+        }
+
+        /// ポインタがこのアロケータで確保したものか判定します。
+        /// 予備アロケータがOwnsを実装している場合のみ使用できます。
+        /// @param pointer 判定するポインタです。
+        /// @retval true このアロケータで確保しました。
+        /// @retval false このアロケータで確保していません。
+        Bool Owns(const TElement *pointer) const noexcept
+        {
+            return this->m_primary.Owns(pointer) || this->m_fallback.Owns(pointer);
+        }
+    };
+
+    /// 確保するバイトサイズで使用するアロケータを振り分けるアロケータです。
+    /// @tparam THRESHOLD 小さいサイズとみなす最大のバイトサイズです。
+    /// @tparam S THRESHOLD以下のサイズを確保するアロケータです。
+    /// @tparam L THRESHOLDより大きいサイズを確保するアロケータです。
+    template<USize THRESHOLD, typename S, typename L>
+    struct Segregator
+    {
+        static_assert(std::is_same_v<typename S::TElement, typename L::TElement>, "Allocators must have the same element type.");
+        static_assert(std::is_same_v<typename S::TAllocateError, typename L::TAllocateError>, "Allocators must have the same allocate error type.");
+        static_assert(std::is_same_v<typename S::TDeallocateError, typename L::TDeallocateError>, "Allocators must have the same deallocate error type.");
+
+        /// 要素の型です。
+        using TElement = typename S::TElement;
+
+        /// メモリ確保時のエラー型です。
+        using TAllocateError = typename S::TAllocateError;
+
+        /// メモリ解放時のエラー型です。
+        using TDeallocateError = typename S::TDeallocateError;
+
+    private:
+
+        S m_small; // 小さいサイズのアロケータ
+        L m_large; // 大きいサイズのアロケータ
+
+    public:
+
+        /// コンストラクタです。
+        /// @param small 小さいサイズのアロケータです。
+        /// @param large 大きいサイズのアロケータです。
+        Segregator(const S &small = S(), const L &large = L()) noexcept
+            : m_small(small)
+            , m_large(large)
+        {}
+
+        /// メモリを確保します。
+        /// @param count 要素数です。
+        /// @return 確保したポインタ、または、エラーです。
+        Result<TElement*, TAllocateError> Allocate(USize count) noexcept
+        {
+            if (sizeof(TElement) * count <= THRESHOLD) return this->m_small.Allocate(count);
+            else                                       return this->m_large.Allocate(count);
+        }
+
+        /// メモリを解放します。
+        /// @param count 要素数です。
+        /// @param pointer 解放するポインタです。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TDeallocateError> Deallocate(USize count, TElement *pointer) noexcept
+        {
+            if (sizeof(TElement) * count <= THRESHOLD) return this->m_small.Deallocate(count, pointer);
+            else                                       return this->m_large.Deallocate(count, pointer);
+        }
+
+        /// ポインタがこのアロケータで確保したものか判定します。
+        /// 両方のアロケータがOwnsを実装している場合のみ使用できます。
+        /// @param pointer 判定するポインタです。
+        /// @retval true このアロケータで確保しました。
+        /// @retval false このアロケータで確保していません。
+        Bool Owns(const TElement *pointer) const noexcept
+        {
+            return this->m_small.Owns(pointer) || this->m_large.Owns(pointer);
+        }
+    };
+
+    /// アロケータの統計情報です。
+    /// 複数のスレッドから同時に更新できます。
+    struct AllocatorStats
+    {
+        /// 確保に成功した回数です。
+        std::atomic<USize> allocateCount{ 0 };
+        /// 確保に失敗した回数です。
+        std::atomic<USize> allocateFailureCount{ 0 };
+        /// 解放に成功した回数です。
+        std::atomic<USize> deallocateCount{ 0 };
+        /// 使用中のバイトサイズです。
+        std::atomic<USize> usedSize{ 0 };
+        /// 使用中のバイトサイズの最大値です。
+        std::atomic<USize> peakUsedSize{ 0 };
+    };
+
+    /// 内部のアロケータの確保、解放を統計情報に記録するアロケータです。
+    /// 統計情報は外部に置かれ、コピーしたアロケータは同じ統計情報を共有します。
+    /// @tparam A 内部のアロケータです。
+    template<typename A>
+    struct StatsAllocator
+    {
+        /// 要素の型です。
+        using TElement = typename A::TElement;
+
+        /// メモリ確保時のエラー型です。
+        using TAllocateError = typename A::TAllocateError;
+
+        /// メモリ解放時のエラー型です。
+        using TDeallocateError = typename A::TDeallocateError;
+
+    private:
+
+        A m_allocator;           // 内部のアロケータ
+        AllocatorStats *m_pStats; // 統計情報
+
+    public:
+
+        /// 型毎に共有される標準の統計情報を返します。
+        /// @return 統計情報です。
+        static AllocatorStats &DefaultStats() noexcept
+        {
+            static AllocatorStats s_stats;
+            return s_stats;
+        }
+
+        /// コンストラクタです。
+        /// 型毎に共有される標準の統計情報に記録します。
+        StatsAllocator() noexcept
+            : m_allocator()
+            , m_pStats(&DefaultStats())
+        {}
+
+        /// コンストラクタです。
+        /// @param stats 記録する統計情報です。
+        /// @param allocator 内部のアロケータです。
+        StatsAllocator(AllocatorStats &stats, const A &allocator = A()) noexcept
+            : m_allocator(allocator)
+            , m_pStats(&stats)
+        {}
+
+        /// メモリを確保します。
+        /// @param count 要素数です。
+        /// @return 確保したポインタ、または、エラーです。
+        Result<TElement*, TAllocateError> Allocate(USize count) noexcept
+        {
+            Var res = this->m_allocator.Allocate(count);
+            if (res.IsSuccess())
+            {
+                this->m_pStats->allocateCount.fetch_add(1, std::memory_order_relaxed);
+                Var used = this->m_pStats->usedSize.fetch_add(sizeof(TElement) * count, std::memory_order_relaxed) + sizeof(TElement) * count;
+                Var peak = this->m_pStats->peakUsedSize.load(std::memory_order_relaxed);
+                while (peak < used && !this->m_pStats->peakUsedSize.compare_exchange_weak(peak, used, std::memory_order_relaxed));
+            }
+            else
+            {
+                this->m_pStats->allocateFailureCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            return res;
+        }
+
+        /// メモリを解放します。
+        /// @param count 要素数です。
+        /// @param pointer 解放するポインタです。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TDeallocateError> Deallocate(USize count, TElement *pointer) noexcept
+        {
+            Var res = this->m_allocator.Deallocate(count, pointer);
+            if (res.IsSuccess())
+            {
+                this->m_pStats->deallocateCount.fetch_add(1, std::memory_order_relaxed);
+                this->m_pStats->usedSize.fetch_sub(sizeof(TElement) * count, std::memory_order_relaxed);
+            }
+            return res;
+        }
+
+        /// ポインタがこのアロケータで確保したものか判定します。
+        /// 内部のアロケータがOwnsを実装している場合のみ使用できます。
+        /// @param pointer 判定するポインタです。
+        /// @retval true このアロケータで確保しました。
+        /// @retval false このアロケータで確保していません。
+        Bool Owns(const TElement *pointer) const noexcept
+        {
+            return this->m_allocator.Owns(pointer);
+        }
+
+        /// 記録している統計情報を返します。
+        /// @return 統計情報です。
+        const AllocatorStats &Stats() const noexcept
+        {
+            return *this->m_pStats;
+        }
+    };
+}
+
+#endif // !_LEYENGINE_ALLOCATORS_HPP
\ No newline at end of file
@@ -0,0 +1,287 @@
+/// @file LeyEngine/AssetArchive.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// アセットをまとめたアーカイブを提供します。
+#ifndef _LEYENGINE_ASSETARCHIVE_HPP
+#define _LEYENGINE_ASSETARCHIVE_HPP
+
+#include "LeyEngine/Memory.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// アセットアーカイブのエラーです。
+    enum class EAssetError
+    {
+        /// 引数が不正でした。
+        INVALID_ARGUMENT,
+        /// ファイルを開けませんでした。
+        OPEN_FAILED,
+        /// ファイルをメモリにマップできませんでした。
+        MAPPING_FAILED,
+        /// ファイルの書き込みに失敗しました。
+        WRITE_FAILED,
+        /// アーカイブの形式が不正でした。
+        INVALID_FORMAT,
+        /// アセットが見つかりませんでした。
+        NOT_FOUND,
+        /// アセットが圧縮されているため直接参照できませんでした。
+        COMPRESSED,
+        /// 展開する方法が登録されていない圧縮形式でした。
+        UNSUPPORTED_COMPRESSION,
+        /// 展開に失敗しました。
+        DECOMPRESS_FAILED,
+        /// メモリ確保に失敗しました。
+        BAD_ALLOCATE,
+        /// データがチェックサムと一致しませんでした。
+        CHECKSUM_MISMATCH,
+    };
+
+    /// アセットの圧縮形式です。
+    enum class EAssetCompression : U32
+    {
+        /// 圧縮していません。
+        UNCOMPRESSED,
+        /// LZ4ブロック形式です。
+        LZ4,
+        /// Zstandard形式です。展開にはSetDecompressorで展開関数を登録する必要があります。
+        ZSTD,
+    };
+
+    /// アセットの圧縮形式の数です。
+    constexpr USize ASSET_COMPRESSION_COUNT = 3;
+
+    /// アセットアーカイブのファイル先頭のマジックナンバー「LEYA」です。
+    constexpr U32 ASSET_ARCHIVE_MAGIC = 0x4159454C;
+
+    /// アセットアーカイブの形式のバージョンです。
+    constexpr U32 ASSET_ARCHIVE_VERSION = 2;
+
+    /// アセットアーカイブ内のアセットのアライメントです。
+    constexpr USize ASSET_ARCHIVE_ALIGNMENT = 64;
+
+    /// アセットアーカイブのヘッダーです。
+    struct AssetArchiveHeader
+    {
+        /// マジックナンバーです。
+        U32 magic;
+        /// 形式のバージョンです。
+        U32 version;
+        /// アセットの数です。
+        U64 entryCount;
+        /// 目次のファイル先頭からのバイトオフセットです。
+        U64 entriesOffset;
+        /// 名前の領域のファイル先頭からのバイトオフセットです。
+        U64 namesOffset;
+        /// 名前の領域のバイトサイズです。
+        U64 namesSize;
+        /// ファイルのバイトサイズです。
+        U64 fileSize;
+    };
+
+    /// アセットアーカイブの目次の項目です。
+    /// 目次は名前のハッシュ値、名前の順に整列しています。
+    struct AssetArchiveEntry
+    {
+        /// 名前のFNV-1aハッシュ値です。
+        U64 nameHash;
+        /// 名前の領域の先頭からのバイトオフセットです。
+        U32 nameOffset;
+        /// 名前のバイトサイズです。
+        U32 nameSize;
+        /// データのファイル先頭からのバイトオフセットです。
+        U64 offset;
+        /// 格納しているデータのバイトサイズです。
+        U64 size;
+        /// 展開後のデータのバイトサイズです。
+        U64 originalSize;
+        /// 圧縮形式です。
+        EAssetCompression compression;
+        /// 格納しているデータのCRC32Cです。
+        U32 checksum;
+    };
+
+    /// アセットアーカイブの読み取り専用のデータです。
+    struct AssetView
+    {
+        /// データの先頭です。
+        const U8 *pData;
+        /// データのバイトサイズです。
+        USize size;
+    };
+
+    /// 展開したアセットを所有するバッファです。
+    /// 標準メモリから確保し、破棄時に解放します。
+    struct AssetBuffer
+    {
+    private:
+
+        U8 *m_pData;    // データ
+        USize m_size;   // バイトサイズ
+
+    public:
+
+        /// バッファを作成します。
+        /// @param pData 標準メモリから確保したデータです。所有権を受け取ります。
+        /// @param size データのバイトサイズです。
+        AssetBuffer(U8 *pData, USize size) noexcept
+            : m_pData(pData)
+            , m_size(size)
+        {
+        }
+
+        AssetBuffer(const AssetBuffer&) = delete;
+        AssetBuffer &operator=(const AssetBuffer&) = delete;
+
+        /// ムーブコンストラクタです。
+        /// @param origin 元のバッファです。
+        AssetBuffer(AssetBuffer &&origin) noexcept
+            : m_pData(origin.m_pData)
+            , m_size(origin.m_size)
+        {
+            origin.m_pData = NONE;
+            origin.m_size = 0;
+        }
+
+        /// デストラクタです。
+        ~AssetBuffer() noexcept
+        {
+            if (this->m_pData != NONE)
+            {
+                (Void)Deallocate(this->m_size, this->m_pData);
+            }
+        }
+
+        /// データの先頭を返します。
+        /// @return データの先頭です。
+        U8 *Data() noexcept
+        {
+            return this->m_pData;
+        }
+
+        /// データの先頭を返します。
+        /// @return データの先頭です。
+        const U8 *Data() const noexcept
+        {
+            return this->m_pData;
+        }
+
+        /// データのバイトサイズを返します。
+        /// @return バイトサイズです。
+        USize Size() const noexcept
+        {
+            return this->m_size;
+        }
+    };
+
+    /// 圧縮データを展開する関数です。
+    /// 引数は圧縮データ、圧縮データのバイトサイズ、出力先、出力先のバイトサイズです。
+    /// 展開後のバイトサイズ、または、エラーを返します。
+    using AssetDecompressor = Result<USize, EAssetError> (*)(const U8 *pSource, USize sourceSize, U8 *pDestination, USize destinationSize);
+
+    /// アセットアーカイブに書き込むアセットです。
+    struct AssetSource
+    {
+        /// UTF-8の名前です。
+        const Char *name;
+        /// 名前のバイトサイズです。
+        USize nameSize;
+        /// データです。
+        const Void *pData;
+        /// データのバイトサイズです。
+        USize size;
+        /// 圧縮形式です。
+        /// LZ4は書き込み時に圧縮し、縮まない場合は圧縮せずに格納します。
+        EAssetCompression compression;
+        /// データを圧縮済みかです。ZSTDでは呼び出し側で圧縮している必要があります。
+        Bool isPrecompressed;
+        /// 圧縮済みのデータの展開後のバイトサイズです。
+        USize originalSize;
+    };
+
+    /// アセットアーカイブを書き込みます。
+    /// @param path UTF-8のファイルパスです。
+    /// @param pSources アセットの配列です。名前は重複してはいけません。
+    /// @param count アセットの数です。
+    /// @return SUCCESS、または、エラーです。
+    Result<Success, EAssetError> WriteAssetArchive(const Char *path, const AssetSource *pSources, USize count) noexcept;
+
+    /// メモリにマップしたアセットアーカイブです。
+    /// 圧縮していないアセットはコピー、確保せずに参照します。
+    struct AssetArchive
+    {
+    private:
+
+        Void *m_pMapping;                                       // マップしたファイル
+        USize m_mappingSize;                                    // マップしたバイトサイズ
+        ISize m_mappingHandle;                                  // マッピングのハンドル
+        const AssetArchiveEntry *m_pEntries;                    // 目次
+        USize m_entryCount;                                     // アセットの数
+        const Char *m_pNames;                                   // 名前の領域
+        AssetDecompressor m_decompressors[ASSET_COMPRESSION_COUNT]; // 圧縮形式毎の展開関数
+
+        // 作成します。
+        AssetArchive(Void *pMapping, USize mappingSize, ISize mappingHandle) noexcept;
+
+    public:
+
+        /// アセットアーカイブを開き、メモリにマップします。
+        /// @param path UTF-8のファイルパスです。
+        /// @return アセットアーカイブ、または、エラーです。
+        static Result<AssetArchive, EAssetError> Open(const Char *path) noexcept;
+
+        AssetArchive(const AssetArchive&) = delete;
+        AssetArchive &operator=(const AssetArchive&) = delete;
+
+        /// ムーブコンストラクタです。
+        /// @param origin 元のアセットアーカイブです。
+        AssetArchive(AssetArchive &&origin) noexcept;
+
+        /// デストラクタです。
+        ~AssetArchive() noexcept;
+
+        /// 圧縮形式の展開関数を登録します。
+        /// @param compression 圧縮形式です。
+        /// @param decompressor 展開関数です。
+        Void SetDecompressor(EAssetCompression compression, AssetDecompressor decompressor) noexcept;
+
+        /// アセットの数を返します。
+        /// @return アセットの数です。
+        USize Count() const noexcept;
+
+        /// 目次の項目を返します。
+        /// @param index 目次のインデックスです。
+        /// @return 目次の項目です。
+        const AssetArchiveEntry &EntryAt(USize index) const noexcept;
+
+        /// アセットの名前を返します。
+        /// @param entry 目次の項目です。
+        /// @return 名前です。
+        AssetView NameOf(const AssetArchiveEntry &entry) const noexcept;
+
+        /// 名前からアセットを検索します。
+        /// @param name UTF-8の名前です。
+        /// @param nameSize 名前のバイトサイズです。
+        /// @return 目次の項目、または、エラーです。
+        Result<const AssetArchiveEntry*, EAssetError> Find(const Char *name, USize nameSize) const noexcept;
+
+        /// 圧縮していないアセットのデータを参照します。
+        /// マップしたファイルを直接指すため、アセットアーカイブより長く使用してはいけません。
+        /// @param entry 目次の項目です。
+        /// @return データ、または、エラーです。
+        Result<AssetView, EAssetError> View(const AssetArchiveEntry &entry) const noexcept;
+
+        /// 格納しているデータをチェックサムで検証します。
+        /// データ全体を読み込むため、ファイルの破損を検出したい場合にのみ呼び出します。
+        /// @param entry 目次の項目です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, EAssetError> Verify(const AssetArchiveEntry &entry) const noexcept;
+
+        /// アセットのデータを標準メモリから確保したバッファに展開します。
+        /// @param entry 目次の項目です。
+        /// @return 展開したデータ、または、エラーです。
+        Result<AssetBuffer, EAssetError> Load(const AssetArchiveEntry &entry) const noexcept;
+    };
+}
+
+#endif // !_LEYENGINE_ASSETARCHIVE_HPP
\ No newline at end of file
@@ -0,0 +1,158 @@
+/// @file LeyEngine/AsyncIO.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// 非同期ファイル入出力を提供します。
+#ifndef _LEYENGINE_ASYNCIO_HPP
+#define _LEYENGINE_ASYNCIO_HPP
+
+#include "LeyEngine/Memory.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// 非同期ファイル入出力のエラーです。
+    enum class EIOError
+    {
+        /// 非同期ファイル入出力システムが初期化されていませんでした。
+        NOT_INITIALIZED,
+        /// 引数が不正でした。
+        INVALID_ARGUMENT,
+        /// ファイルを開けませんでした。
+        OPEN_FAILED,
+        /// ファイルの読み込みに失敗しました。
+        READ_FAILED,
+        /// メモリ確保に失敗しました。
+        BAD_ALLOCATE,
+        /// 読み込みがキャンセルされました。
+        CANCELED,
+    };
+
+    /// 非同期ファイル入出力の優先度です。
+    /// 優先度の高い要求から順に発行します。
+    enum class EIOPriority : U8
+    {
+        /// 高い優先度です。
+        HIGH,
+        /// 通常の優先度です。
+        NORMAL,
+        /// 低い優先度です。
+        LOW,
+    };
+
+    /// 非同期ファイル入出力の優先度の数です。
+    constexpr USize IO_PRIORITY_COUNT = 3;
+
+    /// ダイレクト入出力で使用するバッファ、オフセット、サイズのアライメントです。
+    constexpr USize IO_DIRECT_ALIGNMENT = 4096;
+
+    /// 非同期ファイル入出力で読み込むファイルです。
+    struct IOFile
+    {
+        /// ネイティブのファイルハンドルです。
+        ISize handle;
+        /// ページキャッシュを経由しないダイレクト入出力で開いているかです。
+        Bool isDirect;
+    };
+
+    struct IOCompletion;
+
+    /// 読み込みの完了を通知するコールバックです。
+    using IOCallback = Void (*)(const IOCompletion &completion);
+
+    /// 読み込み要求です。
+    struct IOReadRequest
+    {
+        /// 読み込むファイルです。
+        IOFile file;
+        /// 読み込みを開始するファイル先頭からのバイトオフセットです。
+        /// ダイレクト入出力ではIO_DIRECT_ALIGNMENTの倍数である必要があります。
+        U64 offset;
+        /// 読み込むバイトサイズです。
+        USize size;
+        /// 読み込み先のバッファです。
+        /// NONEの場合はAllocateIOBufferで確保したバッファに読み込みます。
+        Void *pBuffer;
+        /// 優先度です。
+        EIOPriority priority;
+        /// 完了を通知するコールバックです。NONEの場合は通知しません。
+        /// ジョブシステムのワーカースレッドでジョブとして呼び出します。
+        IOCallback callback;
+        /// コールバックに渡す任意のポインタです。
+        Void *pUserData;
+    };
+
+    /// 読み込みの完了情報です。
+    struct IOCompletion
+    {
+        /// 読み込み要求の識別子です。
+        U64 requestId;
+        /// 読み込み先のバッファです。
+        Void *pBuffer;
+        /// バッファのバイトサイズです。
+        USize bufferSize;
+        /// バッファを非同期ファイル入出力システムが確保したかです。
+        /// YESの場合は受け取り側がDeallocateIOBufferで解放する必要があります。
+        Bool isBufferOwned;
+        /// 読み込んだバイトサイズ、または、エラーです。
+        Result<USize, EIOError> result;
+        /// 要求に指定した任意のポインタです。
+        Void *pUserData;
+    };
+
+    /// ダイレクト入出力に使用できるバッファを確保します。
+    /// @param size 確保するバイトサイズです。
+    /// @return 確保したバッファ、または、エラーです。
+    inline Result<Void*, EAllocateError> AllocateIOBuffer(USize size) noexcept
+    {
+        return AllocateAligned(AlignUp(size, IO_DIRECT_ALIGNMENT), IO_DIRECT_ALIGNMENT);
+    }
+
+    /// AllocateIOBufferで確保したバッファを解放します。
+    /// @param size 確保時に指定したバイトサイズです。
+    /// @param pointer 解放するバッファです。
+    /// @return SUCCESS、または、エラーです。
+    inline Result<Success, EDeallocateError> DeallocateIOBuffer(USize size, Void *pointer) noexcept
+    {
+        return DeallocateAligned(AlignUp(size, IO_DIRECT_ALIGNMENT), IO_DIRECT_ALIGNMENT, pointer);
+    }
+
+    /// 非同期ファイル入出力で読み込むファイルを開きます。
+    /// @param path UTF-8のファイルパスです。
+    /// @param isDirect ページキャッシュを経由しないダイレクト入出力で開くかです。
+    /// @return 開いたファイル、または、エラーです。
+    Result<IOFile, EIOError> OpenIOFile(const Char *path, Bool isDirect) noexcept;
+
+    /// OpenIOFileで開いたファイルを閉じます。
+    /// 読み込み中の要求が残っていない必要があります。
+    /// @param file 閉じるファイルです。
+    Void CloseIOFile(IOFile file) noexcept;
+
+    /// 読み込みを要求します。
+    /// @param request 読み込み要求です。
+    /// @return 読み込み要求の識別子、または、エラーです。
+    Result<U64, EIOError> SubmitRead(const IOReadRequest &request) noexcept;
+
+    /// 複数の読み込みをまとめて要求します。
+    /// すべての要求をまとめてキューに追加し、一度のシステムコールで発行します。
+    /// @param pRequests 読み込み要求の配列です。
+    /// @param count 読み込み要求の数です。
+    /// @param pRequestIds 読み込み要求の識別子を書き込む配列です。失敗した要求には0を書き込みます。NONEの場合は書き込みません。
+    /// @return 受け付けた要求の数です。
+    USize SubmitReadBatch(const IOReadRequest *pRequests, USize count, U64 *pRequestIds) noexcept;
+
+    /// 読み込み要求をキャンセルします。
+    /// キャンセルした要求はエラーCANCELEDで完了を通知します。
+    /// @param requestId 読み込み要求の識別子です。
+    /// @retval true 完了していない要求が見つかりました。
+    /// @retval false 要求が見つかりませんでした。
+    Bool CancelRead(U64 requestId) noexcept;
+
+    /// ジョブシステムを使用できない場合に、完了した読み込み要求のコールバックを呼び出します。
+    /// ジョブシステムを使用できる場合は完了をジョブで通知するため、何もしません。
+    /// コールバックは呼び出したスレッドで実行します。
+    /// @param maxCount 呼び出すコールバックの最大数です。
+    /// @return 呼び出したコールバックの数です。
+    USize DispatchIOCompletions(USize maxCount) noexcept;
+}
+
+#endif // !_LEYENGINE_ASYNCIO_HPP
\ No newline at end of file
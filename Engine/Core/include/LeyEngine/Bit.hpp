@@ -0,0 +1,77 @@
+/// @file LeyEngine/Bit.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// ビット操作を提供します。
+#ifndef _LEYENGINE_BIT_HPP
+#define _LEYENGINE_BIT_HPP
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#include "LeyEngine/Primitive.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine 
+{
+    /// 最下位から連続する0のビット数を数えます。
+    /// x86ではtzcnt、ARMではrbit+clzに展開されます。
+    /// @param value 数える値です。0であってはいけません。
+    /// @return 0のビット数です。
+    inline U32 CountTrailingZeros(U64 value) noexcept
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return static_cast<U32>(index);
+#else
+        return static_cast<U32>(__builtin_ctzll(value));
+#endif
+    }
+
+    /// 最上位から連続する0のビット数を数えます。
+    /// @param value 数える値です。0であってはいけません。
+    /// @return 0のビット数です。
+    inline U32 CountLeadingZeros(U64 value) noexcept
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<U32>(63 - index);
+#else
+        return static_cast<U32>(__builtin_clzll(value));
+#endif
+    }
+
+    /// 1のビット数を数えます。
+    /// x86ではpopcnt、ARMではcntに展開されます。
+    /// @param value 数える値です。
+    /// @return 1のビット数です。
+    inline U32 PopCount(U64 value) noexcept
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return static_cast<U32>(__popcnt64(value));
+#else
+        return static_cast<U32>(__builtin_popcountll(value));
+#endif
+    }
+
+    /// 左にビット回転します。
+    /// @param value 回転する値です。
+    /// @param shift 回転するビット数です。
+    /// @return 回転した値です。
+    constexpr U64 RotateLeft(U64 value, U32 shift) noexcept
+    {
+        return (value << (shift & 63)) | (value >> ((64 - shift) & 63));
+    }
+
+    /// 右にビット回転します。
+    /// @param value 回転する値です。
+    /// @param shift 回転するビット数です。
+    /// @return 回転した値です。
+    constexpr U64 RotateRight(U64 value, U32 shift) noexcept
+    {
+        return (value >> (shift & 63)) | (value << ((64 - shift) & 63));
+    }
+}
+
+#endif // !_LEYENGINE_BIT_HPP
\ No newline at end of file
@@ -0,0 +1,341 @@
+/// @file LeyEngine/BitmapPool.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// ビットマップで空きを管理するメモリプールを提供します。
+#ifndef _LEYENGINE_BITMAPPOOL_HPP
+#define _LEYENGINE_BITMAPPOOL_HPP
+
+#include "LeyEngine/Bit.hpp"
+#include "LeyEngine/Memory.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// ビットマッププールのチャンクです。
+        /// ヘッダの後に要素の配列が続きます。
+        /// @tparam T 要素の型です。
+        /// @tparam COUNT チャンクあたりの要素数です。
+        template<typename T, USize COUNT>
+        struct _BitmapPoolChunk
+        {
+            /// ビットマップの語数です。
+            static constexpr USize WORDS_COUNT = COUNT / 64;
+
+            /// ヘッダから要素の配列までのバイトサイズです。
+            static constexpr USize ELEMENTS_OFFSET = (sizeof(U64) * WORDS_COUNT + sizeof(USize) + alignof(T) - 1) & ~(alignof(T) - 1);
+
+            /// チャンク全体のバイトサイズです。
+            static constexpr USize ALLOCATE_SIZE = ELEMENTS_OFFSET + sizeof(T) * COUNT;
+
+            /// 空き要素のビットマップです。1が空きを表します。
+            U64 freeBits[WORDS_COUNT];
+
+            /// 空き要素数です。
+            USize freeCount;
+
+            /// 要素の配列の先頭を返します。
+            T *Elements() noexcept
+            {
+                return Cast<T*>(Cast<U8*>(this) + ELEMENTS_OFFSET);
+            }
+        };
+    }
+    /// @endcond
+
+    /// チャンク毎の空きビットマップで要素を管理するメモリプールです。
+    /// 確保はビットマップの語を末尾の0の数え上げで走査するのみで、解放済みの要素を辿るポインタ追跡は発生しません。
+    /// 使用中の要素の列挙や、複数要素の一括確保、一括解放を行えます。
+    /// 確保した要素は初期化されていないため、使用者が構築、破棄する必要があります。
+    /// 複数スレッドから同時に使用することはできません。
+    /// @tparam T 要素の型です。
+    /// @tparam COUNT チャンクあたりの要素数です。64の倍数である必要があります。
+    template<typename T, USize COUNT = 512>
+    struct BitmapPool
+    {
+        static_assert(COUNT > 0 && COUNT % 64 == 0, "COUNT must be a multiple of 64.");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported.");
+
+        /// 要素の型です。
+        using TElement = T;
+
+        /// チャンクあたりの要素数です。
+        static constexpr USize CHUNK_ELEMENTS_COUNT = COUNT;
+
+    private:
+
+        using TChunk = _Internal::_BitmapPoolChunk<T, COUNT>;
+
+        TChunk **m_ppChunks;             // アドレス順に並べたチャンク配列
+        USize m_chunksCount;             // チャンク数
+        USize m_chunksCapacity;          // チャンク配列長
+        USize m_allocatableChunkIndex;   // 空きがある可能性が高いチャンクの位置
+        USize m_usedCount;               // 使用中の要素数
+
+        // チャンクを追加してアドレス順の位置を返します
+        Result<USize, EAllocateError> AddChunk() noexcept
+        {
+            if (this->m_chunksCount == this->m_chunksCapacity)
+            {
+                Var capacity = this->m_chunksCapacity == 0 ? 8 : this->m_chunksCapacity * 2;
+                Var res = LeyEngine::Allocate(sizeof(TChunk*) * capacity);
+                if (res.IsFailure()) return res.Error();
+                Var ppChunks = Cast<TChunk**>(res.Value());
+                for (USize i = 0; i < this->m_chunksCount; i++) ppChunks[i] = this->m_ppChunks[i];
+                if (this->m_ppChunks != NONE)
+                {
+                    (Void)LeyEngine::Deallocate(sizeof(TChunk*) * this->m_chunksCapacity, this->m_ppChunks);
+                }
+                this->m_ppChunks = ppChunks;
+                this->m_chunksCapacity = capacity;
+            }
+
+            Var res = LeyEngine::Allocate(TChunk::ALLOCATE_SIZE);
+            if (res.IsFailure()) return res.Error();
+            Var pChunk = new(res.Value()) TChunk();
+            for (USize i = 0; i < TChunk::WORDS_COUNT; i++) pChunk->freeBits[i] = ~U64(0);
+            pChunk->freeCount = COUNT;
+
+            // アドレス順に挿入します
+            Var index = this->m_chunksCount;
+            while (index > 0 && Cast<USize>(this->m_ppChunks[index - 1]) > Cast<USize>(pChunk))
+            {
+                this->m_ppChunks[index] = this->m_ppChunks[index - 1];
+                index -= 1;
+            }
+            this->m_ppChunks[index] = pChunk;
+            this->m_chunksCount += 1;
+            return index;
+        }
+
+        // 空きのあるチャンクの位置を返します
+        Result<USize, EAllocateError> FindAllocatableChunk() noexcept
+        {
+            if (this->m_allocatableChunkIndex < this->m_chunksCount && this->m_ppChunks[this->m_allocatableChunkIndex]->freeCount > 0)
+            {
+                return this->m_allocatableChunkIndex;
+            }
+            for (USize i = 0; i < this->m_chunksCount; i++)
+            {
+                if (this->m_ppChunks[i]->freeCount > 0)
+                {
+                    this->m_allocatableChunkIndex = i;
+                    return i;
+                }
+            }
+            Var res = this->AddChunk();
+            if (res.IsSuccess()) this->m_allocatableChunkIndex = res.Value();
+            return res;
+        }
+
+        // 要素を含むチャンクの位置を二分探索します
+        Result<USize, None> FindChunk(const T *pointer) const noexcept
+        {
+            Var adr = Cast<USize>(pointer);
+            USize min = 0;
+            USize max = this->m_chunksCount;
+            while (min < max)
+            {
+                Var mid = (min + max) / 2;
+                Var top = Cast<USize>(this->m_ppChunks[mid]);
+                if (adr < top)                                  max = mid;
+                else if (adr >= top + TChunk::ALLOCATE_SIZE)    min = mid + 1;
+                else                                            return mid;
+            }
+            return NONE;
+        }
+
+        // 要素をチャンクへ戻します
+        // 要素の先頭でないポインタや、解放済みの要素は戻しません
+        Result<Success, EDeallocateError> Release(TChunk *pChunk, T *pointer) noexcept
+        {
+            Var adr = Cast<USize>(pointer);
+            Var top = Cast<USize>(pChunk->Elements());
+            if (adr < top || (adr - top) % sizeof(T) != 0) return EDeallocateError::INVALID_POINTER;
+            Var index = (adr - top) / sizeof(T);
+            Var bit = U64(1) << (index % 64);
+            if ((pChunk->freeBits[index / 64] & bit) != 0) return EDeallocateError::DOUBLE_DEALLOCATE;
+            pChunk->freeBits[index / 64] |= bit;
+            pChunk->freeCount += 1;
+            this->m_usedCount -= 1;
+            return SUCCESS;
+        }
+
+    public:
+
+        /// コンストラクタです。
+        BitmapPool() noexcept
+            : m_ppChunks(NONE)
+            , m_chunksCount(0)
+            , m_chunksCapacity(0)
+            , m_allocatableChunkIndex(0)
+            , m_usedCount(0)
+        {}
+
+        BitmapPool(const BitmapPool<T, COUNT> &origin) = delete;
+        BitmapPool<T, COUNT> &operator=(const BitmapPool<T, COUNT> &origin) = delete;
+
+        /// デストラクタです。
+        /// 使用中の要素は破棄されずにメモリのみ解放されます。
+        ~BitmapPool() noexcept
+        {
+            for (USize i = 0; i < this->m_chunksCount; i++)
+            {
+                (Void)LeyEngine::Deallocate(TChunk::ALLOCATE_SIZE, this->m_ppChunks[i]);
+            }
+            if (this->m_ppChunks != NONE)
+            {
+                (Void)LeyEngine::Deallocate(sizeof(TChunk*) * this->m_chunksCapacity, this->m_ppChunks);
+            }
+        }
+
+        /// 要素を1つ確保します。
+        /// @return 確保した要素のポインタ、または、エラーです。
+        Result<T*, EAllocateError> Allocate() noexcept
+        {
+            Var res = this->FindAllocatableChunk();
+            if (res.IsFailure()) return res.Error();
+            Var pChunk = this->m_ppChunks[res.Value()];
+
+            USize word = 0;
+            while (pChunk->freeBits[word] == 0) word += 1;
+            Var bit = CountTrailingZeros(pChunk->freeBits[word]);
+            pChunk->freeBits[word] &= pChunk->freeBits[word] - 1;
+            pChunk->freeCount -= 1;
+            this->m_usedCount += 1;
+            return pChunk->Elements() + word * 64 + bit;
+        }
+
+        /// 要素を一括で確保します。
+        /// 空きビットマップの語単位で確保するため、1要素ずつ確保するより高速です。
+        /// 失敗した場合は確保済みの要素をすべて戻します。
+        /// @param count 確保する要素数です。
+        /// @param pointers 確保した要素のポインタを受け取るcount要素の配列です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, EAllocateError> AllocateBatch(USize count, T **pointers) noexcept
+        {
+            USize allocated = 0;
+            while (allocated < count)
+            {
+                Var res = this->FindAllocatableChunk();
+                if (res.IsFailure())
+                {
+                    this->DeallocateBatch(allocated, pointers);
+                    return res.Error();
+                }
+                Var pChunk = this->m_ppChunks[res.Value()];
+                Var pElements = pChunk->Elements();
+
+                for (USize word = 0; word < TChunk::WORDS_COUNT && allocated < count; word++)
+                {
+                    Var bits = pChunk->freeBits[word];
+                    if (bits == 0) continue;
+
+                    // 語の空きをまとめて取得します
+                    Var taken = PopCount(bits);
+                    if (taken > count - allocated)
+                    {
+                        taken = static_cast<U32>(count - allocated);
+                    }
+                    for (U32 i = 0; i < taken; i++)
+                    {
+                        pointers[allocated++] = pElements + word * 64 + CountTrailingZeros(bits);
+                        bits &= bits - 1;
+                    }
+                    pChunk->freeBits[word] = bits;
+                    pChunk->freeCount -= taken;
+                    this->m_usedCount += taken;
+                }
+            }
+            return SUCCESS;
+        }
+
+        /// 要素を解放します。
+        /// 解放済みの要素を再び解放した場合はDOUBLE_DEALLOCATEを返し、プールは変更しません。
+        /// @param pointer 解放する要素のポインタです。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, EDeallocateError> Deallocate(T *pointer) noexcept
+        {
+            Var res = this->FindChunk(pointer);
+            if (res.IsFailure()) return EDeallocateError::BAD_DEALLOCATE;
+            Var pChunk = this->m_ppChunks[res.Value()];
+            Var released = this->Release(pChunk, pointer);
+            if (released.IsFailure()) return released.Error();
+            this->m_allocatableChunkIndex = res.Value();
+            return SUCCESS;
+        }
+
+        /// 要素を一括で解放します。
+        /// 同じチャンクの要素が連続する場合はチャンクの探索を省略します。
+        /// @param count 解放する要素数です。
+        /// @param pointers 解放する要素のポインタの配列です。
+        /// @return SUCCESS、または、このプールの要素でないポインタや解放済みの要素が含まれていた場合のエラーです。
+        Result<Success, EDeallocateError> DeallocateBatch(USize count, T *const *pointers) noexcept
+        {
+            Result<Success, EDeallocateError> result = SUCCESS;
+            TChunk *pChunk = NONE;
+            USize chunkIndex = 0;
+            for (USize i = 0; i < count; i++)
+            {
+                Var adr = Cast<USize>(pointers[i]);
+                if (pChunk == NONE || adr < Cast<USize>(pChunk) || adr >= Cast<USize>(pChunk) + TChunk::ALLOCATE_SIZE)
+                {
+                    Var res = this->FindChunk(pointers[i]);
+                    if (res.IsFailure())
+                    {
+                        result = EDeallocateError::BAD_DEALLOCATE;
+                        continue;
+                    }
+                    chunkIndex = res.Value();
+                    pChunk = this->m_ppChunks[chunkIndex];
+                }
+                Var released = this->Release(pChunk, pointers[i]);
+                if (released.IsFailure()) result = released.Error();
+            }
+            if (pChunk != NONE) this->m_allocatableChunkIndex = chunkIndex;
+            return result;
+        }
+
+        /// 使用中の要素をアドレス順に関数へ渡します。
+        /// 空きビットマップの反転を末尾の0の数え上げで走査するため、空き要素には触れません。
+        /// @param function 要素の参照を受け取る関数です。
+        template<typename Fn>
+        Void ForEach(Fn &&function)
+        {
+            for (USize c = 0; c < this->m_chunksCount; c++)
+            {
+                Var pChunk = this->m_ppChunks[c];
+                if (pChunk->freeCount == COUNT) continue;
+                Var pElements = pChunk->Elements();
+                for (USize word = 0; word < TChunk::WORDS_COUNT; word++)
+                {
+                    Var bits = ~pChunk->freeBits[word];
+                    while (bits != 0)
+                    {
+                        function(pElements[word * 64 + CountTrailingZeros(bits)]);
+                        bits &= bits - 1;
+                    }
+                }
+            }
+        }
+
+        /// 使用中の要素数を返します。
+        /// @return 要素数です。
+        USize Count() const noexcept
+        {
+            return this->m_usedCount;
+        }
+
+        /// すべてのチャンクが管理する要素数を返します。
+        /// @return 要素数です。
+        USize Capacity() const noexcept
+        {
+            return this->m_chunksCount * COUNT;
+        }
+    };
+}
+
+#endif // !_LEYENGINE_BITMAPPOOL_HPP
\ No newline at end of file
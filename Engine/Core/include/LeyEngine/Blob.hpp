@@ -0,0 +1,483 @@
+/// @file LeyEngine/Blob.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// 読み込んだまま使用できる再配置可能なバイナリを提供します。
+#ifndef _LEYENGINE_BLOB_HPP
+#define _LEYENGINE_BLOB_HPP
+
+#include <cstring>
+#include "LeyEngine/Collections/Array.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// バイナリのエラーです。
+    enum class EBlobError
+    {
+        /// メモリ確保に失敗しました。
+        BAD_ALLOCATE,
+        /// バイナリが大きすぎました。
+        TOO_LARGE,
+        /// バイナリの形式が不正でした。
+        INVALID_FORMAT,
+        /// バイナリのバージョン、または、ルートの型が一致しませんでした。
+        VERSION_MISMATCH,
+        /// バイナリの先頭が必要なアライメントに揃っていませんでした。
+        MISALIGNED,
+    };
+
+    /// バイナリの先頭のマジックナンバー「LEYB」です。
+    constexpr U32 BLOB_MAGIC = 0x4259454C;
+
+    /// バイナリに配置できる型の最大のアライメントです。
+    constexpr USize BLOB_MAX_ALIGNMENT = 64;
+
+    /// バイナリの先頭に置かれるヘッダです。
+    struct BlobHeader
+    {
+        /// マジックナンバーです。
+        U32 magic;
+        /// 呼び出し側が定めるデータ形式のバージョンです。
+        U32 version;
+        /// ヘッダを含むバイナリのバイトサイズです。
+        U32 size;
+        /// バイナリの先頭に必要なアライメントです。
+        U32 alignment;
+        /// ルートのバイナリ先頭からのバイトオフセットです。
+        U32 rootOffset;
+        /// ルートのバイトサイズです。
+        U32 rootSize;
+    };
+
+    /// 自身のアドレスからの相対オフセットで対象を指すポインタです。
+    /// バイナリごとコピーやマップしても修正せずに使用できます。
+    /// 値のコピーはオフセットをそのままコピーするため、対象と共に移動する場合にのみ有効です。
+    /// @tparam T 対象の型です。
+    template<typename T>
+    struct RelativePointer
+    {
+    private:
+
+        I32 m_offset; // 自身からのバイトオフセット、0の場合はNONE
+
+    public:
+
+        /// NONEを指すポインタを作成します。
+        RelativePointer() noexcept
+            : m_offset(0)
+        {
+        }
+
+        /// 対象を設定します。
+        /// @param pointer 対象です。自身から±2GiBの範囲にある必要があります。
+        Void Set(const T *pointer) noexcept
+        {
+            this->m_offset = pointer == NONE ? 0 : static_cast<I32>(Cast<ISize>(pointer) - Cast<ISize>(this));
+        }
+
+        /// 対象を返します。
+        /// @return 対象、または、NONEです。
+        T *Get() noexcept
+        {
+            return this->m_offset == 0 ? NONE : Cast<T*>(Cast<U8*>(this) + this->m_offset);
+        }
+
+        /// 対象を返します。
+        /// @return 対象、または、NONEです。
+        const T *Get() const noexcept
+        {
+            return this->m_offset == 0 ? NONE : Cast<const T*>(Cast<const U8*>(this) + this->m_offset);
+        }
+
+        /// NONEを指しているかを返します。
+        /// @retval true NONEを指しています。
+        /// @retval false 対象を指しています。
+        Bool IsNone() const noexcept
+        {
+            return this->m_offset == 0;
+        }
+
+        /// 対象にアクセスします。
+        T *operator->() noexcept
+        {
+            return this->Get();
+        }
+
+        /// 対象にアクセスします。
+        const T *operator->() const noexcept
+        {
+            return this->Get();
+        }
+
+        /// 対象を参照します。
+        T &operator*() noexcept
+        {
+            return *this->Get();
+        }
+
+        /// 対象を参照します。
+        const T &operator*() const noexcept
+        {
+            return *this->Get();
+        }
+    };
+
+    /// 自身のアドレスからの相対オフセットで要素を指す配列です。
+    /// @tparam T 要素型です。
+    template<typename T>
+    struct RelativeArray
+    {
+    private:
+
+        RelativePointer<T> m_pElements; // 要素配列
+        U32 m_count;                    // 要素数
+
+    public:
+
+        /// 空の配列を作成します。
+        RelativeArray() noexcept
+            : m_pElements()
+            , m_count(0)
+        {
+        }
+
+        /// 要素を設定します。
+        /// @param pElements 要素配列です。
+        /// @param count 要素数です。
+        Void Set(const T *pElements, U32 count) noexcept
+        {
+            this->m_pElements.Set(count == 0 ? NONE : pElements);
+            this->m_count = count;
+        }
+
+        /// 要素数を返します。
+        /// @return 要素数です。
+        USize Count() const noexcept
+        {
+            return this->m_count;
+        }
+
+        /// 要素配列を返します。
+        /// @return 要素配列です。
+        T *Data() noexcept
+        {
+            return this->m_pElements.Get();
+        }
+
+        /// 要素配列を返します。
+        /// @return 要素配列です。
+        const T *Data() const noexcept
+        {
+            return this->m_pElements.Get();
+        }
+
+        /// 要素を参照します。
+        /// @param index 要素の位置です。
+        /// @return 要素です。
+        T &operator[](USize index) noexcept
+        {
+            return this->Data()[index];
+        }
+
+        /// 要素を参照します。
+        /// @param index 要素の位置です。
+        /// @return 要素です。
+        const T &operator[](USize index) const noexcept
+        {
+            return this->Data()[index];
+        }
+
+        /// 先頭の要素を指すポインタを返します。
+        T *begin() noexcept
+        {
+            return this->Data();
+        }
+
+        /// 先頭の要素を指すポインタを返します。
+        const T *begin() const noexcept
+        {
+            return this->Data();
+        }
+
+        /// 末尾の次を指すポインタを返します。
+        T *end() noexcept
+        {
+            return this->Data() + this->m_count;
+        }
+
+        /// 末尾の次を指すポインタを返します。
+        const T *end() const noexcept
+        {
+            return this->Data() + this->m_count;
+        }
+    };
+
+    /// バイナリにそのまま配置できる型かを判定します。
+    /// 自明にコピー可能で、絶対アドレスを持たない型が該当します。
+    /// 相対ポインタ、相対配列は自明にコピー可能なため、それらを持つ型も該当します。
+    /// 絶対アドレスを持つ独自の型はfalseに特殊化する必要があります。
+    /// @tparam T 判定する型です。
+    template<typename T>
+    struct IsRelocatable
+    {
+        /// 配置できるかです。
+        static constexpr Bool VALUE = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> && !std::is_member_pointer_v<T>;
+    };
+
+    /// 配列は要素が配置できれば配置できます。
+    template<typename T, USize N>
+    struct IsRelocatable<T[N]>
+    {
+        /// 配置できるかです。
+        static constexpr Bool VALUE = IsRelocatable<T>::VALUE;
+    };
+
+    /// 成功と失敗が配置できる結果は配置できます。
+    template<typename S, typename F>
+    struct IsRelocatable<Result<S, F>>
+    {
+        /// 配置できるかです。
+        static constexpr Bool VALUE = IsRelocatable<S>::VALUE && IsRelocatable<F>::VALUE
+            && std::is_trivially_destructible_v<S> && std::is_trivially_destructible_v<F>;
+    };
+
+    /// すべての型が配置できるバリアントは配置できます。
+    template<typename...Ts>
+    struct IsRelocatable<Variant<Ts...>>
+    {
+        /// 配置できるかです。
+        static constexpr Bool VALUE = ((IsRelocatable<Ts>::VALUE && std::is_trivially_destructible_v<Ts>) && ...);
+    };
+
+    /// バイナリ内の値の位置です。
+    /// 構築中はバッファが移動するため、ポインタの代わりに位置で値を保持します。
+    /// @tparam T 値の型です。
+    template<typename T>
+    struct BlobOffset
+    {
+        /// バイナリ先頭からのバイトオフセットです。
+        U32 offset;
+    };
+
+    /// 再配置可能なバイナリを構築します。
+    /// 値は連続したバッファにアライメントを揃えて配置し、ポインタは相対ポインタで結びます。
+    /// 構築したバイナリはファイルに書き込み、読み込んだメモリをOpenBlobでそのまま参照できます。
+    struct BlobBuilder
+    {
+    private:
+
+        U8 *m_pBuffer;      // バッファ
+        USize m_capacity;   // バッファのバイトサイズ
+        USize m_size;       // 使用済みのバイトサイズ
+        USize m_alignment;  // 配置した値の最大のアライメント
+
+        // コンストラクタ
+        BlobBuilder(U8 *pBuffer, USize capacity) noexcept
+            : m_pBuffer(pBuffer)
+            , m_capacity(capacity)
+            , m_size(sizeof(BlobHeader))
+            , m_alignment(alignof(BlobHeader))
+        {
+            std::memset(pBuffer, 0, capacity);
+        }
+
+        // 領域を確保し、位置を返します
+        Result<USize, EBlobError> Reserve(USize size, USize alignment) noexcept
+        {
+            Var offset = AlignUp(this->m_size, alignment);
+            // RelativePointerのオフセットはI32のため、バイナリ全体をその範囲に収めます
+            Var maxSize = static_cast<USize>(I32_MAX);
+            if (offset > maxSize || size > maxSize - offset) return EBlobError::TOO_LARGE;
+            if (offset + size > this->m_capacity)
+            {
+                Var capacity = this->m_capacity * 2;
+                while (capacity < offset + size) capacity *= 2;
+                Var bufferResult = AllocateAligned(capacity, BLOB_MAX_ALIGNMENT);
+                if (bufferResult.IsFailure()) return EBlobError::BAD_ALLOCATE;
+                Var pBuffer = Cast<U8*>(bufferResult.Value());
+                std::memcpy(pBuffer, this->m_pBuffer, this->m_size);
+                std::memset(pBuffer + this->m_size, 0, capacity - this->m_size);
+                (Void)DeallocateAligned(this->m_capacity, BLOB_MAX_ALIGNMENT, this->m_pBuffer);
+                this->m_pBuffer = pBuffer;
+                this->m_capacity = capacity;
+            }
+            this->m_size = offset + size;
+            if (alignment > this->m_alignment) this->m_alignment = alignment;
+            return offset;
+        }
+
+    public:
+
+        /// 作成します。
+        /// @param capacity 最初に確保するバッファのバイトサイズです。
+        /// @return ビルダー、または、エラーです。
+        static Result<BlobBuilder, EBlobError> Create(USize capacity = 4096) noexcept
+        {
+            if (capacity < sizeof(BlobHeader)) capacity = sizeof(BlobHeader);
+            Var bufferResult = AllocateAligned(capacity, BLOB_MAX_ALIGNMENT);
+            if (bufferResult.IsFailure()) return EBlobError::BAD_ALLOCATE;
+            return BlobBuilder(Cast<U8*>(bufferResult.Value()), capacity);
+        }
+
+        BlobBuilder(const BlobBuilder&) = delete;
+        BlobBuilder &operator=(const BlobBuilder&) = delete;
+
+        /// ムーブします。
+        /// @param origin ムーブ元です。
+        BlobBuilder(BlobBuilder &&origin) noexcept
+            : m_pBuffer(origin.m_pBuffer)
+            , m_capacity(origin.m_capacity)
+            , m_size(origin.m_size)
+            , m_alignment(origin.m_alignment)
+        {
+            origin.m_pBuffer = NONE;
+            origin.m_capacity = 0;
+            origin.m_size = 0;
+        }
+
+        /// デストラクタです。
+        ~BlobBuilder() noexcept
+        {
+            if (this->m_pBuffer != NONE)
+            {
+                (Void)DeallocateAligned(this->m_capacity, BLOB_MAX_ALIGNMENT, this->m_pBuffer);
+            }
+        }
+
+        /// 0で初期化した値を配置します。
+        /// @tparam T 値の型です。
+        /// @param count 値の数です。
+        /// @return 先頭の値の位置、または、エラーです。
+        template<typename T>
+        Result<BlobOffset<T>, EBlobError> Reserve(USize count = 1) noexcept
+        {
+            static_assert(IsRelocatable<T>::VALUE, "T must be relocatable.");
+            static_assert(alignof(T) <= BLOB_MAX_ALIGNMENT, "T is over-aligned.");
+            // バイトサイズの計算が桁あふれしないよう先に判定します
+            if (count > USIZE_MAX / sizeof(T)) return EBlobError::TOO_LARGE;
+            return this->Reserve(sizeof(T) * count, alignof(T)).Map([](USize offset) noexcept
+            {
+                return BlobOffset<T>{ static_cast<U32>(offset) };
+            });
+        }
+
+        /// 値をコピーして配置します。
+        /// @tparam T 値の型です。
+        /// @param pValues 値の配列です。
+        /// @param count 値の数です。
+        /// @return 先頭の値の位置、または、エラーです。
+        template<typename T>
+        Result<BlobOffset<T>, EBlobError> Write(const T *pValues, USize count) noexcept
+        {
+            Var result = this->Reserve<T>(count);
+            if (result.IsSuccess() && count != 0)
+            {
+                std::memcpy(this->m_pBuffer + result.Value().offset, pValues, sizeof(T) * count);
+            }
+            return result;
+        }
+
+        /// 値をコピーして配置します。
+        /// @tparam T 値の型です。
+        /// @param value 値です。
+        /// @return 値の位置、または、エラーです。
+        template<typename T>
+        Result<BlobOffset<T>, EBlobError> Write(const T &value) noexcept
+        {
+            return this->Write(&value, 1);
+        }
+
+        /// 配列の要素をコピーして配置します。
+        /// @tparam T 要素型です。
+        /// @tparam A 要素アロケータです。
+        /// @param array 配列です。
+        /// @return 先頭の要素の位置、または、エラーです。
+        template<typename T, typename A>
+        Result<BlobOffset<T>, EBlobError> Write(const Array<T, A> &array) noexcept
+        {
+            return this->Write(array.Data(), array.Count());
+        }
+
+        /// 配置した値を参照します。
+        /// 次に値を配置するとバッファが移動するため、参照は無効になります。
+        /// @tparam T 値の型です。
+        /// @param offset 値の位置です。
+        /// @return 値です。
+        template<typename T>
+        T &At(BlobOffset<T> offset) noexcept
+        {
+            return *Cast<T*>(this->m_pBuffer + offset.offset);
+        }
+
+        /// 配置した相対ポインタに対象を設定します。
+        /// @tparam T 対象の型です。
+        /// @param pointer Atで参照した相対ポインタです。
+        /// @param target 対象の位置です。
+        template<typename T>
+        Void Link(RelativePointer<T> &pointer, BlobOffset<T> target) noexcept
+        {
+            pointer.Set(Cast<const T*>(this->m_pBuffer + target.offset));
+        }
+
+        /// 配置した相対配列に要素を設定します。
+        /// @tparam T 要素型です。
+        /// @param array Atで参照した相対配列です。
+        /// @param target 先頭の要素の位置です。
+        /// @param count 要素数です。
+        template<typename T>
+        Void Link(RelativeArray<T> &array, BlobOffset<T> target, USize count) noexcept
+        {
+            array.Set(Cast<const T*>(this->m_pBuffer + target.offset), static_cast<U32>(count));
+        }
+
+        /// ヘッダを書き込み、バイナリを完成させます。
+        /// @tparam T ルートの型です。
+        /// @param root ルートの位置です。
+        /// @param version 呼び出し側が定めるデータ形式のバージョンです。
+        template<typename T>
+        Void Finish(BlobOffset<T> root, U32 version) noexcept
+        {
+            BlobHeader header = { BLOB_MAGIC, version, static_cast<U32>(this->m_size), static_cast<U32>(this->m_alignment), root.offset, static_cast<U32>(sizeof(T)) };
+            std::memcpy(this->m_pBuffer, &header, sizeof(header));
+        }
+
+        /// バイナリの先頭を返します。
+        /// @return バイナリの先頭です。BLOB_MAX_ALIGNMENTに揃っています。
+        const U8 *Data() const noexcept
+        {
+            return this->m_pBuffer;
+        }
+
+        /// バイナリのバイトサイズを返します。
+        /// @return バイトサイズです。
+        USize Size() const noexcept
+        {
+            return this->m_size;
+        }
+    };
+
+    /// 読み込んだバイナリのルートを返します。
+    /// ヘッダのみを検証し、要素毎の解析や相対ポインタの修正は行いません。
+    /// @tparam T ルートの型です。
+    /// @param pData バイナリの先頭です。
+    /// @param size バイナリのバイトサイズです。
+    /// @param version 期待するデータ形式のバージョンです。
+    /// @return ルート、または、エラーです。
+    template<typename T>
+    Result<const T*, EBlobError> OpenBlob(const Void *pData, USize size, U32 version) noexcept
+    {
+        if (pData == NONE || size < sizeof(BlobHeader)) return EBlobError::INVALID_FORMAT;
+        BlobHeader header;
+        std::memcpy(&header, pData, sizeof(header));
+        if (header.magic != BLOB_MAGIC || header.size > size || header.rootOffset > header.size
+            || header.rootSize > header.size - header.rootOffset)
+        {
+            return EBlobError::INVALID_FORMAT;
+        }
+        if (header.version != version || header.rootSize != sizeof(T)) return EBlobError::VERSION_MISMATCH;
+        if (header.alignment == 0 || Cast<USize>(pData) % header.alignment != 0 || header.rootOffset % alignof(T) != 0) return EBlobError::MISALIGNED;
+        return Cast<const T*>(Cast<const U8*>(pData) + header.rootOffset);
+    }
+}
+
+#endif // !_LEYENGINE_BLOB_HPP
\ No newline at end of file
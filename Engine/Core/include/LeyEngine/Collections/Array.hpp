@@ -5,7 +5,11 @@
 #ifndef _LEYENGINE_COLLECTIONS_ARRAY_HPP
 #define _LEYENGINE_COLLECTIONS_ARRAY_HPP
 
+#include <cstring>
 #include <iterator>
+#include <new>
+#include <type_traits>
+#include "LeyEngine/Hash.hpp"
 #include "LeyEngine/Memory.hpp"
 
 /// LeyEngineのすべての機能を含む名前空間です。
@@ -121,18 +125,64 @@ namespace LeyEngine
 
         /// 要素にアクセスします。
         /// @exception NullRefarenceException 要素がnullptrの可能性があります。
-        T &operator*();
+        T &operator*() const noexcept
+        {
+            return *this->m_element;
+        }
 
-        /// 要素にアクセスします。
-        /// @exception NullRefarenceException 要素がnullptrの可能性があります。
-        const T &operator*() const;
+        /// 要素のメンバにアクセスします。
+        /// @return 要素のポインタです。
+        T *operator->() const noexcept
+        {
+            return this->m_element;
+        }
+
+        /// 指定分進めた位置の要素にアクセスします。
+        /// @param index 進める数です。
+        /// @return 要素です。
+        T &operator[](ISize index) const noexcept
+        {
+            return this->m_element[index];
+        }
+
+        /// 指定分進めたイテレータを返します。
+        /// @param step 進める数です。
+        /// @return イテレータです。
+        PointerIterator<T> operator+(ISize step) const noexcept
+        {
+            return PointerIterator<T>(this->m_element + step);
+        }
+
+        /// 指定分戻ったイテレータを返します。
+        /// @param step 戻る数です。
+        /// @return イテレータです。
+        PointerIterator<T> operator-(ISize step) const noexcept
+        {
+            return PointerIterator<T>(this->m_element - step);
+        }
+
+        /// イテレータ間の距離を返します。
+        /// @param other 開始位置のイテレータです。
+        /// @return 距離です。
+        ISize operator-(const PointerIterator<T> &other) const noexcept
+        {
+            return this->m_element - other.m_element;
+        }
+
+        /// 要素の位置を比較します。
+        /// @param other 比較対象です。
+        /// @return 前にある場合、真です。
+        Bool operator<(const PointerIterator<T> &other) const noexcept
+        {
+            return this->m_element < other.m_element;
+        }
 
         /// 要素が同等か比較します。
         /// @param other 比較対象です。
         /// @return 同等の場合、真です。
         Bool operator==(const PointerIterator<T> &other) const noexcept
         {
-            return l.m_element == r.m_element;
+            return this->m_element == other.m_element;
         }
 
         /// 要素が不等か比較します。
@@ -140,7 +190,7 @@ namespace LeyEngine
         /// @return 不等の場合、真です。
         Bool operator!=(const PointerIterator<T> &other) const noexcept
         {
-            return l.m_element != r.m_element;
+            return this->m_element != other.m_element;
         }
     };
 
@@ -148,7 +198,7 @@ namespace LeyEngine
     template<typename T>
     class ConstPointerIterator
     {
-        T *m_element;
+        const T *m_element;
     
     public:
 
@@ -169,7 +219,7 @@ namespace LeyEngine
 
         /// 初期化します。
         /// @param pointer メモリ上の現在地を指すポインタです。
-        ConstPointerIterator(T *pointer) noexcept
+        ConstPointerIterator(const T *pointer) noexcept
         : m_element(pointer)
         {}
 
@@ -254,14 +304,64 @@ namespace LeyEngine
 
         /// 要素にアクセスします。
         /// @exception NullRefarenceException 要素がnullptrの可能性があります。
-        const T &operator*() const;
+        const T &operator*() const noexcept
+        {
+            return *this->m_element;
+        }
+
+        /// 要素のメンバにアクセスします。
+        /// @return 要素のポインタです。
+        const T *operator->() const noexcept
+        {
+            return this->m_element;
+        }
+
+        /// 指定分進めた位置の要素にアクセスします。
+        /// @param index 進める数です。
+        /// @return 要素です。
+        const T &operator[](ISize index) const noexcept
+        {
+            return this->m_element[index];
+        }
+
+        /// 指定分進めたイテレータを返します。
+        /// @param step 進める数です。
+        /// @return イテレータです。
+        ConstPointerIterator<T> operator+(ISize step) const noexcept
+        {
+            return ConstPointerIterator<T>(this->m_element + step);
+        }
+
+        /// 指定分戻ったイテレータを返します。
+        /// @param step 戻る数です。
+        /// @return イテレータです。
+        ConstPointerIterator<T> operator-(ISize step) const noexcept
+        {
+            return ConstPointerIterator<T>(this->m_element - step);
+        }
+
+        /// イテレータ間の距離を返します。
+        /// @param other 開始位置のイテレータです。
+        /// @return 距離です。
+        ISize operator-(const ConstPointerIterator<T> &other) const noexcept
+        {
+            return this->m_element - other.m_element;
+        }
+
+        /// 要素の位置を比較します。
+        /// @param other 比較対象です。
+        /// @return 前にある場合、真です。
+        Bool operator<(const ConstPointerIterator<T> &other) const noexcept
+        {
+            return this->m_element < other.m_element;
+        }
 
         /// 要素が同等か比較します。
         /// @param other 比較対象です。
         /// @return 同等の場合、真です。
         Bool operator==(const ConstPointerIterator<T> &other) const noexcept
         {
-            return l.m_element == r.m_element;
+            return this->m_element == other.m_element;
         }
 
         /// 要素が不等か比較します。
@@ -269,7 +369,7 @@ namespace LeyEngine
         /// @return 不等の場合、真です。
         Bool operator!=(const ConstPointerIterator<T> &other) const noexcept
         {
-            return l.m_element != r.m_element;
+            return this->m_element != other.m_element;
         }
     };
 
@@ -292,7 +392,7 @@ namespace LeyEngine
         using TDeallocateError = typename TAllocator::TDeallocateError;
 
         /// コピーで起こりうるエラー型です。
-        using TCopyError = Variant<typename TAllocateError, typename TDeallocateError>;
+        using TCopyError = Variant<TAllocateError, TDeallocateError>;
 
     private:
         
@@ -313,26 +413,240 @@ namespace LeyEngine
     
         /// 作成します。
         /// @param length 配列長です。
-        /// @param allocator アロケータのリザルト値です。
-        static Result<Array<TElement, TAllocator>&&, TAllocateError> Create(USize length, const TAllocator &allocator = TAllocator()) noexcept
+        /// @param allocator アロケータです。
+        /// @return 配列、または、エラーです。
+        static Result<Array<TElement, TAllocator>, TAllocateError> Create(USize length, const TAllocator &allocator = TAllocator()) noexcept
         {
-            TElement* pElements = NONE;
-            TAllocateError error;
-            Result<TElement*, TAllocateError> buffRes = allocator.Allocate(length);
-            if (buffRes.IsSuccess(pElements, error))
+            TAllocator alloc = allocator;
+            Var buffRes = alloc.Allocate(length);
+            if (buffRes.IsSuccess())
             {
-                return Move(Array<TElement, TAllocator>(allocator, length, 0, pElements));
+                return Array<TElement, TAllocator>(alloc, length, 0, buffRes.Value());
             }
             else
             {
-                return Move(error);
+                return buffRes.Error();
             }
         }
 
+        /// ムーブします。
+        /// @param origin ムーブ元です。
+        Array(Array<TElement, TAllocator> &&origin) noexcept
+            : m_allocator(Move(origin.m_allocator))
+            , m_elementsLength(origin.m_elementsLength)
+            , m_elementsCount(origin.m_elementsCount)
+            , m_pElements(origin.m_pElements)
+        {
+            origin.m_elementsLength = 0;
+            origin.m_elementsCount = 0;
+            origin.m_pElements = NONE;
+        }
+
         /// デストラクタです。
         ~Array() noexcept
         {
-            this->m_allocator.Deallocate(this->m_elementsLength, this->m_pElements);
+            this->Clear();
+            if (this->m_pElements != NONE)
+            {
+                (Void)this->m_allocator.Deallocate(this->m_elementsLength, this->m_pElements);
+            }
+        }
+
+        /// 配列長を返します。
+        /// @return 配列長です。
+        USize Length() const noexcept
+        {
+            return this->m_elementsLength;
+        }
+
+        /// 要素数を返します。
+        /// @return 要素数です。
+        USize Count() const noexcept
+        {
+            return this->m_elementsCount;
+        }
+
+        /// 要素配列の先頭を返します。
+        /// @return 要素配列の先頭です。
+        TElement *Data() noexcept
+        {
+            return this->m_pElements;
+        }
+
+        /// 要素配列の先頭を返します。
+        /// @return 要素配列の先頭です。
+        const TElement *Data() const noexcept
+        {
+            return this->m_pElements;
+        }
+
+        /// アロケータを返します。
+        /// @return アロケータです。
+        const TAllocator &GetAllocator() const noexcept
+        {
+            return this->m_allocator;
+        }
+
+        /// 要素にアクセスします。
+        /// @param index 要素数未満のインデックスです。
+        /// @return 要素です。
+        TElement &operator[](USize index) noexcept
+        {
+            return this->m_pElements[index];
+        }
+
+        /// 要素にアクセスします。
+        /// @param index 要素数未満のインデックスです。
+        /// @return 要素です。
+        const TElement &operator[](USize index) const noexcept
+        {
+            return this->m_pElements[index];
+        }
+
+        /// 先頭のイテレータを返します。
+        /// @return イテレータです。
+        PointerIterator<TElement> begin() noexcept
+        {
+            return PointerIterator<TElement>(this->m_pElements);
+        }
+
+        /// 末尾のイテレータを返します。
+        /// @return イテレータです。
+        PointerIterator<TElement> end() noexcept
+        {
+            return PointerIterator<TElement>(this->m_pElements + this->m_elementsCount);
+        }
+
+        /// 先頭のイテレータを返します。
+        /// @return イテレータです。
+        ConstPointerIterator<TElement> begin() const noexcept
+        {
+            return ConstPointerIterator<TElement>(this->m_pElements);
+        }
+
+        /// 末尾のイテレータを返します。
+        /// @return イテレータです。
+        ConstPointerIterator<TElement> end() const noexcept
+        {
+            return ConstPointerIterator<TElement>(this->m_pElements + this->m_elementsCount);
+        }
+
+        /// 配列長を指定以上に広げます。
+        /// 広げる場合は要素を新しい配列にムーブします。
+        /// @param length 配列長です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Reserve(USize length) noexcept
+        {
+            if (length <= this->m_elementsLength) return SUCCESS;
+            Var buffRes = this->m_allocator.Allocate(length);
+            if (buffRes.IsFailure()) return buffRes.Error();
+            Var pElements = buffRes.Value();
+            for (USize i = 0; i < this->m_elementsCount; i++)
+            {
+                new(pElements + i) TElement(Move(this->m_pElements[i]));
+                this->m_pElements[i].~TElement();
+            }
+            if (this->m_pElements != NONE)
+            {
+                (Void)this->m_allocator.Deallocate(this->m_elementsLength, this->m_pElements);
+            }
+            this->m_pElements = pElements;
+            this->m_elementsLength = length;
+            return SUCCESS;
+        }
+
+        /// 末尾に要素を追加します。
+        /// 配列長が足りない場合は2倍に広げます。
+        /// @param value 追加する要素です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Push(const TElement &value) noexcept
+        {
+            return this->Emplace(value);
+        }
+
+        /// 末尾に要素を追加します。
+        /// 配列長が足りない場合は2倍に広げます。
+        /// @param value 追加する要素です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Push(TElement &&value) noexcept
+        {
+            return this->Emplace(Move(value));
+        }
+
+        /// 末尾に要素を構築します。
+        /// 配列長が足りない場合は2倍に広げます。
+        /// @param args 構築の引数です。
+        /// @return SUCCESS、または、エラーです。
+        template<typename... Args>
+        Result<Success, TAllocateError> Emplace(Args&&... args) noexcept
+        {
+            if (this->m_elementsCount == this->m_elementsLength)
+            {
+                // 引数が自身の要素を参照している場合に備え、古い要素を解放する前に新しい配列へ構築します
+                Var length = this->m_elementsLength < 4 ? 4 : this->m_elementsLength * 2;
+                Var buffRes = this->m_allocator.Allocate(length);
+                if (buffRes.IsFailure()) return buffRes.Error();
+                Var pElements = buffRes.Value();
+                new(pElements + this->m_elementsCount) TElement(Forward<Args>(args)...);
+                for (USize i = 0; i < this->m_elementsCount; i++)
+                {
+                    new(pElements + i) TElement(Move(this->m_pElements[i]));
+                    this->m_pElements[i].~TElement();
+                }
+                if (this->m_pElements != NONE)
+                {
+                    (Void)this->m_allocator.Deallocate(this->m_elementsLength, this->m_pElements);
+                }
+                this->m_pElements = pElements;
+                this->m_elementsLength = length;
+                this->m_elementsCount++;
+                return SUCCESS;
+            }
+            new(this->m_pElements + this->m_elementsCount) TElement(Forward<Args>(args)...);
+            this->m_elementsCount++;
+            return SUCCESS;
+        }
+
+        /// 末尾の要素を削除します。
+        /// 要素数が0の場合は何もしません。
+        Void Pop() noexcept
+        {
+            if (this->m_elementsCount == 0) return;
+            this->m_elementsCount--;
+            this->m_pElements[this->m_elementsCount].~TElement();
+        }
+
+        /// 要素数を変更します。
+        /// 増やす場合は値初期化した要素を末尾に追加し、配列長が足りない場合は要素数に広げます。
+        /// @param count 要素数です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Resize(USize count) noexcept
+        {
+            if (count > this->m_elementsLength)
+            {
+                Var result = this->Reserve(count);
+                if (result.IsFailure()) return result.Error();
+            }
+            for (USize i = this->m_elementsCount; i < count; i++)
+            {
+                new(this->m_pElements + i) TElement();
+            }
+            for (USize i = count; i < this->m_elementsCount; i++)
+            {
+                this->m_pElements[i].~TElement();
+            }
+            this->m_elementsCount = count;
+            return SUCCESS;
+        }
+
+        /// すべての要素を削除します。配列長は変わりません。
+        Void Clear() noexcept
+        {
+            for (USize i = 0; i < this->m_elementsCount; i++)
+            {
+                this->m_pElements[i].~TElement();
+            }
+            this->m_elementsCount = 0;
         }
 
         /// コピー代入します。
@@ -343,6 +657,28 @@ namespace LeyEngine
             
         }
     };
+
+    /// バイト配列のwyhash方式の64ビットハッシュ値を求めます。
+    /// @tparam A 要素アロケータです。
+    /// @param bytes バイト配列です。
+    /// @param seed シード値です。
+    /// @return ハッシュ値です。
+    template<typename A>
+    U64 HashWy(const Array<U8, A> &bytes, U64 seed = 0) noexcept
+    {
+        return HashWy(bytes.Data(), bytes.Count(), seed);
+    }
+
+    /// バイト配列のCRC32Cを求めます。
+    /// @tparam A 要素アロケータです。
+    /// @param bytes バイト配列です。
+    /// @param crc 分割して求める場合の直前までのCRC32Cです。
+    /// @return CRC32Cです。
+    template<typename A>
+    U32 Crc32c(const Array<U8, A> &bytes, U32 crc = 0) noexcept
+    {
+        return Crc32c(bytes.Data(), bytes.Count(), crc);
+    }
 }
 
 #endif // !_LEYENGINE_COLLECTIONS_ARRAY_HPP
\ No newline at end of file
@@ -0,0 +1,659 @@
+/// @file LeyEngine/Collections/Buffered.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// 書き込み側と読み込み側で別のバッファを使用する多重バッファを提供します。
+#ifndef _LEYENGINE_COLLECTIONS_BUFFERED_HPP
+#define _LEYENGINE_COLLECTIONS_BUFFERED_HPP
+
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+#include "LeyEngine/Collections/Array.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// DirtyRangesが記録する範囲の最大数です。
+    constexpr USize DIRTY_RANGE_CAPACITY = 16;
+
+    /// TripleBufferが差分のコピーのために保持するフレーム数です。
+    /// 書き込み用に受け取った配列がこれより古い場合はすべての要素をコピーします。
+    constexpr USize TRIPLE_BUFFER_HISTORY = 4;
+
+    /// 変更した要素の範囲です。
+    struct DirtyRange
+    {
+        /// 先頭のインデックスです。
+        USize begin;
+        /// 末尾の次のインデックスです。
+        USize end;
+    };
+
+    /// 配列の変更した要素の範囲を記録します。
+    /// 範囲はインデックス順に整列し、重なる、または、隣接する範囲は結合します。
+    /// DIRTY_RANGE_CAPACITYを超える場合は間隔が最も狭い範囲同士を結合するため、変更していない要素を含むことがあります。
+    struct DirtyRanges
+    {
+    private:
+
+        DirtyRange m_ranges[DIRTY_RANGE_CAPACITY]; // 範囲
+        USize m_count;                             // 範囲の数
+
+        // 間隔が最も狭い隣り合う範囲を結合します
+        Void MergeClosest() noexcept
+        {
+            USize closest = 0;
+            for (USize i = 1; i + 1 < this->m_count; i++)
+            {
+                if (this->m_ranges[i + 1].begin - this->m_ranges[i].end < this->m_ranges[closest + 1].begin - this->m_ranges[closest].end)
+                {
+                    closest = i;
+                }
+            }
+            this->m_ranges[closest].end = this->m_ranges[closest + 1].end;
+            for (USize i = closest + 1; i + 1 < this->m_count; i++) this->m_ranges[i] = this->m_ranges[i + 1];
+            this->m_count -= 1;
+        }
+
+    public:
+
+        /// コンストラクタです。
+        DirtyRanges() noexcept
+            : m_count(0)
+        {}
+
+        /// 範囲を記録します。
+        /// @param begin 先頭のインデックスです。
+        /// @param count 要素数です。
+        Void Mark(USize begin, USize count) noexcept
+        {
+            if (count == 0) return;
+            Var end = count > USIZE_MAX - begin ? USIZE_MAX : begin + count;
+
+            // 末尾の範囲に続けて変更する場合が多いため先に判定します
+            if (this->m_count != 0)
+            {
+                Var &last = this->m_ranges[this->m_count - 1];
+                if (last.begin <= begin && begin <= last.end)
+                {
+                    if (last.end < end) last.end = end;
+                    return;
+                }
+            }
+
+            // 重なる、または、隣接する範囲を結合します
+            USize first = 0;
+            while (first < this->m_count && this->m_ranges[first].end < begin) first++;
+            Var last = first;
+            while (last < this->m_count && this->m_ranges[last].begin <= end)
+            {
+                if (this->m_ranges[last].begin < begin) begin = this->m_ranges[last].begin;
+                if (end < this->m_ranges[last].end) end = this->m_ranges[last].end;
+                last++;
+            }
+            if (first < last)
+            {
+                this->m_ranges[first] = DirtyRange{ begin, end };
+                Var removed = last - first - 1;
+                for (USize i = first + 1; i + removed < this->m_count; i++) this->m_ranges[i] = this->m_ranges[i + removed];
+                this->m_count -= removed;
+                return;
+            }
+
+            // 結合できない場合は挿入します
+            if (this->m_count == DIRTY_RANGE_CAPACITY)
+            {
+                this->MergeClosest();
+                this->Mark(begin, end - begin);
+                return;
+            }
+            for (USize i = this->m_count; i > first; i--) this->m_ranges[i] = this->m_ranges[i - 1];
+            this->m_ranges[first] = DirtyRange{ begin, end };
+            this->m_count += 1;
+        }
+
+        /// 別の記録の範囲をすべて記録します。
+        /// @param other 記録です。
+        Void Mark(const DirtyRanges &other) noexcept
+        {
+            for (USize i = 0; i < other.m_count; i++)
+            {
+                this->Mark(other.m_ranges[i].begin, other.m_ranges[i].end - other.m_ranges[i].begin);
+            }
+        }
+
+        /// すべての記録を削除します。
+        Void Clear() noexcept
+        {
+            this->m_count = 0;
+        }
+
+        /// 範囲の数を返します。
+        /// @return 範囲の数です。
+        USize Count() const noexcept
+        {
+            return this->m_count;
+        }
+
+        /// 範囲が無いか判定します。
+        /// @retval true 範囲がありません。
+        /// @retval false 範囲があります。
+        Bool IsEmpty() const noexcept
+        {
+            return this->m_count == 0;
+        }
+
+        /// 範囲を返します。
+        /// @param index 範囲の数未満のインデックスです。
+        /// @return 範囲です。
+        const DirtyRange &operator[](USize index) const noexcept
+        {
+            return this->m_ranges[index];
+        }
+    };
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// 配列の要素数を合わせ、変更した範囲の要素をコピーします。
+        /// 失敗した場合も共通する要素数までは変更した範囲をコピーし、末尾の要素のみ欠けます。
+        template<typename T, typename A>
+        Result<Success, typename A::TAllocateError> _SyncArray(Array<T, A> &destination, const Array<T, A> &source, const DirtyRanges &ranges) noexcept
+        {
+            while (destination.Count() > source.Count()) destination.Pop();
+            Var common = destination.Count();
+            for (USize i = 0; i < ranges.Count(); i++)
+            {
+                Var begin = ranges[i].begin;
+                Var end = ranges[i].end < common ? ranges[i].end : common;
+                if (end <= begin) continue;
+                if constexpr (std::is_trivially_copyable_v<T>)
+                {
+                    std::memcpy(destination.Data() + begin, source.Data() + begin, sizeof(T) * (end - begin));
+                }
+                else
+                {
+                    for (USize j = begin; j < end; j++) destination[j] = source[j];
+                }
+            }
+
+            if (common < source.Count())
+            {
+                Var res = destination.Reserve(source.Count());
+                if (res.IsFailure()) return res;
+                for (USize i = common; i < source.Count(); i++) (Void)destination.Emplace(source[i]);
+            }
+            return SUCCESS;
+        }
+    }
+    /// @endcond
+
+    /// 書き込み用と読み込み用の2つのバッファを持つ値です。
+    /// 書き込み側のスレッドが次のフレームの値を書き込む間、読み込み側のスレッドは前のフレームの値を読み込めます。
+    /// Swapは読み込み側が読み込んでいないフレームの境界で呼び出す必要があります。
+    /// @tparam T 値の型です。コピー代入できる必要があります。
+    template<typename T>
+    struct DoubleBuffered
+    {
+    private:
+
+        T m_buffers[2];                   // バッファ
+        std::atomic<U32> m_frontIndex;    // 読み込み用のバッファの位置
+
+    public:
+
+        /// コンストラクタです。
+        /// @param value 初期値です。
+        DoubleBuffered(const T &value = T()) noexcept
+            : m_buffers{ value, value }
+            , m_frontIndex(0)
+        {}
+
+        DoubleBuffered(const DoubleBuffered<T>&) = delete;
+        DoubleBuffered<T> &operator=(const DoubleBuffered<T>&) = delete;
+
+        /// 読み込み用の値を返します。
+        /// @return 前のフレームの値です。
+        const T &Read() const noexcept
+        {
+            return this->m_buffers[this->m_frontIndex.load(std::memory_order_acquire)];
+        }
+
+        /// 書き込み用の値を返します。
+        /// @return 次のフレームの値です。
+        T &Write() noexcept
+        {
+            return this->m_buffers[1 - this->m_frontIndex.load(std::memory_order_relaxed)];
+        }
+
+        /// 書き込み用と読み込み用のバッファを入れ替え、書き込んだ値を読み込めるようにします。
+        /// 新たな書き込み用のバッファには書き込んだ値をコピーします。
+        Void Swap() noexcept
+        {
+            Var front = this->m_frontIndex.load(std::memory_order_relaxed);
+            this->m_frontIndex.store(1 - front, std::memory_order_release);
+            this->m_buffers[front] = this->m_buffers[1 - front];
+        }
+    };
+
+    /// 書き込み用と読み込み用の2つの配列を持つ配列です。
+    /// 変更した要素の範囲を記録し、Swapでは新たな書き込み用の配列へ変更した範囲のみコピーします。
+    /// Swapは読み込み側が読み込んでいないフレームの境界で呼び出す必要があります。
+    /// @tparam T 要素の型です。コピー構築、コピー代入できる必要があります。
+    /// @tparam A 要素アロケータです。
+    template<typename T, typename A>
+    struct DoubleBuffered<Array<T, A>>
+    {
+        /// 要素の型です。
+        using TElement = T;
+
+        /// アロケート時のエラー型です。
+        using TAllocateError = typename A::TAllocateError;
+
+    private:
+
+        Array<T, A> m_arrays[2];          // 配列
+        std::atomic<U32> m_frontIndex;    // 読み込み用の配列の位置
+        DirtyRanges m_dirty;              // 書き込み用の配列の変更した範囲
+
+        // コンストラクタ
+        DoubleBuffered(Array<T, A> &&front, Array<T, A> &&back) noexcept
+            : m_arrays{ Move(front), Move(back) }
+            , m_frontIndex(0)
+            , m_dirty()
+        {}
+
+        // 書き込み用の配列を返します
+        Array<T, A> &Back() noexcept
+        {
+            return this->m_arrays[1 - this->m_frontIndex.load(std::memory_order_relaxed)];
+        }
+
+    public:
+
+        /// 作成します。
+        /// @param length 配列長です。
+        /// @param allocator アロケータです。
+        /// @return 配列、または、エラーです。
+        static Result<DoubleBuffered<Array<T, A>>, TAllocateError> Create(USize length, const A &allocator = A()) noexcept
+        {
+            Var frontRes = Array<T, A>::Create(length, allocator);
+            if (frontRes.IsFailure()) return frontRes.Error();
+            Var backRes = Array<T, A>::Create(length, allocator);
+            if (backRes.IsFailure()) return backRes.Error();
+            return DoubleBuffered<Array<T, A>>(Move(frontRes.Value()), Move(backRes.Value()));
+        }
+
+        DoubleBuffered(const DoubleBuffered<Array<T, A>>&) = delete;
+        DoubleBuffered<Array<T, A>> &operator=(const DoubleBuffered<Array<T, A>>&) = delete;
+
+        /// ムーブします。
+        /// @param origin ムーブ元です。
+        DoubleBuffered(DoubleBuffered<Array<T, A>> &&origin) noexcept
+            : m_arrays{ Move(origin.m_arrays[0]), Move(origin.m_arrays[1]) }
+            , m_frontIndex(origin.m_frontIndex.load(std::memory_order_relaxed))
+            , m_dirty(origin.m_dirty)
+        {}
+
+        /// 読み込み用の配列を返します。
+        /// @return 前のフレームの配列です。
+        const Array<T, A> &Read() const noexcept
+        {
+            return this->m_arrays[this->m_frontIndex.load(std::memory_order_acquire)];
+        }
+
+        /// 書き込み用の配列を返します。
+        /// @return 次のフレームの配列です。
+        const Array<T, A> &Current() const noexcept
+        {
+            return this->m_arrays[1 - this->m_frontIndex.load(std::memory_order_relaxed)];
+        }
+
+        /// 書き込み用の配列の要素を変更した範囲として記録し、返します。
+        /// @param index 要素数未満のインデックスです。
+        /// @return 要素です。
+        TElement &WriteAt(USize index) noexcept
+        {
+            this->m_dirty.Mark(index, 1);
+            return this->Back()[index];
+        }
+
+        /// 書き込み用の配列の範囲を変更した範囲として記録し、先頭を返します。
+        /// @param begin 先頭のインデックスです。
+        /// @param count 要素数です。begin + countは要素数以下である必要があります。
+        /// @return 範囲の先頭の要素です。
+        TElement *WriteRange(USize begin, USize count) noexcept
+        {
+            this->m_dirty.Mark(begin, count);
+            return this->Back().Data() + begin;
+        }
+
+        /// 書き込み用の配列の末尾に要素を構築します。
+        /// @param args 構築の引数です。
+        /// @return SUCCESS、または、エラーです。
+        template<typename... Args>
+        Result<Success, TAllocateError> Emplace(Args&&... args) noexcept
+        {
+            Var &back = this->Back();
+            this->m_dirty.Mark(back.Count(), 1);
+            return back.Emplace(Forward<Args>(args)...);
+        }
+
+        /// 書き込み用の配列の末尾に要素を追加します。
+        /// @param value 追加する要素です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Push(const TElement &value) noexcept
+        {
+            return this->Emplace(value);
+        }
+
+        /// 書き込み用の配列の末尾の要素を削除します。
+        Void Pop() noexcept
+        {
+            this->Back().Pop();
+        }
+
+        /// 書き込み用の配列のすべての要素を削除します。
+        Void Clear() noexcept
+        {
+            this->Back().Clear();
+        }
+
+        /// 書き込み用の配列の変更した範囲を返します。
+        /// @return 変更した範囲です。
+        const DirtyRanges &Dirty() const noexcept
+        {
+            return this->m_dirty;
+        }
+
+        /// 書き込み用と読み込み用の配列を入れ替え、書き込んだ配列を読み込めるようにします。
+        /// 新たな書き込み用の配列には変更した範囲のみコピーします。
+        /// 失敗した場合は入れ替えず、変更した範囲も残します。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Swap() noexcept
+        {
+            Var front = this->m_frontIndex.load(std::memory_order_relaxed);
+            // コピーで失敗しないよう、入れ替える前に新たな書き込み用の配列の容量を確保します
+            Var res = this->m_arrays[front].Reserve(this->m_arrays[1 - front].Count());
+            if (res.IsFailure()) return res;
+            this->m_frontIndex.store(1 - front, std::memory_order_release);
+            (Void)_Internal::_SyncArray(this->m_arrays[front], this->m_arrays[1 - front], this->m_dirty);
+            this->m_dirty.Clear();
+            return SUCCESS;
+        }
+    };
+
+    /// 書き込み用、受け渡し用、読み込み用の3つのバッファを持つ値です。
+    /// 書き込み側と読み込み側のスレッドがそれぞれの頻度で、ロックせずに値を受け渡せます。
+    /// 書き込み側は1つのスレッド、読み込み側は1つのスレッドである必要があります。
+    /// @tparam T 値の型です。コピー代入できる必要があります。
+    template<typename T>
+    struct TripleBuffer
+    {
+    private:
+
+        static constexpr U32 INDEX_MASK = 3;    // バッファの位置のマスク
+        static constexpr U32 FRESH = 4;         // 受け渡し用のバッファが未読であることを表すフラグ
+
+        T m_buffers[3];                                             // バッファ
+        alignas(CACHE_LINE_SIZE) std::atomic<U32> m_middle;         // 受け渡し用のバッファの位置とフラグ
+        alignas(CACHE_LINE_SIZE) U32 m_writeIndex;                  // 書き込み用のバッファの位置
+        alignas(CACHE_LINE_SIZE) U32 m_readIndex;                   // 読み込み用のバッファの位置
+
+    public:
+
+        /// コンストラクタです。
+        /// @param value 初期値です。
+        TripleBuffer(const T &value = T()) noexcept
+            : m_buffers{ value, value, value }
+            , m_middle(1)
+            , m_writeIndex(0)
+            , m_readIndex(2)
+        {}
+
+        TripleBuffer(const TripleBuffer<T>&) = delete;
+        TripleBuffer<T> &operator=(const TripleBuffer<T>&) = delete;
+
+        /// 書き込み用の値を返します。
+        /// 書き込み側のスレッドから呼び出します。
+        /// @return 書き込み用の値です。
+        T &Write() noexcept
+        {
+            return this->m_buffers[this->m_writeIndex];
+        }
+
+        /// 書き込んだ値を受け渡し用のバッファと入れ替え、読み込み側が受け取れるようにします。
+        /// 新たな書き込み用のバッファには書き込んだ値をコピーします。
+        /// 書き込み側のスレッドから呼び出します。
+        Void Publish() noexcept
+        {
+            Var published = this->m_writeIndex;
+            this->m_writeIndex = this->m_middle.exchange(published | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+            this->m_buffers[this->m_writeIndex] = this->m_buffers[published];
+        }
+
+        /// 未読の値があれば受け取ります。
+        /// 読み込み側のスレッドから呼び出します。
+        /// @retval true 新しい値を受け取りました。
+        /// @retval false 未読の値がありませんでした。
+        Bool Update() noexcept
+        {
+            if ((this->m_middle.load(std::memory_order_relaxed) & FRESH) == 0) return NO;
+            this->m_readIndex = this->m_middle.exchange(this->m_readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+            return YES;
+        }
+
+        /// 読み込み用の値を返します。
+        /// 読み込み側のスレッドから呼び出します。
+        /// @return 最後に受け取った値です。
+        const T &Read() const noexcept
+        {
+            return this->m_buffers[this->m_readIndex];
+        }
+    };
+
+    /// 書き込み用、受け渡し用、読み込み用の3つの配列を持つ配列です。
+    /// フレーム毎に変更した要素の範囲を記録し、Publishでは新たな書き込み用の配列へ、その配列が古い分の範囲のみコピーします。
+    /// 書き込み側は1つのスレッド、読み込み側は1つのスレッドである必要があります。
+    /// @tparam T 要素の型です。コピー構築、コピー代入できる必要があります。
+    /// @tparam A 要素アロケータです。
+    template<typename T, typename A>
+    struct TripleBuffer<Array<T, A>>
+    {
+        /// 要素の型です。
+        using TElement = T;
+
+        /// アロケート時のエラー型です。
+        using TAllocateError = typename A::TAllocateError;
+
+    private:
+
+        static constexpr U32 INDEX_MASK = 3;    // 配列の位置のマスク
+        static constexpr U32 FRESH = 4;         // 受け渡し用の配列が未読であることを表すフラグ
+
+        Array<T, A> m_arrays[3];                                    // 配列
+        alignas(CACHE_LINE_SIZE) std::atomic<U32> m_middle;         // 受け渡し用の配列の位置とフラグ
+        alignas(CACHE_LINE_SIZE) U32 m_writeIndex;                  // 書き込み用の配列の位置
+        U64 m_version;                                              // 最後に受け渡したフレームの番号
+        U64 m_versions[3];                                          // 配列毎の内容のフレームの番号
+        DirtyRanges m_dirty;                                        // 書き込み用の配列の変更した範囲
+        DirtyRanges m_history[TRIPLE_BUFFER_HISTORY];               // フレーム毎の変更した範囲
+        alignas(CACHE_LINE_SIZE) U32 m_readIndex;                   // 読み込み用の配列の位置
+
+        // コンストラクタ
+        TripleBuffer(Array<T, A> &&first, Array<T, A> &&second, Array<T, A> &&third) noexcept
+            : m_arrays{ Move(first), Move(second), Move(third) }
+            , m_middle(1)
+            , m_writeIndex(0)
+            , m_version(0)
+            , m_versions{ 0, 0, 0 }
+            , m_dirty()
+            , m_history()
+            , m_readIndex(2)
+        {}
+
+        // 書き込み用の配列を返します
+        Array<T, A> &Back() noexcept
+        {
+            return this->m_arrays[this->m_writeIndex];
+        }
+
+    public:
+
+        /// 作成します。
+        /// @param length 配列長です。
+        /// @param allocator アロケータです。
+        /// @return 配列、または、エラーです。
+        static Result<TripleBuffer<Array<T, A>>, TAllocateError> Create(USize length, const A &allocator = A()) noexcept
+        {
+            Var firstRes = Array<T, A>::Create(length, allocator);
+            if (firstRes.IsFailure()) return firstRes.Error();
+            Var secondRes = Array<T, A>::Create(length, allocator);
+            if (secondRes.IsFailure()) return secondRes.Error();
+            Var thirdRes = Array<T, A>::Create(length, allocator);
+            if (thirdRes.IsFailure()) return thirdRes.Error();
+            return TripleBuffer<Array<T, A>>(Move(firstRes.Value()), Move(secondRes.Value()), Move(thirdRes.Value()));
+        }
+
+        TripleBuffer(const TripleBuffer<Array<T, A>>&) = delete;
+        TripleBuffer<Array<T, A>> &operator=(const TripleBuffer<Array<T, A>>&) = delete;
+
+        /// ムーブします。
+        /// 書き込み側、読み込み側のスレッドが使用していない間のみムーブできます。
+        /// @param origin ムーブ元です。
+        TripleBuffer(TripleBuffer<Array<T, A>> &&origin) noexcept
+            : m_arrays{ Move(origin.m_arrays[0]), Move(origin.m_arrays[1]), Move(origin.m_arrays[2]) }
+            , m_middle(origin.m_middle.load(std::memory_order_relaxed))
+            , m_writeIndex(origin.m_writeIndex)
+            , m_version(origin.m_version)
+            , m_versions{ origin.m_versions[0], origin.m_versions[1], origin.m_versions[2] }
+            , m_dirty(origin.m_dirty)
+            , m_history()
+            , m_readIndex(origin.m_readIndex)
+        {
+            for (USize i = 0; i < TRIPLE_BUFFER_HISTORY; i++) this->m_history[i] = origin.m_history[i];
+        }
+
+        /// 書き込み用の配列を返します。
+        /// 書き込み側のスレッドから呼び出します。
+        /// @return 書き込み用の配列です。
+        const Array<T, A> &Current() const noexcept
+        {
+            return this->m_arrays[this->m_writeIndex];
+        }
+
+        /// 書き込み用の配列の要素を変更した範囲として記録し、返します。
+        /// 書き込み側のスレッドから呼び出します。
+        /// @param index 要素数未満のインデックスです。
+        /// @return 要素です。
+        TElement &WriteAt(USize index) noexcept
+        {
+            this->m_dirty.Mark(index, 1);
+            return this->Back()[index];
+        }
+
+        /// 書き込み用の配列の範囲を変更した範囲として記録し、先頭を返します。
+        /// 書き込み側のスレッドから呼び出します。
+        /// @param begin 先頭のインデックスです。
+        /// @param count 要素数です。begin + countは要素数以下である必要があります。
+        /// @return 範囲の先頭の要素です。
+        TElement *WriteRange(USize begin, USize count) noexcept
+        {
+            this->m_dirty.Mark(begin, count);
+            return this->Back().Data() + begin;
+        }
+
+        /// 書き込み用の配列の末尾に要素を構築します。
+        /// 書き込み側のスレッドから呼び出します。
+        /// @param args 構築の引数です。
+        /// @return SUCCESS、または、エラーです。
+        template<typename... Args>
+        Result<Success, TAllocateError> Emplace(Args&&... args) noexcept
+        {
+            Var &back = this->Back();
+            this->m_dirty.Mark(back.Count(), 1);
+            return back.Emplace(Forward<Args>(args)...);
+        }
+
+        /// 書き込み用の配列の末尾に要素を追加します。
+        /// 書き込み側のスレッドから呼び出します。
+        /// @param value 追加する要素です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Push(const TElement &value) noexcept
+        {
+            return this->Emplace(value);
+        }
+
+        /// 書き込み用の配列の末尾の要素を削除します。
+        /// 書き込み側のスレッドから呼び出します。
+        Void Pop() noexcept
+        {
+            this->Back().Pop();
+        }
+
+        /// 書き込み用の配列のすべての要素を削除します。
+        /// 書き込み側のスレッドから呼び出します。
+        Void Clear() noexcept
+        {
+            this->Back().Clear();
+        }
+
+        /// 書き込んだ配列を受け渡し用の配列と入れ替え、読み込み側が受け取れるようにします。
+        /// 新たな書き込み用の配列には、その配列が古い分の変更した範囲のみコピーします。
+        /// 失敗した場合は新たな書き込み用の配列の末尾の要素が欠けます。
+        /// すべての要素を変更した範囲として記録するため、以降のPublishで各配列の内容は揃います。
+        /// 書き込み側のスレッドから呼び出します。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Publish() noexcept
+        {
+            Var published = this->m_writeIndex;
+            this->m_version += 1;
+            this->m_versions[published] = this->m_version;
+            this->m_history[this->m_version % TRIPLE_BUFFER_HISTORY] = this->m_dirty;
+            this->m_dirty.Clear();
+            this->m_writeIndex = this->m_middle.exchange(published | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+
+            // 受け取った配列より後のフレームで変更した範囲を集めます
+            // 受け渡した配列は読み込み側も読み込みのみ行うため、同時に読み込めます
+            DirtyRanges ranges;
+            Var stale = this->m_versions[this->m_writeIndex];
+            if (this->m_version - stale > TRIPLE_BUFFER_HISTORY)
+            {
+                ranges.Mark(0, USIZE_MAX);
+            }
+            else
+            {
+                for (Var version = stale + 1; version <= this->m_version; version++)
+                {
+                    ranges.Mark(this->m_history[version % TRIPLE_BUFFER_HISTORY]);
+                }
+            }
+            this->m_versions[this->m_writeIndex] = this->m_version;
+            Var res = _Internal::_SyncArray(this->m_arrays[this->m_writeIndex], this->m_arrays[published], ranges);
+            if (res.IsFailure()) this->m_dirty.Mark(0, USIZE_MAX);
+            return res;
+        }
+
+        /// 未読の配列があれば受け取ります。
+        /// 読み込み側のスレッドから呼び出します。
+        /// @retval true 新しい配列を受け取りました。
+        /// @retval false 未読の配列がありませんでした。
+        Bool Update() noexcept
+        {
+            if ((this->m_middle.load(std::memory_order_relaxed) & FRESH) == 0) return NO;
+            this->m_readIndex = this->m_middle.exchange(this->m_readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+            return YES;
+        }
+
+        /// 読み込み用の配列を返します。
+        /// 読み込み側のスレッドから呼び出します。
+        /// @return 最後に受け取った配列です。
+        const Array<T, A> &Read() const noexcept
+        {
+            return this->m_arrays[this->m_readIndex];
+        }
+    };
+}
+
+#endif // !_LEYENGINE_COLLECTIONS_BUFFERED_HPP
\ No newline at end of file
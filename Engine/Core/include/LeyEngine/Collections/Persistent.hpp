@@ -0,0 +1,927 @@
+/// @file LeyEngine/Collections/Persistent.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// 構造を共有する永続コレクションを提供します。
+#ifndef _LEYENGINE_COLLECTIONS_PERSISTENT_HPP
+#define _LEYENGINE_COLLECTIONS_PERSISTENT_HPP
+
+#include <atomic>
+#include <new>
+#include "LeyEngine/Bit.hpp"
+#include "LeyEngine/Hash.hpp"
+#include "LeyEngine/Memory.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// 永続コレクションの節が持つ子の数の、2を底とする対数です。
+    constexpr USize PERSISTENT_BRANCH_BITS = 5;
+
+    /// 永続コレクションの節が持つ子の最大数です。
+    constexpr USize PERSISTENT_BRANCH_COUNT = USize(1) << PERSISTENT_BRANCH_BITS;
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// 子の位置を求めるマスクです。
+        constexpr USize _PERSISTENT_BRANCH_MASK = PERSISTENT_BRANCH_COUNT - 1;
+
+        /// 永続ベクタの節です。
+        /// ヘッダの後に子、または、要素の配列が続きます。
+        struct _PersistentVectorNode
+        {
+            std::atomic<U32> refCount; // 参照数
+            U32 count;                 // 使用中の子、または、要素の数
+        };
+
+        /// 永続ベクタの節を操作します。
+        /// 節は標準メモリから固定サイズで確保するため、メモリプールから確保されます。
+        template<typename T>
+        struct _PersistentVectorNodes
+        {
+            using TNode = _PersistentVectorNode;
+
+            /// 子の配列のヘッダからのバイトオフセットです。
+            static constexpr USize CHILDREN_OFFSET = AlignUp(sizeof(TNode), alignof(TNode*));
+
+            /// 要素の配列のヘッダからのバイトオフセットです。
+            static constexpr USize VALUES_OFFSET = AlignUp(sizeof(TNode), alignof(T));
+
+            /// 節のバイトサイズを返します。
+            static constexpr USize SizeOf(USize shift) noexcept
+            {
+                return shift > 0 ? CHILDREN_OFFSET + sizeof(TNode*) * PERSISTENT_BRANCH_COUNT : VALUES_OFFSET + sizeof(T) * PERSISTENT_BRANCH_COUNT;
+            }
+
+            /// 子の配列を返します。
+            static TNode **Children(TNode *pNode) noexcept
+            {
+                return Cast<TNode**>(Cast<U8*>(pNode) + CHILDREN_OFFSET);
+            }
+
+            /// 要素の配列を返します。
+            static T *Values(TNode *pNode) noexcept
+            {
+                return Cast<T*>(Cast<U8*>(pNode) + VALUES_OFFSET);
+            }
+
+            /// 空の節を確保します。
+            static TNode *New(USize shift) noexcept
+            {
+                Var res = Allocate(SizeOf(shift));
+                if (res.IsFailure()) return NONE;
+                Var pNode = Cast<TNode*>(res.Value());
+                new(&pNode->refCount) std::atomic<U32>(1);
+                pNode->count = 0;
+                return pNode;
+            }
+
+            /// 参照を追加します。
+            static Void Retain(TNode *pNode) noexcept
+            {
+                if (pNode != NONE) pNode->refCount.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /// 参照を削除し、参照が無くなった場合は子、または、要素と共に解放します。
+            static Void Release(TNode *pNode, USize shift) noexcept
+            {
+                if (pNode == NONE || pNode->refCount.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+                if (shift > 0)
+                {
+                    Var ppChildren = Children(pNode);
+                    for (USize i = 0; i < pNode->count; i++) Release(ppChildren[i], shift - PERSISTENT_BRANCH_BITS);
+                }
+                else
+                {
+                    Var pValues = Values(pNode);
+                    for (USize i = 0; i < pNode->count; i++) pValues[i].~T();
+                }
+                (Void)Deallocate(SizeOf(shift), pNode);
+            }
+
+            /// 先頭から指定数の子、または、要素を共有、コピーした節を確保します。
+            static TNode *Copy(TNode *pNode, USize shift, USize count) noexcept
+            {
+                Var pCopy = New(shift);
+                if (pCopy == NONE) return NONE;
+                if (shift > 0)
+                {
+                    Var ppChildren = Children(pNode);
+                    Var ppCopyChildren = Children(pCopy);
+                    for (USize i = 0; i < count; i++)
+                    {
+                        Retain(ppChildren[i]);
+                        ppCopyChildren[i] = ppChildren[i];
+                    }
+                }
+                else
+                {
+                    Var pValues = Values(pNode);
+                    Var pCopyValues = Values(pCopy);
+                    for (USize i = 0; i < count; i++) new(&pCopyValues[i]) T(pValues[i]);
+                }
+                pCopy->count = static_cast<U32>(count);
+                return pCopy;
+            }
+
+            /// 要素を置き換えた経路を複製します。
+            static TNode *Set(TNode *pNode, USize shift, USize index, const T &value) noexcept
+            {
+                Var pCopy = Copy(pNode, shift, pNode->count);
+                if (pCopy == NONE) return NONE;
+                Var slot = (index >> shift) & _PERSISTENT_BRANCH_MASK;
+                if (shift == 0)
+                {
+                    Values(pCopy)[slot] = value;
+                    return pCopy;
+                }
+                Var pChild = Set(Children(pNode)[slot], shift - PERSISTENT_BRANCH_BITS, index, value);
+                if (pChild == NONE)
+                {
+                    Release(pCopy, shift);
+                    return NONE;
+                }
+                Release(Children(pCopy)[slot], shift - PERSISTENT_BRANCH_BITS);
+                Children(pCopy)[slot] = pChild;
+                return pCopy;
+            }
+
+            /// 末尾に要素を追加した経路を複製します。
+            /// 節がNONEの場合は新たに作成します。
+            static TNode *Push(TNode *pNode, USize shift, USize index, const T &value) noexcept
+            {
+                Var pCopy = pNode != NONE ? Copy(pNode, shift, pNode->count) : New(shift);
+                if (pCopy == NONE) return NONE;
+                Var slot = (index >> shift) & _PERSISTENT_BRANCH_MASK;
+                if (shift == 0)
+                {
+                    new(&Values(pCopy)[slot]) T(value);
+                    pCopy->count = static_cast<U32>(slot + 1);
+                    return pCopy;
+                }
+                Var isExisting = slot < pCopy->count;
+                Var pChild = Push(isExisting ? Children(pCopy)[slot] : NONE, shift - PERSISTENT_BRANCH_BITS, index, value);
+                if (pChild == NONE)
+                {
+                    Release(pCopy, shift);
+                    return NONE;
+                }
+                if (isExisting) Release(Children(pCopy)[slot], shift - PERSISTENT_BRANCH_BITS);
+                Children(pCopy)[slot] = pChild;
+                pCopy->count = static_cast<U32>(slot + 1);
+                return pCopy;
+            }
+
+            /// 末尾の要素を削除した経路を複製します。
+            /// 節が空になる場合はNONEを返します。
+            static TNode *Pop(TNode *pNode, USize shift, USize index, Bool &isFailed) noexcept
+            {
+                Var slot = (index >> shift) & _PERSISTENT_BRANCH_MASK;
+                if (shift == 0)
+                {
+                    if (slot == 0) return NONE;
+                    Var pCopy = Copy(pNode, shift, slot);
+                    isFailed = pCopy == NONE;
+                    return pCopy;
+                }
+                Var pChild = Pop(Children(pNode)[slot], shift - PERSISTENT_BRANCH_BITS, index, isFailed);
+                if (isFailed) return NONE;
+                if (pChild == NONE && slot == 0) return NONE;
+                Var pCopy = Copy(pNode, shift, pChild != NONE ? slot + 1 : slot);
+                if (pCopy == NONE)
+                {
+                    Release(pChild, shift - PERSISTENT_BRANCH_BITS);
+                    isFailed = YES;
+                    return NONE;
+                }
+                if (pChild != NONE)
+                {
+                    Release(Children(pCopy)[slot], shift - PERSISTENT_BRANCH_BITS);
+                    Children(pCopy)[slot] = pChild;
+                }
+                return pCopy;
+            }
+
+            /// すべての要素を順に関数へ渡します。
+            template<typename Fn>
+            static Void ForEach(TNode *pNode, USize shift, Fn &function) noexcept
+            {
+                if (shift > 0)
+                {
+                    Var ppChildren = Children(pNode);
+                    for (USize i = 0; i < pNode->count; i++) ForEach(ppChildren[i], shift - PERSISTENT_BRANCH_BITS, function);
+                }
+                else
+                {
+                    const Var pValues = Values(pNode);
+                    for (USize i = 0; i < pNode->count; i++) function(pValues[i]);
+                }
+            }
+        };
+
+        /// 永続ハッシュマップの節です。
+        /// ヘッダの後に子の配列、要素の配列が続きます。
+        struct _PersistentMapNode
+        {
+            std::atomic<U32> refCount; // 参照数
+            U32 dataMap;               // 要素を持つ位置のビットマップ
+            U32 nodeMap;               // 子を持つ位置のビットマップ
+            U32 collisionCount;        // ハッシュ値が衝突した要素のみを持つ節の場合、要素数
+        };
+
+        /// 永続ハッシュマップの要素です。
+        template<typename K, typename V>
+        struct _PersistentMapEntry
+        {
+            U64 hash;   // キーのハッシュ値
+            K key;      // キー
+            V value;    // 値
+        };
+
+        /// 永続ハッシュマップの削除の結果です。
+        enum class _EPersistentRemove
+        {
+            NOT_FOUND,  // キーが見つかりませんでした
+            REMOVED,    // 削除しました
+            FAILED,     // メモリ確保に失敗しました
+        };
+
+        /// 永続ハッシュマップの節を操作します。
+        /// 要素と子を別のビットマップで管理するCHAMP方式のハッシュ配列マップトライです。
+        /// ハッシュ値のビットを使い切った深さでは、衝突した要素を線形に並べた節を使用します。
+        template<typename K, typename V>
+        struct _PersistentMapNodes
+        {
+            using TNode = _PersistentMapNode;
+            using TEntry = _PersistentMapEntry<K, V>;
+
+            /// ハッシュ値のビット数です。
+            static constexpr USize HASH_BITS = 64;
+
+            /// 子の配列のヘッダからのバイトオフセットです。
+            static constexpr USize CHILDREN_OFFSET = AlignUp(sizeof(TNode), alignof(TNode*));
+
+            /// 位置のビットを返します。
+            static U32 BitOf(U64 hash, USize shift) noexcept
+            {
+                return U32(1) << ((hash >> shift) & _PERSISTENT_BRANCH_MASK);
+            }
+
+            /// ビットより下位の要素、または、子の数を返します。
+            static USize IndexOf(U32 map, U32 bit) noexcept
+            {
+                return PopCount(map & (bit - 1));
+            }
+
+            /// 要素の配列のヘッダからのバイトオフセットを返します。
+            static constexpr USize EntriesOffset(USize nodeCount) noexcept
+            {
+                return AlignUp(CHILDREN_OFFSET + sizeof(TNode*) * nodeCount, alignof(TEntry));
+            }
+
+            /// 要素数を返します。
+            static USize EntryCount(const TNode *pNode) noexcept
+            {
+                return pNode->collisionCount != 0 ? pNode->collisionCount : PopCount(pNode->dataMap);
+            }
+
+            /// 節のバイトサイズを返します。
+            static USize SizeOf(const TNode *pNode) noexcept
+            {
+                return EntriesOffset(PopCount(pNode->nodeMap)) + sizeof(TEntry) * EntryCount(pNode);
+            }
+
+            /// 子の配列を返します。
+            static TNode **Children(TNode *pNode) noexcept
+            {
+                return Cast<TNode**>(Cast<U8*>(pNode) + CHILDREN_OFFSET);
+            }
+
+            /// 要素の配列を返します。
+            static TEntry *Entries(TNode *pNode) noexcept
+            {
+                return Cast<TEntry*>(Cast<U8*>(pNode) + EntriesOffset(PopCount(pNode->nodeMap)));
+            }
+
+            /// 子、要素を構築していない節を確保します。
+            static TNode *New(U32 dataMap, U32 nodeMap, U32 collisionCount) noexcept
+            {
+                Var dataCount = collisionCount != 0 ? collisionCount : PopCount(dataMap);
+                Var res = Allocate(EntriesOffset(PopCount(nodeMap)) + sizeof(TEntry) * dataCount);
+                if (res.IsFailure()) return NONE;
+                Var pNode = Cast<TNode*>(res.Value());
+                new(&pNode->refCount) std::atomic<U32>(1);
+                pNode->dataMap = dataMap;
+                pNode->nodeMap = nodeMap;
+                pNode->collisionCount = collisionCount;
+                return pNode;
+            }
+
+            /// 参照を追加します。
+            static Void Retain(TNode *pNode) noexcept
+            {
+                if (pNode != NONE) pNode->refCount.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /// 参照を削除し、参照が無くなった場合は子、要素と共に解放します。
+            static Void Release(TNode *pNode) noexcept
+            {
+                if (pNode == NONE || pNode->refCount.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+                Var ppChildren = Children(pNode);
+                for (USize i = 0; i < PopCount(pNode->nodeMap); i++) Release(ppChildren[i]);
+                Var pEntries = Entries(pNode);
+                for (USize i = 0; i < EntryCount(pNode); i++) pEntries[i].~TEntry();
+                (Void)Deallocate(SizeOf(pNode), pNode);
+            }
+
+            /// ビットマップを変更した節を確保します。
+            /// bitの位置はpEntry、または、pChildを使用し、それ以外は元の節の要素、子を共有、コピーします。
+            /// pChildの所有権は失敗した場合も含めて受け取ります。
+            static TNode *Rebuild(TNode *pSource, U32 dataMap, U32 nodeMap, U32 bit, const TEntry *pEntry, TNode *pChild) noexcept
+            {
+                Var pNode = New(dataMap, nodeMap, 0);
+                if (pNode == NONE)
+                {
+                    Release(pChild);
+                    return NONE;
+                }
+                Var ppChildren = Children(pNode);
+                USize index = 0;
+                for (Var bits = nodeMap; bits != 0; bits &= bits - 1)
+                {
+                    Var current = bits & (~bits + 1);
+                    if (current == bit && pChild != NONE)
+                    {
+                        ppChildren[index++] = pChild;
+                        continue;
+                    }
+                    Var pShared = Children(pSource)[IndexOf(pSource->nodeMap, current)];
+                    Retain(pShared);
+                    ppChildren[index++] = pShared;
+                }
+                Var pEntries = Entries(pNode);
+                index = 0;
+                for (Var bits = dataMap; bits != 0; bits &= bits - 1)
+                {
+                    Var current = bits & (~bits + 1);
+                    if (current == bit && pEntry != NONE) new(&pEntries[index++]) TEntry(*pEntry);
+                    else                                  new(&pEntries[index++]) TEntry(Entries(pSource)[IndexOf(pSource->dataMap, current)]);
+                }
+                return pNode;
+            }
+
+            /// 衝突した要素の節を、skipの位置を除いてコピーし、pEntryを末尾に加えて確保します。
+            static TNode *RebuildCollision(TNode *pSource, USize skip, const TEntry *pEntry) noexcept
+            {
+                Var count = pSource->collisionCount - (skip < pSource->collisionCount ? 1 : 0) + (pEntry != NONE ? 1 : 0);
+                Var pNode = New(0, 0, static_cast<U32>(count));
+                if (pNode == NONE) return NONE;
+                Var pEntries = Entries(pNode);
+                USize index = 0;
+                for (USize i = 0; i < pSource->collisionCount; i++)
+                {
+                    if (i != skip) new(&pEntries[index++]) TEntry(Entries(pSource)[i]);
+                }
+                if (pEntry != NONE) new(&pEntries[index]) TEntry(*pEntry);
+                return pNode;
+            }
+
+            /// 異なるキーの2つの要素を持つ節を確保します。
+            static TNode *Merge(const TEntry &first, const TEntry &second, USize shift) noexcept
+            {
+                if (shift >= HASH_BITS)
+                {
+                    Var pNode = New(0, 0, 2);
+                    if (pNode == NONE) return NONE;
+                    new(&Entries(pNode)[0]) TEntry(first);
+                    new(&Entries(pNode)[1]) TEntry(second);
+                    return pNode;
+                }
+                Var firstBit = BitOf(first.hash, shift);
+                Var secondBit = BitOf(second.hash, shift);
+                if (firstBit != secondBit)
+                {
+                    Var pNode = New(firstBit | secondBit, 0, 0);
+                    if (pNode == NONE) return NONE;
+                    new(&Entries(pNode)[firstBit < secondBit ? 0 : 1]) TEntry(first);
+                    new(&Entries(pNode)[firstBit < secondBit ? 1 : 0]) TEntry(second);
+                    return pNode;
+                }
+                Var pChild = Merge(first, second, shift + PERSISTENT_BRANCH_BITS);
+                if (pChild == NONE) return NONE;
+                Var pNode = New(0, firstBit, 0);
+                if (pNode == NONE)
+                {
+                    Release(pChild);
+                    return NONE;
+                }
+                Children(pNode)[0] = pChild;
+                return pNode;
+            }
+
+            /// 要素を追加、または、置き換えた経路を複製します。
+            static TNode *Set(TNode *pNode, USize shift, const TEntry &entry, Bool &isAdded) noexcept
+            {
+                if (pNode->collisionCount != 0)
+                {
+                    for (USize i = 0; i < pNode->collisionCount; i++)
+                    {
+                        if (Entries(pNode)[i].key == entry.key) return RebuildCollision(pNode, i, &entry);
+                    }
+                    isAdded = YES;
+                    return RebuildCollision(pNode, USIZE_MAX, &entry);
+                }
+
+                Var bit = BitOf(entry.hash, shift);
+                if ((pNode->dataMap & bit) != 0)
+                {
+                    const Var &existing = Entries(pNode)[IndexOf(pNode->dataMap, bit)];
+                    if (existing.hash == entry.hash && existing.key == entry.key)
+                    {
+                        return Rebuild(pNode, pNode->dataMap, pNode->nodeMap, bit, &entry, NONE);
+                    }
+                    // 同じ位置の要素と共に子へ移します
+                    isAdded = YES;
+                    Var pChild = Merge(existing, entry, shift + PERSISTENT_BRANCH_BITS);
+                    if (pChild == NONE) return NONE;
+                    return Rebuild(pNode, pNode->dataMap & ~bit, pNode->nodeMap | bit, bit, NONE, pChild);
+                }
+                if ((pNode->nodeMap & bit) != 0)
+                {
+                    Var pChild = Set(Children(pNode)[IndexOf(pNode->nodeMap, bit)], shift + PERSISTENT_BRANCH_BITS, entry, isAdded);
+                    if (pChild == NONE) return NONE;
+                    return Rebuild(pNode, pNode->dataMap, pNode->nodeMap, bit, NONE, pChild);
+                }
+                isAdded = YES;
+                return Rebuild(pNode, pNode->dataMap | bit, pNode->nodeMap, bit, &entry, NONE);
+            }
+
+            /// 要素を1つのみ持つ節か判定します。
+            static Bool IsSingle(const TNode *pNode) noexcept
+            {
+                return pNode->collisionCount == 1 || (pNode->collisionCount == 0 && pNode->nodeMap == 0 && PopCount(pNode->dataMap) == 1);
+            }
+
+            /// 要素を削除した経路を複製します。
+            /// 子が要素を1つのみ持つようになった場合は、その要素を親へ移します。
+            static _EPersistentRemove Remove(TNode *pNode, USize shift, U64 hash, const K &key, TNode *&pResult) noexcept
+            {
+                pResult = NONE;
+                if (pNode->collisionCount != 0)
+                {
+                    for (USize i = 0; i < pNode->collisionCount; i++)
+                    {
+                        if (Entries(pNode)[i].key == key)
+                        {
+                            pResult = RebuildCollision(pNode, i, NONE);
+                            return pResult != NONE ? _EPersistentRemove::REMOVED : _EPersistentRemove::FAILED;
+                        }
+                    }
+                    return _EPersistentRemove::NOT_FOUND;
+                }
+
+                Var bit = BitOf(hash, shift);
+                if ((pNode->dataMap & bit) != 0)
+                {
+                    const Var &existing = Entries(pNode)[IndexOf(pNode->dataMap, bit)];
+                    if (existing.hash != hash || !(existing.key == key)) return _EPersistentRemove::NOT_FOUND;
+                    if (pNode->dataMap == bit && pNode->nodeMap == 0) return _EPersistentRemove::REMOVED;
+                    pResult = Rebuild(pNode, pNode->dataMap & ~bit, pNode->nodeMap, bit, NONE, NONE);
+                    return pResult != NONE ? _EPersistentRemove::REMOVED : _EPersistentRemove::FAILED;
+                }
+                if ((pNode->nodeMap & bit) != 0)
+                {
+                    TNode *pChild = NONE;
+                    Var status = Remove(Children(pNode)[IndexOf(pNode->nodeMap, bit)], shift + PERSISTENT_BRANCH_BITS, hash, key, pChild);
+                    if (status != _EPersistentRemove::REMOVED) return status;
+                    if (IsSingle(pChild))
+                    {
+                        pResult = Rebuild(pNode, pNode->dataMap | bit, pNode->nodeMap & ~bit, bit, &Entries(pChild)[0], NONE);
+                        Release(pChild);
+                    }
+                    else
+                    {
+                        pResult = Rebuild(pNode, pNode->dataMap, pNode->nodeMap, bit, NONE, pChild);
+                    }
+                    return pResult != NONE ? _EPersistentRemove::REMOVED : _EPersistentRemove::FAILED;
+                }
+                return _EPersistentRemove::NOT_FOUND;
+            }
+
+            /// キーの要素を検索します。
+            static const TEntry *Find(TNode *pNode, U64 hash, const K &key) noexcept
+            {
+                USize shift = 0;
+                while (pNode != NONE)
+                {
+                    if (pNode->collisionCount != 0)
+                    {
+                        for (USize i = 0; i < pNode->collisionCount; i++)
+                        {
+                            if (Entries(pNode)[i].key == key) return &Entries(pNode)[i];
+                        }
+                        return NONE;
+                    }
+                    Var bit = BitOf(hash, shift);
+                    if ((pNode->dataMap & bit) != 0)
+                    {
+                        const Var &entry = Entries(pNode)[IndexOf(pNode->dataMap, bit)];
+                        return entry.hash == hash && entry.key == key ? &entry : NONE;
+                    }
+                    if ((pNode->nodeMap & bit) == 0) return NONE;
+                    pNode = Children(pNode)[IndexOf(pNode->nodeMap, bit)];
+                    shift += PERSISTENT_BRANCH_BITS;
+                }
+                return NONE;
+            }
+
+            /// すべての要素を関数へ渡します。
+            template<typename Fn>
+            static Void ForEach(TNode *pNode, Fn &function) noexcept
+            {
+                Var pEntries = Entries(pNode);
+                for (USize i = 0; i < EntryCount(pNode); i++) function(pEntries[i].key, pEntries[i].value);
+                Var ppChildren = Children(pNode);
+                for (USize i = 0; i < PopCount(pNode->nodeMap); i++) ForEach(ppChildren[i], function);
+            }
+        };
+    }
+    /// @endcond
+
+    /// 構造を共有する変更不可能な可変長配列です。
+    /// 要素を32分木の葉に格納し、変更は根から葉までの経路のみを複製した新しいベクタを返します。
+    /// コピーは参照数の加算のみで、元のベクタ、コピーはいずれも以降の変更の影響を受けません。
+    /// 節は参照数で共有し、複数のスレッドから同時に読み込み、コピーできます。
+    /// @tparam T 要素の型です。コピー構築、コピー代入できる必要があります。
+    template<typename T>
+    struct PersistentVector
+    {
+        /// 要素の型です。
+        using TElement = T;
+
+    private:
+
+        using TNodes = _Internal::_PersistentVectorNodes<T>;
+        using TNode = _Internal::_PersistentVectorNode;
+
+        TNode *m_pRoot;   // 根
+        USize m_count;    // 要素数
+        USize m_shift;    // 根の節の位置を求めるシフト量
+
+        // コンストラクタ
+        PersistentVector(TNode *pRoot, USize count, USize shift) noexcept
+            : m_pRoot(pRoot)
+            , m_count(count)
+            , m_shift(shift)
+        {}
+
+    public:
+
+        /// 空のベクタを作成します。
+        PersistentVector() noexcept
+            : m_pRoot(NONE)
+            , m_count(0)
+            , m_shift(0)
+        {}
+
+        /// コピーします。節を共有するため、要素数に依らず定数時間です。
+        /// @param origin コピー元です。
+        PersistentVector(const PersistentVector<TElement> &origin) noexcept
+            : m_pRoot(origin.m_pRoot)
+            , m_count(origin.m_count)
+            , m_shift(origin.m_shift)
+        {
+            TNodes::Retain(this->m_pRoot);
+        }
+
+        /// ムーブします。
+        /// @param origin ムーブ元です。
+        PersistentVector(PersistentVector<TElement> &&origin) noexcept
+            : m_pRoot(origin.m_pRoot)
+            , m_count(origin.m_count)
+            , m_shift(origin.m_shift)
+        {
+            origin.m_pRoot = NONE;
+            origin.m_count = 0;
+            origin.m_shift = 0;
+        }
+
+        /// デストラクタです。
+        ~PersistentVector() noexcept
+        {
+            TNodes::Release(this->m_pRoot, this->m_shift);
+        }
+
+        /// コピー代入します。
+        /// @param origin コピー元です。
+        /// @return 自身です。
+        PersistentVector<TElement> &operator=(const PersistentVector<TElement> &origin) noexcept
+        {
+            TNodes::Retain(origin.m_pRoot);
+            TNodes::Release(this->m_pRoot, this->m_shift);
+            this->m_pRoot = origin.m_pRoot;
+            this->m_count = origin.m_count;
+            this->m_shift = origin.m_shift;
+            return *this;
+        }
+
+        /// ムーブ代入します。
+        /// @param origin ムーブ元です。
+        /// @return 自身です。
+        PersistentVector<TElement> &operator=(PersistentVector<TElement> &&origin) noexcept
+        {
+            if (this == &origin) return *this;
+            TNodes::Release(this->m_pRoot, this->m_shift);
+            this->m_pRoot = origin.m_pRoot;
+            this->m_count = origin.m_count;
+            this->m_shift = origin.m_shift;
+            origin.m_pRoot = NONE;
+            origin.m_count = 0;
+            origin.m_shift = 0;
+            return *this;
+        }
+
+        /// 要素数を返します。
+        /// @return 要素数です。
+        USize Count() const noexcept
+        {
+            return this->m_count;
+        }
+
+        /// 要素が無いか判定します。
+        /// @retval true 要素がありません。
+        /// @retval false 要素があります。
+        Bool IsEmpty() const noexcept
+        {
+            return this->m_count == 0;
+        }
+
+        /// 要素にアクセスします。
+        /// @param index 要素数未満のインデックスです。
+        /// @return 要素です。
+        const TElement &operator[](USize index) const noexcept
+        {
+            Var pNode = this->m_pRoot;
+            for (Var shift = this->m_shift; shift > 0; shift -= PERSISTENT_BRANCH_BITS)
+            {
+                pNode = TNodes::Children(pNode)[(index >> shift) & _Internal::_PERSISTENT_BRANCH_MASK];
+            }
+            return TNodes::Values(pNode)[index & _Internal::_PERSISTENT_BRANCH_MASK];
+        }
+
+        /// 要素を置き換えたベクタを作成します。
+        /// @param index 要素数未満のインデックスです。
+        /// @param value 新しい値です。
+        /// @return 新しいベクタ、または、エラーです。
+        Result<PersistentVector<TElement>, EAllocateError> Set(USize index, const TElement &value) const noexcept
+        {
+            Var pRoot = TNodes::Set(this->m_pRoot, this->m_shift, index, value);
+            if (pRoot == NONE) return EAllocateError::BAD_ALLOCATE;
+            return PersistentVector<TElement>(pRoot, this->m_count, this->m_shift);
+        }
+
+        /// 末尾に要素を追加したベクタを作成します。
+        /// @param value 追加する要素です。
+        /// @return 新しいベクタ、または、エラーです。
+        Result<PersistentVector<TElement>, EAllocateError> Push(const TElement &value) const noexcept
+        {
+            if (this->m_pRoot == NONE)
+            {
+                Var pRoot = TNodes::Push(NONE, 0, 0, value);
+                if (pRoot == NONE) return EAllocateError::BAD_ALLOCATE;
+                return PersistentVector<TElement>(pRoot, 1, 0);
+            }
+
+            // 根が満たされている場合は1段深くします
+            if (this->m_count == USize(1) << (this->m_shift + PERSISTENT_BRANCH_BITS))
+            {
+                Var shift = this->m_shift + PERSISTENT_BRANCH_BITS;
+                Var pBranch = TNodes::Push(NONE, this->m_shift, this->m_count, value);
+                if (pBranch == NONE) return EAllocateError::BAD_ALLOCATE;
+                Var pRoot = TNodes::New(shift);
+                if (pRoot == NONE)
+                {
+                    TNodes::Release(pBranch, this->m_shift);
+                    return EAllocateError::BAD_ALLOCATE;
+                }
+                TNodes::Retain(this->m_pRoot);
+                TNodes::Children(pRoot)[0] = this->m_pRoot;
+                TNodes::Children(pRoot)[1] = pBranch;
+                pRoot->count = 2;
+                return PersistentVector<TElement>(pRoot, this->m_count + 1, shift);
+            }
+
+            Var pRoot = TNodes::Push(this->m_pRoot, this->m_shift, this->m_count, value);
+            if (pRoot == NONE) return EAllocateError::BAD_ALLOCATE;
+            return PersistentVector<TElement>(pRoot, this->m_count + 1, this->m_shift);
+        }
+
+        /// 末尾の要素を削除したベクタを作成します。
+        /// 要素数が0の場合は同じ内容のベクタを返します。
+        /// @return 新しいベクタ、または、エラーです。
+        Result<PersistentVector<TElement>, EAllocateError> Pop() const noexcept
+        {
+            if (this->m_count <= 1) return PersistentVector<TElement>();
+            Bool isFailed = NO;
+            Var pRoot = TNodes::Pop(this->m_pRoot, this->m_shift, this->m_count - 1, isFailed);
+            if (isFailed) return EAllocateError::BAD_ALLOCATE;
+
+            // 根の子が1つになった場合は1段浅くします
+            Var shift = this->m_shift;
+            if (shift > 0 && pRoot->count == 1)
+            {
+                Var pChild = TNodes::Children(pRoot)[0];
+                TNodes::Retain(pChild);
+                TNodes::Release(pRoot, shift);
+                pRoot = pChild;
+                shift -= PERSISTENT_BRANCH_BITS;
+            }
+            return PersistentVector<TElement>(pRoot, this->m_count - 1, shift);
+        }
+
+        /// すべての要素を先頭から順に関数へ渡します。
+        /// @param function 要素を受け取る関数です。
+        template<typename Fn>
+        Void ForEach(Fn &&function) const noexcept
+        {
+            if (this->m_pRoot != NONE) TNodes::ForEach(this->m_pRoot, this->m_shift, function);
+        }
+    };
+
+    /// 構造を共有する変更不可能なハッシュマップです。
+    /// キーのハッシュ値の5ビット毎に分岐するハッシュ配列マップトライで、変更は根から変更箇所までの経路のみを複製した新しいマップを返します。
+    /// コピーは参照数の加算のみで、元のマップ、コピーはいずれも以降の変更の影響を受けません。
+    /// 節は参照数で共有し、複数のスレッドから同時に読み込み、コピーできます。
+    /// @tparam K キーの型です。コピー構築でき、==で比較できる必要があります。
+    /// @tparam V 値の型です。コピー構築できる必要があります。
+    /// @tparam H キーのハッシュ値を求める関数オブジェクトの型です。
+    template<typename K, typename V, typename H = Hasher<K>>
+    struct PersistentHashMap
+    {
+        /// キーの型です。
+        using TKey = K;
+
+        /// 値の型です。
+        using TValue = V;
+
+    private:
+
+        using TNodes = _Internal::_PersistentMapNodes<K, V>;
+        using TNode = _Internal::_PersistentMapNode;
+        using TEntry = _Internal::_PersistentMapEntry<K, V>;
+
+        TNode *m_pRoot;   // 根
+        USize m_count;    // 要素数
+        H m_hasher;       // ハッシュ関数
+
+        // コンストラクタ
+        PersistentHashMap(TNode *pRoot, USize count, const H &hasher) noexcept
+            : m_pRoot(pRoot)
+            , m_count(count)
+            , m_hasher(hasher)
+        {}
+
+    public:
+
+        /// 空のマップを作成します。
+        /// @param hasher ハッシュ関数です。
+        PersistentHashMap(const H &hasher = H()) noexcept
+            : m_pRoot(NONE)
+            , m_count(0)
+            , m_hasher(hasher)
+        {}
+
+        /// コピーします。節を共有するため、要素数に依らず定数時間です。
+        /// @param origin コピー元です。
+        PersistentHashMap(const PersistentHashMap<K, V, H> &origin) noexcept
+            : m_pRoot(origin.m_pRoot)
+            , m_count(origin.m_count)
+            , m_hasher(origin.m_hasher)
+        {
+            TNodes::Retain(this->m_pRoot);
+        }
+
+        /// ムーブします。
+        /// @param origin ムーブ元です。
+        PersistentHashMap(PersistentHashMap<K, V, H> &&origin) noexcept
+            : m_pRoot(origin.m_pRoot)
+            , m_count(origin.m_count)
+            , m_hasher(origin.m_hasher)
+        {
+            origin.m_pRoot = NONE;
+            origin.m_count = 0;
+        }
+
+        /// デストラクタです。
+        ~PersistentHashMap() noexcept
+        {
+            TNodes::Release(this->m_pRoot);
+        }
+
+        /// コピー代入します。
+        /// @param origin コピー元です。
+        /// @return 自身です。
+        PersistentHashMap<K, V, H> &operator=(const PersistentHashMap<K, V, H> &origin) noexcept
+        {
+            TNodes::Retain(origin.m_pRoot);
+            TNodes::Release(this->m_pRoot);
+            this->m_pRoot = origin.m_pRoot;
+            this->m_count = origin.m_count;
+            this->m_hasher = origin.m_hasher;
+            return *this;
+        }
+
+        /// ムーブ代入します。
+        /// @param origin ムーブ元です。
+        /// @return 自身です。
+        PersistentHashMap<K, V, H> &operator=(PersistentHashMap<K, V, H> &&origin) noexcept
+        {
+            if (this == &origin) return *this;
+            TNodes::Release(this->m_pRoot);
+            this->m_pRoot = origin.m_pRoot;
+            this->m_count = origin.m_count;
+            this->m_hasher = origin.m_hasher;
+            origin.m_pRoot = NONE;
+            origin.m_count = 0;
+            return *this;
+        }
+
+        /// 要素数を返します。
+        /// @return 要素数です。
+        USize Count() const noexcept
+        {
+            return this->m_count;
+        }
+
+        /// 要素が無いか判定します。
+        /// @retval true 要素がありません。
+        /// @retval false 要素があります。
+        Bool IsEmpty() const noexcept
+        {
+            return this->m_count == 0;
+        }
+
+        /// キーの値を検索します。
+        /// @param key キーです。
+        /// @return 値、または、見つからない場合はNONEです。
+        const TValue *Find(const TKey &key) const noexcept
+        {
+            Var pEntry = TNodes::Find(this->m_pRoot, this->m_hasher(key), key);
+            return pEntry != NONE ? &pEntry->value : NONE;
+        }
+
+        /// キーを含むか判定します。
+        /// @param key キーです。
+        /// @retval true 含みます。
+        /// @retval false 含みません。
+        Bool Contains(const TKey &key) const noexcept
+        {
+            return this->Find(key) != NONE;
+        }
+
+        /// キーの値を追加、または、置き換えたマップを作成します。
+        /// @param key キーです。
+        /// @param value 値です。
+        /// @return 新しいマップ、または、エラーです。
+        Result<PersistentHashMap<K, V, H>, EAllocateError> Set(const TKey &key, const TValue &value) const noexcept
+        {
+            TEntry entry{ this->m_hasher(key), key, value };
+            if (this->m_pRoot == NONE)
+            {
+                Var pRoot = TNodes::New(TNodes::BitOf(entry.hash, 0), 0, 0);
+                if (pRoot == NONE) return EAllocateError::BAD_ALLOCATE;
+                new(&TNodes::Entries(pRoot)[0]) TEntry(entry);
+                return PersistentHashMap<K, V, H>(pRoot, 1, this->m_hasher);
+            }
+            Bool isAdded = NO;
+            Var pRoot = TNodes::Set(this->m_pRoot, 0, entry, isAdded);
+            if (pRoot == NONE) return EAllocateError::BAD_ALLOCATE;
+            return PersistentHashMap<K, V, H>(pRoot, this->m_count + (isAdded ? 1 : 0), this->m_hasher);
+        }
+
+        /// キーを削除したマップを作成します。
+        /// キーを含まない場合は同じ内容のマップを返します。
+        /// @param key キーです。
+        /// @return 新しいマップ、または、エラーです。
+        Result<PersistentHashMap<K, V, H>, EAllocateError> Remove(const TKey &key) const noexcept
+        {
+            if (this->m_pRoot == NONE) return PersistentHashMap<K, V, H>(*this);
+            TNode *pRoot = NONE;
+            Var status = TNodes::Remove(this->m_pRoot, 0, this->m_hasher(key), key, pRoot);
+            if (status == _Internal::_EPersistentRemove::NOT_FOUND) return PersistentHashMap<K, V, H>(*this);
+            if (status == _Internal::_EPersistentRemove::FAILED) return EAllocateError::BAD_ALLOCATE;
+            return PersistentHashMap<K, V, H>(pRoot, this->m_count - 1, this->m_hasher);
+        }
+
+        /// すべてのキーと値を関数へ渡します。順序は不定です。
+        /// @param function キーと値を受け取る関数です。
+        template<typename Fn>
+        Void ForEach(Fn &&function) const noexcept
+        {
+            if (this->m_pRoot != NONE) TNodes::ForEach(this->m_pRoot, function);
+        }
+    };
+}
+
+#endif // !_LEYENGINE_COLLECTIONS_PERSISTENT_HPP
\ No newline at end of file
@@ -0,0 +1,315 @@
+/// @file LeyEngine/Collections/RingQueue.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// 固定長のロックフリーキューを提供します。
+#ifndef _LEYENGINE_COLLECTIONS_RINGQUEUE_HPP
+#define _LEYENGINE_COLLECTIONS_RINGQUEUE_HPP
+
+#include <atomic>
+#include "LeyEngine/Memory.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine 
+{
+    /// リングキューの要素を格納するセルです。
+    /// リングキューのアロケータはこの型を要素とします。
+    /// @tparam T 要素型です。
+    template<typename T>
+    struct RingQueueCell
+    {
+        /// セルの状態を表す連番です。
+        std::atomic<USize> sequence;
+
+        /// 要素を格納するバッファです。
+        alignas(T) U8 storage[sizeof(T)];
+    };
+
+    /// 固定長の複数生産者、複数消費者ロックフリーキューです。
+    /// セル毎の連番で書き込み、読み込みの完了を判定するDmitry Vyukov方式です。
+    /// 先頭、末尾の位置は別のキャッシュラインに置かれます。
+    /// @tparam T 要素型です。
+    /// @tparam A セルのアロケータです。
+    template<typename T, typename A = Allocator<RingQueueCell<T>>>
+    struct RingQueue
+    {
+        static_assert(std::is_same_v<typename A::TElement, RingQueueCell<T>>, "The allocator must allocate RingQueueCell<T>.");
+
+        /// 要素の型です。
+        using TElement = T;
+
+        /// アロケータの型です。
+        using TAllocator = A;
+
+        /// アロケート時のエラー型です。
+        using TAllocateError = typename TAllocator::TAllocateError;
+
+        /// アロケート時のエラー型です。
+        using TDeallocateError = typename TAllocator::TDeallocateError;
+
+    private:
+
+        using TCell = RingQueueCell<T>;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<USize> m_enqueuePosition; // 次に書き込む位置
+        alignas(CACHE_LINE_SIZE) std::atomic<USize> m_dequeuePosition; // 次に読み込む位置
+        alignas(CACHE_LINE_SIZE) TAllocator m_allocator;                // アロケータ
+        TCell *m_pCells;                                                 // セル配列
+        USize m_mask;                                                    // 位置からセルの添え字を求めるマスク
+
+        // コンストラクタ
+        RingQueue(const TAllocator &allocator, TCell *pCells, USize capacity) noexcept
+            : m_enqueuePosition(0)
+            , m_dequeuePosition(0)
+            , m_allocator(allocator)
+            , m_pCells(pCells)
+            , m_mask(capacity - 1)
+        {
+            for (USize i = 0; i < capacity; i++)
+            {
+                new(&this->m_pCells[i].sequence) std::atomic<USize>(i);
+            }
+        }
+
+        // 書き込む位置を最大count個まで予約し、予約した数を返します
+        USize ReservePush(USize count, USize &position) noexcept
+        {
+            Var pos = this->m_enqueuePosition.load(std::memory_order_relaxed);
+            while (YES)
+            {
+                // 連続して書き込めるセルを数えます
+                USize ready = 0;
+                while (ready < count)
+                {
+                    Var &cell = this->m_pCells[(pos + ready) & this->m_mask];
+                    Var seq = cell.sequence.load(std::memory_order_acquire);
+                    Var diff = static_cast<ISize>(seq) - static_cast<ISize>(pos + ready);
+                    if (diff != 0) break;
+                    ready += 1;
+                }
+
+                if (ready == 0)
+                {
+                    // 満杯か、他の生産者が先に進めています
+                    Var &cell = this->m_pCells[pos & this->m_mask];
+                    Var seq = cell.sequence.load(std::memory_order_acquire);
+                    if (static_cast<ISize>(seq) - static_cast<ISize>(pos) < 0) return 0;
+                    pos = this->m_enqueuePosition.load(std::memory_order_relaxed);
+                }
+                else if (this->m_enqueuePosition.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed))
+                {
+                    position = pos;
+                    return ready;
+                }
+            }
+        }
+
+        // 読み込む位置を最大count個まで予約し、予約した数を返します
+        USize ReservePop(USize count, USize &position) noexcept
+        {
+            Var pos = this->m_dequeuePosition.load(std::memory_order_relaxed);
+            while (YES)
+            {
+                // 連続して読み込めるセルを数えます
+                USize ready = 0;
+                while (ready < count)
+                {
+                    Var &cell = this->m_pCells[(pos + ready) & this->m_mask];
+                    Var seq = cell.sequence.load(std::memory_order_acquire);
+                    Var diff = static_cast<ISize>(seq) - static_cast<ISize>(pos + ready + 1);
+                    if (diff != 0) break;
+                    ready += 1;
+                }
+
+                if (ready == 0)
+                {
+                    // 空か、他の消費者が先に進めています
+                    Var &cell = this->m_pCells[pos & this->m_mask];
+                    Var seq = cell.sequence.load(std::memory_order_acquire);
+                    if (static_cast<ISize>(seq) - static_cast<ISize>(pos + 1) < 0) return 0;
+                    pos = this->m_dequeuePosition.load(std::memory_order_relaxed);
+                }
+                else if (this->m_dequeuePosition.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed))
+                {
+                    position = pos;
+                    return ready;
+                }
+            }
+        }
+
+        // 予約した位置に要素を構築して公開します
+        template<typename...Args>
+        Void Publish(USize position, Args &&...args) noexcept
+        {
+            Var &cell = this->m_pCells[position & this->m_mask];
+            new(cell.storage) T(Forward<Args>(args)...);
+            cell.sequence.store(position + 1, std::memory_order_release);
+        }
+
+        // 予約した位置から要素をムーブして解放します
+        Void Consume(USize position, T &value) noexcept
+        {
+            Var &cell = this->m_pCells[position & this->m_mask];
+            Var ptr = std::launder(Cast<T*>(cell.storage));
+            value = Move(*ptr);
+            ptr->~T();
+            cell.sequence.store(position + this->m_mask + 1, std::memory_order_release);
+        }
+
+    public:
+
+        /// 作成します。
+        /// @param capacity 容量です。2の累乗に切り上げられます。
+        /// @param allocator アロケータです。
+        /// @return キュー、または、エラーです。
+        static Result<RingQueue<TElement, TAllocator>, TAllocateError> Create(USize capacity, const TAllocator &allocator = TAllocator()) noexcept
+        {
+            // 2の累乗に切り上げると桁あふれする容量と、バイトサイズが桁あふれする容量は確保できません
+            if (capacity > USIZE_MAX / 2 + 1) return TAllocateError::BAD_ALLOCATE;
+            USize length = 2;
+            while (length < capacity) length <<= 1;
+            if (length > USIZE_MAX / sizeof(TCell)) return TAllocateError::BAD_ALLOCATE;
+
+            TAllocator alloc = allocator;
+            Var res = alloc.Allocate(length);
+            if (res.IsSuccess())
+            {
+                return RingQueue<TElement, TAllocator>(alloc, res.Value(), length);
+            }
+            else
+            {
+                return res.Error();
+            }
+        }
+
+        RingQueue(const RingQueue<TElement, TAllocator> &origin) = delete;
+        RingQueue<TElement, TAllocator> &operator=(const RingQueue<TElement, TAllocator> &origin) = delete;
+
+        /// ムーブします。
+        /// ムーブ元を他のスレッドが使用していない場合のみ呼び出せます。
+        /// @param origin ムーブ元です。
+        RingQueue(RingQueue<TElement, TAllocator> &&origin) noexcept
+            : m_enqueuePosition(origin.m_enqueuePosition.load(std::memory_order_relaxed))
+            , m_dequeuePosition(origin.m_dequeuePosition.load(std::memory_order_relaxed))
+            , m_allocator(Move(origin.m_allocator))
+            , m_pCells(origin.m_pCells)
+            , m_mask(origin.m_mask)
+        {
+            origin.m_pCells = NONE;
+            origin.m_mask = 0;
+        }
+
+        /// デストラクタです。
+        /// 残っている要素を破棄します。
+        ~RingQueue() noexcept
+        {
+            if (this->m_pCells == NONE) return;
+            Var begin = this->m_dequeuePosition.load(std::memory_order_relaxed);
+            Var end = this->m_enqueuePosition.load(std::memory_order_relaxed);
+            for (Var pos = begin; pos != end; pos++)
+            {
+                std::launder(Cast<T*>(this->m_pCells[pos & this->m_mask].storage))->~T();
+            }
+            (Void)this->m_allocator.Deallocate(this->m_mask + 1, this->m_pCells);
+        }
+
+        /// 要素を追加します。
+        /// @param value 追加する要素です。
+        /// @retval true 追加しました。
+        /// @retval false 満杯でした。
+        Bool TryPush(const TElement &value) noexcept
+        {
+            return this->TryEmplace(value);
+        }
+
+        /// 要素を追加します。
+        /// @param value 追加する要素です。
+        /// @retval true 追加しました。
+        /// @retval false 満杯でした。
+        Bool TryPush(TElement &&value) noexcept
+        {
+            return this->TryEmplace(Move(value));
+        }
+
+        /// 要素をその場で構築して追加します。
+        /// @param args 要素のコンストラクタ引数です。
+        /// @retval true 追加しました。
+        /// @retval false 満杯でした。
+        template<typename...Args>
+        Bool TryEmplace(Args &&...args) noexcept
+        {
+            USize pos = 0;
+            if (this->ReservePush(1, pos) == 0) return NO;
+            this->Publish(pos, Forward<Args>(args)...);
+            return YES;
+        }
+
+        /// 要素を取り出します。
+        /// @param value 取り出した要素を受け取る参照です。
+        /// @retval true 取り出しました。
+        /// @retval false 空でした。
+        Bool TryPop(TElement &value) noexcept
+        {
+            USize pos = 0;
+            if (this->ReservePop(1, pos) == 0) return NO;
+            this->Consume(pos, value);
+            return YES;
+        }
+
+        /// 複数の要素を一括で追加します。
+        /// 連続した位置を1回の比較交換で予約します。
+        /// @param values 追加する要素の配列です。
+        /// @param count 追加する要素数です。
+        /// @return 追加できた要素数です。
+        USize TryPushBatch(const TElement *values, USize count) noexcept
+        {
+            USize pushed = 0;
+            while (pushed < count)
+            {
+                USize pos = 0;
+                Var reserved = this->ReservePush(count - pushed, pos);
+                if (reserved == 0) break;
+                for (USize i = 0; i < reserved; i++) this->Publish(pos + i, values[pushed + i]);
+                pushed += reserved;
+            }
+            return pushed;
+        }
+
+        /// 複数の要素を一括で取り出します。
+        /// 連続した位置を1回の比較交換で予約します。
+        /// @param values 取り出した要素を受け取る配列です。
+        /// @param count 取り出す最大の要素数です。
+        /// @return 取り出した要素数です。
+        USize TryPopBatch(TElement *values, USize count) noexcept
+        {
+            USize popped = 0;
+            while (popped < count)
+            {
+                USize pos = 0;
+                Var reserved = this->ReservePop(count - popped, pos);
+                if (reserved == 0) break;
+                for (USize i = 0; i < reserved; i++) this->Consume(pos + i, values[popped + i]);
+                popped += reserved;
+            }
+            return popped;
+        }
+
+        /// 容量を返します。
+        /// @return 容量です。
+        USize Capacity() const noexcept
+        {
+            return this->m_mask + 1;
+        }
+
+        /// おおよその要素数を返します。
+        /// 他のスレッドが操作している間は正確な値になりません。
+        /// @return 要素数です。
+        USize ApproximateCount() const noexcept
+        {
+            Var end = this->m_enqueuePosition.load(std::memory_order_relaxed);
+            Var begin = this->m_dequeuePosition.load(std::memory_order_relaxed);
+            return end - begin;
+        }
+    };
+}
+
+#endif // !_LEYENGINE_COLLECTIONS_RINGQUEUE_HPP
\ No newline at end of file
@@ -0,0 +1,611 @@
+/// @file LeyEngine/Collections/Sort.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// 配列の整列を提供します。
+#ifndef _LEYENGINE_COLLECTIONS_SORT_HPP
+#define _LEYENGINE_COLLECTIONS_SORT_HPP
+
+#include <cstring>
+#include <type_traits>
+#include "LeyEngine/Bit.hpp"
+#include "LeyEngine/Job.hpp"
+#include "LeyEngine/Collections/Array.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// 整列をジョブで並列に実行する最小の要素数です。
+    constexpr USize SORT_PARALLEL_THRESHOLD = 64 * 1024;
+
+    /// 基数ソートで整列するキーとインデックスの組です。
+    /// 大きな要素を直接並べ替えず、キーで整列してからインデックスで参照する際に使用します。
+    /// @tparam K キーの型です。整数型、または、浮動小数点型である必要があります。
+    template<typename K>
+    struct SortKeyIndex
+    {
+        /// キーです。
+        K key;
+        /// 元のインデックスです。
+        U32 index;
+    };
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// 挿入ソートに切り替える要素数です。
+        constexpr USize _INSERTION_SORT_THRESHOLD = 24;
+
+        /// 並列に整列する際の1ジョブあたりの最小の要素数です。
+        constexpr USize _PARALLEL_SORT_GRAIN = 4096;
+
+        /// 演算子<で比較します。
+        struct _Less
+        {
+            template<typename T>
+            Bool operator()(const T &l, const T &r) const noexcept
+            {
+                return l < r;
+            }
+        };
+
+        /// 要素を交換します。
+        template<typename T>
+        Void _Swap(T &l, T &r) noexcept
+        {
+            T temporary = Move(l);
+            l = Move(r);
+            r = Move(temporary);
+        }
+
+        /// 整列を並列に実行するかを返します。
+        inline Bool _IsParallelSort(USize count) noexcept
+        {
+            return count >= SORT_PARALLEL_THRESHOLD && JobWorkerCount() > 1;
+        }
+
+        /// 整列を分割する数を返します。
+        inline USize _SortTaskCount(USize count) noexcept
+        {
+            Var taskCount = JobWorkerCount() * 4;
+            Var maxCount = count / _PARALLEL_SORT_GRAIN;
+            if (taskCount > maxCount) taskCount = maxCount;
+            return taskCount < 1 ? 1 : taskCount;
+        }
+
+        /// 処理をジョブで並列に実行します。ジョブを実行できない場合は順に実行します。
+        template<typename Fn>
+        Void _RunSortTasks(USize count, Bool isParallel, Fn &&function) noexcept
+        {
+            if (isParallel && count > 1 && ParallelFor(count, 1, function).IsSuccess()) return;
+            for (USize i = 0; i < count; i++) function(i);
+        }
+
+        /// 挿入ソートで整列します。
+        template<typename T, typename Less>
+        Void _InsertionSort(T *pData, USize count, Less &less) noexcept
+        {
+            for (USize i = 1; i < count; i++)
+            {
+                if (!less(pData[i], pData[i - 1])) continue;
+                T value = Move(pData[i]);
+                Var j = i;
+                do
+                {
+                    pData[j] = Move(pData[j - 1]);
+                    j--;
+                } while (j > 0 && less(value, pData[j - 1]));
+                pData[j] = Move(value);
+            }
+        }
+
+        /// ヒープの根から要素を下ろします。
+        template<typename T, typename Less>
+        Void _SiftDown(T *pData, USize root, USize count, Less &less) noexcept
+        {
+            while (YES)
+            {
+                Var child = root * 2 + 1;
+                if (child >= count) return;
+                if (child + 1 < count && less(pData[child], pData[child + 1])) child++;
+                if (!less(pData[root], pData[child])) return;
+                _Swap(pData[root], pData[child]);
+                root = child;
+            }
+        }
+
+        /// ヒープソートで整列します。
+        template<typename T, typename Less>
+        Void _HeapSort(T *pData, USize count, Less &less) noexcept
+        {
+            for (Var i = count / 2; i > 0; i--) _SiftDown(pData, i - 1, count, less);
+            for (Var i = count; i > 1; i--)
+            {
+                _Swap(pData[0], pData[i - 1]);
+                _SiftDown(pData, 0, i - 1, less);
+            }
+        }
+
+        /// 先頭、中央、末尾の中央値を基準に分割し、基準の位置を返します。
+        /// 基準より前は基準以下、後は基準以上になります。要素数は3以上である必要があります。
+        template<typename T, typename Less>
+        USize _Partition(T *pData, USize count, Less &less) noexcept
+        {
+            Var middle = count / 2;
+            if (less(pData[middle], pData[0])) _Swap(pData[middle], pData[0]);
+            if (less(pData[count - 1], pData[middle]))
+            {
+                _Swap(pData[count - 1], pData[middle]);
+                if (less(pData[middle], pData[0])) _Swap(pData[middle], pData[0]);
+            }
+            // 末尾は基準以上のため、前からの走査の番兵になります
+            _Swap(pData[0], pData[middle]);
+            USize i = 0;
+            USize j = count;
+            while (YES)
+            {
+                do i++; while (less(pData[i], pData[0]));
+                do j--; while (less(pData[0], pData[j]));
+                if (i >= j) break;
+                _Swap(pData[i], pData[j]);
+            }
+            _Swap(pData[0], pData[j]);
+            return j;
+        }
+
+        /// イントロソートで整列します。
+        template<typename T, typename Less>
+        Void _IntroSort(T *pData, USize count, USize depth, Less &less) noexcept
+        {
+            while (count > _INSERTION_SORT_THRESHOLD)
+            {
+                if (depth == 0)
+                {
+                    _HeapSort(pData, count, less);
+                    return;
+                }
+                depth--;
+                Var split = _Partition(pData, count, less);
+                // 小さい方を再帰し、大きい方を繰り返しで処理します
+                if (split < count - split - 1)
+                {
+                    _IntroSort(pData, split, depth, less);
+                    pData += split + 1;
+                    count -= split + 1;
+                }
+                else
+                {
+                    _IntroSort(pData + split + 1, count - split - 1, depth, less);
+                    count = split;
+                }
+            }
+            _InsertionSort(pData, count, less);
+        }
+
+        /// イントロソートの再帰の深さの上限を返します。
+        inline USize _IntroSortDepth(USize count) noexcept
+        {
+            return count < 2 ? 0 : (63 - CountLeadingZeros(count)) * 2;
+        }
+
+        /// 整列する範囲です。
+        template<typename T>
+        struct _SortRange
+        {
+            T *pData;       // 先頭
+            USize count;    // 要素数
+        };
+
+        /// 分割で独立した範囲を作り、各範囲をジョブで並列に整列します。
+        template<typename T, typename Less>
+        Void _ParallelSort(T *pData, USize count, Less &less) noexcept
+        {
+            constexpr USize MAX_RANGE_COUNT = 256;
+            _SortRange<T> ranges[MAX_RANGE_COUNT];
+            ranges[0] = _SortRange<T>{ pData, count };
+            USize rangeCount = 1;
+            Var targetCount = count / _SortTaskCount(count);
+            // 最も大きい範囲を目標の要素数以下になるまで分割します
+            while (rangeCount + 1 < MAX_RANGE_COUNT)
+            {
+                USize largest = 0;
+                for (USize i = 1; i < rangeCount; i++)
+                {
+                    if (ranges[i].count > ranges[largest].count) largest = i;
+                }
+                Var range = ranges[largest];
+                if (range.count <= targetCount || range.count <= _INSERTION_SORT_THRESHOLD) break;
+                Var split = _Partition(range.pData, range.count, less);
+                ranges[largest] = _SortRange<T>{ range.pData, split };
+                ranges[rangeCount++] = _SortRange<T>{ range.pData + split + 1, range.count - split - 1 };
+            }
+            _RunSortTasks(rangeCount, YES, [&](USize index)
+            {
+                _IntroSort(ranges[index].pData, ranges[index].count, _IntroSortDepth(ranges[index].count), less);
+            });
+        }
+
+        /// 2つの整列済みの範囲を結合した際に、先頭から指定数の要素に含まれる左の範囲の要素数を求めます。
+        template<typename T, typename Less>
+        USize _MergeRank(USize position, const T *pLeft, USize leftCount, const T *pRight, USize rightCount, Less &less) noexcept
+        {
+            USize low = position > rightCount ? position - rightCount : 0;
+            USize high = position < leftCount ? position : leftCount;
+            while (low < high)
+            {
+                Var i = low + (high - low) / 2;
+                Var j = position - i;
+                // 同じ値は左の範囲を先にするため、右の要素が真に小さい場合のみ右を先にします
+                if (j > 0 && i < leftCount && !less(pRight[j - 1], pLeft[i])) low = i + 1;
+                else high = i;
+            }
+            return low;
+        }
+
+        /// 2つの整列済みの範囲を安定に結合し、結合後の指定の範囲を出力します。
+        template<typename T, typename Less>
+        Void _Merge(const T *pLeft, USize leftCount, const T *pRight, USize rightCount, USize begin, USize end, T *pOutput, Less &less) noexcept
+        {
+            Var i = _MergeRank(begin, pLeft, leftCount, pRight, rightCount, less);
+            Var j = begin - i;
+            for (Var k = begin; k < end; k++)
+            {
+                if (j >= rightCount || (i < leftCount && !less(pRight[j], pLeft[i]))) pOutput[k] = pLeft[i++];
+                else pOutput[k] = pRight[j++];
+            }
+        }
+
+        /// 作業領域を使用して、範囲をマージソートで整列します。
+        template<typename T, typename Less>
+        Void _MergeSort(T *pData, T *pBuffer, USize count, Less &less) noexcept
+        {
+            constexpr USize RUN_COUNT = 32;
+            for (USize begin = 0; begin < count; begin += RUN_COUNT)
+            {
+                _InsertionSort(pData + begin, count - begin < RUN_COUNT ? count - begin : RUN_COUNT, less);
+            }
+            T *pSource = pData;
+            T *pDestination = pBuffer;
+            for (Var width = RUN_COUNT; width < count; width *= 2)
+            {
+                for (USize begin = 0; begin < count; begin += width * 2)
+                {
+                    Var leftCount = count - begin < width ? count - begin : width;
+                    Var rightCount = count - begin - leftCount < width ? count - begin - leftCount : width;
+                    _Merge(pSource + begin, leftCount, pSource + begin + leftCount, rightCount, 0, leftCount + rightCount, pDestination + begin, less);
+                }
+                _Swap(pSource, pDestination);
+            }
+            if (pSource != pData) std::memcpy(pData, pSource, sizeof(T) * count);
+        }
+
+        /// 符号無し整数に変換したキーの型です。
+        template<typename K>
+        using _RadixKey = std::conditional_t<sizeof(K) == 1, U8, std::conditional_t<sizeof(K) == 2, U16, std::conditional_t<sizeof(K) == 4, U32, U64>>>;
+
+        /// キーを大小関係を保つ符号無し整数に変換します。
+        template<typename K>
+        _RadixKey<K> _ToRadixKey(K key) noexcept
+        {
+            static_assert(std::is_arithmetic_v<K>, "The key must be an integer or a floating point number.");
+            using TKey = _RadixKey<K>;
+            constexpr TKey SIGN = static_cast<TKey>(TKey(1) << (sizeof(K) * 8 - 1));
+            if constexpr (std::is_floating_point_v<K>)
+            {
+                // 負の数はすべてのビットを反転し、正の数は符号ビットを立てます
+                TKey bits = 0;
+                std::memcpy(&bits, &key, sizeof(K));
+                return (bits & SIGN) != 0 ? static_cast<TKey>(~bits) : static_cast<TKey>(bits | SIGN);
+            }
+            else if constexpr (std::is_signed_v<K>)
+            {
+                return static_cast<TKey>(static_cast<TKey>(key) ^ SIGN);
+            }
+            else
+            {
+                return static_cast<TKey>(key);
+            }
+        }
+
+        /// 基数ソートの1桁のバケット数です。
+        constexpr USize _RADIX_BUCKET_COUNT = 256;
+
+        /// 並列の基数ソートで範囲毎の出力位置の格納に必要な、作業領域の追加の要素数を返します。
+        template<typename T>
+        constexpr USize _RadixOffsetsElementCount(USize taskCount) noexcept
+        {
+            // 要素の後ろにUSizeのアライメントで配置するため、アライメント分を余分に確保します
+            return (sizeof(USize) * _RADIX_BUCKET_COUNT * taskCount + alignof(USize) + sizeof(T) - 1) / sizeof(T);
+        }
+
+        /// 作業領域を使用して、キーの下位の桁から基数ソートで整列します。
+        /// 範囲毎の出力位置はpBufferのcount要素より後ろに配置します。taskCountが1の場合は並列に整列しません。
+        template<typename T, typename KeyOf>
+        Void _RadixSort(T *pData, T *pBuffer, USize count, USize taskCount, KeyOf &keyOf) noexcept
+        {
+            using TKey = decltype(_ToRadixKey(keyOf(*pData)));
+            constexpr USize DIGIT_COUNT = sizeof(TKey);
+            T *pSource = pData;
+            T *pDestination = pBuffer;
+            if (taskCount <= 1)
+            {
+                // 桁毎の出現数は順序に依らないため、すべての桁を1度の走査で数えます
+                USize counts[DIGIT_COUNT][_RADIX_BUCKET_COUNT] = {};
+                for (USize i = 0; i < count; i++)
+                {
+                    Var key = _ToRadixKey(keyOf(pData[i]));
+                    for (USize digit = 0; digit < DIGIT_COUNT; digit++) counts[digit][(key >> (digit * 8)) & 0xFF]++;
+                }
+                for (USize digit = 0; digit < DIGIT_COUNT; digit++)
+                {
+                    Var pCounts = counts[digit];
+                    // すべての要素が同じ値の桁は並びが変わらないため省きます
+                    if (pCounts[(_ToRadixKey(keyOf(pSource[0])) >> (digit * 8)) & 0xFF] == count) continue;
+                    USize offset = 0;
+                    for (USize bucket = 0; bucket < _RADIX_BUCKET_COUNT; bucket++)
+                    {
+                        Var bucketCount = pCounts[bucket];
+                        pCounts[bucket] = offset;
+                        offset += bucketCount;
+                    }
+                    for (USize i = 0; i < count; i++)
+                    {
+                        Var bucket = (_ToRadixKey(keyOf(pSource[i])) >> (digit * 8)) & 0xFF;
+                        pDestination[pCounts[bucket]++] = pSource[i];
+                    }
+                    _Swap(pSource, pDestination);
+                }
+            }
+            else
+            {
+                Var pOffsets = Cast<USize*>(AlignUp(Cast<USize>(pBuffer + count), alignof(USize)));
+                Var taskSize = (count + taskCount - 1) / taskCount;
+                for (USize digit = 0; digit < DIGIT_COUNT; digit++)
+                {
+                    Var shift = digit * 8;
+                    // 範囲毎の出現数を数えます
+                    _RunSortTasks(taskCount, YES, [&](USize task)
+                    {
+                        Var pCounts = pOffsets + task * _RADIX_BUCKET_COUNT;
+                        std::memset(pCounts, 0, sizeof(USize) * _RADIX_BUCKET_COUNT);
+                        Var end = (task + 1) * taskSize < count ? (task + 1) * taskSize : count;
+                        for (Var i = task * taskSize; i < end; i++) pCounts[(_ToRadixKey(keyOf(pSource[i])) >> shift) & 0xFF]++;
+                    });
+                    // 範囲の順に出力位置を割り当てるため、安定になります
+                    USize offset = 0;
+                    Bool isTrivial = NO;
+                    for (USize bucket = 0; bucket < _RADIX_BUCKET_COUNT; bucket++)
+                    {
+                        USize bucketTotal = 0;
+                        for (USize task = 0; task < taskCount; task++)
+                        {
+                            Var &taskOffset = pOffsets[task * _RADIX_BUCKET_COUNT + bucket];
+                            Var bucketCount = taskOffset;
+                            taskOffset = offset;
+                            offset += bucketCount;
+                            bucketTotal += bucketCount;
+                        }
+                        if (bucketTotal == count) isTrivial = YES;
+                    }
+                    if (isTrivial) continue;
+                    _RunSortTasks(taskCount, YES, [&](USize task)
+                    {
+                        Var pCounts = pOffsets + task * _RADIX_BUCKET_COUNT;
+                        Var end = (task + 1) * taskSize < count ? (task + 1) * taskSize : count;
+                        for (Var i = task * taskSize; i < end; i++)
+                        {
+                            pDestination[pCounts[(_ToRadixKey(keyOf(pSource[i])) >> shift) & 0xFF]++] = pSource[i];
+                        }
+                    });
+                    _Swap(pSource, pDestination);
+                }
+            }
+            if (pSource != pData) std::memcpy(pData, pSource, sizeof(T) * count);
+        }
+    }
+    /// @endcond
+
+    /// 要素を整列します。安定ではありません。
+    /// 要素数がSORT_PARALLEL_THRESHOLD以上の場合はジョブで並列に整列します。
+    /// @tparam T 要素の型です。
+    /// @tparam Less 比較関数の型です。Bool(const T&, const T&)を呼び出せる必要があります。
+    /// @param pData 要素配列の先頭です。
+    /// @param count 要素数です。
+    /// @param less 左辺が右辺より小さい場合に真を返す関数です。
+    template<typename T, typename Less = _Internal::_Less>
+    Void Sort(T *pData, USize count, Less less = Less()) noexcept
+    {
+        if (count < 2) return;
+        if (_Internal::_IsParallelSort(count)) _Internal::_ParallelSort(pData, count, less);
+        else _Internal::_IntroSort(pData, count, _Internal::_IntroSortDepth(count), less);
+    }
+
+    /// 範囲の要素を整列します。安定ではありません。
+    /// @tparam T 要素の型です。
+    /// @tparam Less 比較関数の型です。Bool(const T&, const T&)を呼び出せる必要があります。
+    /// @param begin 範囲の先頭です。
+    /// @param end 範囲の末尾です。
+    /// @param less 左辺が右辺より小さい場合に真を返す関数です。
+    template<typename T, typename Less = _Internal::_Less>
+    Void Sort(PointerIterator<T> begin, PointerIterator<T> end, Less less = Less()) noexcept
+    {
+        Sort(begin.operator->(), static_cast<USize>(end - begin), less);
+    }
+
+    /// 配列の要素を整列します。安定ではありません。
+    /// @tparam T 要素の型です。
+    /// @tparam A 要素アロケータです。
+    /// @tparam Less 比較関数の型です。Bool(const T&, const T&)を呼び出せる必要があります。
+    /// @param array 配列です。
+    /// @param less 左辺が右辺より小さい場合に真を返す関数です。
+    template<typename T, typename A, typename Less = _Internal::_Less>
+    Void Sort(Array<T, A> &array, Less less = Less()) noexcept
+    {
+        Sort(array.Data(), array.Count(), less);
+    }
+
+    /// 同じ値の要素の順序を保って整列します。
+    /// 要素数と同じ大きさの作業領域をアロケータから確保します。
+    /// 要素数がSORT_PARALLEL_THRESHOLD以上の場合はジョブで並列に整列します。
+    /// @tparam T 要素の型です。トリビアルにコピーできる必要があります。
+    /// @tparam Less 比較関数の型です。Bool(const T&, const T&)を呼び出せる必要があります。
+    /// @tparam A 作業領域のアロケータです。
+    /// @param pData 要素配列の先頭です。
+    /// @param count 要素数です。
+    /// @param less 左辺が右辺より小さい場合に真を返す関数です。
+    /// @param allocator 作業領域のアロケータです。
+    /// @return SUCCESS、または、作業領域の確保のエラーです。
+    template<typename T, typename Less = _Internal::_Less, typename A = Allocator<T>>
+    Result<Success, typename A::TAllocateError> StableSort(T *pData, USize count, Less less = Less(), const A &allocator = A()) noexcept
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "The element must be trivially copyable.");
+        using namespace _Internal;
+        if (count < 2) return SUCCESS;
+        A scratch = allocator;
+        Var bufferResult = scratch.Allocate(count);
+        if (bufferResult.IsFailure()) return bufferResult.Error();
+        Var pBuffer = bufferResult.Value();
+        Var isParallel = _IsParallelSort(count);
+        Var taskCount = isParallel ? _SortTaskCount(count) : 1;
+        Var taskSize = (count + taskCount - 1) / taskCount;
+        // 範囲毎に整列してから、隣り合う範囲を結合します
+        _RunSortTasks(taskCount, isParallel, [&](USize task)
+        {
+            Var begin = task * taskSize;
+            if (begin >= count) return;
+            _MergeSort(pData + begin, pBuffer + begin, count - begin < taskSize ? count - begin : taskSize, less);
+        });
+        T *pSource = pData;
+        T *pDestination = pBuffer;
+        for (Var width = taskSize; width < count; width *= 2)
+        {
+            // 結合後の位置で等分するため、範囲の大きさに依らず並列に結合できます
+            _RunSortTasks(taskCount, isParallel, [&](USize task)
+            {
+                Var position = task * taskSize;
+                Var end = (task + 1) * taskSize < count ? (task + 1) * taskSize : count;
+                while (position < end)
+                {
+                    Var pairBegin = position / (width * 2) * (width * 2);
+                    Var leftCount = count - pairBegin < width ? count - pairBegin : width;
+                    Var rightCount = count - pairBegin - leftCount < width ? count - pairBegin - leftCount : width;
+                    Var pairEnd = pairBegin + leftCount + rightCount < end ? pairBegin + leftCount + rightCount : end;
+                    _Merge(pSource + pairBegin, leftCount, pSource + pairBegin + leftCount, rightCount, position - pairBegin, pairEnd - pairBegin, pDestination + pairBegin, less);
+                    position = pairEnd;
+                }
+            });
+            _Swap(pSource, pDestination);
+        }
+        if (pSource != pData) std::memcpy(pData, pSource, sizeof(T) * count);
+        (Void)scratch.Deallocate(count, pBuffer);
+        return SUCCESS;
+    }
+
+    /// 範囲の要素を同じ値の要素の順序を保って整列します。
+    /// @tparam T 要素の型です。トリビアルにコピーできる必要があります。
+    /// @tparam Less 比較関数の型です。Bool(const T&, const T&)を呼び出せる必要があります。
+    /// @tparam A 作業領域のアロケータです。
+    /// @param begin 範囲の先頭です。
+    /// @param end 範囲の末尾です。
+    /// @param less 左辺が右辺より小さい場合に真を返す関数です。
+    /// @param allocator 作業領域のアロケータです。
+    /// @return SUCCESS、または、作業領域の確保のエラーです。
+    template<typename T, typename Less = _Internal::_Less, typename A = Allocator<T>>
+    Result<Success, typename A::TAllocateError> StableSort(PointerIterator<T> begin, PointerIterator<T> end, Less less = Less(), const A &allocator = A()) noexcept
+    {
+        return StableSort(begin.operator->(), static_cast<USize>(end - begin), less, allocator);
+    }
+
+    /// 配列の要素を同じ値の要素の順序を保って整列します。
+    /// 作業領域は配列のアロケータから確保します。
+    /// @tparam T 要素の型です。トリビアルにコピーできる必要があります。
+    /// @tparam A 要素アロケータです。
+    /// @tparam Less 比較関数の型です。Bool(const T&, const T&)を呼び出せる必要があります。
+    /// @param array 配列です。
+    /// @param less 左辺が右辺より小さい場合に真を返す関数です。
+    /// @return SUCCESS、または、作業領域の確保のエラーです。
+    template<typename T, typename A, typename Less = _Internal::_Less>
+    Result<Success, typename A::TAllocateError> StableSort(Array<T, A> &array, Less less = Less()) noexcept
+    {
+        return StableSort(array.Data(), array.Count(), less, array.GetAllocator());
+    }
+
+    /// キーの下位の桁から基数ソートで整列します。同じキーの要素の順序を保ちます。
+    /// 要素数と同じ大きさの作業領域をアロケータから確保します。
+    /// 要素数がSORT_PARALLEL_THRESHOLD以上の場合はジョブで並列に整列し、範囲毎の出力位置も作業領域に含めて確保します。
+    /// @tparam T 要素の型です。トリビアルにコピーできる必要があります。
+    /// @tparam KeyOf キーを返す関数の型です。整数型、または、浮動小数点型を返す必要があります。
+    /// @tparam A 作業領域のアロケータです。
+    /// @param pData 要素配列の先頭です。
+    /// @param count 要素数です。
+    /// @param keyOf 要素のキーを返す関数です。
+    /// @param allocator 作業領域のアロケータです。
+    /// @return SUCCESS、または、作業領域の確保のエラーです。
+    template<typename T, typename KeyOf, typename A = Allocator<T>>
+    Result<Success, typename A::TAllocateError> RadixSortBy(T *pData, USize count, KeyOf keyOf, const A &allocator = A()) noexcept
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "The element must be trivially copyable.");
+        if (count < 2) return SUCCESS;
+        A scratch = allocator;
+        USize taskCount = 1;
+        USize bufferCount = count;
+        if (_Internal::_IsParallelSort(count))
+        {
+            taskCount = _Internal::_SortTaskCount(count);
+            bufferCount += _Internal::_RadixOffsetsElementCount<T>(taskCount);
+        }
+        Var bufferResult = scratch.Allocate(bufferCount);
+        if (bufferResult.IsFailure() && taskCount > 1)
+        {
+            // 出力位置の分を確保できない場合は順に整列します
+            taskCount = 1;
+            bufferCount = count;
+            bufferResult = scratch.Allocate(bufferCount);
+        }
+        if (bufferResult.IsFailure()) return bufferResult.Error();
+        _Internal::_RadixSort(pData, bufferResult.Value(), count, taskCount, keyOf);
+        (Void)scratch.Deallocate(bufferCount, bufferResult.Value());
+        return SUCCESS;
+    }
+
+    /// 整数、または、浮動小数点数を基数ソートで整列します。
+    /// 浮動小数点数の負の0は正の0より前、NaNは符号に応じて両端に並びます。
+    /// @tparam T 要素の型です。
+    /// @tparam A 作業領域のアロケータです。
+    /// @param pData 要素配列の先頭です。
+    /// @param count 要素数です。
+    /// @param allocator 作業領域のアロケータです。
+    /// @return SUCCESS、または、作業領域の確保のエラーです。
+    template<typename T, typename A = Allocator<T>, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+    Result<Success, typename A::TAllocateError> RadixSort(T *pData, USize count, const A &allocator = A()) noexcept
+    {
+        return RadixSortBy(pData, count, [](T value) noexcept { return value; }, allocator);
+    }
+
+    /// キーとインデックスの組をキーで基数ソートします。同じキーの組の順序を保ちます。
+    /// @tparam K キーの型です。
+    /// @tparam A 作業領域のアロケータです。
+    /// @param pData 組の配列の先頭です。
+    /// @param count 組の数です。
+    /// @param allocator 作業領域のアロケータです。
+    /// @return SUCCESS、または、作業領域の確保のエラーです。
+    template<typename K, typename A = Allocator<SortKeyIndex<K>>>
+    Result<Success, typename A::TAllocateError> RadixSort(SortKeyIndex<K> *pData, USize count, const A &allocator = A()) noexcept
+    {
+        return RadixSortBy(pData, count, [](const SortKeyIndex<K> &pair) noexcept { return pair.key; }, allocator);
+    }
+
+    /// 配列の要素を基数ソートで整列します。
+    /// 作業領域は配列のアロケータから確保します。
+    /// @tparam T 要素の型です。整数型、浮動小数点型、または、SortKeyIndexである必要があります。
+    /// @tparam A 要素アロケータです。
+    /// @param array 配列です。
+    /// @return SUCCESS、または、作業領域の確保のエラーです。
+    template<typename T, typename A>
+    Result<Success, typename A::TAllocateError> RadixSort(Array<T, A> &array) noexcept
+    {
+        return RadixSort(array.Data(), array.Count(), array.GetAllocator());
+    }
+}
+
+#endif // !_LEYENGINE_COLLECTIONS_SORT_HPP
\ No newline at end of file
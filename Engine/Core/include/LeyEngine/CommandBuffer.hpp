@@ -0,0 +1,348 @@
+/// @file LeyEngine/CommandBuffer.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// コマンドバッファを提供します。
+#ifndef _LEYENGINE_COMMANDBUFFER_HPP
+#define _LEYENGINE_COMMANDBUFFER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include "LeyEngine/Memory.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// コマンドバッファのチャンクの標準バイトサイズです。
+    constexpr USize COMMAND_BUFFER_CHUNK_SIZE = 16 * 1024;
+
+    /// コマンドの後に続けて記録するペイロードのアライメントです。
+    constexpr USize COMMAND_PAYLOAD_ALIGNMENT = alignof(std::max_align_t);
+
+    /// 記録されたコマンドの先頭に置かれるヘッダです。
+    struct CommandHeader
+    {
+        /// コマンドの型の位置です。
+        U32 typeIndex;
+        /// このヘッダから次のヘッダまでのバイトサイズです。
+        U32 size;
+        /// コマンドの後に続くペイロードのバイトサイズです。ペイロードが無い場合は0です。
+        U32 payloadSize;
+    };
+
+    /// コマンドの後に続けて記録する可変長のデータです。
+    struct CommandPayload
+    {
+        /// データの先頭です。
+        const Void *pData;
+        /// データのバイトサイズです。
+        USize size;
+    };
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// コマンドバッファのチャンクです。
+        struct _CommandChunk
+        {
+            _CommandChunk *pNext; // 次のチャンク
+            USize capacity;       // データ部のバイトサイズ
+            USize used;           // 使用済みのバイトサイズ
+
+            /// データ部の先頭を返します。
+            U8 *Data() noexcept
+            {
+                return Cast<U8*>(this) + AlignUp(sizeof(_CommandChunk), alignof(CommandHeader));
+            }
+
+            /// データ部の先頭を返します。
+            const U8 *Data() const noexcept
+            {
+                return Cast<const U8*>(this) + AlignUp(sizeof(_CommandChunk), alignof(CommandHeader));
+            }
+        };
+
+        /// ヘッダの後に置かれたコマンドを関数に渡します。
+        /// 関数がペイロードも受け取れる場合は、コマンドの後に続くペイロードも渡します。
+        template<typename T, typename Fn>
+        Void _PlayCommand(const CommandHeader *pHeader, Fn &&function)
+        {
+            Var commandAddress = AlignUp(Cast<USize>(pHeader) + sizeof(CommandHeader), alignof(T));
+            Var pCommand = std::launder(Cast<const T*>(commandAddress));
+            if constexpr (std::is_invocable_v<Fn, const T&, const CommandPayload&>)
+            {
+                Var payloadAddress = AlignUp(commandAddress + sizeof(T), COMMAND_PAYLOAD_ALIGNMENT);
+                CommandPayload payload = { Cast<const Void*>(payloadAddress), pHeader->payloadSize };
+                function(*pCommand, payload);
+            }
+            else
+            {
+                function(*pCommand);
+            }
+        }
+    }
+    /// @endcond
+
+    /// 異なる型のコマンドを連続したメモリに記録するバッファです。
+    /// コマンドはヘッダと共にチャンクへ詰めて記録され、コマンド毎のヒープ確保は行いません。
+    /// バッファはスレッド毎に用意して記録し、Appendで連結してから再生します。
+    /// @tparam Ts 記録できるコマンドの型です。すべて自明にコピー可能である必要があります。
+    template<typename...Ts>
+    struct CommandBuffer
+    {
+        static_assert((std::is_trivially_copyable_v<Ts> && ...), "Commands must be trivially copyable.");
+        static_assert(sizeof...(Ts) <= U32_MAX, "Too many command types.");
+
+    private:
+
+        _Internal::_CommandChunk *m_pHead;  // 先頭のチャンク
+        _Internal::_CommandChunk *m_pTail;  // 書き込み中のチャンク
+        _Internal::_CommandChunk *m_pSpare; // 再利用待ちのチャンク
+        USize m_commandsCount;              // 記録したコマンド数
+
+        // チャンクを確保して末尾に連結します
+        Result<_Internal::_CommandChunk*, EAllocateError> PushChunk(USize minimumCapacity) noexcept
+        {
+            _Internal::_CommandChunk *pChunk = NONE;
+            if (this->m_pSpare != NONE && this->m_pSpare->capacity >= minimumCapacity)
+            {
+                pChunk = this->m_pSpare;
+                this->m_pSpare = pChunk->pNext;
+            }
+            else
+            {
+                Var capacity = minimumCapacity > COMMAND_BUFFER_CHUNK_SIZE ? minimumCapacity : COMMAND_BUFFER_CHUNK_SIZE;
+                Var headerSize = AlignUp(sizeof(_Internal::_CommandChunk), alignof(CommandHeader));
+                Var allocateResult = LeyEngine::Allocate(headerSize + capacity);
+                if (allocateResult.IsFailure()) return allocateResult.Error();
+                pChunk = new(allocateResult.Value()) _Internal::_CommandChunk();
+                pChunk->capacity = capacity;
+            }
+            pChunk->pNext = NONE;
+            pChunk->used = 0;
+
+            if (this->m_pTail != NONE)
+            {
+                this->m_pTail->pNext = pChunk;
+            }
+            else
+            {
+                this->m_pHead = pChunk;
+            }
+            this->m_pTail = pChunk;
+            return pChunk;
+        }
+
+        // コマンドをペイロードと共にチャンクの末尾へ構築します
+        template<typename T, typename...Args>
+        Result<T*, EAllocateError> Emplace(const Void *pPayload, USize payloadSize, Args &&...args) noexcept
+        {
+            static_assert(ContainsType<T, Ts...>(), "The type is not a command of this buffer.");
+
+            // ヘッダ、アライメント調整、コマンド本体を格納できるバイトサイズです
+            constexpr USize COMMAND_SIZE = sizeof(CommandHeader) + alignof(T) + sizeof(T) + alignof(CommandHeader);
+
+            // ヘッダのバイトサイズに収まらないペイロードは記録できません
+            if (payloadSize > U32_MAX - COMMAND_SIZE - COMMAND_PAYLOAD_ALIGNMENT) return EAllocateError::BAD_ALLOCATE;
+            Var requiredSize = COMMAND_SIZE + (payloadSize != 0 ? COMMAND_PAYLOAD_ALIGNMENT + payloadSize : 0);
+
+            Var pChunk = this->m_pTail;
+            if (pChunk == NONE || pChunk->capacity - pChunk->used < requiredSize)
+            {
+                Var chunkResult = this->PushChunk(requiredSize);
+                if (chunkResult.IsFailure()) return chunkResult.Error();
+                pChunk = chunkResult.Value();
+            }
+
+            Var headerAddress = Cast<USize>(pChunk->Data() + pChunk->used);
+            Var commandAddress = AlignUp(headerAddress + sizeof(CommandHeader), alignof(T));
+            Var payloadAddress = AlignUp(commandAddress + sizeof(T), COMMAND_PAYLOAD_ALIGNMENT);
+            Var endAddress = payloadSize != 0 ? payloadAddress + payloadSize : commandAddress + sizeof(T);
+            Var nextAddress = AlignUp(endAddress, alignof(CommandHeader));
+
+            Var pHeader = new(Cast<Void*>(headerAddress)) CommandHeader();
+            pHeader->typeIndex = static_cast<U32>(TypeIndexOf<T, Ts...>());
+            pHeader->size = static_cast<U32>(nextAddress - headerAddress);
+            pHeader->payloadSize = static_cast<U32>(payloadSize);
+            if (payloadSize != 0) std::memcpy(Cast<Void*>(payloadAddress), pPayload, payloadSize);
+            pChunk->used += pHeader->size;
+            this->m_commandsCount += 1;
+            return new(Cast<Void*>(commandAddress)) T(Forward<Args>(args)...);
+        }
+
+        // チャンクのリストを解放します
+        static Void FreeChunks(_Internal::_CommandChunk *pChunk) noexcept
+        {
+            while (pChunk != NONE)
+            {
+                Var pNext = pChunk->pNext;
+                Var headerSize = AlignUp(sizeof(_Internal::_CommandChunk), alignof(CommandHeader));
+                (Void)LeyEngine::Deallocate(headerSize + pChunk->capacity, pChunk);
+                pChunk = pNext;
+            }
+        }
+
+    public:
+
+        /// コンストラクタです。
+        CommandBuffer() noexcept
+            : m_pHead(NONE)
+            , m_pTail(NONE)
+            , m_pSpare(NONE)
+            , m_commandsCount(0)
+        {
+        }
+
+        CommandBuffer(const CommandBuffer<Ts...> &origin) = delete;
+        CommandBuffer<Ts...> &operator=(const CommandBuffer<Ts...> &origin) = delete;
+
+        /// ムーブします。
+        /// @param origin ムーブ元です。
+        CommandBuffer(CommandBuffer<Ts...> &&origin) noexcept
+            : m_pHead(origin.m_pHead)
+            , m_pTail(origin.m_pTail)
+            , m_pSpare(origin.m_pSpare)
+            , m_commandsCount(origin.m_commandsCount)
+        {
+            origin.m_pHead = NONE;
+            origin.m_pTail = NONE;
+            origin.m_pSpare = NONE;
+            origin.m_commandsCount = 0;
+        }
+
+        /// ムーブ代入します。
+        /// @param origin ムーブ元です。
+        /// @return 自身の参照です。
+        CommandBuffer<Ts...> &operator=(CommandBuffer<Ts...> &&origin) noexcept
+        {
+            if (this != &origin)
+            {
+                FreeChunks(this->m_pHead);
+                FreeChunks(this->m_pSpare);
+                this->m_pHead = origin.m_pHead;
+                this->m_pTail = origin.m_pTail;
+                this->m_pSpare = origin.m_pSpare;
+                this->m_commandsCount = origin.m_commandsCount;
+                origin.m_pHead = NONE;
+                origin.m_pTail = NONE;
+                origin.m_pSpare = NONE;
+                origin.m_commandsCount = 0;
+            }
+            return *this;
+        }
+
+        /// デストラクタです。
+        ~CommandBuffer() noexcept
+        {
+            FreeChunks(this->m_pHead);
+            FreeChunks(this->m_pSpare);
+        }
+
+        /// コマンドを記録します。
+        /// @tparam T コマンドの型です。Tsのどれかである必要があります。
+        /// @param args コマンドのコンストラクタ引数です。
+        /// @return 記録したコマンドのポインタ、または、エラーです。
+        template<typename T, typename...Args>
+        Result<T*, EAllocateError> Record(Args &&...args) noexcept
+        {
+            return this->Emplace<T>(NONE, 0, Forward<Args>(args)...);
+        }
+
+        /// コマンドを可変長のペイロードと共に記録します。
+        /// ペイロードはコマンドの直後にCOMMAND_PAYLOAD_ALIGNMENTで揃えてコピーし、ヘッダのバイトサイズに含めます。
+        /// Playbackではコマンドとペイロードを受け取れる関数にペイロードも渡します。
+        /// @tparam T コマンドの型です。Tsのどれかである必要があります。
+        /// @param payload コマンドの後にコピーするデータです。
+        /// @param args コマンドのコンストラクタ引数です。
+        /// @return 記録したコマンドのポインタ、または、エラーです。
+        template<typename T, typename...Args>
+        Result<T*, EAllocateError> Record(CommandPayload payload, Args &&...args) noexcept
+        {
+            return this->Emplace<T>(payload.pData, payload.size, Forward<Args>(args)...);
+        }
+
+        /// 他のバッファのコマンドを末尾に連結します。
+        /// チャンクを付け替えるのみで、コマンドのコピーは行いません。
+        /// @param other 連結するバッファです。連結後は空になります。
+        Void Append(CommandBuffer<Ts...> &&other) noexcept
+        {
+            if (this == &other) return;
+            if (other.m_pHead != NONE)
+            {
+                if (this->m_pTail != NONE)
+                {
+                    this->m_pTail->pNext = other.m_pHead;
+                }
+                else
+                {
+                    this->m_pHead = other.m_pHead;
+                }
+                this->m_pTail = other.m_pTail;
+                this->m_commandsCount += other.m_commandsCount;
+            }
+            if (other.m_pSpare != NONE)
+            {
+                Var pLast = other.m_pSpare;
+                while (pLast->pNext != NONE) pLast = pLast->pNext;
+                pLast->pNext = this->m_pSpare;
+                this->m_pSpare = other.m_pSpare;
+            }
+            other.m_pHead = NONE;
+            other.m_pTail = NONE;
+            other.m_pSpare = NONE;
+            other.m_commandsCount = 0;
+        }
+
+        /// 記録したコマンドを記録順に関数へ渡します。
+        /// 型毎の分岐はコンパイル時に生成した関数テーブルで行います。
+        /// 関数がコマンドのconst参照とCommandPayloadのconst参照を受け取れる場合は、ペイロードも渡します。
+        /// @param function すべてのコマンド型のconst参照を受け取れる関数です。
+        template<typename Fn>
+        Void Playback(Fn &&function) const
+        {
+            constexpr Void (*TABLE[])(const CommandHeader*, Fn&&) = { &_Internal::_PlayCommand<Ts, Fn>... };
+            for (Var pChunk = this->m_pHead; pChunk != NONE; pChunk = pChunk->pNext)
+            {
+                Var pPosition = pChunk->Data();
+                Var pEnd = pPosition + pChunk->used;
+                while (pPosition < pEnd)
+                {
+                    Var pHeader = std::launder(Cast<const CommandHeader*>(pPosition));
+                    TABLE[pHeader->typeIndex](pHeader, Forward<Fn>(function));
+                    pPosition += pHeader->size;
+                }
+            }
+        }
+
+        /// 記録したコマンドを破棄します。チャンクは解放せず再利用します。
+        Void Reset() noexcept
+        {
+            if (this->m_pTail != NONE)
+            {
+                this->m_pTail->pNext = this->m_pSpare;
+                this->m_pSpare = this->m_pHead;
+            }
+            this->m_pHead = NONE;
+            this->m_pTail = NONE;
+            this->m_commandsCount = 0;
+        }
+
+        /// 記録したコマンド数を返します。
+        /// @return コマンド数です。
+        USize Count() const noexcept
+        {
+            return this->m_commandsCount;
+        }
+
+        /// コマンドが記録されていないか判定します。
+        /// @retval true 記録されていません。
+        /// @retval false 記録されています。
+        Bool IsEmpty() const noexcept
+        {
+            return this->m_commandsCount == 0;
+        }
+    };
+}
+
+#endif // !_LEYENGINE_COMMANDBUFFER_HPP
\ No newline at end of file
@@ -0,0 +1,147 @@
+/// @file LeyEngine/Compression.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// データの圧縮、展開を提供します。
+#ifndef _LEYENGINE_COMPRESSION_HPP
+#define _LEYENGINE_COMPRESSION_HPP
+
+#include <cstring>
+#include <type_traits>
+#include "LeyEngine/Utility.hpp"
+#include "LeyEngine/Collections/Array.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// 圧縮、展開のエラーです。
+    enum class ECompressionError
+    {
+        /// 出力先のバッファが不足しました。
+        BUFFER_TOO_SMALL,
+        /// 圧縮データが壊れていました。
+        CORRUPTED,
+        /// メモリの確保に失敗しました。
+        BAD_ALLOCATE,
+    };
+
+    /// LZ4ブロック形式で圧縮した場合の最大のバイトサイズを返します。
+    /// @param size 圧縮するバイトサイズです。
+    /// @return 圧縮後の最大のバイトサイズです。
+    constexpr USize Lz4CompressBound(USize size) noexcept
+    {
+        return size + size / 255 + 16;
+    }
+
+    /// LZ4ブロック形式で圧縮します。
+    /// 出力はLZ4の標準のデコーダで展開できます。
+    /// @param pSource 圧縮するデータです。
+    /// @param sourceSize 圧縮するバイトサイズです。
+    /// @param pDestination 出力先のバッファです。
+    /// @param destinationSize 出力先のバッファのバイトサイズです。
+    /// @return 圧縮後のバイトサイズ、または、エラーです。
+    Result<USize, ECompressionError> Lz4Compress(const Void *pSource, USize sourceSize, Void *pDestination, USize destinationSize) noexcept;
+
+    /// LZ4ブロック形式のデータを展開します。
+    /// 壊れたデータを与えても出力先のバッファの範囲外にはアクセスしません。
+    /// @param pSource 圧縮データです。
+    /// @param sourceSize 圧縮データのバイトサイズです。
+    /// @param pDestination 出力先のバッファです。
+    /// @param destinationSize 出力先のバッファのバイトサイズです。
+    /// @return 展開後のバイトサイズ、または、エラーです。
+    Result<USize, ECompressionError> Lz4Decompress(const Void *pSource, USize sourceSize, Void *pDestination, USize destinationSize) noexcept;
+
+    /// 差分の出力先に必要な最大のバイトサイズを返します。
+    /// @param targetSize 変更後のバイトサイズです。
+    /// @return 差分の最大のバイトサイズです。
+    constexpr USize DeltaEncodeBound(USize targetSize) noexcept
+    {
+        return targetSize + targetSize / 2 + 32;
+    }
+
+    /// 変更前と変更後のバイト列の差分を作成します。
+    /// バイト列を比較の単位毎に比較し、変更された単位の連続を、ビット単位に詰めた読み飛ばす単位数と変更された単位数、変更前との排他的論理和の組で表します。
+    /// 変更前より長い部分は変更前を0とみなします。
+    /// @param pBase 変更前のデータです。
+    /// @param baseSize 変更前のバイトサイズです。
+    /// @param pTarget 変更後のデータです。
+    /// @param targetSize 変更後のバイトサイズです。
+    /// @param unitSize 比較の単位のバイトサイズです。1でバイト単位、フィールドのサイズでフィールド単位に比較します。
+    /// @param pDestination 出力先のバッファです。
+    /// @param destinationSize 出力先のバッファのバイトサイズです。
+    /// @return 差分のバイトサイズ、または、エラーです。
+    Result<USize, ECompressionError> DeltaEncode(const Void *pBase, USize baseSize, const Void *pTarget, USize targetSize, USize unitSize, Void *pDestination, USize destinationSize) noexcept;
+
+    /// 差分が表す変更後のバイトサイズを返します。
+    /// @param pDelta 差分です。
+    /// @param deltaSize 差分のバイトサイズです。
+    /// @return 変更後のバイトサイズ、または、エラーです。
+    Result<USize, ECompressionError> DeltaTargetSize(const Void *pDelta, USize deltaSize) noexcept;
+
+    /// 変更前のデータに差分を適用し、変更後のデータにします。
+    /// データは変更後のバイトサイズ以上で、変更前のバイトサイズを超える部分は0で埋まっている必要があります。
+    /// 壊れた差分を与えてもデータの範囲外にはアクセスしませんが、データの内容は不定になります。
+    /// @param pDelta 差分です。
+    /// @param deltaSize 差分のバイトサイズです。
+    /// @param pData 変更前のデータです。
+    /// @param dataSize データのバイトサイズです。
+    /// @return 変更後のバイトサイズ、または、エラーです。
+    Result<USize, ECompressionError> DeltaApply(const Void *pDelta, USize deltaSize, Void *pData, USize dataSize) noexcept;
+
+    /// 2つの配列の差分を作成します。
+    /// ネットワークでの複製などで、前回送った配列から変更された部分のみを送るために使用します。
+    /// @tparam T 要素型です。トリビアルにコピーできる必要があります。
+    /// @tparam A 要素アロケータです。
+    /// @tparam B 差分のアロケータです。
+    /// @param base 変更前の配列です。
+    /// @param target 変更後の配列です。
+    /// @param delta 差分の出力先です。内容は置き換えます。
+    /// @param unitSize 比較の単位のバイトサイズです。既定では要素のアライメント、多くの場合はフィールド単位で比較します。
+    /// @return SUCCESS、または、エラーです。
+    template<typename T, typename A, typename B>
+    Result<Success, ECompressionError> DeltaEncode(const Array<T, A> &base, const Array<T, A> &target, Array<U8, B> &delta, USize unitSize = alignof(T)) noexcept
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "The element type is not trivially copyable.");
+        Var bound = DeltaEncodeBound(target.Count() * sizeof(T));
+        if (delta.Resize(bound).IsFailure()) return ECompressionError::BAD_ALLOCATE;
+        Var result = DeltaEncode(base.Data(), base.Count() * sizeof(T), target.Data(), target.Count() * sizeof(T), unitSize, delta.Data(), bound);
+        if (result.IsFailure()) return result.Error();
+        (Void)delta.Resize(result.Value());
+        return SUCCESS;
+    }
+
+    /// 配列に差分を適用し、変更後の配列にします。
+    /// 失敗した場合の配列の内容は不定です。
+    /// @tparam T 要素型です。トリビアルにコピーできる必要があります。
+    /// @tparam A 要素アロケータです。
+    /// @tparam B 差分のアロケータです。
+    /// @param delta 差分です。
+    /// @param data 変更前の配列です。
+    /// @return SUCCESS、または、エラーです。
+    template<typename T, typename A, typename B>
+    Result<Success, ECompressionError> DeltaApply(const Array<U8, B> &delta, Array<T, A> &data) noexcept
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "The element type is not trivially copyable.");
+        Var sizeResult = DeltaTargetSize(delta.Data(), delta.Count());
+        if (sizeResult.IsFailure()) return sizeResult.Error();
+        Var targetSize = sizeResult.Value();
+        if (targetSize % sizeof(T) != 0) return ECompressionError::CORRUPTED;
+        // 変更前より長い部分は0とみなします
+        Var baseCount = data.Count();
+        if (data.Resize(targetSize / sizeof(T)).IsFailure()) return ECompressionError::BAD_ALLOCATE;
+        if (data.Count() > baseCount) std::memset(Cast<Void*>(data.Data() + baseCount), 0, (data.Count() - baseCount) * sizeof(T));
+        Var result = DeltaApply(delta.Data(), delta.Count(), data.Data(), targetSize);
+        if (result.IsFailure()) return result.Error();
+        return SUCCESS;
+    }
+
+#ifdef LEYENGINE_TEST
+    /// 差分を作成して適用し、変更後のデータに戻るかを検証します。
+    /// 変更前と変更後のバイトサイズ、比較の単位、変更の密度を変えた組み合わせと、配列の差分を確かめます。
+    /// 壊れた差分を適用しても範囲外にアクセスしないことも、サニタイザと組み合わせて確かめます。
+    /// @retval true すべての組み合わせで一致しました。
+    /// @retval false 一致しない組み合わせがありました。
+    Bool TestDeltaRoundTrip() noexcept;
+#endif
+}
+
+#endif // !_LEYENGINE_COMPRESSION_HPP
\ No newline at end of file
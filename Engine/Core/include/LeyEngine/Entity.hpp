@@ -0,0 +1,642 @@
+/// @file LeyEngine/Entity.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// アーキタイプ毎のチャンクにコンポーネントを格納するエンティティシステムを提供します。
+#ifndef _LEYENGINE_ENTITY_HPP
+#define _LEYENGINE_ENTITY_HPP
+
+#include <cstring>
+#include <tuple>
+#include "LeyEngine/BitmapPool.hpp"
+#include "LeyEngine/Job.hpp"
+#include "LeyEngine/TypeId.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// エンティティシステムのエラーです。
+    enum class EEntityError
+    {
+        /// メモリ確保に失敗しました。
+        BAD_ALLOCATE,
+        /// 登録できるコンポーネントの種類の上限を超えました。
+        TOO_MANY_COMPONENTS,
+        /// アーキタイプの1エンティティ分がチャンクに収まりませんでした。
+        TOO_LARGE,
+        /// エンティティ、または、コンポーネントが見つかりませんでした。
+        NOT_FOUND,
+    };
+
+    /// チャンクのバイトサイズです。
+    constexpr USize ENTITY_CHUNK_SIZE = 16 * 1024;
+
+    /// 1つのワールドに登録できるコンポーネントの種類の上限です。
+    constexpr USize MAX_COMPONENT_COUNT = 128;
+
+    /// エンティティです。
+    /// 破棄したエンティティの位置は再利用し、世代で区別します。
+    struct Entity
+    {
+        /// ワールド内の位置です。
+        U32 index;
+        /// 世代です。0は無効なエンティティです。
+        U32 generation;
+
+        /// 無効なエンティティかを返します。
+        /// @retval true 無効です。
+        /// @retval false 有効な可能性があります。
+        constexpr Bool IsNone() const noexcept
+        {
+            return this->generation == 0;
+        }
+
+        /// エンティティが同等か比較します。
+        /// @param other 比較対象です。
+        /// @return 同等の場合、真です。
+        constexpr Bool operator==(const Entity &other) const noexcept
+        {
+            return this->index == other.index && this->generation == other.generation;
+        }
+
+        /// エンティティが不等か比較します。
+        /// @param other 比較対象です。
+        /// @return 不等の場合、真です。
+        constexpr Bool operator!=(const Entity &other) const noexcept
+        {
+            return !(*this == other);
+        }
+    };
+
+    /// ワールド内のコンポーネントの種類の番号です。
+    using ComponentId = U32;
+
+    /// コンポーネントの種類の集合です。
+    struct ComponentMask
+    {
+        /// 語数です。
+        static constexpr USize WORDS_COUNT = MAX_COMPONENT_COUNT / 64;
+
+        /// 種類毎のビットです。
+        U64 words[WORDS_COUNT];
+
+        /// 空の集合を作成します。
+        constexpr ComponentMask() noexcept
+            : words()
+        {
+        }
+
+        /// 種類を追加します。
+        /// @param id 種類の番号です。
+        Void Set(ComponentId id) noexcept
+        {
+            this->words[id / 64] |= U64(1) << (id % 64);
+        }
+
+        /// 種類を取り除きます。
+        /// @param id 種類の番号です。
+        Void Reset(ComponentId id) noexcept
+        {
+            this->words[id / 64] &= ~(U64(1) << (id % 64));
+        }
+
+        /// 種類を含むかを返します。
+        /// @param id 種類の番号です。
+        /// @retval true 含みます。
+        /// @retval false 含みません。
+        Bool Test(ComponentId id) const noexcept
+        {
+            return (this->words[id / 64] >> (id % 64)) & 1;
+        }
+
+        /// 他の集合をすべて含むかを返します。
+        /// @param other 他の集合です。
+        /// @retval true すべて含みます。
+        /// @retval false 含まない種類があります。
+        Bool ContainsAll(const ComponentMask &other) const noexcept
+        {
+            for (USize i = 0; i < WORDS_COUNT; i++)
+            {
+                if ((this->words[i] & other.words[i]) != other.words[i]) return NO;
+            }
+            return YES;
+        }
+
+        /// 他の集合と共通する種類があるかを返します。
+        /// @param other 他の集合です。
+        /// @retval true 共通する種類があります。
+        /// @retval false 共通する種類はありません。
+        Bool Intersects(const ComponentMask &other) const noexcept
+        {
+            for (USize i = 0; i < WORDS_COUNT; i++)
+            {
+                if ((this->words[i] & other.words[i]) != 0) return YES;
+            }
+            return NO;
+        }
+
+        /// 集合が同等か比較します。
+        /// @param other 比較対象です。
+        /// @return 同等の場合、真です。
+        Bool operator==(const ComponentMask &other) const noexcept
+        {
+            for (USize i = 0; i < WORDS_COUNT; i++)
+            {
+                if (this->words[i] != other.words[i]) return NO;
+            }
+            return YES;
+        }
+
+        /// 集合が不等か比較します。
+        /// @param other 比較対象です。
+        /// @return 不等の場合、真です。
+        Bool operator!=(const ComponentMask &other) const noexcept
+        {
+            return !(*this == other);
+        }
+    };
+
+    /// コンポーネントの種類の情報です。
+    struct ComponentInfo
+    {
+        /// 型の識別子です。
+        TypeId typeId;
+        /// バイトサイズです。
+        U32 size;
+        /// アライメントです。
+        U32 alignment;
+    };
+
+    /// チャンクのメモリです。
+    struct EntityChunkMemory
+    {
+        /// データです。
+        alignas(std::max_align_t) U8 bytes[ENTITY_CHUNK_SIZE];
+    };
+
+    struct EntityArchetype;
+
+    /// 同じアーキタイプのエンティティを格納するチャンクのヘッダです。
+    /// ヘッダの後にエンティティの配列、コンポーネント毎の配列が続きます。
+    struct EntityChunk
+    {
+        /// アーキタイプです。
+        EntityArchetype *pArchetype;
+        /// 格納しているエンティティの数です。
+        U32 count;
+        /// アーキタイプのチャンク配列内の位置です。
+        U32 index;
+    };
+
+    /// アーキタイプ内のコンポーネントの配列です。
+    struct EntityColumn
+    {
+        /// 種類の番号です。
+        ComponentId id;
+        /// チャンク先頭からのバイトオフセットです。
+        U32 offset;
+        /// 要素のバイトサイズです。
+        U32 size;
+    };
+
+    /// 同じコンポーネントの組み合わせを持つエンティティの集まりです。
+    /// 最後のチャンク以外は常に満杯になるよう詰めて格納します。
+    struct EntityArchetype
+    {
+        /// 列を持たないことを表す位置です。
+        static constexpr U16 NO_COLUMN = 0xFFFF;
+
+        /// コンポーネントの種類の集合です。
+        ComponentMask mask;
+        /// 種類の番号から列の位置を引く表です。
+        U16 columnOf[MAX_COMPONENT_COUNT];
+        /// 列です。
+        EntityColumn *pColumns;
+        /// 列の数です。
+        U32 columnCount;
+        /// チャンクあたりのエンティティの数です。
+        U32 capacity;
+        /// エンティティの配列のチャンク先頭からのバイトオフセットです。
+        U32 entitiesOffset;
+        /// チャンクの配列です。
+        EntityChunk **ppChunks;
+        /// チャンクの数です。
+        USize chunkCount;
+        /// チャンクの配列長です。
+        USize chunkCapacity;
+        /// エンティティの数です。
+        USize entityCount;
+
+        /// チャンク内のエンティティの配列を返します。
+        /// @param pChunk チャンクです。
+        /// @return エンティティの配列です。
+        Entity *EntitiesOf(EntityChunk *pChunk) const noexcept
+        {
+            return Cast<Entity*>(Cast<U8*>(pChunk) + this->entitiesOffset);
+        }
+
+        /// チャンク内のコンポーネントの配列を返します。
+        /// @param pChunk チャンクです。
+        /// @param id 種類の番号です。
+        /// @return コンポーネントの配列、または、持たない場合はNONEです。
+        U8 *ColumnOf(EntityChunk *pChunk, ComponentId id) const noexcept
+        {
+            Var column = this->columnOf[id];
+            if (column == NO_COLUMN) return NONE;
+            return Cast<U8*>(pChunk) + this->pColumns[column].offset;
+        }
+    };
+
+    /// エンティティとコンポーネントを管理するワールドです。
+    /// コンポーネントは自明にコピー、破棄できる型である必要があり、チャンク間の移動はmemcpyで行います。
+    /// 複数スレッドから同時に構造を変更することはできません。
+    struct EntityWorld
+    {
+    private:
+
+        // エンティティの格納位置です。
+        struct Record
+        {
+            EntityArchetype *pArchetype;    // アーキタイプ、破棄済みの場合はNONE
+            EntityChunk *pChunk;            // チャンク
+            U32 row;                        // チャンク内の位置、破棄済みの場合は次の空き位置
+            U32 generation;                 // 世代
+        };
+
+        // 型の識別子から種類の番号を引く表の項目です。
+        struct ComponentSlot
+        {
+            U64 typeHash;   // 型の識別子のハッシュ値
+            U32 idPlusOne;  // 種類の番号+1、0は空
+        };
+
+        // 型の識別子から種類の番号を引く表のスロット数です。
+        static constexpr USize COMPONENT_SLOT_COUNT = MAX_COMPONENT_COUNT * 2;
+
+        BitmapPool<EntityChunkMemory, 64> m_chunkPool;          // チャンクのプール
+        ComponentInfo m_components[MAX_COMPONENT_COUNT];        // 種類の情報
+        ComponentSlot m_componentSlots[COMPONENT_SLOT_COUNT];   // 型の識別子から種類の番号を引く表
+        U32 m_componentCount;                                   // 種類の数
+        EntityArchetype **m_ppArchetypes;                       // アーキタイプの配列、追加のみで削除しません
+        USize m_archetypeCount;                                 // アーキタイプの数
+        USize m_archetypeCapacity;                              // アーキタイプの配列長
+        Record *m_pRecords;                                     // エンティティの格納位置
+        USize m_recordCount;                                    // 格納位置の数
+        USize m_recordCapacity;                                 // 格納位置の配列長
+        U32 m_freeRecord;                                       // 空きの格納位置の先頭、無い場合はU32_MAX
+        USize m_entityCount;                                    // エンティティの数
+
+        // 種類の集合に一致するアーキタイプを返し、無ければ作成します。
+        Result<EntityArchetype*, EEntityError> FindOrCreateArchetype(const ComponentMask &mask) noexcept;
+
+        // アーキタイプの末尾にエンティティの行を追加します。
+        Result<Success, EEntityError> AppendRow(EntityArchetype *pArchetype, Entity entity, EntityChunk **ppChunk, U32 *pRow) noexcept;
+
+        // 行を取り除き、最後の行で埋めます。
+        Void RemoveRow(EntityArchetype *pArchetype, EntityChunk *pChunk, U32 row) noexcept;
+
+        // 有効なエンティティの格納位置を返します。
+        Record *FindRecord(Entity entity) const noexcept;
+
+        // エンティティを別のアーキタイプへ移動します。
+        Result<Success, EEntityError> MoveEntity(Record &record, const ComponentMask &mask) noexcept;
+
+    public:
+
+        /// 空のワールドを作成します。
+        EntityWorld() noexcept;
+
+        EntityWorld(const EntityWorld&) = delete;
+        EntityWorld &operator=(const EntityWorld&) = delete;
+
+        /// デストラクタです。
+        ~EntityWorld() noexcept;
+
+        /// コンポーネントの種類を登録します。登録済みの場合は登録済みの番号を返します。
+        /// @param info 種類の情報です。
+        /// @return 種類の番号、または、エラーです。
+        Result<ComponentId, EEntityError> RegisterComponent(const ComponentInfo &info) noexcept;
+
+        /// コンポーネントの種類を登録します。登録済みの場合は登録済みの番号を返します。
+        /// @tparam T コンポーネントの型です。
+        /// @return 種類の番号、または、エラーです。
+        template<typename T>
+        Result<ComponentId, EEntityError> RegisterComponent() noexcept
+        {
+            static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Components must be trivially copyable and destructible.");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned components are not supported.");
+            return this->RegisterComponent(ComponentInfo{ TypeIdOf<T>(), static_cast<U32>(sizeof(T)), static_cast<U32>(alignof(T)) });
+        }
+
+        /// 登録済みのコンポーネントの種類の番号を返します。
+        /// @param typeId 型の識別子です。
+        /// @return 種類の番号、または、登録されていない場合のエラーです。
+        Result<ComponentId, EEntityError> FindComponent(TypeId typeId) const noexcept;
+
+        /// コンポーネントの種類の情報を返します。
+        /// @param id 種類の番号です。
+        /// @return 種類の情報です。
+        const ComponentInfo &ComponentInfoOf(ComponentId id) const noexcept
+        {
+            return this->m_components[id];
+        }
+
+        /// コンポーネントの集合を指定してエンティティを作成します。
+        /// コンポーネントの値は0で初期化します。
+        /// @param mask コンポーネントの種類の集合です。
+        /// @return エンティティ、または、エラーです。
+        Result<Entity, EEntityError> CreateEntity(const ComponentMask &mask) noexcept;
+
+        /// コンポーネントの値を指定してエンティティを作成します。
+        /// @tparam Ts コンポーネントの型です。
+        /// @param components コンポーネントの値です。
+        /// @return エンティティ、または、エラーです。
+        template<typename...Ts>
+        Result<Entity, EEntityError> CreateEntity(const Ts &...components) noexcept
+        {
+            ComponentId ids[sizeof...(Ts) + 1] = {};
+            USize i = 0;
+            Bool isRegistered = YES;
+            ((isRegistered = isRegistered && this->RegisterTo<Ts>(ids[i++])), ...);
+            if (!isRegistered) return EEntityError::TOO_MANY_COMPONENTS;
+            ComponentMask mask;
+            for (i = 0; i < sizeof...(Ts); i++) mask.Set(ids[i]);
+            Var result = this->CreateEntity(mask);
+            if (result.IsFailure()) return result;
+            Var &record = this->m_pRecords[result.Value().index];
+            i = 0;
+            ((std::memcpy(record.pArchetype->ColumnOf(record.pChunk, ids[i++]) + sizeof(Ts) * record.row, &components, sizeof(Ts))), ...);
+            return result;
+        }
+
+        /// エンティティを破棄します。
+        /// @param entity エンティティです。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, EEntityError> DestroyEntity(Entity entity) noexcept;
+
+        /// エンティティが有効かを返します。
+        /// @param entity エンティティです。
+        /// @retval true 有効です。
+        /// @retval false 破棄済み、または、無効です。
+        Bool IsAlive(Entity entity) const noexcept
+        {
+            return this->FindRecord(entity) != NONE;
+        }
+
+        /// エンティティのコンポーネントを返します。
+        /// チャンク内を指すため、構造を変更すると無効になります。
+        /// @param entity エンティティです。
+        /// @param id 種類の番号です。
+        /// @return コンポーネント、または、持たない場合はNONEです。
+        Void *GetComponent(Entity entity, ComponentId id) const noexcept;
+
+        /// エンティティのコンポーネントを返します。
+        /// チャンク内を指すため、構造を変更すると無効になります。
+        /// @tparam T コンポーネントの型です。
+        /// @param entity エンティティです。
+        /// @return コンポーネント、または、持たない場合はNONEです。
+        template<typename T>
+        T *GetComponent(Entity entity) const noexcept
+        {
+            Var id = this->FindComponent(TypeIdOf<T>());
+            if (id.IsFailure()) return NONE;
+            return Cast<T*>(this->GetComponent(entity, id.Value()));
+        }
+
+        /// エンティティにコンポーネントを追加します。持っている場合は値を上書きします。
+        /// 追加したコンポーネントの値は0で初期化します。
+        /// @param entity エンティティです。
+        /// @param id 種類の番号です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, EEntityError> AddComponent(Entity entity, ComponentId id) noexcept;
+
+        /// エンティティにコンポーネントを追加します。持っている場合は値を上書きします。
+        /// @tparam T コンポーネントの型です。
+        /// @param entity エンティティです。
+        /// @param component コンポーネントの値です。
+        /// @return SUCCESS、または、エラーです。
+        template<typename T>
+        Result<Success, EEntityError> AddComponent(Entity entity, const T &component) noexcept
+        {
+            ComponentId id;
+            if (!this->RegisterTo<T>(id)) return EEntityError::TOO_MANY_COMPONENTS;
+            Var result = this->AddComponent(entity, id);
+            if (result.IsFailure()) return result;
+            std::memcpy(this->GetComponent(entity, id), &component, sizeof(T));
+            return SUCCESS;
+        }
+
+        /// エンティティからコンポーネントを取り除きます。
+        /// @param entity エンティティです。
+        /// @param id 種類の番号です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, EEntityError> RemoveComponent(Entity entity, ComponentId id) noexcept;
+
+        /// エンティティからコンポーネントを取り除きます。
+        /// @tparam T コンポーネントの型です。
+        /// @param entity エンティティです。
+        /// @return SUCCESS、または、エラーです。
+        template<typename T>
+        Result<Success, EEntityError> RemoveComponent(Entity entity) noexcept
+        {
+            Var id = this->FindComponent(TypeIdOf<T>());
+            if (id.IsFailure()) return id.Error();
+            return this->RemoveComponent(entity, id.Value());
+        }
+
+        /// エンティティの数を返します。
+        /// @return エンティティの数です。
+        USize EntityCount() const noexcept
+        {
+            return this->m_entityCount;
+        }
+
+        /// アーキタイプの数を返します。
+        /// アーキタイプは追加のみで削除しないため、クエリは前回以降に追加された分だけを確認します。
+        /// @return アーキタイプの数です。
+        USize ArchetypeCount() const noexcept
+        {
+            return this->m_archetypeCount;
+        }
+
+        /// アーキタイプを返します。
+        /// @param index アーキタイプの位置です。
+        /// @return アーキタイプです。
+        EntityArchetype *ArchetypeAt(USize index) const noexcept
+        {
+            return this->m_ppArchetypes[index];
+        }
+
+    private:
+
+        // 型を登録して番号を受け取ります。
+        template<typename T>
+        Bool RegisterTo(ComponentId &id) noexcept
+        {
+            Var result = this->RegisterComponent<T>();
+            if (result.IsFailure()) return NO;
+            id = result.Value();
+            return YES;
+        }
+    };
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// クエリの型に依存しない部分です。
+        /// 一致したアーキタイプを保持し、ワールドに追加されたアーキタイプだけを追加で照合します。
+        struct _EntityQueryBase
+        {
+            EntityWorld *pWorld;                // ワールド
+            ComponentMask include;              // 持つ必要がある種類
+            ComponentMask exclude;              // 持ってはいけない種類
+            EntityArchetype **ppArchetypes;     // 一致したアーキタイプ
+            USize archetypeCount;               // 一致したアーキタイプの数
+            USize archetypeCapacity;            // 一致したアーキタイプの配列長
+            USize checkedCount;                 // 照合済みのワールドのアーキタイプの数
+            EntityChunk **ppChunks;             // 並列実行するチャンク
+            USize chunkCapacity;                // 並列実行するチャンクの配列長
+
+            _EntityQueryBase(EntityWorld *pWorld) noexcept;
+
+            _EntityQueryBase(_EntityQueryBase &&origin) noexcept;
+
+            ~_EntityQueryBase() noexcept;
+
+            /// ワールドに追加されたアーキタイプを照合します。
+            Void Update() noexcept;
+
+            /// 一致したアーキタイプのチャンクを集めます。
+            /// @return チャンクの数です。確保に失敗した場合は0です。
+            USize CollectChunks() noexcept;
+        };
+    }
+    /// @endcond
+
+    /// 指定のコンポーネントを持つエンティティを列挙するクエリです。
+    /// 一致したアーキタイプを保持するため、毎フレーム作り直さずに使い回します。
+    /// @tparam Ts 持つ必要があるコンポーネントの型です。
+    template<typename...Ts>
+    struct EntityQuery
+    {
+        static_assert(sizeof...(Ts) > 0, "EntityQuery requires at least one component.");
+
+    private:
+
+        _Internal::_EntityQueryBase m_base; // 型に依存しない部分
+        ComponentId m_ids[sizeof...(Ts)];   // 種類の番号
+
+        // 作成します。
+        EntityQuery(EntityWorld *pWorld) noexcept
+            : m_base(pWorld)
+            , m_ids()
+        {
+        }
+
+        // チャンク内のエンティティを関数に渡します。
+        template<typename Fn, USize...Is>
+        Void RunChunk(EntityArchetype *pArchetype, EntityChunk *pChunk, Fn &function, std::index_sequence<Is...>) const
+        {
+            Var pEntities = pArchetype->EntitiesOf(pChunk);
+            Var columns = std::make_tuple(Cast<Ts*>(pArchetype->ColumnOf(pChunk, this->m_ids[Is]))...);
+            Var count = pChunk->count;
+            for (U32 row = 0; row < count; row++)
+            {
+                function(pEntities[row], std::get<Is>(columns)[row]...);
+            }
+        }
+
+    public:
+
+        /// クエリを作成します。コンポーネントが未登録の場合は登録します。
+        /// @param world ワールドです。クエリより長く存在する必要があります。
+        /// @return クエリ、または、エラーです。
+        static Result<EntityQuery<Ts...>, EEntityError> Create(EntityWorld &world) noexcept
+        {
+            EntityQuery<Ts...> query(&world);
+            USize i = 0;
+            Bool isRegistered = YES;
+            ((isRegistered = isRegistered && world.RegisterComponent<Ts>().Map([&](ComponentId id) noexcept
+            {
+                query.m_ids[i++] = id;
+                return id;
+            }).IsSuccess()), ...);
+            if (!isRegistered) return EEntityError::TOO_MANY_COMPONENTS;
+            for (i = 0; i < sizeof...(Ts); i++) query.m_base.include.Set(query.m_ids[i]);
+            return Move(query);
+        }
+
+        EntityQuery(const EntityQuery&) = delete;
+        EntityQuery &operator=(const EntityQuery&) = delete;
+
+        /// ムーブします。
+        /// @param origin ムーブ元です。
+        EntityQuery(EntityQuery<Ts...> &&origin) noexcept
+            : m_base(Move(origin.m_base))
+        {
+            for (USize i = 0; i < sizeof...(Ts); i++) this->m_ids[i] = origin.m_ids[i];
+        }
+
+        /// 持ってはいけないコンポーネントを追加します。
+        /// 照合済みのアーキタイプは照合し直します。
+        /// @tparam T コンポーネントの型です。
+        /// @return SUCCESS、または、エラーです。
+        template<typename T>
+        Result<Success, EEntityError> Exclude() noexcept
+        {
+            Var result = this->m_base.pWorld->template RegisterComponent<T>();
+            if (result.IsFailure()) return result.Error();
+            this->m_base.exclude.Set(result.Value());
+            this->m_base.archetypeCount = 0;
+            this->m_base.checkedCount = 0;
+            return SUCCESS;
+        }
+
+        /// 一致するエンティティの数を返します。
+        /// @return エンティティの数です。
+        USize Count() noexcept
+        {
+            this->m_base.Update();
+            USize count = 0;
+            for (USize i = 0; i < this->m_base.archetypeCount; i++) count += this->m_base.ppArchetypes[i]->entityCount;
+            return count;
+        }
+
+        /// 一致するエンティティを呼び出したスレッドで関数に渡します。
+        /// 列挙中に構造を変更してはいけません。
+        /// @param function Void(Entity, Ts&...)を呼び出せる関数です。
+        template<typename Fn>
+        Void ForEach(Fn &&function) noexcept
+        {
+            this->m_base.Update();
+            for (USize a = 0; a < this->m_base.archetypeCount; a++)
+            {
+                Var pArchetype = this->m_base.ppArchetypes[a];
+                for (USize c = 0; c < pArchetype->chunkCount; c++)
+                {
+                    this->RunChunk(pArchetype, pArchetype->ppChunks[c], function, std::index_sequence_for<Ts...>());
+                }
+            }
+        }
+
+        /// 一致するエンティティをチャンク単位でジョブに分け、ワーカースレッドで並列に関数へ渡します。
+        /// 完了まで待機します。ジョブを実行できない場合は呼び出したスレッドで実行します。
+        /// 列挙中に構造を変更してはいけません。
+        /// @param function Void(Entity, Ts&...)を呼び出せる関数です。複数スレッドから同時に呼び出します。
+        /// @param chunksPerJob 1つのジョブで処理するチャンクの数です。
+        template<typename Fn>
+        Void ParallelForEach(Fn &&function, USize chunksPerJob = 1) noexcept
+        {
+            this->m_base.Update();
+            Var chunkCount = this->m_base.CollectChunks();
+            Var result = ParallelFor(chunkCount, chunksPerJob == 0 ? 1 : chunksPerJob, [this, &function](USize index)
+            {
+                Var pChunk = this->m_base.ppChunks[index];
+                this->RunChunk(pChunk->pArchetype, pChunk, function, std::index_sequence_for<Ts...>());
+            });
+            if (chunkCount == 0 || result.IsFailure()) this->ForEach(function);
+        }
+    };
+}
+
+#endif // !_LEYENGINE_ENTITY_HPP
\ No newline at end of file
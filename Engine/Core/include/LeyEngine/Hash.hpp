@@ -0,0 +1,604 @@
+/// @file LeyEngine/Hash.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// ハッシュ関数とチェックサムを提供します。
+#ifndef _LEYENGINE_HASH_HPP
+#define _LEYENGINE_HASH_HPP
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include "LeyEngine/Primitive.hpp"
+#if defined(__SSE4_2__) || defined(__AVX__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        constexpr U64 _XXH64_PRIME1 = 0x9E3779B185EBCA87ULL;
+        constexpr U64 _XXH64_PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+        constexpr U64 _XXH64_PRIME3 = 0x165667B19E3779F9ULL;
+        constexpr U64 _XXH64_PRIME4 = 0x85EBCA77C2B2AE63ULL;
+        constexpr U64 _XXH64_PRIME5 = 0x27D4EB2F165667C5ULL;
+
+        /// 左に回転します。
+        constexpr U64 _RotateLeft64(U64 value, U32 shift) noexcept
+        {
+            return (value << shift) | (value >> (64 - shift));
+        }
+
+        /// リトルエンディアンで読み込みます。
+        /// 定数式で評価できるよう1バイトずつ読み込みます。
+        template<typename C>
+        constexpr U64 _ReadLittle(const C *pData, USize size) noexcept
+        {
+            U64 value = 0;
+            for (USize i = 0; i < size; i++)
+            {
+                value |= static_cast<U64>(static_cast<U8>(pData[i])) << (i * 8);
+            }
+            return value;
+        }
+
+        /// XXH64の1ラウンドです。
+        constexpr U64 _Xxh64Round(U64 accumulator, U64 input) noexcept
+        {
+            return _RotateLeft64(accumulator + input * _XXH64_PRIME2, 31) * _XXH64_PRIME1;
+        }
+
+        /// XXH64の累積値を合成します。
+        constexpr U64 _Xxh64Merge(U64 accumulator, U64 value) noexcept
+        {
+            return (accumulator ^ _Xxh64Round(0, value)) * _XXH64_PRIME1 + _XXH64_PRIME4;
+        }
+    }
+    /// @endcond
+
+    /// FNV-1aの32ビットハッシュ値を求めます。
+    /// @tparam C 要素の型です。1バイトの型である必要があります。
+    /// @param pData データの先頭です。
+    /// @param size データのバイトサイズです。
+    /// @return ハッシュ値です。
+    template<typename C>
+    constexpr U32 HashFnv1a32(const C *pData, USize size) noexcept
+    {
+        static_assert(sizeof(C) == 1, "The element must be a single byte.");
+        U32 hash = 2166136261U;
+        for (USize i = 0; i < size; i++)
+        {
+            hash ^= static_cast<U8>(pData[i]);
+            hash *= 16777619U;
+        }
+        return hash;
+    }
+
+    /// 文字列リテラルのFNV-1aの32ビットハッシュ値を求めます。終端文字は含めません。
+    /// @tparam C 文字の型です。
+    /// @tparam N 終端文字を含む文字数です。
+    /// @param literal TXTで記述した文字列リテラルです。
+    /// @return ハッシュ値です。
+    template<typename C, USize N>
+    constexpr U32 HashFnv1a32(const C (&literal)[N]) noexcept
+    {
+        return HashFnv1a32(literal, N - 1);
+    }
+
+    /// FNV-1aの64ビットハッシュ値を求めます。
+    /// @tparam C 要素の型です。1バイトの型である必要があります。
+    /// @param pData データの先頭です。
+    /// @param size データのバイトサイズです。
+    /// @return ハッシュ値です。
+    template<typename C>
+    constexpr U64 HashFnv1a64(const C *pData, USize size) noexcept
+    {
+        static_assert(sizeof(C) == 1, "The element must be a single byte.");
+        U64 hash = 14695981039346656037ULL;
+        for (USize i = 0; i < size; i++)
+        {
+            hash ^= static_cast<U8>(pData[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /// 文字列リテラルのFNV-1aの64ビットハッシュ値を求めます。終端文字は含めません。
+    /// @tparam C 文字の型です。
+    /// @tparam N 終端文字を含む文字数です。
+    /// @param literal TXTで記述した文字列リテラルです。
+    /// @return ハッシュ値です。
+    template<typename C, USize N>
+    constexpr U64 HashFnv1a64(const C (&literal)[N]) noexcept
+    {
+        return HashFnv1a64(literal, N - 1);
+    }
+
+    /// XXH64のハッシュ値を求めます。
+    /// 定数式で評価できる実装のため、実行時の長いデータには向きません。
+    /// @tparam C 要素の型です。1バイトの型である必要があります。
+    /// @param pData データの先頭です。
+    /// @param size データのバイトサイズです。
+    /// @param seed シード値です。
+    /// @return ハッシュ値です。
+    template<typename C>
+    constexpr U64 HashXxh64(const C *pData, USize size, U64 seed = 0) noexcept
+    {
+        static_assert(sizeof(C) == 1, "The element must be a single byte.");
+        using namespace _Internal;
+        USize offset = 0;
+        U64 hash = 0;
+        if (size >= 32)
+        {
+            U64 v1 = seed + _XXH64_PRIME1 + _XXH64_PRIME2;
+            U64 v2 = seed + _XXH64_PRIME2;
+            U64 v3 = seed;
+            U64 v4 = seed - _XXH64_PRIME1;
+            for (; offset + 32 <= size; offset += 32)
+            {
+                v1 = _Xxh64Round(v1, _ReadLittle(pData + offset, 8));
+                v2 = _Xxh64Round(v2, _ReadLittle(pData + offset + 8, 8));
+                v3 = _Xxh64Round(v3, _ReadLittle(pData + offset + 16, 8));
+                v4 = _Xxh64Round(v4, _ReadLittle(pData + offset + 24, 8));
+            }
+            hash = _RotateLeft64(v1, 1) + _RotateLeft64(v2, 7) + _RotateLeft64(v3, 12) + _RotateLeft64(v4, 18);
+            hash = _Xxh64Merge(hash, v1);
+            hash = _Xxh64Merge(hash, v2);
+            hash = _Xxh64Merge(hash, v3);
+            hash = _Xxh64Merge(hash, v4);
+        }
+        else
+        {
+            hash = seed + _XXH64_PRIME5;
+        }
+        hash += static_cast<U64>(size);
+        for (; offset + 8 <= size; offset += 8)
+        {
+            hash ^= _Xxh64Round(0, _ReadLittle(pData + offset, 8));
+            hash = _RotateLeft64(hash, 27) * _XXH64_PRIME1 + _XXH64_PRIME4;
+        }
+        if (offset + 4 <= size)
+        {
+            hash ^= _ReadLittle(pData + offset, 4) * _XXH64_PRIME1;
+            hash = _RotateLeft64(hash, 23) * _XXH64_PRIME2 + _XXH64_PRIME3;
+            offset += 4;
+        }
+        for (; offset < size; offset++)
+        {
+            hash ^= static_cast<U8>(pData[offset]) * _XXH64_PRIME5;
+            hash = _RotateLeft64(hash, 11) * _XXH64_PRIME1;
+        }
+        hash ^= hash >> 33;
+        hash *= _XXH64_PRIME2;
+        hash ^= hash >> 29;
+        hash *= _XXH64_PRIME3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    /// 文字列リテラルのXXH64のハッシュ値を求めます。終端文字は含めません。
+    /// @tparam C 文字の型です。
+    /// @tparam N 終端文字を含む文字数です。
+    /// @param literal TXTで記述した文字列リテラルです。
+    /// @return ハッシュ値です。
+    template<typename C, USize N>
+    constexpr U64 HashXxh64(const C (&literal)[N]) noexcept
+    {
+        return HashXxh64(literal, N - 1);
+    }
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// 定数式で評価中かを返します。
+        /// 判定できないコンパイラでは常に定数式で評価できる実装を使用します。
+        constexpr Bool _IsConstantEvaluated() noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+            return __builtin_is_constant_evaluated();
+#else
+            return YES;
+#endif
+        }
+
+        /// リトルエンディアンで4バイト、または、8バイトを読み込みます。
+        /// 実行時はアライメントに依らず1命令で読み込みます。
+        template<typename C>
+        constexpr U64 _ReadWord(const C *pData, USize size) noexcept
+        {
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            if (!_IsConstantEvaluated())
+            {
+                if (size == 8)
+                {
+                    U64 value = 0;
+                    std::memcpy(&value, pData, 8);
+                    return value;
+                }
+                U32 value = 0;
+                std::memcpy(&value, pData, 4);
+                return value;
+            }
+#endif
+            return _ReadLittle(pData, size);
+        }
+
+        constexpr U64 _WYHASH_SECRET0 = 0x2D358DCCAA6C78A5ULL;
+        constexpr U64 _WYHASH_SECRET1 = 0x8BB84B93962EACC9ULL;
+        constexpr U64 _WYHASH_SECRET2 = 0x4B33A62ED433D4A3ULL;
+        constexpr U64 _WYHASH_SECRET3 = 0x4D5A2DA51DE1AA47ULL;
+
+        /// 128ビットの積を求め、下位をl、上位をrに格納します。
+        constexpr Void _Multiply128(U64 &l, U64 &r) noexcept
+        {
+#if defined(__SIZEOF_INT128__)
+            __extension__ typedef unsigned __int128 U128;
+            U128 product = static_cast<U128>(l) * r;
+            l = static_cast<U64>(product);
+            r = static_cast<U64>(product >> 64);
+#else
+            U64 lh = l >> 32, ll = l & 0xFFFFFFFFULL, rh = r >> 32, rl = r & 0xFFFFFFFFULL;
+            U64 high = lh * rh, middle0 = lh * rl, middle1 = rh * ll, low = ll * rl;
+            U64 t = low + (middle0 << 32);
+            U64 carry = t < low ? 1 : 0;
+            U64 result = t + (middle1 << 32);
+            carry += result < t ? 1 : 0;
+            l = result;
+            r = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
+        }
+
+        /// 128ビットの積の上位と下位を混ぜます。
+        constexpr U64 _WyMix(U64 l, U64 r) noexcept
+        {
+            _Multiply128(l, r);
+            return l ^ r;
+        }
+
+        /// シードを初期化します。
+        constexpr U64 _WyhashSeed(U64 seed) noexcept
+        {
+            return seed ^ _WyMix(seed ^ _WYHASH_SECRET0, _WYHASH_SECRET1);
+        }
+
+        /// 48バイトを処理します。
+        template<typename C>
+        constexpr Void _WyhashBlock(const C *pData, U64 &seed, U64 &seed1, U64 &seed2) noexcept
+        {
+            seed = _WyMix(_ReadWord(pData, 8) ^ _WYHASH_SECRET1, _ReadWord(pData + 8, 8) ^ seed);
+            seed1 = _WyMix(_ReadWord(pData + 16, 8) ^ _WYHASH_SECRET2, _ReadWord(pData + 24, 8) ^ seed1);
+            seed2 = _WyMix(_ReadWord(pData + 32, 8) ^ _WYHASH_SECRET3, _ReadWord(pData + 40, 8) ^ seed2);
+        }
+
+        /// 最後の16バイトからハッシュ値を求めます。
+        constexpr U64 _WyhashFinish(U64 a, U64 b, U64 seed, U64 size) noexcept
+        {
+            a ^= _WYHASH_SECRET1;
+            b ^= seed;
+            _Multiply128(a, b);
+            return _WyMix(a ^ _WYHASH_SECRET0 ^ size, b ^ _WYHASH_SECRET1);
+        }
+
+        /// 16バイト以下のデータのハッシュ値を求めます。
+        template<typename C>
+        constexpr U64 _WyhashShort(const C *pData, USize size, U64 seed) noexcept
+        {
+            U64 a = 0;
+            U64 b = 0;
+            if (size >= 4)
+            {
+                Var offset = (size >> 3) << 2;
+                a = (_ReadWord(pData, 4) << 32) | _ReadWord(pData + offset, 4);
+                b = (_ReadWord(pData + size - 4, 4) << 32) | _ReadWord(pData + size - 4 - offset, 4);
+            }
+            else if (size > 0)
+            {
+                a = (static_cast<U64>(static_cast<U8>(pData[0])) << 16) | (static_cast<U64>(static_cast<U8>(pData[size >> 1])) << 8) | static_cast<U8>(pData[size - 1]);
+            }
+            return _WyhashFinish(a, b, seed, size);
+        }
+
+        /// 48バイト未満の残りを処理し、ハッシュ値を求めます。
+        /// 残りが16バイト未満の場合は直前の処理済みのデータを読み込みます。
+        template<typename C>
+        constexpr U64 _WyhashTail(const C *pData, USize rest, U64 seed, U64 size) noexcept
+        {
+            while (rest > 16)
+            {
+                seed = _WyMix(_ReadWord(pData, 8) ^ _WYHASH_SECRET1, _ReadWord(pData + 8, 8) ^ seed);
+                pData += 16;
+                rest -= 16;
+            }
+            return _WyhashFinish(_ReadWord(pData + rest - 16, 8), _ReadWord(pData + rest - 8, 8), seed, size);
+        }
+
+        /// CRC32Cの表です。
+        /// 8バイトずつ処理するため、8通りの表を持ちます。
+        struct _Crc32cTable
+        {
+            U32 values[8][256];
+
+            constexpr _Crc32cTable() noexcept
+                : values()
+            {
+                for (U32 i = 0; i < 256; i++)
+                {
+                    U32 crc = i;
+                    for (U32 bit = 0; bit < 8; bit++)
+                    {
+                        crc = (crc >> 1) ^ ((crc & 1) != 0 ? 0x82F63B78U : 0);
+                    }
+                    this->values[0][i] = crc;
+                }
+                for (U32 i = 0; i < 256; i++)
+                {
+                    for (USize table = 1; table < 8; table++)
+                    {
+                        Var previous = this->values[table - 1][i];
+                        this->values[table][i] = (previous >> 8) ^ this->values[0][previous & 0xFF];
+                    }
+                }
+            }
+        };
+
+        /// CRC32Cの表です。
+        constexpr _Crc32cTable _CRC32C_TABLE = _Crc32cTable();
+    }
+    /// @endcond
+
+    /// wyhash方式の64ビットハッシュ値を求めます。
+    /// 定数式でも評価でき、実行時は8バイトずつ読み込みます。
+    /// @tparam C 要素の型です。1バイトの型以外はVoidのポインタの多重定義を使用します。
+    /// @param pData データの先頭です。
+    /// @param size データのバイトサイズです。
+    /// @param seed シード値です。
+    /// @return ハッシュ値です。
+    template<typename C, typename = std::enable_if_t<sizeof(C) == 1>>
+    constexpr U64 HashWy(const C *pData, USize size, U64 seed = 0) noexcept
+    {
+        using namespace _Internal;
+        seed = _WyhashSeed(seed);
+        if (size <= 16) return _WyhashShort(pData, size, seed);
+        USize rest = size;
+        // 最後の1～48バイトは残りとして処理します
+        if (rest > 48)
+        {
+            U64 seed1 = seed;
+            U64 seed2 = seed;
+            do
+            {
+                _WyhashBlock(pData, seed, seed1, seed2);
+                pData += 48;
+                rest -= 48;
+            } while (rest > 48);
+            seed ^= seed1 ^ seed2;
+        }
+        return _WyhashTail(pData, rest, seed, size);
+    }
+
+    /// wyhash方式の64ビットハッシュ値を求めます。
+    /// @param pData データの先頭です。
+    /// @param size データのバイトサイズです。
+    /// @param seed シード値です。
+    /// @return ハッシュ値です。
+    inline U64 HashWy(const Void *pData, USize size, U64 seed = 0) noexcept
+    {
+        return HashWy(static_cast<const U8*>(pData), size, seed);
+    }
+
+    /// 文字列リテラルのwyhash方式の64ビットハッシュ値を求めます。終端文字は含めません。
+    /// @tparam C 文字の型です。
+    /// @tparam N 終端文字を含む文字数です。
+    /// @param literal TXTで記述した文字列リテラルです。
+    /// @return ハッシュ値です。
+    template<typename C, USize N>
+    constexpr U64 HashWy(const C (&literal)[N]) noexcept
+    {
+        return HashWy(literal, N - 1);
+    }
+
+    /// @cond LEYDOC_INTERNAL
+    namespace _Internal
+    {
+        /// 既知のハッシュ値との比較に使用する144バイトのデータです。
+        constexpr const char _WYHASH_KNOWN_DATA[] =
+            "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKL"
+            "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKL"
+            "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKL";
+
+        // 48バイトの倍数の境界で参照実装(wyhash final4)と同じ値になることを確認します
+        static_assert(HashWy(_WYHASH_KNOWN_DATA, 0) == 0x93228A4DE0EEC5A2ULL, "HashWy differs from wyhash.");
+        static_assert(HashWy(_WYHASH_KNOWN_DATA, 48) == 0x29B3B1A2CD889E34ULL, "HashWy differs from wyhash.");
+        static_assert(HashWy(_WYHASH_KNOWN_DATA, 49) == 0x5B314CCB3262ACC1ULL, "HashWy differs from wyhash.");
+        static_assert(HashWy(_WYHASH_KNOWN_DATA, 96) == 0x1039AFBDBEC28883ULL, "HashWy differs from wyhash.");
+        static_assert(HashWy(_WYHASH_KNOWN_DATA, 144) == 0x286CC81668C61C90ULL, "HashWy differs from wyhash.");
+    }
+    /// @endcond
+
+    /// 分割して入力したデータのwyhash方式のハッシュ値を求めます。
+    /// 大きなファイルを読み込みながらハッシュ値を求める際に使用し、結果はHashWyと同じです。
+    struct HashStream
+    {
+    private:
+
+        U64 m_seed;         // シード値
+        U64 m_seed1;        // 2本目の累積値
+        U64 m_seed2;        // 3本目の累積値
+        U64 m_size;         // 入力したバイトサイズ
+        USize m_restSize;   // 未処理のバイトサイズ
+        U8 m_buffer[64];    // 直前の処理済みの16バイトと、未処理の48バイト
+
+        // 未処理の領域です。
+        static constexpr USize REST_OFFSET = 16;
+
+    public:
+
+        /// 作成します。
+        /// @param seed シード値です。
+        explicit HashStream(U64 seed = 0) noexcept
+            : m_seed(_Internal::_WyhashSeed(seed))
+            , m_seed1(0)
+            , m_seed2(0)
+            , m_size(0)
+            , m_restSize(0)
+            , m_buffer()
+        {
+            this->m_seed1 = this->m_seed;
+            this->m_seed2 = this->m_seed;
+        }
+
+        /// データを入力します。
+        /// @param pData データの先頭です。
+        /// @param size データのバイトサイズです。
+        Void Update(const Void *pData, USize size) noexcept
+        {
+            Var pBytes = static_cast<const U8*>(pData);
+            this->m_size += size;
+            // 未処理のデータが無ければバッファを介さずに処理します
+            // 最後の1～48バイトはFinishで残りとして処理するため、続きが入力されるまで処理しません
+            if (this->m_restSize == 0 && size > 48)
+            {
+                do
+                {
+                    _Internal::_WyhashBlock(pBytes, this->m_seed, this->m_seed1, this->m_seed2);
+                    pBytes += 48;
+                    size -= 48;
+                } while (size > 48);
+                std::memcpy(this->m_buffer, pBytes - REST_OFFSET, REST_OFFSET);
+            }
+            while (size > 0)
+            {
+                if (this->m_restSize == 48)
+                {
+                    _Internal::_WyhashBlock(this->m_buffer + REST_OFFSET, this->m_seed, this->m_seed1, this->m_seed2);
+                    std::memcpy(this->m_buffer, this->m_buffer + 48, REST_OFFSET);
+                    this->m_restSize = 0;
+                }
+                Var copySize = 48 - this->m_restSize < size ? 48 - this->m_restSize : size;
+                std::memcpy(this->m_buffer + REST_OFFSET + this->m_restSize, pBytes, copySize);
+                pBytes += copySize;
+                size -= copySize;
+                this->m_restSize += copySize;
+            }
+        }
+
+        /// 入力したデータのハッシュ値を返します。
+        /// 続けて入力することもできます。
+        /// @return ハッシュ値です。
+        U64 Finish() const noexcept
+        {
+            Var pRest = this->m_buffer + REST_OFFSET;
+            if (this->m_size <= 16) return _Internal::_WyhashShort(pRest, this->m_restSize, this->m_seed);
+            Var seed = this->m_size > 48 ? this->m_seed ^ this->m_seed1 ^ this->m_seed2 : this->m_seed;
+            return _Internal::_WyhashTail(pRest, this->m_restSize, seed, this->m_size);
+        }
+    };
+
+    /// CRC32Cを求めます。
+    /// 実行時はSSE4.2、または、ARMv8のCRC32命令を使用できれば使用します。
+    /// @tparam C 要素の型です。1バイトの型以外はVoidのポインタの多重定義を使用します。
+    /// @param pData データの先頭です。
+    /// @param size データのバイトサイズです。
+    /// @param crc 分割して求める場合の直前までのCRC32Cです。
+    /// @return CRC32Cです。
+    template<typename C, typename = std::enable_if_t<sizeof(C) == 1>>
+    constexpr U32 Crc32c(const C *pData, USize size, U32 crc = 0) noexcept
+    {
+        using namespace _Internal;
+        crc = ~crc;
+        USize offset = 0;
+        if (!_IsConstantEvaluated())
+        {
+#if defined(__SSE4_2__) || defined(__AVX__) || defined(__ARM_FEATURE_CRC32)
+            for (; offset + 8 <= size; offset += 8)
+            {
+#if defined(__ARM_FEATURE_CRC32)
+                crc = __crc32cd(crc, _ReadWord(pData + offset, 8));
+#elif defined(_M_X64) || defined(__x86_64__)
+                crc = static_cast<U32>(_mm_crc32_u64(crc, _ReadWord(pData + offset, 8)));
+#else
+                crc = _mm_crc32_u32(crc, static_cast<U32>(_ReadWord(pData + offset, 4)));
+                crc = _mm_crc32_u32(crc, static_cast<U32>(_ReadWord(pData + offset + 4, 4)));
+#endif
+            }
+#else
+            for (; offset + 8 <= size; offset += 8)
+            {
+                Var word = _ReadWord(pData + offset, 8) ^ crc;
+                crc = _CRC32C_TABLE.values[7][word & 0xFF] ^ _CRC32C_TABLE.values[6][(word >> 8) & 0xFF]
+                    ^ _CRC32C_TABLE.values[5][(word >> 16) & 0xFF] ^ _CRC32C_TABLE.values[4][(word >> 24) & 0xFF]
+                    ^ _CRC32C_TABLE.values[3][(word >> 32) & 0xFF] ^ _CRC32C_TABLE.values[2][(word >> 40) & 0xFF]
+                    ^ _CRC32C_TABLE.values[1][(word >> 48) & 0xFF] ^ _CRC32C_TABLE.values[0][word >> 56];
+            }
+#endif
+        }
+        for (; offset < size; offset++)
+        {
+            crc = (crc >> 8) ^ _CRC32C_TABLE.values[0][(crc ^ static_cast<U8>(pData[offset])) & 0xFF];
+        }
+        return ~crc;
+    }
+
+    /// CRC32Cを求めます。
+    /// @param pData データの先頭です。
+    /// @param size データのバイトサイズです。
+    /// @param crc 分割して求める場合の直前までのCRC32Cです。
+    /// @return CRC32Cです。
+    inline U32 Crc32c(const Void *pData, USize size, U32 crc = 0) noexcept
+    {
+        return Crc32c(static_cast<const U8*>(pData), size, crc);
+    }
+
+    /// 文字列リテラルのCRC32Cを求めます。終端文字は含めません。
+    /// @tparam C 文字の型です。
+    /// @tparam N 終端文字を含む文字数です。
+    /// @param literal TXTで記述した文字列リテラルです。
+    /// @return CRC32Cです。
+    template<typename C, USize N>
+    constexpr U32 Crc32c(const C (&literal)[N]) noexcept
+    {
+        return Crc32c(literal, N - 1);
+    }
+
+    /// 値のハッシュ値を求める関数オブジェクトです。
+    /// 整数、列挙型、ポインタはビットを混ぜた値を返します。
+    /// @tparam K 値の型です。
+    template<typename K, typename = Void>
+    struct Hasher
+    {
+        static_assert(std::is_integral_v<K> || std::is_enum_v<K> || std::is_pointer_v<K>, "The type is not hashable.");
+
+        /// ハッシュ値を求めます。
+        /// @param value 値です。
+        /// @return ハッシュ値です。
+        constexpr U64 operator()(const K &value) const noexcept
+        {
+            U64 bits = 0;
+            if constexpr (std::is_pointer_v<K>) bits = static_cast<U64>(reinterpret_cast<USize>(value));
+            else                                bits = static_cast<U64>(value);
+            return _Internal::_WyMix(bits ^ _Internal::_WYHASH_SECRET0, _Internal::_WYHASH_SECRET1);
+        }
+    };
+
+    /// Hashメンバー関数を持つ値のハッシュ値を求める関数オブジェクトです。
+    /// @tparam K 値の型です。
+    template<typename K>
+    struct Hasher<K, std::void_t<decltype(std::declval<const K&>().Hash())>>
+    {
+        /// ハッシュ値を求めます。
+        /// @param value 値です。
+        /// @return ハッシュ値です。
+        constexpr U64 operator()(const K &value) const noexcept
+        {
+            return static_cast<U64>(value.Hash());
+        }
+    };
+}
+
+#endif // !_LEYENGINE_HASH_HPP
\ No newline at end of file
@@ -0,0 +1,162 @@
+/// @file LeyEngine/Job.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// ファイバーで実行するジョブシステムを提供します。
+#ifndef _LEYENGINE_JOB_HPP
+#define _LEYENGINE_JOB_HPP
+
+#include <atomic>
+#include "LeyEngine/Memory.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// ジョブシステムのエラーです。
+    enum class EJobError
+    {
+        /// ジョブシステムが初期化されていませんでした。
+        NOT_INITIALIZED,
+        /// 引数が不正でした。
+        INVALID_ARGUMENT,
+        /// メモリ確保に失敗しました。
+        BAD_ALLOCATE,
+    };
+
+    /// ジョブの関数です。
+    using JobFunction = Void (*)(Void *pData);
+
+    /// 実行するジョブです。
+    struct JobDeclaration
+    {
+        /// 関数です。
+        JobFunction function;
+        /// 関数に渡す任意のポインタです。
+        Void *pData;
+    };
+
+    /// 完了していないジョブを数えるカウンタです。
+    /// ジョブの完了毎に1つの不可分操作で減少し、0になった時だけ待機中のファイバーを再開します。
+    /// 待機中のファイバーがいる間は破棄してはいけません。
+    struct JobCounter
+    {
+        /// 完了していないジョブの数です。
+        std::atomic<U32> value;
+
+        /// 0で作成します。
+        JobCounter() noexcept
+            : value(0)
+        {
+        }
+
+        JobCounter(const JobCounter&) = delete;
+        JobCounter &operator=(const JobCounter&) = delete;
+
+        /// 完了していないジョブの数を返します。
+        /// @return ジョブの数です。
+        U32 Value() const noexcept
+        {
+            return this->value.load(std::memory_order_acquire);
+        }
+    };
+
+    /// ジョブを実行します。
+    /// ジョブはワーカースレッドのファイバーで実行します。
+    /// @param pJobs ジョブの配列です。
+    /// @param count ジョブの数です。
+    /// @param pCounter 完了を数えるカウンタです。ジョブの数だけ増加し、完了毎に減少します。NONEの場合は数えません。
+    /// @return SUCCESS、または、エラーです。
+    Result<Success, EJobError> RunJobs(const JobDeclaration *pJobs, USize count, JobCounter *pCounter) noexcept;
+
+    /// ジョブを次のフレームで実行します。
+    /// ジョブはAdvanceJobFrameを呼び出した時に実行を開始します。
+    /// @param pJobs ジョブの配列です。
+    /// @param count ジョブの数です。
+    /// @param pCounter 完了を数えるカウンタです。呼び出した時点でジョブの数だけ増加します。NONEの場合は数えません。
+    /// @return SUCCESS、または、エラーです。
+    Result<Success, EJobError> RunJobsNextFrame(const JobDeclaration *pJobs, USize count, JobCounter *pCounter) noexcept;
+
+    /// フレームを進め、RunJobsNextFrameで予約したジョブの実行を開始します。
+    /// フレームの開始時に1つのスレッドから呼び出します。
+    /// @return 実行を開始したジョブの数です。
+    USize AdvanceJobFrame() noexcept;
+
+    /// カウンタが0になるまで待機します。
+    /// ジョブ内で呼び出した場合はファイバーを中断し、ワーカースレッドは他のジョブを実行します。
+    /// ジョブ外で呼び出した場合は待機中に呼び出したスレッドでジョブを実行します。
+    /// @param counter 待機するカウンタです。
+    Void WaitForCounter(JobCounter &counter) noexcept;
+
+    /// ジョブを実行しているファイバー内かを返します。
+    /// @retval true ファイバー内です。
+    /// @retval false ファイバー外です。
+    Bool IsInJob() noexcept;
+
+    /// ジョブを実行するワーカースレッドの数を返します。
+    /// @return ワーカースレッドの数です。
+    USize JobWorkerCount() noexcept;
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// ParallelForの範囲です。
+        template<typename Fn>
+        struct _ParallelForRange
+        {
+            Fn *pFunction;  // 関数
+            USize begin;    // 開始位置
+            USize end;      // 終了位置
+        };
+
+        /// ParallelForの範囲を実行します。
+        template<typename Fn>
+        Void _RunParallelForRange(Void *pData)
+        {
+            Var pRange = Cast<_ParallelForRange<Fn>*>(pData);
+            for (USize i = pRange->begin; i < pRange->end; i++)
+            {
+                (*pRange->pFunction)(i);
+            }
+        }
+    }
+    /// @endcond
+
+    /// 範囲をバッチに分けてジョブで並列に実行し、完了まで待機します。
+    /// @tparam Fn 関数の型です。Void(USize index)を呼び出せる必要があります。
+    /// @param count 範囲の要素数です。
+    /// @param batchSize 1つのジョブで実行する要素数です。
+    /// @param function 要素毎に呼び出す関数です。
+    /// @return SUCCESS、または、エラーです。
+    template<typename Fn>
+    Result<Success, EJobError> ParallelFor(USize count, USize batchSize, Fn &&function) noexcept
+    {
+        using TFunction = std::remove_reference_t<Fn>;
+        if (batchSize == 0) return EJobError::INVALID_ARGUMENT;
+        if (count == 0) return SUCCESS;
+        Var batchCount = (count + batchSize - 1) / batchSize;
+        // 1つのバッチで終わる場合はジョブを作りません
+        if (batchCount == 1)
+        {
+            for (USize i = 0; i < count; i++) function(i);
+            return SUCCESS;
+        }
+        Var size = batchCount * (sizeof(_Internal::_ParallelForRange<TFunction>) + sizeof(JobDeclaration));
+        Var memoryResult = Allocate(size);
+        if (memoryResult.IsFailure()) return EJobError::BAD_ALLOCATE;
+        Var pJobs = Cast<JobDeclaration*>(memoryResult.Value());
+        Var pRanges = Cast<_Internal::_ParallelForRange<TFunction>*>(pJobs + batchCount);
+        for (USize i = 0; i < batchCount; i++)
+        {
+            Var end = (i + 1) * batchSize;
+            pRanges[i] = _Internal::_ParallelForRange<TFunction>{ &function, i * batchSize, end < count ? end : count };
+            pJobs[i] = JobDeclaration{ &_Internal::_RunParallelForRange<TFunction>, &pRanges[i] };
+        }
+        JobCounter counter;
+        Var result = RunJobs(pJobs, batchCount, &counter);
+        if (result.IsSuccess()) WaitForCounter(counter);
+        (Void)Deallocate(size, pJobs);
+        return result;
+    }
+}
+
+#endif // !_LEYENGINE_JOB_HPP
\ No newline at end of file
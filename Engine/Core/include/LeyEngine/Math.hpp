@@ -0,0 +1,972 @@
+/// @file LeyEngine/Math.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// SIMD命令で実装したベクトル、行列、境界ボックスと一括処理を提供します。
+#ifndef _LEYENGINE_MATH_HPP
+#define _LEYENGINE_MATH_HPP
+
+#include <cmath>
+#include "LeyEngine/Bit.hpp"
+#include "LeyEngine/Utility.hpp"
+
+// --------------------
+//
+// SIMD
+//
+// ====================
+#if defined(LEYENGINE_NO_SIMD)
+#elif defined(__AVX__)
+/// AVX命令を使用します。
+#define LEYENGINE_SIMD_AVX
+/// SSE命令を使用します。
+#define LEYENGINE_SIMD_SSE
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+/// SSE命令を使用します。
+#define LEYENGINE_SIMD_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+/// NEON命令を使用します。
+#define LEYENGINE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+#if defined(LEYENGINE_SIMD_SSE)
+        /// 4要素のF32のレジスタです。
+        using _F32x4 = __m128;
+
+        inline _F32x4 _Load(const F32 *pData) noexcept { return _mm_loadu_ps(pData); }
+        inline Void _Store(F32 *pData, _F32x4 value) noexcept { _mm_storeu_ps(pData, value); }
+        inline _F32x4 _Set(F32 x, F32 y, F32 z, F32 w) noexcept { return _mm_set_ps(w, z, y, x); }
+        inline _F32x4 _Splat(F32 value) noexcept { return _mm_set1_ps(value); }
+        inline _F32x4 _Add(_F32x4 l, _F32x4 r) noexcept { return _mm_add_ps(l, r); }
+        inline _F32x4 _Sub(_F32x4 l, _F32x4 r) noexcept { return _mm_sub_ps(l, r); }
+        inline _F32x4 _Mul(_F32x4 l, _F32x4 r) noexcept { return _mm_mul_ps(l, r); }
+        inline _F32x4 _Div(_F32x4 l, _F32x4 r) noexcept { return _mm_div_ps(l, r); }
+        inline _F32x4 _Min(_F32x4 l, _F32x4 r) noexcept { return _mm_min_ps(l, r); }
+        inline _F32x4 _Max(_F32x4 l, _F32x4 r) noexcept { return _mm_max_ps(l, r); }
+        inline _F32x4 _Abs(_F32x4 value) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f), value); }
+        inline _F32x4 _LessEqual(_F32x4 l, _F32x4 r) noexcept { return _mm_cmple_ps(l, r); }
+        inline _F32x4 _And(_F32x4 l, _F32x4 r) noexcept { return _mm_and_ps(l, r); }
+        inline U32 _MoveMask(_F32x4 mask) noexcept { return static_cast<U32>(_mm_movemask_ps(mask)); }
+        template<int I>
+        inline _F32x4 _SplatLane(_F32x4 value) noexcept { return _mm_shuffle_ps(value, value, _MM_SHUFFLE(I, I, I, I)); }
+#elif defined(LEYENGINE_SIMD_NEON)
+        /// 4要素のF32のレジスタです。
+        using _F32x4 = float32x4_t;
+
+        inline _F32x4 _Load(const F32 *pData) noexcept { return vld1q_f32(pData); }
+        inline Void _Store(F32 *pData, _F32x4 value) noexcept { vst1q_f32(pData, value); }
+        inline _F32x4 _Set(F32 x, F32 y, F32 z, F32 w) noexcept { const F32 data[4] = { x, y, z, w }; return vld1q_f32(data); }
+        inline _F32x4 _Splat(F32 value) noexcept { return vdupq_n_f32(value); }
+        inline _F32x4 _Add(_F32x4 l, _F32x4 r) noexcept { return vaddq_f32(l, r); }
+        inline _F32x4 _Sub(_F32x4 l, _F32x4 r) noexcept { return vsubq_f32(l, r); }
+        inline _F32x4 _Mul(_F32x4 l, _F32x4 r) noexcept { return vmulq_f32(l, r); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+        inline _F32x4 _Div(_F32x4 l, _F32x4 r) noexcept { return vdivq_f32(l, r); }
+#else
+        inline _F32x4 _Div(_F32x4 l, _F32x4 r) noexcept
+        {
+            // ARMv7には除算命令が無いため、逆数の近似をニュートン法で2回補正します
+            Var reciprocal = vrecpeq_f32(r);
+            reciprocal = vmulq_f32(vrecpsq_f32(r, reciprocal), reciprocal);
+            reciprocal = vmulq_f32(vrecpsq_f32(r, reciprocal), reciprocal);
+            return vmulq_f32(l, reciprocal);
+        }
+#endif
+        inline _F32x4 _Min(_F32x4 l, _F32x4 r) noexcept { return vminq_f32(l, r); }
+        inline _F32x4 _Max(_F32x4 l, _F32x4 r) noexcept { return vmaxq_f32(l, r); }
+        inline _F32x4 _Abs(_F32x4 value) noexcept { return vabsq_f32(value); }
+        inline _F32x4 _LessEqual(_F32x4 l, _F32x4 r) noexcept { return vreinterpretq_f32_u32(vcleq_f32(l, r)); }
+        inline _F32x4 _And(_F32x4 l, _F32x4 r) noexcept { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(l), vreinterpretq_u32_f32(r))); }
+        inline U32 _MoveMask(_F32x4 mask) noexcept
+        {
+            Var bits = vshrq_n_u32(vreinterpretq_u32_f32(mask), 31);
+            return vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1) | (vgetq_lane_u32(bits, 2) << 2) | (vgetq_lane_u32(bits, 3) << 3);
+        }
+        template<int I>
+        inline _F32x4 _SplatLane(_F32x4 value) noexcept { return vdupq_n_f32(vgetq_lane_f32(value, I)); }
+#else
+        /// 4要素のF32のレジスタです。
+        /// SIMD命令を使用できない場合の実装です。
+        struct _F32x4
+        {
+            F32 lanes[4];   // 要素
+        };
+
+        inline _F32x4 _Load(const F32 *pData) noexcept { return _F32x4{ { pData[0], pData[1], pData[2], pData[3] } }; }
+        inline Void _Store(F32 *pData, _F32x4 value) noexcept { for (USize i = 0; i < 4; i++) pData[i] = value.lanes[i]; }
+        inline _F32x4 _Set(F32 x, F32 y, F32 z, F32 w) noexcept { return _F32x4{ { x, y, z, w } }; }
+        inline _F32x4 _Splat(F32 value) noexcept { return _F32x4{ { value, value, value, value } }; }
+        template<typename Fn>
+        inline _F32x4 _Map(_F32x4 l, _F32x4 r, Fn function) noexcept
+        {
+            return _F32x4{ { function(l.lanes[0], r.lanes[0]), function(l.lanes[1], r.lanes[1]), function(l.lanes[2], r.lanes[2]), function(l.lanes[3], r.lanes[3]) } };
+        }
+        inline _F32x4 _Add(_F32x4 l, _F32x4 r) noexcept { return _Map(l, r, [](F32 a, F32 b) { return a + b; }); }
+        inline _F32x4 _Sub(_F32x4 l, _F32x4 r) noexcept { return _Map(l, r, [](F32 a, F32 b) { return a - b; }); }
+        inline _F32x4 _Mul(_F32x4 l, _F32x4 r) noexcept { return _Map(l, r, [](F32 a, F32 b) { return a * b; }); }
+        inline _F32x4 _Div(_F32x4 l, _F32x4 r) noexcept { return _Map(l, r, [](F32 a, F32 b) { return a / b; }); }
+        inline _F32x4 _Min(_F32x4 l, _F32x4 r) noexcept { return _Map(l, r, [](F32 a, F32 b) { return a < b ? a : b; }); }
+        inline _F32x4 _Max(_F32x4 l, _F32x4 r) noexcept { return _Map(l, r, [](F32 a, F32 b) { return a > b ? a : b; }); }
+        inline _F32x4 _Abs(_F32x4 value) noexcept { return _Map(value, value, [](F32 a, F32) { return std::fabs(a); }); }
+        inline _F32x4 _LessEqual(_F32x4 l, _F32x4 r) noexcept { return _Map(l, r, [](F32 a, F32 b) { return a <= b ? -1.0f : 0.0f; }); }
+        inline _F32x4 _And(_F32x4 l, _F32x4 r) noexcept { return _Map(l, r, [](F32 a, F32 b) { return a != 0.0f && b != 0.0f ? -1.0f : 0.0f; }); }
+        inline U32 _MoveMask(_F32x4 mask) noexcept
+        {
+            U32 bits = 0;
+            for (U32 i = 0; i < 4; i++) bits |= (mask.lanes[i] != 0.0f ? 1U : 0U) << i;
+            return bits;
+        }
+        template<int I>
+        inline _F32x4 _SplatLane(_F32x4 value) noexcept { return _Splat(value.lanes[I]); }
+#endif
+
+#if defined(LEYENGINE_SIMD_AVX)
+        /// 一括処理に使用する最も幅の広いF32のレジスタです。
+        using _F32xN = __m256;
+
+        inline _F32xN _LoadN(const F32 *pData) noexcept { return _mm256_loadu_ps(pData); }
+        inline _F32xN _SplatN(F32 value) noexcept { return _mm256_set1_ps(value); }
+        inline _F32xN _Add(_F32xN l, _F32xN r) noexcept { return _mm256_add_ps(l, r); }
+        inline _F32xN _Sub(_F32xN l, _F32xN r) noexcept { return _mm256_sub_ps(l, r); }
+        inline _F32xN _Mul(_F32xN l, _F32xN r) noexcept { return _mm256_mul_ps(l, r); }
+        inline _F32xN _Max(_F32xN l, _F32xN r) noexcept { return _mm256_max_ps(l, r); }
+        inline _F32xN _Abs(_F32xN value) noexcept { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value); }
+        inline _F32xN _LessEqual(_F32xN l, _F32xN r) noexcept { return _mm256_cmp_ps(l, r, _CMP_LE_OQ); }
+        inline _F32xN _And(_F32xN l, _F32xN r) noexcept { return _mm256_and_ps(l, r); }
+        inline U32 _MoveMask(_F32xN mask) noexcept { return static_cast<U32>(_mm256_movemask_ps(mask)); }
+        inline Void _Store(F32 *pData, _F32xN value) noexcept { _mm256_storeu_ps(pData, value); }
+#else
+        /// 一括処理に使用する最も幅の広いF32のレジスタです。
+        using _F32xN = _F32x4;
+
+        inline _F32xN _LoadN(const F32 *pData) noexcept { return _Load(pData); }
+        inline _F32xN _SplatN(F32 value) noexcept { return _Splat(value); }
+#endif
+    }
+    /// @endcond
+
+    /// 一括処理で1度に処理する要素数です。
+    constexpr USize F32_SIMD_WIDTH = sizeof(_Internal::_F32xN) / sizeof(F32);
+
+    /// 円周率です。
+    constexpr F32 PI = 3.14159265358979323846f;
+
+    // --------------------
+    //
+    // ベクトル
+    //
+    // ====================
+
+    /// 2次元ベクトルです。
+    struct Vec2
+    {
+        /// X成分です。
+        F32 x;
+        /// Y成分です。
+        F32 y;
+
+        /// 加算します。
+        Vec2 operator+(const Vec2 &other) const noexcept { return Vec2{ this->x + other.x, this->y + other.y }; }
+        /// 減算します。
+        Vec2 operator-(const Vec2 &other) const noexcept { return Vec2{ this->x - other.x, this->y - other.y }; }
+        /// 拡大します。
+        Vec2 operator*(F32 scale) const noexcept { return Vec2{ this->x * scale, this->y * scale }; }
+        /// 反転します。
+        Vec2 operator-() const noexcept { return Vec2{ -this->x, -this->y }; }
+
+        /// 内積を返します。
+        /// @param other 対象です。
+        /// @return 内積です。
+        F32 Dot(const Vec2 &other) const noexcept
+        {
+            return this->x * other.x + this->y * other.y;
+        }
+
+        /// 長さを返します。
+        /// @return 長さです。
+        F32 Length() const noexcept
+        {
+            return std::sqrt(this->Dot(*this));
+        }
+    };
+
+    /// 3次元ベクトルです。
+    /// 配列で詰めて格納できるよう12バイトです。一括処理にはSoAの関数を使用します。
+    struct Vec3
+    {
+        /// X成分です。
+        F32 x;
+        /// Y成分です。
+        F32 y;
+        /// Z成分です。
+        F32 z;
+
+        /// 加算します。
+        Vec3 operator+(const Vec3 &other) const noexcept { return Vec3{ this->x + other.x, this->y + other.y, this->z + other.z }; }
+        /// 減算します。
+        Vec3 operator-(const Vec3 &other) const noexcept { return Vec3{ this->x - other.x, this->y - other.y, this->z - other.z }; }
+        /// 成分毎に乗算します。
+        Vec3 operator*(const Vec3 &other) const noexcept { return Vec3{ this->x * other.x, this->y * other.y, this->z * other.z }; }
+        /// 拡大します。
+        Vec3 operator*(F32 scale) const noexcept { return Vec3{ this->x * scale, this->y * scale, this->z * scale }; }
+        /// 反転します。
+        Vec3 operator-() const noexcept { return Vec3{ -this->x, -this->y, -this->z }; }
+
+        /// 内積を返します。
+        /// @param other 対象です。
+        /// @return 内積です。
+        F32 Dot(const Vec3 &other) const noexcept
+        {
+            return this->x * other.x + this->y * other.y + this->z * other.z;
+        }
+
+        /// 外積を返します。
+        /// @param other 対象です。
+        /// @return 外積です。
+        Vec3 Cross(const Vec3 &other) const noexcept
+        {
+            return Vec3{ this->y * other.z - this->z * other.y, this->z * other.x - this->x * other.z, this->x * other.y - this->y * other.x };
+        }
+
+        /// 長さを返します。
+        /// @return 長さです。
+        F32 Length() const noexcept
+        {
+            return std::sqrt(this->Dot(*this));
+        }
+
+        /// 長さを1にしたベクトルを返します。
+        /// @return 正規化したベクトルです。長さが0の場合は0ベクトルです。
+        Vec3 Normalized() const noexcept
+        {
+            Var length = this->Length();
+            return length > 0.0f ? *this * (1.0f / length) : Vec3{ 0.0f, 0.0f, 0.0f };
+        }
+
+        /// 成分毎の最小値を返します。
+        /// @param other 対象です。
+        /// @return 最小値です。
+        Vec3 Min(const Vec3 &other) const noexcept
+        {
+            return Vec3{ std::fmin(this->x, other.x), std::fmin(this->y, other.y), std::fmin(this->z, other.z) };
+        }
+
+        /// 成分毎の最大値を返します。
+        /// @param other 対象です。
+        /// @return 最大値です。
+        Vec3 Max(const Vec3 &other) const noexcept
+        {
+            return Vec3{ std::fmax(this->x, other.x), std::fmax(this->y, other.y), std::fmax(this->z, other.z) };
+        }
+    };
+
+    /// 4次元ベクトルです。
+    /// SIMDレジスタに直接読み込めるよう16バイトでアライメントします。
+    struct alignas(16) Vec4
+    {
+        /// X成分です。
+        F32 x;
+        /// Y成分です。
+        F32 y;
+        /// Z成分です。
+        F32 z;
+        /// W成分です。
+        F32 w;
+
+        /// @cond LEYDOC_INTERNAL
+        /// レジスタから作成します。
+        static Vec4 _From(_Internal::_F32x4 value) noexcept
+        {
+            Vec4 result;
+            _Internal::_Store(&result.x, value);
+            return result;
+        }
+
+        /// レジスタに読み込みます。
+        _Internal::_F32x4 _Get() const noexcept
+        {
+            return _Internal::_Load(&this->x);
+        }
+        /// @endcond
+
+        /// 加算します。
+        Vec4 operator+(const Vec4 &other) const noexcept { return _From(_Internal::_Add(this->_Get(), other._Get())); }
+        /// 減算します。
+        Vec4 operator-(const Vec4 &other) const noexcept { return _From(_Internal::_Sub(this->_Get(), other._Get())); }
+        /// 成分毎に乗算します。
+        Vec4 operator*(const Vec4 &other) const noexcept { return _From(_Internal::_Mul(this->_Get(), other._Get())); }
+        /// 拡大します。
+        Vec4 operator*(F32 scale) const noexcept { return _From(_Internal::_Mul(this->_Get(), _Internal::_Splat(scale))); }
+
+        /// 内積を返します。
+        /// @param other 対象です。
+        /// @return 内積です。
+        F32 Dot(const Vec4 &other) const noexcept
+        {
+            alignas(16) F32 products[4];
+            _Internal::_Store(products, _Internal::_Mul(this->_Get(), other._Get()));
+            return (products[0] + products[1]) + (products[2] + products[3]);
+        }
+
+        /// 長さを返します。
+        /// @return 長さです。
+        F32 Length() const noexcept
+        {
+            return std::sqrt(this->Dot(*this));
+        }
+
+        /// 成分毎の最小値を返します。
+        /// @param other 対象です。
+        /// @return 最小値です。
+        Vec4 Min(const Vec4 &other) const noexcept
+        {
+            return _From(_Internal::_Min(this->_Get(), other._Get()));
+        }
+
+        /// 成分毎の最大値を返します。
+        /// @param other 対象です。
+        /// @return 最大値です。
+        Vec4 Max(const Vec4 &other) const noexcept
+        {
+            return _From(_Internal::_Max(this->_Get(), other._Get()));
+        }
+
+        /// XYZ成分を返します。
+        /// @return XYZ成分です。
+        Vec3 XYZ() const noexcept
+        {
+            return Vec3{ this->x, this->y, this->z };
+        }
+    };
+
+    // --------------------
+    //
+    // 四元数
+    //
+    // ====================
+
+    /// 回転を表す四元数です。
+    struct alignas(16) Quat
+    {
+        /// X成分です。
+        F32 x;
+        /// Y成分です。
+        F32 y;
+        /// Z成分です。
+        F32 z;
+        /// W成分です。
+        F32 w;
+
+        /// 回転しない四元数を返します。
+        /// @return 四元数です。
+        static Quat Identity() noexcept
+        {
+            return Quat{ 0.0f, 0.0f, 0.0f, 1.0f };
+        }
+
+        /// 軸と角度から作成します。
+        /// @param axis 長さ1の回転軸です。
+        /// @param radian ラジアンの回転角度です。
+        /// @return 四元数です。
+        static Quat FromAxisAngle(const Vec3 &axis, F32 radian) noexcept
+        {
+            Var s = std::sin(radian * 0.5f);
+            return Quat{ axis.x * s, axis.y * s, axis.z * s, std::cos(radian * 0.5f) };
+        }
+
+        /// 回転を合成します。右辺の回転の後に左辺の回転を適用します。
+        /// @param other 先に適用する回転です。
+        /// @return 合成した回転です。
+        Quat operator*(const Quat &other) const noexcept
+        {
+            return Quat{
+                this->w * other.x + this->x * other.w + this->y * other.z - this->z * other.y,
+                this->w * other.y - this->x * other.z + this->y * other.w + this->z * other.x,
+                this->w * other.z + this->x * other.y - this->y * other.x + this->z * other.w,
+                this->w * other.w - this->x * other.x - this->y * other.y - this->z * other.z };
+        }
+
+        /// 逆回転を返します。長さ1である必要があります。
+        /// @return 逆回転です。
+        Quat Conjugate() const noexcept
+        {
+            return Quat{ -this->x, -this->y, -this->z, this->w };
+        }
+
+        /// 長さを1にした四元数を返します。
+        /// @return 正規化した四元数です。
+        Quat Normalized() const noexcept
+        {
+            Var length = std::sqrt(this->x * this->x + this->y * this->y + this->z * this->z + this->w * this->w);
+            Var inverse = length > 0.0f ? 1.0f / length : 0.0f;
+            return Quat{ this->x * inverse, this->y * inverse, this->z * inverse, this->w * inverse };
+        }
+
+        /// ベクトルを回転します。
+        /// @param vector 回転するベクトルです。
+        /// @return 回転したベクトルです。
+        Vec3 Rotate(const Vec3 &vector) const noexcept
+        {
+            Vec3 axis = { this->x, this->y, this->z };
+            Var t = axis.Cross(vector) * 2.0f;
+            return vector + t * this->w + axis.Cross(t);
+        }
+    };
+
+    // --------------------
+    //
+    // 行列
+    //
+    // ====================
+
+    /// 列優先の3x3行列です。
+    struct Mat3
+    {
+        /// 列です。
+        Vec3 columns[3];
+
+        /// 単位行列を返します。
+        /// @return 単位行列です。
+        static Mat3 Identity() noexcept
+        {
+            return Mat3{ { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } } };
+        }
+
+        /// 四元数の回転行列を返します。
+        /// @param rotation 長さ1の四元数です。
+        /// @return 回転行列です。
+        static Mat3 FromQuat(const Quat &rotation) noexcept
+        {
+            Var x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+            return Mat3{ {
+                { 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w) },
+                { 2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w) },
+                { 2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y) } } };
+        }
+
+        /// ベクトルを変換します。
+        /// @param vector ベクトルです。
+        /// @return 変換したベクトルです。
+        Vec3 operator*(const Vec3 &vector) const noexcept
+        {
+            return this->columns[0] * vector.x + this->columns[1] * vector.y + this->columns[2] * vector.z;
+        }
+
+        /// 行列を乗算します。
+        /// @param other 先に適用する行列です。
+        /// @return 積です。
+        Mat3 operator*(const Mat3 &other) const noexcept
+        {
+            return Mat3{ { *this * other.columns[0], *this * other.columns[1], *this * other.columns[2] } };
+        }
+
+        /// 転置行列を返します。
+        /// @return 転置行列です。
+        Mat3 Transposed() const noexcept
+        {
+            Var &c = this->columns;
+            return Mat3{ { { c[0].x, c[1].x, c[2].x }, { c[0].y, c[1].y, c[2].y }, { c[0].z, c[1].z, c[2].z } } };
+        }
+    };
+
+    /// 列優先の4x4行列です。
+    /// ベクトルは列ベクトルとして右から乗算します。
+    struct alignas(16) Mat4
+    {
+        /// 列です。
+        Vec4 columns[4];
+
+        /// 単位行列を返します。
+        /// @return 単位行列です。
+        static Mat4 Identity() noexcept
+        {
+            return Mat4{ { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } } };
+        }
+
+        /// 平行移動、回転、拡大縮小の順に適用する変換行列を返します。
+        /// @param translation 平行移動です。
+        /// @param rotation 回転です。
+        /// @param scale 拡大縮小です。
+        /// @return 変換行列です。
+        static Mat4 FromTransform(const Vec3 &translation, const Quat &rotation, const Vec3 &scale) noexcept
+        {
+            Var r = Mat3::FromQuat(rotation);
+            return Mat4{ {
+                { r.columns[0].x * scale.x, r.columns[0].y * scale.x, r.columns[0].z * scale.x, 0.0f },
+                { r.columns[1].x * scale.y, r.columns[1].y * scale.y, r.columns[1].z * scale.y, 0.0f },
+                { r.columns[2].x * scale.z, r.columns[2].y * scale.z, r.columns[2].z * scale.z, 0.0f },
+                { translation.x, translation.y, translation.z, 1.0f } } };
+        }
+
+        /// ベクトルを変換します。
+        /// @param vector ベクトルです。
+        /// @return 変換したベクトルです。
+        Vec4 operator*(const Vec4 &vector) const noexcept
+        {
+            using namespace _Internal;
+            Var v = vector._Get();
+            Var result = _Mul(this->columns[0]._Get(), _SplatLane<0>(v));
+            result = _Add(result, _Mul(this->columns[1]._Get(), _SplatLane<1>(v)));
+            result = _Add(result, _Mul(this->columns[2]._Get(), _SplatLane<2>(v)));
+            result = _Add(result, _Mul(this->columns[3]._Get(), _SplatLane<3>(v)));
+            return Vec4::_From(result);
+        }
+
+        /// 行列を乗算します。
+        /// 階層の変換では親の行列に子の行列を右から乗算します。
+        /// @param other 先に適用する行列です。
+        /// @return 積です。
+        Mat4 operator*(const Mat4 &other) const noexcept
+        {
+            return Mat4{ { *this * other.columns[0], *this * other.columns[1], *this * other.columns[2], *this * other.columns[3] } };
+        }
+
+        /// 点を変換します。W成分は1として扱います。
+        /// @param point 点です。
+        /// @return 変換した点です。
+        Vec3 TransformPoint(const Vec3 &point) const noexcept
+        {
+            return (*this * Vec4{ point.x, point.y, point.z, 1.0f }).XYZ();
+        }
+
+        /// 方向を変換します。W成分は0として扱います。
+        /// @param direction 方向です。
+        /// @return 変換した方向です。
+        Vec3 TransformDirection(const Vec3 &direction) const noexcept
+        {
+            return (*this * Vec4{ direction.x, direction.y, direction.z, 0.0f }).XYZ();
+        }
+
+        /// 転置行列を返します。
+        /// @return 転置行列です。
+        Mat4 Transposed() const noexcept
+        {
+            Var &c = this->columns;
+            return Mat4{ {
+                { c[0].x, c[1].x, c[2].x, c[3].x }, { c[0].y, c[1].y, c[2].y, c[3].y },
+                { c[0].z, c[1].z, c[2].z, c[3].z }, { c[0].w, c[1].w, c[2].w, c[3].w } } };
+        }
+
+        /// 逆行列を返します。
+        /// @return 逆行列、または、逆行列が存在しない場合の失敗です。
+        Result<Mat4, Failure> Inverse() const noexcept
+        {
+            const F32 *m = &this->columns[0].x;
+            F32 inv[16];
+            inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+            inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+            inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+            inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+            inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+            inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+            inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+            inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+            inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+            inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+            inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+            inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+            inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+            inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+            inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+            inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+            Var determinant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+            if (determinant == 0.0f) return FAILURE;
+            Var scale = _Internal::_Splat(1.0f / determinant);
+            Mat4 result;
+            for (USize i = 0; i < 4; i++)
+            {
+                result.columns[i] = Vec4::_From(_Internal::_Mul(_Internal::_Load(inv + i * 4), scale));
+            }
+            return result;
+        }
+    };
+
+    // --------------------
+    //
+    // 境界ボックス
+    //
+    // ====================
+
+    /// 軸に平行な境界ボックスです。
+    struct AABB
+    {
+        /// 最小の点です。
+        Vec3 min;
+        /// 最大の点です。
+        Vec3 max;
+
+        /// 中心を返します。
+        /// @return 中心です。
+        Vec3 Center() const noexcept
+        {
+            return (this->min + this->max) * 0.5f;
+        }
+
+        /// 中心から各面までの距離を返します。
+        /// @return 中心から各面までの距離です。
+        Vec3 Extent() const noexcept
+        {
+            return (this->max - this->min) * 0.5f;
+        }
+
+        /// 点を含むかを返します。
+        /// @param point 点です。
+        /// @retval true 含みます。
+        /// @retval false 含みません。
+        Bool Contains(const Vec3 &point) const noexcept
+        {
+            return this->min.x <= point.x && point.x <= this->max.x
+                && this->min.y <= point.y && point.y <= this->max.y
+                && this->min.z <= point.z && point.z <= this->max.z;
+        }
+
+        /// 他の境界ボックスと重なるかを返します。
+        /// @param other 他の境界ボックスです。
+        /// @retval true 重なります。
+        /// @retval false 重なりません。
+        Bool Intersects(const AABB &other) const noexcept
+        {
+            return this->min.x <= other.max.x && other.min.x <= this->max.x
+                && this->min.y <= other.max.y && other.min.y <= this->max.y
+                && this->min.z <= other.max.z && other.min.z <= this->max.z;
+        }
+
+        /// 他の境界ボックスを含む境界ボックスを返します。
+        /// @param other 他の境界ボックスです。
+        /// @return 和の境界ボックスです。
+        AABB Union(const AABB &other) const noexcept
+        {
+            return AABB{ this->min.Min(other.min), this->max.Max(other.max) };
+        }
+
+        /// 変換後の境界ボックスを返します。
+        /// 中心を変換し、各面までの距離は行列の絶対値で変換します。
+        /// @param matrix アフィン変換行列です。
+        /// @return 変換後の境界ボックスです。
+        AABB Transformed(const Mat4 &matrix) const noexcept
+        {
+            using namespace _Internal;
+            Var center = matrix.TransformPoint(this->Center());
+            Var extent = this->Extent();
+            Var e = _Mul(_Abs(matrix.columns[0]._Get()), _Splat(extent.x));
+            e = _Add(e, _Mul(_Abs(matrix.columns[1]._Get()), _Splat(extent.y)));
+            e = _Add(e, _Mul(_Abs(matrix.columns[2]._Get()), _Splat(extent.z)));
+            Var newExtent = Vec4::_From(e).XYZ();
+            return AABB{ center - newExtent, center + newExtent };
+        }
+    };
+
+    /// 視錐台です。
+    /// 平面は法線が内側を向き、XYZが法線、Wが原点からの距離です。
+    struct Frustum
+    {
+        /// 左、右、下、上、前、後の平面です。
+        Vec4 planes[6];
+
+        /// ビュー射影行列から平面を取り出します。
+        /// クリップ空間のZが0から1の範囲の射影行列を想定します。
+        /// @param viewProjection ビュー射影行列です。
+        /// @return 視錐台です。
+        static Frustum FromMatrix(const Mat4 &viewProjection) noexcept
+        {
+            Var t = viewProjection.Transposed();
+            Var &r = t.columns;
+            Frustum frustum = { { r[3] + r[0], r[3] - r[0], r[3] + r[1], r[3] - r[1], r[2], r[3] - r[2] } };
+            for (USize i = 0; i < 6; i++)
+            {
+                Var length = frustum.planes[i].XYZ().Length();
+                if (length > 0.0f) frustum.planes[i] = frustum.planes[i] * (1.0f / length);
+            }
+            return frustum;
+        }
+    };
+
+    // --------------------
+    //
+    // 比較
+    //
+    // ====================
+
+    /// 誤差を考慮して成分毎に等しいか比較します。
+    /// @param l 比較対象です。
+    /// @param r 比較対象です。
+    /// @retval true すべての成分の差が誤差の範囲内です。
+    /// @retval false 差が誤差の範囲外の成分があります。
+    inline Bool Equal(const Vec4 &l, const Vec4 &r) noexcept
+    {
+        using namespace _Internal;
+        Var a = l._Get();
+        Var b = r._Get();
+        Var tolerance = _Mul(_Splat(F32_EPSILON), _Max(_Splat(1.0f), _Max(_Abs(a), _Abs(b))));
+        return _MoveMask(_LessEqual(_Abs(_Sub(a, b)), tolerance)) == 0xF;
+    }
+
+    /// 誤差を考慮して成分毎に等しいか比較します。
+    /// @param l 比較対象です。
+    /// @param r 比較対象です。
+    /// @retval true すべての成分の差が誤差の範囲内です。
+    /// @retval false 差が誤差の範囲外の成分があります。
+    inline Bool Equal(const Vec3 &l, const Vec3 &r) noexcept
+    {
+        return Equal(Vec4{ l.x, l.y, l.z, 0.0f }, Vec4{ r.x, r.y, r.z, 0.0f });
+    }
+
+    /// 誤差を考慮して成分毎に等しいか比較します。
+    /// @param l 比較対象です。
+    /// @param r 比較対象です。
+    /// @retval true すべての成分の差が誤差の範囲内です。
+    /// @retval false 差が誤差の範囲外の成分があります。
+    inline Bool Equal(const Quat &l, const Quat &r) noexcept
+    {
+        return Equal(Vec4{ l.x, l.y, l.z, l.w }, Vec4{ r.x, r.y, r.z, r.w });
+    }
+
+    /// 誤差を考慮して成分毎に等しいか比較します。
+    /// @param l 比較対象です。
+    /// @param r 比較対象です。
+    /// @retval true すべての成分の差が誤差の範囲内です。
+    /// @retval false 差が誤差の範囲外の成分があります。
+    inline Bool Equal(const Mat4 &l, const Mat4 &r) noexcept
+    {
+        return Equal(l.columns[0], r.columns[0]) && Equal(l.columns[1], r.columns[1])
+            && Equal(l.columns[2], r.columns[2]) && Equal(l.columns[3], r.columns[3]);
+    }
+
+    // --------------------
+    //
+    // 一括処理
+    //
+    // ====================
+
+    /// 誤差を考慮して配列の要素毎に等しいか比較します。
+    /// @param pL 比較対象の配列です。
+    /// @param pR 比較対象の配列です。
+    /// @param pResults 要素毎の結果を受け取る配列です。
+    /// @param count 要素数です。
+    /// @return 等しかった要素数です。
+    inline USize Equal(const F32 *pL, const F32 *pR, Bool *pResults, USize count) noexcept
+    {
+        using namespace _Internal;
+        USize equalCount = 0;
+        USize i = 0;
+        for (; i + F32_SIMD_WIDTH <= count; i += F32_SIMD_WIDTH)
+        {
+            Var a = _LoadN(pL + i);
+            Var b = _LoadN(pR + i);
+            Var tolerance = _Mul(_SplatN(F32_EPSILON), _Max(_SplatN(1.0f), _Max(_Abs(a), _Abs(b))));
+            Var bits = _MoveMask(_LessEqual(_Abs(_Sub(a, b)), tolerance));
+            for (USize lane = 0; lane < F32_SIMD_WIDTH; lane++) pResults[i + lane] = (bits >> lane) & 1;
+            equalCount += PopCount(bits);
+        }
+        for (; i < count; i++)
+        {
+            pResults[i] = Equal(pL[i], pR[i]);
+            equalCount += pResults[i] ? 1 : 0;
+        }
+        return equalCount;
+    }
+
+    /// 誤差を考慮して配列のすべての要素が等しいか比較します。
+    /// @param pL 比較対象の配列です。
+    /// @param pR 比較対象の配列です。
+    /// @param count 要素数です。
+    /// @retval true すべての要素の差が誤差の範囲内です。
+    /// @retval false 差が誤差の範囲外の要素があります。
+    inline Bool AllEqual(const F32 *pL, const F32 *pR, USize count) noexcept
+    {
+        using namespace _Internal;
+        constexpr U32 ALL_BITS = (1U << F32_SIMD_WIDTH) - 1;
+        USize i = 0;
+        for (; i + F32_SIMD_WIDTH <= count; i += F32_SIMD_WIDTH)
+        {
+            Var a = _LoadN(pL + i);
+            Var b = _LoadN(pR + i);
+            Var tolerance = _Mul(_SplatN(F32_EPSILON), _Max(_SplatN(1.0f), _Max(_Abs(a), _Abs(b))));
+            if (_MoveMask(_LessEqual(_Abs(_Sub(a, b)), tolerance)) != ALL_BITS) return NO;
+        }
+        for (; i < count; i++)
+        {
+            if (!Equal(pL[i], pR[i])) return NO;
+        }
+        return YES;
+    }
+
+    /// SoAで格納した点の配列を変換します。W成分は1として扱います。
+    /// 入力と出力は同じ配列でも構いません。
+    /// @param matrix アフィン変換行列です。
+    /// @param pX 点のX成分の配列です。
+    /// @param pY 点のY成分の配列です。
+    /// @param pZ 点のZ成分の配列です。
+    /// @param pOutX 変換した点のX成分を受け取る配列です。
+    /// @param pOutY 変換した点のY成分を受け取る配列です。
+    /// @param pOutZ 変換した点のZ成分を受け取る配列です。
+    /// @param count 点の数です。
+    inline Void TransformPoints(const Mat4 &matrix, const F32 *pX, const F32 *pY, const F32 *pZ, F32 *pOutX, F32 *pOutY, F32 *pOutZ, USize count) noexcept
+    {
+        using namespace _Internal;
+        Var &c = matrix.columns;
+        USize i = 0;
+        for (; i + F32_SIMD_WIDTH <= count; i += F32_SIMD_WIDTH)
+        {
+            Var x = _LoadN(pX + i);
+            Var y = _LoadN(pY + i);
+            Var z = _LoadN(pZ + i);
+            Var outX = _Add(_Add(_Mul(_SplatN(c[0].x), x), _Mul(_SplatN(c[1].x), y)), _Add(_Mul(_SplatN(c[2].x), z), _SplatN(c[3].x)));
+            Var outY = _Add(_Add(_Mul(_SplatN(c[0].y), x), _Mul(_SplatN(c[1].y), y)), _Add(_Mul(_SplatN(c[2].y), z), _SplatN(c[3].y)));
+            Var outZ = _Add(_Add(_Mul(_SplatN(c[0].z), x), _Mul(_SplatN(c[1].z), y)), _Add(_Mul(_SplatN(c[2].z), z), _SplatN(c[3].z)));
+            _Store(pOutX + i, outX);
+            _Store(pOutY + i, outY);
+            _Store(pOutZ + i, outZ);
+        }
+        for (; i < count; i++)
+        {
+            Var point = matrix.TransformPoint(Vec3{ pX[i], pY[i], pZ[i] });
+            pOutX[i] = point.x;
+            pOutY[i] = point.y;
+            pOutZ[i] = point.z;
+        }
+    }
+
+    /// 点の配列を変換します。W成分は1として扱います。
+    /// 入力と出力は同じ配列でも構いません。
+    /// @param matrix アフィン変換行列です。
+    /// @param pPoints 点の配列です。
+    /// @param pOutPoints 変換した点を受け取る配列です。
+    /// @param count 点の数です。
+    inline Void TransformPoints(const Mat4 &matrix, const Vec3 *pPoints, Vec3 *pOutPoints, USize count) noexcept
+    {
+        for (USize i = 0; i < count; i++) pOutPoints[i] = matrix.TransformPoint(pPoints[i]);
+    }
+
+    /// 行列の配列を親の行列と乗算します。変換の階層を更新する際に使用します。
+    /// 入力と出力は同じ配列でも構いません。
+    /// @param parent 親の行列です。
+    /// @param pLocals 子の行列の配列です。
+    /// @param pOutWorlds 積を受け取る配列です。
+    /// @param count 行列の数です。
+    inline Void MultiplyMatrices(const Mat4 &parent, const Mat4 *pLocals, Mat4 *pOutWorlds, USize count) noexcept
+    {
+        for (USize i = 0; i < count; i++) pOutWorlds[i] = parent * pLocals[i];
+    }
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// 中心と平面への投影半径から、視錐台と重なる要素のビットを求めます。
+        /// @param radiusOf 平面の添字から投影半径を求める関数です。
+        template<typename Fn>
+        inline U32 _InsideBits(const Frustum &frustum, _F32xN x, _F32xN y, _F32xN z, Fn radiusOf) noexcept
+        {
+            U32 bits = ~0U;
+            for (USize p = 0; p < 6; p++)
+            {
+                Var &plane = frustum.planes[p];
+                Var distance = _Add(_Add(_Mul(_SplatN(plane.x), x), _Mul(_SplatN(plane.y), y)), _Add(_Mul(_SplatN(plane.z), z), _SplatN(plane.w)));
+                bits &= _MoveMask(_LessEqual(_Sub(_SplatN(0.0f), radiusOf(plane)), distance));
+            }
+            return bits;
+        }
+
+        /// 要素毎の可視性を書き込み、可視の要素数を返します。
+        inline USize _WriteVisibility(U32 bits, Bool *pVisible, USize count) noexcept
+        {
+            for (USize lane = 0; lane < count; lane++) pVisible[lane] = (bits >> lane) & 1;
+            return PopCount(bits & ((1ULL << count) - 1));
+        }
+    }
+    /// @endcond
+
+    /// SoAで格納した球の配列を視錐台で判定します。
+    /// @param frustum 視錐台です。
+    /// @param pX 中心のX成分の配列です。
+    /// @param pY 中心のY成分の配列です。
+    /// @param pZ 中心のZ成分の配列です。
+    /// @param pRadius 半径の配列です。
+    /// @param pVisible 視錐台と重なるかを受け取る配列です。
+    /// @param count 球の数です。
+    /// @return 視錐台と重なる球の数です。
+    inline USize CullSpheres(const Frustum &frustum, const F32 *pX, const F32 *pY, const F32 *pZ, const F32 *pRadius, Bool *pVisible, USize count) noexcept
+    {
+        using namespace _Internal;
+        USize visibleCount = 0;
+        USize i = 0;
+        for (; i + F32_SIMD_WIDTH <= count; i += F32_SIMD_WIDTH)
+        {
+            Var radius = _LoadN(pRadius + i);
+            Var bits = _InsideBits(frustum, _LoadN(pX + i), _LoadN(pY + i), _LoadN(pZ + i), [&](const Vec4 &) { return radius; });
+            visibleCount += _WriteVisibility(bits, pVisible + i, F32_SIMD_WIDTH);
+        }
+        if (i < count)
+        {
+            // 端数はゼロで埋めた一時配列で処理します
+            alignas(32) F32 x[F32_SIMD_WIDTH] = {}, y[F32_SIMD_WIDTH] = {}, z[F32_SIMD_WIDTH] = {}, r[F32_SIMD_WIDTH] = {};
+            for (USize lane = 0; i + lane < count; lane++)
+            {
+                x[lane] = pX[i + lane], y[lane] = pY[i + lane], z[lane] = pZ[i + lane], r[lane] = pRadius[i + lane];
+            }
+            Var radius = _LoadN(r);
+            Var bits = _InsideBits(frustum, _LoadN(x), _LoadN(y), _LoadN(z), [&](const Vec4 &) { return radius; });
+            visibleCount += _WriteVisibility(bits, pVisible + i, count - i);
+        }
+        return visibleCount;
+    }
+
+    /// SoAで格納した境界ボックスの配列を視錐台で判定します。
+    /// @param frustum 視錐台です。
+    /// @param pCenterX 中心のX成分の配列です。
+    /// @param pCenterY 中心のY成分の配列です。
+    /// @param pCenterZ 中心のZ成分の配列です。
+    /// @param pExtentX 中心から面までのX方向の距離の配列です。
+    /// @param pExtentY 中心から面までのY方向の距離の配列です。
+    /// @param pExtentZ 中心から面までのZ方向の距離の配列です。
+    /// @param pVisible 視錐台と重なるかを受け取る配列です。
+    /// @param count 境界ボックスの数です。
+    /// @return 視錐台と重なる境界ボックスの数です。
+    inline USize CullBoxes(const Frustum &frustum, const F32 *pCenterX, const F32 *pCenterY, const F32 *pCenterZ, const F32 *pExtentX, const F32 *pExtentY, const F32 *pExtentZ, Bool *pVisible, USize count) noexcept
+    {
+        using namespace _Internal;
+        Var process = [&](const F32 *pX, const F32 *pY, const F32 *pZ, const F32 *pEX, const F32 *pEY, const F32 *pEZ)
+        {
+            Var ex = _LoadN(pEX);
+            Var ey = _LoadN(pEY);
+            Var ez = _LoadN(pEZ);
+            return _InsideBits(frustum, _LoadN(pX), _LoadN(pY), _LoadN(pZ), [&](const Vec4 &plane)
+            {
+                // 箱を平面の法線へ投影した半径です
+                return _Add(_Add(_Mul(_SplatN(std::fabs(plane.x)), ex), _Mul(_SplatN(std::fabs(plane.y)), ey)), _Mul(_SplatN(std::fabs(plane.z)), ez));
+            });
+        };
+        USize visibleCount = 0;
+        USize i = 0;
+        for (; i + F32_SIMD_WIDTH <= count; i += F32_SIMD_WIDTH)
+        {
+            Var bits = process(pCenterX + i, pCenterY + i, pCenterZ + i, pExtentX + i, pExtentY + i, pExtentZ + i);
+            visibleCount += _WriteVisibility(bits, pVisible + i, F32_SIMD_WIDTH);
+        }
+        if (i < count)
+        {
+            // 端数はゼロで埋めた一時配列で処理します
+            alignas(32) F32 x[F32_SIMD_WIDTH] = {}, y[F32_SIMD_WIDTH] = {}, z[F32_SIMD_WIDTH] = {};
+            alignas(32) F32 ex[F32_SIMD_WIDTH] = {}, ey[F32_SIMD_WIDTH] = {}, ez[F32_SIMD_WIDTH] = {};
+            for (USize lane = 0; i + lane < count; lane++)
+            {
+                x[lane] = pCenterX[i + lane], y[lane] = pCenterY[i + lane], z[lane] = pCenterZ[i + lane];
+                ex[lane] = pExtentX[i + lane], ey[lane] = pExtentY[i + lane], ez[lane] = pExtentZ[i + lane];
+            }
+            visibleCount += _WriteVisibility(process(x, y, z, ex, ey, ez), pVisible + i, count - i);
+        }
+        return visibleCount;
+    }
+}
+
+#endif // !_LEYENGINE_MATH_HPP
\ No newline at end of file
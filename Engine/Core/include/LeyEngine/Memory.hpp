@@ -26,8 +26,82 @@ namespace LeyEngine
         ZERO_SIZE,
         /// メモリ確保に失敗しました。
         BAD_DEALLOCATE,
+        /// ポインタが確保したメモリの先頭を指していませんでした。
+        INVALID_POINTER,
+        /// 解放済みのメモリを解放しようとしました。
+        DOUBLE_DEALLOCATE,
+        /// 確保したメモリの範囲外への書き込みを検出しました。
+        CORRUPTED,
     };
 
+    /// メモリプールのサイズクラスの数です。
+    constexpr USize MEMORY_SIZE_CLASS_COUNT = 9;
+
+    /// メモリプールを分けて管理するNUMAノード数の最大値です。
+    constexpr USize MEMORY_NUMA_NODE_CAPACITY = 8;
+
+    /// メモリプールのサイズクラス毎の統計情報です。
+    struct MemorySizeClassStats
+    {
+        /// 要素のバイトサイズです。
+        USize elementSize;
+        /// プールの数です。
+        USize poolCount;
+        /// すべてのプールが管理する要素数です。
+        USize elementsCount;
+        /// 使用中の要素数です。
+        USize usedCount;
+        /// 使用中の要素数の最大値です。
+        USize peakUsedCount;
+        /// NUMAノード毎の使用中の要素数の最大値です。
+        USize nodePeakUsedCounts[MEMORY_NUMA_NODE_CAPACITY];
+    };
+
+    /// メモリシステムの統計情報です。
+    struct MemoryStats
+    {
+        /// 確保に成功した回数です。
+        USize allocateCount;
+        /// 解放に成功した回数です。
+        USize deallocateCount;
+        /// 使用中のバイトサイズです。
+        USize usedSize;
+        /// 使用中のバイトサイズの最大値です。
+        USize peakUsedSize;
+        /// プールを経由せず確保した使用中のバイトサイズです。
+        USize largeUsedSize;
+        /// サイズクラス毎の統計情報です。
+        /// NUMAノードが複数ある場合はすべてのノードの合計です。
+        MemorySizeClassStats sizeClasses[MEMORY_SIZE_CLASS_COUNT];
+        /// メモリプールを分けて管理しているNUMAノード数です。
+        USize numaNodeCount;
+        /// 確保したメモリの先頭以外を解放しようとした回数です。
+        /// LEYENGINE_MEMORY_GUARDが定義されている場合のみ記録されます。
+        USize invalidDeallocateCount;
+        /// 解放済みのメモリを解放しようとした回数です。
+        /// LEYENGINE_MEMORY_GUARDが定義されている場合のみ記録されます。
+        USize doubleDeallocateCount;
+        /// 確保したメモリの範囲外への書き込みを検出した回数です。
+        /// LEYENGINE_MEMORY_GUARDが定義されている場合のみ記録されます。
+        USize corruptionCount;
+        /// 解放済みのメモリへの書き込みを検出した回数です。
+        /// LEYENGINE_MEMORY_GUARDが定義されている場合のみ記録されます。
+        USize useAfterFreeCount;
+    };
+
+    /// キャッシュラインのバイトサイズです。
+    /// 複数スレッドから更新される値を別のキャッシュラインへ分ける際に使用します。
+    constexpr USize CACHE_LINE_SIZE = 64;
+
+    /// 値をアライメントの倍数に切り上げます。
+    /// @param value 切り上げる値です。
+    /// @param alignment アライメントです。2の累乗である必要があります。
+    /// @return 切り上げた値です。
+    constexpr USize AlignUp(USize value, USize alignment) noexcept
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
     /// 標準メモリからメモリを確保します。
     /// @param size 確保するバイトサイズです。
     /// @return 確保したメモリのポインタ、または、エラーです。
@@ -39,6 +113,365 @@ namespace LeyEngine
     /// @return SUCCESS、または、エラーです。
     Result<Success, EDeallocateError> Deallocate(USize size, Void *pointer) noexcept;
 
+    /// アライメントを指定して標準メモリからメモリを確保します。
+    /// 確保したメモリはDeallocateAlignedで解放する必要があります。
+    /// @param size 確保するバイトサイズです。
+    /// @param alignment アライメントです。2の累乗である必要があります。
+    /// @return 確保したメモリのポインタ、または、エラーです。
+    inline Result<Void*, EAllocateError> AllocateAligned(USize size, USize alignment) noexcept
+    {
+        // 先頭に元のポインタを格納する領域を含めて確保します
+        return Allocate(size + alignment + sizeof(Void*)).Map([alignment](Void *ptr) noexcept
+        {
+            Var adr = AlignUp(Cast<USize>(ptr) + sizeof(Void*), alignment);
+            Cast<Void**>(adr)[-1] = ptr;
+            return Cast<Void*>(adr);
+        });
+    }
+
+    /// AllocateAlignedで確保したメモリを解放します。
+    /// @param size 解放するメモリのバイトサイズです。
+    /// @param alignment 確保時に指定したアライメントです。
+    /// @param pointer 解放するメモリのポインタです。
+    /// @return SUCCESS、または、エラーです。
+    inline Result<Success, EDeallocateError> DeallocateAligned(USize size, USize alignment, Void *pointer) noexcept
+    {
+        if (pointer == NONE) return EDeallocateError::BAD_DEALLOCATE;
+        return Deallocate(size + alignment + sizeof(Void*), Cast<Void**>(pointer)[-1]);
+    }
+
+    /// メモリシステムの統計情報を返します。
+    /// @return 統計情報です。
+    MemoryStats GetMemoryStats() noexcept;
+
+    /// メモリの確保元を表すタグです。
+    /// 識別子はHashFnv1a32などで名前から求め、NameMemoryTagで名前を登録することを想定しています。
+    struct MemoryTag
+    {
+        /// 確保したモジュールの識別子です。0は不明を表します。
+        U32 module;
+        /// 確保した箇所の識別子です。0は不明を表します。
+        U32 callsite;
+    };
+
+    /// 現在のスレッドで以降に確保するメモリのタグを設定します。
+    /// LEYENGINE_MEMORY_TRACKINGが定義されている場合のみ記録されます。
+    /// @param tag 設定するタグです。
+    /// @return 設定前のタグです。
+    MemoryTag SetMemoryTag(MemoryTag tag) noexcept;
+
+    /// 以降に確保するメモリに記録するフレーム番号を設定します。
+    /// フレームの境界で呼び出すことを想定しています。
+    /// @param frame フレーム番号です。
+    Void SetMemoryFrame(U64 frame) noexcept;
+
+    /// スコープの間、現在のスレッドで確保するメモリのタグを設定します。
+    struct MemoryTagScope
+    {
+    private:
+
+        MemoryTag m_previous;   // 設定前のタグ
+
+    public:
+
+        /// タグを設定します。
+        /// @param tag 設定するタグです。
+        explicit MemoryTagScope(MemoryTag tag) noexcept
+            : m_previous(SetMemoryTag(tag))
+        {
+        }
+
+        MemoryTagScope(const MemoryTagScope&) = delete;
+        MemoryTagScope &operator=(const MemoryTagScope&) = delete;
+
+        /// 設定前のタグに戻します。
+        ~MemoryTagScope() noexcept
+        {
+            (Void)SetMemoryTag(this->m_previous);
+        }
+    };
+
+    /// メモリスナップショットのエラーです。
+    enum class EMemorySnapshotError
+    {
+        /// 引数が不正でした。
+        INVALID_ARGUMENT,
+        /// LEYENGINE_MEMORY_TRACKINGが定義されていないため記録していませんでした。
+        NOT_TRACKED,
+        /// メモリ確保に失敗しました。
+        BAD_ALLOCATE,
+        /// ファイルを開けませんでした。
+        OPEN_FAILED,
+        /// ファイルの書き込みに失敗しました。
+        WRITE_FAILED,
+    };
+
+    /// タグの識別子に名前を登録します。
+    /// 名前はコピーするため、登録したモジュールを解放した後もスナップショットに含まれます。
+    /// @param id モジュール、または、確保した箇所の識別子です。
+    /// @param name UTF-8の名前です。
+    /// @param nameSize 名前のバイトサイズです。
+    /// @return SUCCESS、または、エラーです。
+    Result<Success, EMemorySnapshotError> NameMemoryTag(U32 id, const Char *name, USize nameSize) noexcept;
+
+    /// スナップショットに記録した使用中のメモリブロックです。
+    struct MemoryBlockInfo
+    {
+        /// 先頭のアドレスです。
+        U64 address;
+        /// 確保した順の通し番号です。アドレスが再利用されても異なります。
+        U64 serial;
+        /// 確保したフレーム番号です。
+        U64 frame;
+        /// 確保を要求したバイトサイズです。
+        U64 size;
+        /// サイズクラスの位置です。プールを経由しない場合はMEMORY_SIZE_CLASS_COUNTです。
+        U32 sizeClass;
+        /// 確保したモジュールの識別子です。
+        U32 module;
+        /// 確保した箇所の識別子です。
+        U32 callsite;
+        /// 予約領域です。
+        U32 reserved;
+    };
+
+    /// スナップショットに記録したタグの名前です。
+    struct MemoryTagName
+    {
+        /// タグの識別子です。
+        U32 id;
+        /// 名前のバイトサイズです。
+        U32 nameSize;
+        /// 名前の領域の先頭からのバイトオフセットです。
+        U64 nameOffset;
+    };
+
+    /// メモリスナップショットファイルの先頭のマジックナンバー「LEYM」です。
+    constexpr U32 MEMORY_SNAPSHOT_MAGIC = 0x4D59454C;
+
+    /// メモリスナップショットファイルの形式のバージョンです。
+    constexpr U32 MEMORY_SNAPSHOT_VERSION = 1;
+
+    /// 差分のスナップショットであることを表すフラグです。
+    constexpr U32 MEMORY_SNAPSHOT_DIFF = 1;
+
+    /// メモリスナップショットファイルのヘッダーです。
+    /// ヘッダーの後にblockCount個とfreedBlockCount個のMemoryBlockInfo、
+    /// nameCount個のMemoryTagName、nameTextSizeバイトの名前の領域が続きます。
+    struct MemorySnapshotHeader
+    {
+        /// マジックナンバーです。
+        U32 magic;
+        /// 形式のバージョンです。
+        U32 version;
+        /// MEMORY_SNAPSHOT_DIFFなどのフラグです。
+        U32 flags;
+        /// 予約領域です。
+        U32 reserved;
+        /// 取得したフレーム番号です。
+        U64 frame;
+        /// 差分の場合、比較元のフレーム番号です。
+        U64 baseFrame;
+        /// 使用中、または、差分で新たに確保されたブロック数です。
+        U64 blockCount;
+        /// 差分で解放されたブロック数です。
+        U64 freedBlockCount;
+        /// タグの名前の数です。
+        U64 nameCount;
+        /// 名前の領域のバイトサイズです。
+        U64 nameTextSize;
+    };
+
+    /// ある時点の使用中のすべてのメモリブロック、または、2つの時点の差分です。
+    /// 標準メモリから確保し、破棄時に解放します。
+    /// ブロックは確保した順に整列しています。
+    struct MemorySnapshot
+    {
+    private:
+
+        U8 *m_pBuffer;                     // ブロックと名前を格納するバッファ
+        USize m_bufferSize;                // バッファのバイトサイズ
+        U32 m_flags;                       // フラグ
+        U64 m_frame;                       // 取得したフレーム番号
+        U64 m_baseFrame;                   // 比較元のフレーム番号
+        MemoryBlockInfo *m_pBlocks;        // 使用中、または、新たに確保されたブロック
+        USize m_blockCount;                // ブロック数
+        MemoryBlockInfo *m_pFreedBlocks;   // 解放されたブロック
+        USize m_freedBlockCount;           // 解放されたブロック数
+        MemoryTagName *m_pNames;           // タグの名前
+        USize m_nameCount;                 // タグの名前の数
+        const Char *m_pNameText;           // 名前の領域
+        USize m_nameTextSize;              // 名前の領域のバイトサイズ
+
+        // 作成します。
+        MemorySnapshot(U8 *pBuffer, USize bufferSize, const MemorySnapshotHeader &header) noexcept;
+
+        // ヘッダーの要素数に合わせてバッファを確保し、作成します。
+        static Result<MemorySnapshot, EMemorySnapshotError> Create(const MemorySnapshotHeader &header) noexcept;
+
+    public:
+
+        /// 現在使用中のすべてのメモリブロックを記録します。
+        /// LEYENGINE_MEMORY_TRACKINGが定義されている場合のみ取得できます。
+        /// @return スナップショット、または、エラーです。
+        static Result<MemorySnapshot, EMemorySnapshotError> Take() noexcept;
+
+        /// 2つのスナップショットの差分を求めます。
+        /// 比較元の後に確保され比較先で使用中のブロックと、比較元で使用中で比較先までに解放されたブロックを記録します。
+        /// @param before 比較元のスナップショットです。
+        /// @param after 比較先のスナップショットです。
+        /// @return 差分のスナップショット、または、エラーです。
+        static Result<MemorySnapshot, EMemorySnapshotError> Diff(const MemorySnapshot &before, const MemorySnapshot &after) noexcept;
+
+        MemorySnapshot(const MemorySnapshot&) = delete;
+        MemorySnapshot &operator=(const MemorySnapshot&) = delete;
+
+        /// ムーブコンストラクタです。
+        /// @param origin 元のスナップショットです。
+        MemorySnapshot(MemorySnapshot &&origin) noexcept;
+
+        /// デストラクタです。
+        ~MemorySnapshot() noexcept;
+
+        /// 差分か判定します。
+        /// @retval true 差分です。
+        /// @retval false ある時点のスナップショットです。
+        Bool IsDiff() const noexcept;
+
+        /// 取得したフレーム番号を返します。
+        /// @return フレーム番号です。
+        U64 Frame() const noexcept;
+
+        /// 差分の場合、比較元のフレーム番号を返します。
+        /// @return フレーム番号です。
+        U64 BaseFrame() const noexcept;
+
+        /// 使用中、または、差分で新たに確保されたブロック数を返します。
+        /// @return ブロック数です。
+        USize BlockCount() const noexcept;
+
+        /// 使用中、または、差分で新たに確保されたブロックを返します。
+        /// @param index ブロックのインデックスです。
+        /// @return ブロックです。
+        const MemoryBlockInfo &BlockAt(USize index) const noexcept;
+
+        /// 差分で解放されたブロック数を返します。
+        /// @return ブロック数です。
+        USize FreedBlockCount() const noexcept;
+
+        /// 差分で解放されたブロックを返します。
+        /// @param index ブロックのインデックスです。
+        /// @return ブロックです。
+        const MemoryBlockInfo &FreedBlockAt(USize index) const noexcept;
+
+        /// タグの名前を検索します。
+        /// @param id タグの識別子です。
+        /// @param nameSize 名前のバイトサイズを受け取ります。
+        /// @return 名前、または、登録されていない場合はNONEです。
+        const Char *NameOf(U32 id, USize &nameSize) const noexcept;
+
+        /// オフラインのビューアで読み込めるファイルに書き込みます。
+        /// ファイルの形式はMemorySnapshotHeaderを参照してください。
+        /// @param path UTF-8のファイルパスです。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, EMemorySnapshotError> Write(const Char *path) const noexcept;
+    };
+
+    /// メモリプールのプロファイルのエラーです。
+    enum class EMemoryPoolProfileError
+    {
+        /// 引数が不正でした。
+        INVALID_ARGUMENT,
+        /// ファイルを開けませんでした。
+        OPEN_FAILED,
+        /// ファイルの読み込みに失敗しました。
+        READ_FAILED,
+        /// ファイルの書き込みに失敗しました。
+        WRITE_FAILED,
+        /// ファイルの形式が不正でした。
+        INVALID_FORMAT,
+    };
+
+    /// メモリプールのプロファイルファイルの先頭のマジックナンバー「LEYP」です。
+    constexpr U32 MEMORY_POOL_PROFILE_MAGIC = 0x5059454C;
+
+    /// メモリプールのプロファイルファイルの形式のバージョンです。
+    constexpr U32 MEMORY_POOL_PROFILE_VERSION = 2;
+
+    /// 前回の実行で必要になったメモリプールの構成です。
+    /// 終了前などにCaptureMemoryPoolProfileで取得してファイルに書き込み、次回のメモリシステムの初期化時にReadMemoryPoolProfileで読み込んでWarmMemoryPoolsで事前にプールを作成します。
+    /// そのままファイルの形式でもあります。
+    struct MemoryPoolProfile
+    {
+        /// マジックナンバーです。
+        U32 magic;
+        /// 形式のバージョンです。
+        U32 version;
+        /// サイズクラス毎の要素のバイトサイズです。
+        U64 elementSizes[MEMORY_SIZE_CLASS_COUNT];
+        /// サイズクラス毎に取得時点で作成されていたプールの数です。
+        U64 poolCounts[MEMORY_SIZE_CLASS_COUNT];
+        /// サイズクラス毎に同時に使用された要素数の最大値です。
+        /// NUMAノード数が取得時と異なる場合に、事前に作成する要素数として使用します。
+        U64 elementsCounts[MEMORY_SIZE_CLASS_COUNT];
+        /// 取得時点のNUMAノード数です。
+        U64 numaNodeCount;
+        /// NUMAノード毎、サイズクラス毎に同時に使用された要素数の最大値です。事前に作成する要素数として使用します。
+        U64 nodeElementsCounts[MEMORY_NUMA_NODE_CAPACITY][MEMORY_SIZE_CLASS_COUNT];
+    };
+
+    /// 現在のメモリシステムの統計情報からメモリプールのプロファイルを作成します。
+    /// @return プロファイルです。
+    inline MemoryPoolProfile CaptureMemoryPoolProfile() noexcept
+    {
+        Var stats = GetMemoryStats();
+        MemoryPoolProfile profile = {};
+        profile.magic = MEMORY_POOL_PROFILE_MAGIC;
+        profile.version = MEMORY_POOL_PROFILE_VERSION;
+        for (USize i = 0; i < MEMORY_SIZE_CLASS_COUNT; i++)
+        {
+            profile.elementSizes[i] = stats.sizeClasses[i].elementSize;
+            profile.poolCounts[i] = stats.sizeClasses[i].poolCount;
+            profile.elementsCounts[i] = stats.sizeClasses[i].peakUsedCount;
+            for (USize node = 0; node < stats.numaNodeCount; node++)
+            {
+                profile.nodeElementsCounts[node][i] = stats.sizeClasses[i].nodePeakUsedCounts[node];
+            }
+        }
+        profile.numaNodeCount = stats.numaNodeCount;
+        return profile;
+    }
+
+    /// メモリプールのプロファイルをファイルに書き込みます。
+    /// @param profile プロファイルです。
+    /// @param path UTF-8のファイルパスです。
+    /// @return SUCCESS、または、エラーです。
+    Result<Success, EMemoryPoolProfileError> WriteMemoryPoolProfile(const MemoryPoolProfile &profile, const Char *path) noexcept;
+
+    /// メモリプールのプロファイルをファイルから読み込みます。
+    /// @param path UTF-8のファイルパスです。
+    /// @return プロファイル、または、エラーです。
+    Result<MemoryPoolProfile, EMemoryPoolProfileError> ReadMemoryPoolProfile(const Char *path) noexcept;
+
+    /// プロファイルの要素数に足りない分のメモリプールを事前に作成します。
+    /// NUMAノード数が取得時と同じ場合は各ノードにそのノードの要素数の最大値で作成し、異なる場合はすべてのノードの合計を現在のスレッドのノードに作成します。
+    /// 作成したプールは物理ページを割り当て済みのため、以降の確保でページフォールトやプールの追加が起こりません。
+    /// 要素のバイトサイズが現在の構成と異なるサイズクラスは無視します。
+    /// @param profile プロファイルです。
+    /// @param isBackground YESの場合はバックグラウンドのスレッドで作成し、完了を待たずに戻ります。
+    /// @return SUCCESS、または、エラーです。バックグラウンドで作成する場合は作成時のエラーを返しません。
+    Result<Success, EAllocateError> WarmMemoryPools(const MemoryPoolProfile &profile, Bool isBackground = YES) noexcept;
+
+    /// バックグラウンドでのメモリプールの作成の完了を待ちます。
+    /// 作成中でない場合はすぐに戻ります。
+    Void WaitMemoryPoolsWarmed() noexcept;
+
+    /// バックグラウンドでのメモリプールの作成を中断し、作成するスレッドの終了を待ちます。
+    /// 作成中でない場合はすぐに戻ります。
+    /// モジュールの解放やプログラムの終了の前に呼び出す必要があります。
+    /// 呼び出さずに終了した場合、作成中のスレッドは待たずに切り離します。
+    Void StopMemoryPoolWarming() noexcept;
+
     /// 標準メモリアロケータです。
     /// @tparam T 要素の型です。
     template<typename T>
@@ -58,27 +491,25 @@ namespace LeyEngine
         {}
 
         /// コピーコンストラクタです。
-        /// @param origin コピー元です。
-        Allocator(const Allocator<TElement> &origin) noexcept
+        Allocator(const Allocator<TElement> &) noexcept
         {}
 
         /// ムーブコンストラクタです。
-        /// @param origin ムーブ元です。
-        Allocator(Allocator<TElement> &&origin) noexcept
+        Allocator(Allocator<TElement> &&) noexcept
         {}
 
         /// コピー代入します。
         /// @param origin コピー元です。
         Allocator<TElement> &operator=(const Allocator<TElement> &origin) noexcept
         {
-            return this;
+            return *this;
         }
 
         /// ムーブ代入します。
         /// @param origin ムーブ元です。
         Allocator<TElement> &operator=(Allocator<TElement> &&origin) noexcept
         {
-            return this;
+            return *this;
         }
 
         /// メモリを確保します。
@@ -86,17 +517,10 @@ namespace LeyEngine
         /// @return 確保したポインタ、または、エラーです。
         Result<TElement*, TAllocateError> Allocate(USize count) noexcept
         {
-            Var res = LeyEngine::Allocate(sizeof(TElement) * count);
-            Void *ptr;
-            TAllocateError err;
-            if (res.IsSuccess(ptr, err))
+            return LeyEngine::Allocate(sizeof(TElement) * count).Map([](Void *ptr) noexcept
             {
                 return Cast<TElement*>(ptr);
-            }
-            else
-            {
-                return err;
-            }
+            });
         }
 
         /// メモリを解放します。
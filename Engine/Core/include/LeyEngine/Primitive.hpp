@@ -5,6 +5,7 @@
 #ifndef _LEYENGINE_PRIMITIVE_HPP
 #define _LEYENGINE_PRIMITIVE_HPP
 
+#include <cmath>
 #include <cstddef>
 #include <limits>
 #include "LeyEngine/Preprocess.hpp"
@@ -43,7 +44,7 @@ namespace LeyEngine
 
 #if __cplusplus >= 202002L
     /// 文字型です。
-    using Char = char8_t
+    using Char = char8_t;
 #else
     /// 文字型です。
     using Char = char;
@@ -132,7 +133,7 @@ namespace LeyEngine
     /// @retval false 差が誤差の範囲外です。
     inline Bool Equal(F32 l, F32 r)
     {
-        return fabsf(l - r) <= F32_EPSILON * fmaxf(1.0f, fmaxf(fabsf(l), fabsf(r)));
+        return std::fabs(l - r) <= F32_EPSILON * std::fmax(1.0f, std::fmax(std::fabs(l), std::fabs(r)));
     }
 
     /// 誤差を考慮して等しいか比較します。
@@ -142,7 +143,7 @@ namespace LeyEngine
     /// @retval false 差が誤差の範囲外です。
     inline Bool Equal(F64 l, F64 r)
     {
-        return fabs(l - r) <= F64_EPSILON * fmax(1.0, fmax(fabs(l), fabs(r)));
+        return std::fabs(l - r) <= F64_EPSILON * std::fmax(1.0, std::fmax(std::fabs(l), std::fabs(r)));
     }
 }
 
@@ -0,0 +1,533 @@
+/// @file LeyEngine/String.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// 文字列型、文字列の参照、インターンした名前を提供します。
+#ifndef _LEYENGINE_STRING_HPP
+#define _LEYENGINE_STRING_HPP
+
+#include "LeyEngine/Hash.hpp"
+#include "LeyEngine/Memory.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// 文字列の読み取り専用の参照です。
+    /// 終端文字を含むとは限りません。
+    struct StringView
+    {
+    private:
+
+        const Char *m_pData;    // 先頭
+        USize m_size;           // バイトサイズ
+
+    public:
+
+        /// 空の参照を作成します。
+        constexpr StringView() noexcept
+            : m_pData(TXT(""))
+            , m_size(0)
+        {
+        }
+
+        /// 作成します。
+        /// @param pData 先頭です。
+        /// @param size バイトサイズです。
+        constexpr StringView(const Char *pData, USize size) noexcept
+            : m_pData(pData)
+            , m_size(size)
+        {
+        }
+
+        /// 終端文字までを参照します。
+        /// @param pData 終端文字で終わる文字列です。
+        constexpr StringView(const Char *pData) noexcept
+            : m_pData(pData)
+            , m_size(0)
+        {
+            while (pData[this->m_size] != 0) this->m_size++;
+        }
+
+        /// 先頭を返します。
+        /// @return 先頭です。
+        constexpr const Char *Data() const noexcept
+        {
+            return this->m_pData;
+        }
+
+        /// バイトサイズを返します。
+        /// @return バイトサイズです。
+        constexpr USize Size() const noexcept
+        {
+            return this->m_size;
+        }
+
+        /// 空かを返します。
+        /// @retval true 空です。
+        /// @retval false 空ではありません。
+        constexpr Bool IsEmpty() const noexcept
+        {
+            return this->m_size == 0;
+        }
+
+        /// 部分文字列を参照します。
+        /// @param offset 開始位置です。
+        /// @param size バイトサイズです。範囲を超える場合は末尾までを参照します。
+        /// @return 部分文字列です。
+        constexpr StringView Substring(USize offset, USize size) const noexcept
+        {
+            if (offset > this->m_size) offset = this->m_size;
+            if (size > this->m_size - offset) size = this->m_size - offset;
+            return StringView(this->m_pData + offset, size);
+        }
+
+        /// 文字列のwyhash方式のハッシュ値を返します。
+        /// 定数式で計算でき、Name::Createに事前計算した値として渡せます。
+        /// @return ハッシュ値です。
+        constexpr U64 Hash() const noexcept
+        {
+            return HashWy(this->m_pData, this->m_size);
+        }
+
+        /// 文字にアクセスします。
+        /// @param index インデックスです。
+        /// @return 文字です。
+        constexpr Char operator[](USize index) const noexcept
+        {
+            return this->m_pData[index];
+        }
+
+        /// 先頭を返します。
+        /// @return 先頭です。
+        constexpr const Char *begin() const noexcept
+        {
+            return this->m_pData;
+        }
+
+        /// 末尾を返します。
+        /// @return 末尾です。
+        constexpr const Char *end() const noexcept
+        {
+            return this->m_pData + this->m_size;
+        }
+
+        /// 文字列が同等か比較します。
+        /// @param other 比較対象です。
+        /// @return 同等の場合、真です。
+        constexpr Bool operator==(const StringView &other) const noexcept
+        {
+            if (this->m_size != other.m_size) return NO;
+            for (USize i = 0; i < this->m_size; i++)
+            {
+                if (this->m_pData[i] != other.m_pData[i]) return NO;
+            }
+            return YES;
+        }
+
+        /// 文字列が不等か比較します。
+        /// @param other 比較対象です。
+        /// @return 不等の場合、真です。
+        constexpr Bool operator!=(const StringView &other) const noexcept
+        {
+            return !(*this == other);
+        }
+    };
+
+    /// 文字列型が確保せずに格納できる最大のバイトサイズです。
+    constexpr USize STRING_SMALL_CAPACITY = 15;
+
+    /// 終端文字で終わる可変長の文字列型です。
+    /// STRING_SMALL_CAPACITY以下の文字列は確保せずに自身に格納します。
+    /// @tparam A 文字アロケータです。
+    template<typename A = Allocator<Char>>
+    struct BasicString
+    {
+        /// アロケータの型です。
+        using TAllocator = A;
+
+        /// アロケート時のエラー型です。
+        using TAllocateError = typename TAllocator::TAllocateError;
+
+        /// デアロケート時のエラー型です。
+        using TDeallocateError = typename TAllocator::TDeallocateError;
+
+    private:
+
+        TAllocator m_allocator; // アロケータ
+        USize m_size;           // バイトサイズ
+        USize m_capacity;       // 終端文字を除く容量、自身に格納している間はSTRING_SMALL_CAPACITY
+        union
+        {
+            Char *m_pData;                              // 確保した文字列
+            Char m_small[STRING_SMALL_CAPACITY + 1];    // 自身に格納した文字列
+        };
+
+        // 確保した文字列を解放します。
+        Void Release() noexcept
+        {
+            if (!this->IsSmall()) (Void)this->m_allocator.Deallocate(this->m_capacity + 1, this->m_pData);
+        }
+
+        // 確保した文字列を受け取ります。
+        Void Take(BasicString &origin) noexcept
+        {
+            this->m_size = origin.m_size;
+            this->m_capacity = origin.m_capacity;
+            if (origin.IsSmall())
+            {
+                for (USize i = 0; i <= origin.m_size; i++) this->m_small[i] = origin.m_small[i];
+            }
+            else
+            {
+                this->m_pData = origin.m_pData;
+            }
+            origin.m_size = 0;
+            origin.m_capacity = STRING_SMALL_CAPACITY;
+            origin.m_small[0] = 0;
+        }
+
+    public:
+
+        /// 空の文字列を作成します。
+        /// @param allocator アロケータです。
+        explicit BasicString(const TAllocator &allocator = TAllocator()) noexcept
+            : m_allocator(allocator)
+            , m_size(0)
+            , m_capacity(STRING_SMALL_CAPACITY)
+        {
+            this->m_small[0] = 0;
+        }
+
+        /// 文字列をコピーして作成します。
+        /// @param view コピーする文字列です。
+        /// @param allocator アロケータです。
+        /// @return 文字列、または、エラーです。
+        static Result<BasicString<TAllocator>, TAllocateError> Create(StringView view, const TAllocator &allocator = TAllocator()) noexcept
+        {
+            BasicString<TAllocator> string(allocator);
+            Var result = string.Append(view);
+            if (result.IsFailure()) return result.Error();
+            return Move(string);
+        }
+
+        BasicString(const BasicString&) = delete;
+        BasicString &operator=(const BasicString&) = delete;
+
+        /// ムーブします。
+        /// @param origin ムーブ元です。
+        BasicString(BasicString<TAllocator> &&origin) noexcept
+            : m_allocator(Move(origin.m_allocator))
+        {
+            this->Take(origin);
+        }
+
+        /// ムーブ代入します。
+        /// @param origin ムーブ元です。
+        /// @return 自身です。
+        BasicString<TAllocator> &operator=(BasicString<TAllocator> &&origin) noexcept
+        {
+            if (this != &origin)
+            {
+                this->Release();
+                this->m_allocator = Move(origin.m_allocator);
+                this->Take(origin);
+            }
+            return *this;
+        }
+
+        /// デストラクタです。
+        ~BasicString() noexcept
+        {
+            this->Release();
+        }
+
+        /// 同じアロケータで複製します。
+        /// @return 複製した文字列、または、エラーです。
+        Result<BasicString<TAllocator>, TAllocateError> Clone() const noexcept
+        {
+            return Create(this->View(), this->m_allocator);
+        }
+
+        /// バイトサイズを返します。
+        /// @return バイトサイズです。
+        USize Size() const noexcept
+        {
+            return this->m_size;
+        }
+
+        /// 確保し直さずに格納できるバイトサイズを返します。
+        /// @return バイトサイズです。
+        USize Capacity() const noexcept
+        {
+            return this->m_capacity;
+        }
+
+        /// 空かを返します。
+        /// @retval true 空です。
+        /// @retval false 空ではありません。
+        Bool IsEmpty() const noexcept
+        {
+            return this->m_size == 0;
+        }
+
+        /// 確保せずに自身に格納しているかを返します。
+        /// @retval true 自身に格納しています。
+        /// @retval false 確保したメモリに格納しています。
+        Bool IsSmall() const noexcept
+        {
+            return this->m_capacity == STRING_SMALL_CAPACITY;
+        }
+
+        /// 終端文字で終わる文字列の先頭を返します。
+        /// @return 先頭です。
+        Char *Data() noexcept
+        {
+            return this->IsSmall() ? this->m_small : this->m_pData;
+        }
+
+        /// 終端文字で終わる文字列の先頭を返します。
+        /// @return 先頭です。
+        const Char *Data() const noexcept
+        {
+            return this->IsSmall() ? this->m_small : this->m_pData;
+        }
+
+        /// 文字列を参照します。
+        /// @return 参照です。
+        StringView View() const noexcept
+        {
+            return StringView(this->Data(), this->m_size);
+        }
+
+        /// 文字列を参照します。
+        /// @return 参照です。
+        operator StringView() const noexcept
+        {
+            return this->View();
+        }
+
+        /// 容量を確保します。
+        /// @param capacity 終端文字を除く容量です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Reserve(USize capacity) noexcept
+        {
+            if (capacity <= this->m_capacity) return SUCCESS;
+            Var result = this->m_allocator.Allocate(capacity + 1);
+            if (result.IsFailure()) return result.Error();
+            Var pData = result.Value();
+            const Var pOld = this->Data();
+            for (USize i = 0; i <= this->m_size; i++) pData[i] = pOld[i];
+            this->Release();
+            this->m_pData = pData;
+            this->m_capacity = capacity;
+            return SUCCESS;
+        }
+
+        /// 末尾に文字列を追加します。
+        /// @param view 追加する文字列です。自身を参照していても構いません。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Append(StringView view) noexcept
+        {
+            Var size = this->m_size + view.Size();
+            if (size > this->m_capacity)
+            {
+                // 自身を参照している場合に備えて、確保し直す前に位置を求めます
+                const Var pOld = this->Data();
+                Var isSelf = view.Data() >= pOld && view.Data() <= pOld + this->m_size;
+                Var offset = static_cast<USize>(view.Data() - pOld);
+                Var capacity = this->m_capacity * 2;
+                Var result = this->Reserve(capacity > size ? capacity : size);
+                if (result.IsFailure()) return result;
+                if (isSelf) view = StringView(this->Data() + offset, view.Size());
+            }
+            Var pData = this->Data();
+            for (USize i = 0; i < view.Size(); i++) pData[this->m_size + i] = view[i];
+            this->m_size = size;
+            pData[size] = 0;
+            return SUCCESS;
+        }
+
+        /// 末尾に文字を追加します。
+        /// @param character 追加する文字です。
+        /// @return SUCCESS、または、エラーです。
+        Result<Success, TAllocateError> Append(Char character) noexcept
+        {
+            return this->Append(StringView(&character, 1));
+        }
+
+        /// 空にします。容量は解放しません。
+        Void Clear() noexcept
+        {
+            this->m_size = 0;
+            this->Data()[0] = 0;
+        }
+
+        /// 文字にアクセスします。
+        /// @param index インデックスです。
+        /// @return 文字です。
+        Char &operator[](USize index) noexcept
+        {
+            return this->Data()[index];
+        }
+
+        /// 文字にアクセスします。
+        /// @param index インデックスです。
+        /// @return 文字です。
+        Char operator[](USize index) const noexcept
+        {
+            return this->Data()[index];
+        }
+
+        /// 文字列が同等か比較します。
+        /// @param other 比較対象です。
+        /// @return 同等の場合、真です。
+        Bool operator==(StringView other) const noexcept
+        {
+            return this->View() == other;
+        }
+
+        /// 文字列が不等か比較します。
+        /// @param other 比較対象です。
+        /// @return 不等の場合、真です。
+        Bool operator!=(StringView other) const noexcept
+        {
+            return this->View() != other;
+        }
+    };
+
+    /// 標準メモリから確保する文字列型です。
+    using String = BasicString<>;
+
+    /// 名前のエラーです。
+    enum class ENameError
+    {
+        /// 名前のテーブルが初期化されていませんでした。
+        NOT_INITIALIZED,
+        /// メモリ確保に失敗しました。
+        BAD_ALLOCATE,
+        /// 名前のテーブルが満杯でした。
+        TABLE_FULL,
+    };
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// インターンした名前の項目です。
+        /// 直後に終端文字で終わる文字列が続きます。
+        struct _NameEntry
+        {
+            U64 hash;   // 文字列のハッシュ値
+            USize size; // 文字列のバイトサイズ
+        };
+
+        /// 名前をインターンし、識別子を返します。
+        Result<U32, ENameError> _InternName(const Char *pData, USize size, U64 hash) noexcept;
+
+        /// 識別子から名前の項目を返します。
+        const _NameEntry *_FindNameEntry(U32 id) noexcept;
+    }
+    /// @endcond
+
+    /// インターンした名前です。
+    /// 同じ文字列は同じ識別子になり、比較とハッシュ値の取得は文字列を走査しません。
+    /// 識別子はプロセス内でのみ有効なため、保存や通信にはハッシュ値か文字列を使用します。
+    struct Name
+    {
+    private:
+
+        U32 m_id;   // 識別子、0は空の名前
+
+        // 作成します。
+        explicit constexpr Name(U32 id) noexcept
+            : m_id(id)
+        {
+        }
+
+    public:
+
+        /// 空の名前を作成します。
+        constexpr Name() noexcept
+            : m_id(0)
+        {
+        }
+
+        /// 文字列をインターンして作成します。
+        /// @param view 文字列です。
+        /// @return 名前、または、エラーです。
+        static Result<Name, ENameError> Create(StringView view) noexcept
+        {
+            return Create(view, view.Hash());
+        }
+
+        /// 事前計算したハッシュ値で文字列をインターンして作成します。
+        /// @param view 文字列です。
+        /// @param hash StringView::Hashで計算したハッシュ値です。
+        /// @return 名前、または、エラーです。
+        static Result<Name, ENameError> Create(StringView view, U64 hash) noexcept
+        {
+            if (view.IsEmpty()) return Name();
+            return _Internal::_InternName(view.Data(), view.Size(), hash).Map([](U32 id) noexcept
+            {
+                return Name(id);
+            });
+        }
+
+        /// 識別子を返します。
+        /// @return 識別子です。
+        constexpr U32 Id() const noexcept
+        {
+            return this->m_id;
+        }
+
+        /// 空かを返します。
+        /// @retval true 空です。
+        /// @retval false 空ではありません。
+        constexpr Bool IsEmpty() const noexcept
+        {
+            return this->m_id == 0;
+        }
+
+        /// 終端文字で終わる文字列を参照します。
+        /// @return 参照です。
+        StringView View() const noexcept
+        {
+            if (this->m_id == 0) return StringView();
+            Var pEntry = _Internal::_FindNameEntry(this->m_id);
+            return StringView(Cast<const Char*>(pEntry + 1), pEntry->size);
+        }
+
+        /// インターン時に計算した文字列のハッシュ値を返します。
+        /// @return ハッシュ値です。
+        U64 Hash() const noexcept
+        {
+            if (this->m_id == 0) return StringView().Hash();
+            return _Internal::_FindNameEntry(this->m_id)->hash;
+        }
+
+        /// 名前が同等か比較します。
+        /// @param other 比較対象です。
+        /// @return 同等の場合、真です。
+        constexpr Bool operator==(const Name &other) const noexcept
+        {
+            return this->m_id == other.m_id;
+        }
+
+        /// 名前が不等か比較します。
+        /// @param other 比較対象です。
+        /// @return 不等の場合、真です。
+        constexpr Bool operator!=(const Name &other) const noexcept
+        {
+            return this->m_id != other.m_id;
+        }
+
+        /// 識別子の順序で比較します。文字列の順序ではありません。
+        /// @param other 比較対象です。
+        /// @return 小さい場合、真です。
+        constexpr Bool operator<(const Name &other) const noexcept
+        {
+            return this->m_id < other.m_id;
+        }
+    };
+}
+
+#endif // !_LEYENGINE_STRING_HPP
\ No newline at end of file
@@ -0,0 +1,448 @@
+/// @file LeyEngine/Task.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// ワーカースレッドで再開するコルーチンを提供します。
+#ifndef _LEYENGINE_TASK_HPP
+#define _LEYENGINE_TASK_HPP
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <new>
+#include "LeyEngine/AsyncIO.hpp"
+#include "LeyEngine/Job.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    template<typename T>
+    struct Task;
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// コルーチンを再開するジョブです。
+        inline Void _ResumeCoroutine(Void *pData)
+        {
+            std::coroutine_handle<>::from_address(pData).resume();
+        }
+
+        /// 完了時に待機しているコルーチンへ切り替える待機オブジェクトです。
+        template<typename Promise>
+        struct _TaskFinalAwaiter
+        {
+            Bool await_ready() const noexcept
+            {
+                return NO;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            {
+                // 完了を公開した後は所有者が破棄する可能性があるため、先に待機しているコルーチンを取り出します
+                Var &promise = handle.promise();
+                std::coroutine_handle<> continuation = promise.continuation;
+                promise.isDone.store(YES, std::memory_order_release);
+                if (continuation) return continuation;
+                return std::noop_coroutine();
+            }
+
+            Void await_resume() const noexcept
+            {
+            }
+        };
+
+        /// Taskのプロミスの共通部分です。
+        /// コルーチンのフレームはメモリシステムから確保します。
+        struct _TaskPromiseBase
+        {
+            std::coroutine_handle<> continuation;   // 完了を待機しているコルーチン
+            std::atomic<Bool> isDone;               // 完了したか
+
+            _TaskPromiseBase() noexcept
+                : continuation()
+                , isDone(NO)
+            {
+            }
+
+            /// コルーチンのフレームを確保します。
+            static Void *operator new(USize size) noexcept
+            {
+                Var result = Allocate(size);
+                return result.IsSuccess() ? result.Value() : NONE;
+            }
+
+            /// コルーチンのフレームを解放します。
+            static Void operator delete(Void *pointer, USize size) noexcept
+            {
+                (Void)Deallocate(size, pointer);
+            }
+
+            std::suspend_always initial_suspend() const noexcept
+            {
+                return {};
+            }
+
+            Void unhandled_exception() const noexcept
+            {
+                std::terminate();
+            }
+        };
+
+        /// Taskのプロミスです。
+        template<typename T>
+        struct _TaskPromise : _TaskPromiseBase
+        {
+            alignas(T) U8 value[sizeof(T)];     // 戻り値
+            Bool hasValue = NO;                 // 戻り値を格納したか
+
+            ~_TaskPromise() noexcept
+            {
+                if (this->hasValue) Cast<T*>(this->value)->~T();
+            }
+
+            Task<T> get_return_object() noexcept;
+
+            static Task<T> get_return_object_on_allocation_failure() noexcept;
+
+            _TaskFinalAwaiter<_TaskPromise<T>> final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            template<typename U>
+            Void return_value(U &&result) noexcept
+            {
+                new(this->value) T(Forward<U>(result));
+                this->hasValue = YES;
+            }
+
+            T &Value() noexcept
+            {
+                return *Cast<T*>(this->value);
+            }
+        };
+
+        /// 戻り値の無いTaskのプロミスです。
+        template<>
+        struct _TaskPromise<Void> : _TaskPromiseBase
+        {
+            Task<Void> get_return_object() noexcept;
+
+            static Task<Void> get_return_object_on_allocation_failure() noexcept;
+
+            _TaskFinalAwaiter<_TaskPromise<Void>> final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            Void return_void() const noexcept
+            {
+            }
+
+            Void Value() const noexcept
+            {
+            }
+        };
+    }
+    /// @endcond
+
+    /// 値を返すコルーチンです。
+    /// 開始するか、他のコルーチンからco_awaitするまで実行しません。
+    /// コルーチンのフレームはメモリシステムから確保し、確保に失敗した場合は無効なTaskを返します。
+    /// @tparam T 戻り値の型です。
+    template<typename T>
+    struct Task
+    {
+    public:
+
+        /// コルーチンのプロミスの型です。
+        using promise_type = _Internal::_TaskPromise<T>;
+
+    private:
+
+        std::coroutine_handle<promise_type> m_handle;   // コルーチン
+
+    public:
+
+        /// 作成します。
+        /// @param handle コルーチンです。所有権を受け取ります。
+        explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+            : m_handle(handle)
+        {
+        }
+
+        Task(const Task&) = delete;
+        Task &operator=(const Task&) = delete;
+
+        /// ムーブコンストラクタです。
+        /// @param origin 元のTaskです。
+        Task(Task &&origin) noexcept
+            : m_handle(origin.m_handle)
+        {
+            origin.m_handle = NONE;
+        }
+
+        /// ムーブ代入します。
+        /// @param origin 元のTaskです。
+        /// @return 自身です。
+        Task &operator=(Task &&origin) noexcept
+        {
+            if (this != &origin)
+            {
+                if (this->m_handle) this->m_handle.destroy();
+                this->m_handle = origin.m_handle;
+                origin.m_handle = NONE;
+            }
+            return *this;
+        }
+
+        /// デストラクタです。
+        /// 実行中のTaskを破棄してはいけません。
+        ~Task() noexcept
+        {
+            if (this->m_handle) this->m_handle.destroy();
+        }
+
+        /// コルーチンのフレームを確保できたかを返します。
+        /// @retval true 有効です。
+        /// @retval false フレームの確保に失敗しました。
+        Bool IsValid() const noexcept
+        {
+            return static_cast<Bool>(this->m_handle);
+        }
+
+        /// 完了したかを返します。
+        /// @retval true 完了しました。
+        /// @retval false 完了していません。
+        Bool IsDone() const noexcept
+        {
+            return this->m_handle && this->m_handle.promise().isDone.load(std::memory_order_acquire);
+        }
+
+        /// 呼び出したスレッドで実行を開始します。
+        /// 最初の中断まで実行して戻り、以降は待機オブジェクトが再開したワーカースレッドで実行します。
+        Void Start() noexcept
+        {
+            this->m_handle.resume();
+        }
+
+        /// 完了したTaskの戻り値を返します。
+        /// @return 戻り値です。
+        decltype(auto) Value() noexcept
+        {
+            return this->m_handle.promise().Value();
+        }
+
+        /// co_awaitで完了を待機する待機オブジェクトです。
+        struct Awaiter
+        {
+            std::coroutine_handle<promise_type> handle; // 待機するコルーチン
+
+            Bool await_ready() const noexcept
+            {
+                return NO;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+            {
+                // 待機するコルーチンへ直接切り替え、完了時に呼び出し元へ戻ります
+                this->handle.promise().continuation = continuation;
+                return this->handle;
+            }
+
+            T await_resume() noexcept
+            {
+                if constexpr (std::is_void_v<T>) return;
+                else return Move(this->handle.promise().Value());
+            }
+        };
+
+        /// 完了を待機します。
+        /// 有効なTaskである必要があります。
+        /// @return 待機オブジェクトです。
+        Awaiter operator co_await() && noexcept
+        {
+            return Awaiter{ this->m_handle };
+        }
+    };
+
+    /// @cond LEYDOC_INTERNAL
+    template<typename T>
+    Task<T> _Internal::_TaskPromise<T>::get_return_object() noexcept
+    {
+        return Task<T>(std::coroutine_handle<_TaskPromise<T>>::from_promise(*this));
+    }
+
+    template<typename T>
+    Task<T> _Internal::_TaskPromise<T>::get_return_object_on_allocation_failure() noexcept
+    {
+        return Task<T>(NONE);
+    }
+
+    inline Task<Void> _Internal::_TaskPromise<Void>::get_return_object() noexcept
+    {
+        return Task<Void>(std::coroutine_handle<_TaskPromise<Void>>::from_promise(*this));
+    }
+
+    inline Task<Void> _Internal::_TaskPromise<Void>::get_return_object_on_allocation_failure() noexcept
+    {
+        return Task<Void>(NONE);
+    }
+    /// @endcond
+
+    /// ワーカースレッドへ切り替える待機オブジェクトです。
+    struct JobWorkerAwaiter
+    {
+        Bool await_ready() const noexcept
+        {
+            return NO;
+        }
+
+        Bool await_suspend(std::coroutine_handle<> handle) const noexcept
+        {
+            JobDeclaration job = { &_Internal::_ResumeCoroutine, handle.address() };
+            // ジョブを積めなかった場合は中断せずに続行します
+            return RunJobs(&job, 1, NONE).IsSuccess();
+        }
+
+        Void await_resume() const noexcept
+        {
+        }
+    };
+
+    /// ワーカースレッドへ切り替えます。
+    /// @return 待機オブジェクトです。
+    inline JobWorkerAwaiter SwitchToJobWorker() noexcept
+    {
+        return {};
+    }
+
+    /// 次のフレームで再開する待機オブジェクトです。
+    struct NextFrameAwaiter
+    {
+        Bool await_ready() const noexcept
+        {
+            return NO;
+        }
+
+        Bool await_suspend(std::coroutine_handle<> handle) const noexcept
+        {
+            JobDeclaration job = { &_Internal::_ResumeCoroutine, handle.address() };
+            return RunJobsNextFrame(&job, 1, NONE).IsSuccess();
+        }
+
+        Void await_resume() const noexcept
+        {
+        }
+    };
+
+    /// 次のフレームのAdvanceJobFrameの呼び出し後にワーカースレッドで再開します。
+    /// @return 待機オブジェクトです。
+    inline NextFrameAwaiter NextFrame() noexcept
+    {
+        return {};
+    }
+
+    /// カウンタが0になるとワーカースレッドで再開する待機オブジェクトです。
+    struct JobCounterAwaiter
+    {
+        JobCounter *pCounter;               // 待機するカウンタ
+        std::coroutine_handle<> handle;     // 再開するコルーチン
+
+        Bool await_ready() const noexcept
+        {
+            return this->pCounter->Value() == 0;
+        }
+
+        Bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            this->handle = handle;
+            // ファイバー内で待機するジョブを積み、ワーカースレッドを塞がずに待機します
+            JobDeclaration job = { &JobCounterAwaiter::Run, this };
+            return RunJobs(&job, 1, NONE).IsSuccess();
+        }
+
+        Void await_resume() const noexcept
+        {
+        }
+
+        static Void Run(Void *pData)
+        {
+            Var pAwaiter = Cast<JobCounterAwaiter*>(pData);
+            WaitForCounter(*pAwaiter->pCounter);
+            pAwaiter->handle.resume();
+        }
+    };
+
+    /// カウンタが0になるまで待機し、ワーカースレッドで再開します。
+    /// @param counter 待機するカウンタです。待機中に破棄してはいけません。
+    /// @return 待機オブジェクトです。
+    inline JobCounterAwaiter WaitForJobs(JobCounter &counter) noexcept
+    {
+        return JobCounterAwaiter{ &counter, NONE };
+    }
+
+    /// 読み込みの完了後にワーカースレッドで再開する待機オブジェクトです。
+    struct IOReadAwaiter
+    {
+        IOReadRequest request;              // 読み込み要求
+        std::coroutine_handle<> handle;     // 再開するコルーチン
+        U64 requestId;                      // 読み込み要求の識別子
+        Void *pBuffer;                      // 読み込み先のバッファ
+        USize bufferSize;                   // バッファのバイトサイズ
+        Bool isBufferOwned;                 // バッファを非同期ファイル入出力システムが確保したか
+        Result<USize, EIOError> result;     // 読み込んだバイトサイズ、または、エラー
+
+        Bool await_ready() const noexcept
+        {
+            return NO;
+        }
+
+        Bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            this->handle = handle;
+            IOReadRequest request = this->request;
+            request.callback = &IOReadAwaiter::Complete;
+            request.pUserData = this;
+            Var submitResult = SubmitRead(request);
+            if (submitResult.IsSuccess()) return YES;
+            // 要求できなかった場合は中断せずにエラーを返します
+            this->result = submitResult.Error();
+            return NO;
+        }
+
+        IOCompletion await_resume() noexcept
+        {
+            return IOCompletion{ this->requestId, this->pBuffer, this->bufferSize, this->isBufferOwned, Move(this->result), this->request.pUserData };
+        }
+
+        static Void Complete(const IOCompletion &completion)
+        {
+            Var pAwaiter = Cast<IOReadAwaiter*>(completion.pUserData);
+            pAwaiter->requestId = completion.requestId;
+            pAwaiter->pBuffer = completion.pBuffer;
+            pAwaiter->bufferSize = completion.bufferSize;
+            pAwaiter->isBufferOwned = completion.isBufferOwned;
+            pAwaiter->result = completion.result;
+            JobDeclaration job = { &_Internal::_ResumeCoroutine, pAwaiter->handle.address() };
+            // ジョブを積めなかった場合は完了を通知したスレッドで再開します
+            if (RunJobs(&job, 1, NONE).IsFailure()) pAwaiter->handle.resume();
+        }
+    };
+
+    /// ファイルを読み込み、完了後にワーカースレッドで再開します。
+    /// 完了はDispatchIOCompletionsを呼び出したスレッドが受け取るため、フレーム毎に呼び出す必要があります。
+    /// @param request 読み込み要求です。コールバックは無視し、pUserDataは完了情報にそのまま返します。
+    /// @return 完了情報を返す待機オブジェクトです。
+    inline IOReadAwaiter ReadFileAsync(const IOReadRequest &request) noexcept
+    {
+        return IOReadAwaiter{ request, NONE, 0, request.pBuffer, 0, NO, EIOError::NOT_INITIALIZED };
+    }
+}
+
+#endif // __cplusplus >= 202002L && __has_include(<coroutine>)
+
+#endif // !_LEYENGINE_TASK_HPP
\ No newline at end of file
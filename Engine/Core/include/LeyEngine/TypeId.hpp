@@ -0,0 +1,151 @@
+/// @file LeyEngine/TypeId.hpp
+/// @copyright (C) 2022 LeyCommunity.
+/// @author Taichi Ito.
+/// RTTIを使用しない、コンパイル時に決まる型の識別子を提供します。
+#ifndef _LEYENGINE_TYPEID_HPP
+#define _LEYENGINE_TYPEID_HPP
+
+#include "LeyEngine/Hash.hpp"
+
+/// LeyEngineのすべての機能を含む名前空間です。
+namespace LeyEngine
+{
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// 関数のシグネチャの文字列です。
+        struct _Signature
+        {
+            const char *pData;  // 先頭
+            USize size;         // バイトサイズ
+        };
+
+        /// 型名を含む関数のシグネチャを返します。
+        template<typename T>
+        constexpr _Signature _SignatureOf() noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            return _Signature{ __FUNCSIG__, sizeof(__FUNCSIG__) - 1 };
+#else
+            return _Signature{ __PRETTY_FUNCTION__, sizeof(__PRETTY_FUNCTION__) - 1 };
+#endif
+        }
+
+        /// シグネチャ内の型名の前後のバイトサイズです。
+        /// 名前の分かっているvoidの位置から求めます。
+        struct _TypeNameAffix
+        {
+            USize prefix;   // 型名の前のバイトサイズ
+            USize suffix;   // 型名の後のバイトサイズ
+
+            constexpr _TypeNameAffix() noexcept
+                : prefix(0)
+                , suffix(0)
+            {
+                constexpr _Signature signature = _SignatureOf<void>();
+                constexpr const char NAME[] = "void";
+                constexpr USize NAME_SIZE = sizeof(NAME) - 1;
+                while (this->prefix + NAME_SIZE <= signature.size)
+                {
+                    USize i = 0;
+                    while (i < NAME_SIZE && signature.pData[this->prefix + i] == NAME[i]) i++;
+                    if (i == NAME_SIZE) break;
+                    this->prefix++;
+                }
+                this->suffix = signature.size - this->prefix - NAME_SIZE;
+            }
+        };
+
+        /// シグネチャ内の型名の前後のバイトサイズです。
+        constexpr _TypeNameAffix _TYPE_NAME_AFFIX = _TypeNameAffix();
+
+        /// 型名を返します。
+        template<typename T>
+        constexpr _Signature _TypeNameOf() noexcept
+        {
+            constexpr _Signature signature = _SignatureOf<T>();
+            return _Signature{ signature.pData + _TYPE_NAME_AFFIX.prefix, signature.size - _TYPE_NAME_AFFIX.prefix - _TYPE_NAME_AFFIX.suffix };
+        }
+    }
+    /// @endcond
+
+    /// 型の識別子です。
+    /// 型名のハッシュ値のため、同じコンパイラでビルドしたモジュール間では同じ型が同じ識別子になります。
+    /// コンパイラ毎に型名の表記が異なるため、ファイルに保存してはいけません。
+    struct TypeId
+    {
+    private:
+
+        U64 m_hash; // 型名のハッシュ値、0は型無し
+
+    public:
+
+        /// 型無しの識別子を作成します。
+        constexpr TypeId() noexcept
+            : m_hash(0)
+        {
+        }
+
+        /// ハッシュ値から作成します。
+        /// @param hash 型名のハッシュ値です。
+        explicit constexpr TypeId(U64 hash) noexcept
+            : m_hash(hash)
+        {
+        }
+
+        /// 型名のハッシュ値を返します。
+        /// @return ハッシュ値です。
+        constexpr U64 Hash() const noexcept
+        {
+            return this->m_hash;
+        }
+
+        /// 型無しかを返します。
+        /// @retval true 型無しです。
+        /// @retval false 型を表します。
+        constexpr Bool IsNone() const noexcept
+        {
+            return this->m_hash == 0;
+        }
+
+        /// 識別子が同等か比較します。
+        /// @param other 比較対象です。
+        /// @return 同等の場合、真です。
+        constexpr Bool operator==(const TypeId &other) const noexcept
+        {
+            return this->m_hash == other.m_hash;
+        }
+
+        /// 識別子が不等か比較します。
+        /// @param other 比較対象です。
+        /// @return 不等の場合、真です。
+        constexpr Bool operator!=(const TypeId &other) const noexcept
+        {
+            return this->m_hash != other.m_hash;
+        }
+
+        /// ハッシュ値の順序で比較します。
+        /// @param other 比較対象です。
+        /// @return 小さい場合、真です。
+        constexpr Bool operator<(const TypeId &other) const noexcept
+        {
+            return this->m_hash < other.m_hash;
+        }
+    };
+
+    /// 型の識別子をコンパイル時に求めます。
+    /// const、参照の有無は別の型として扱います。
+    /// @tparam T 型です。
+    /// @return 識別子です。
+    template<typename T>
+    constexpr TypeId TypeIdOf() noexcept
+    {
+        constexpr _Internal::_Signature NAME = _Internal::_TypeNameOf<T>();
+        constexpr U64 HASH = HashXxh64(NAME.pData, NAME.size);
+        // 型無しと区別するため、0は避けます
+        return TypeId(HASH != 0 ? HASH : 1);
+    }
+}
+
+#endif // !_LEYENGINE_TYPEID_HPP
\ No newline at end of file
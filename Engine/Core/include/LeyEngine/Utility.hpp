@@ -5,8 +5,12 @@
 #ifndef _LEYENGINE_UTILITY_HPP
 #define _LEYENGINE_UTILITY_HPP
 
+#include <cassert>
+#include <new>
+#include <type_traits>
 #include <utility>
 #include "LeyEngine/Primitive.hpp"
+#include "LeyEngine/TypeId.hpp"
 
 /// LeyEngineのすべての機能を含む名前空間です。
 namespace LeyEngine 
@@ -16,7 +20,7 @@ namespace LeyEngine
     /// @param value ムーブする値です。
     /// @return ムーブする値です。
     template<typename T>
-    constexpr std::remove_reference<T>::type &&Move(T &&value) noexcept
+    constexpr typename std::remove_reference<T>::type &&Move(T &&value) noexcept
     {
         return std::move(value);
     }
@@ -28,7 +32,7 @@ namespace LeyEngine
     template<typename T>
     constexpr T&& Forward(typename std::remove_reference<T>::type &value) noexcept
     {
-        return std::forward(value);
+        return std::forward<T>(value);
     }
     
     /// 左辺値はコピー、右辺値はムーブします。
@@ -38,7 +42,7 @@ namespace LeyEngine
     template<typename T>
     constexpr T&& Forward(typename std::remove_reference<T>::type &&value) noexcept
     {
-        return std::forward(value);
+        return std::forward<T>(value);
     }
 
     /// @cond LEYDOC_INTERNAL
@@ -57,7 +61,7 @@ namespace LeyEngine
             /// @param value キャストする値です。
             T operator()(U value) const noexcept
             {
-                return reinterpret_cast<T>(Forward(value))
+                return reinterpret_cast<T>(Forward<U>(value));
             }
         };
 
@@ -73,7 +77,7 @@ namespace LeyEngine
             /// @param value キャストする値です。
             T operator()(U value) const noexcept
             {
-                return static_cast<T>(Forward(value))
+                return static_cast<T>(Forward<U>(value));
             }
         };
         
@@ -89,7 +93,7 @@ namespace LeyEngine
             /// @param value キャストする値です。
             T operator()(U value) const noexcept
             {
-                return static_cast<T>(Forward(value))
+                return static_cast<T>(Forward<U>(value));
             }
         };
 
@@ -106,77 +110,65 @@ namespace LeyEngine
             /// @param value キャストする値です。
             T operator()(U value) const noexcept
             {
-                return dynamic_cast<T>(Forward(value))
+                return dynamic_cast<T>(Forward<U>(value));
             }
         };
 
-        /// 複数の型で最も大きいの型サイズを返す関数オブジェクト特殊化です。
-        template<typename T, typename U, typename...Ts>
+        /// 複数の型で最も大きい型サイズを求める関数オブジェクトです。
+        template<typename...Ts>
         struct _MaxSizeOf
         {
-            static constexpr USize MAX_SIZE = sizeof(T) > sizeof(U) ? _MaxSizeOf<T, Ts...>::MAX_SIZE : _MaxSizeOf<U, Ts...>::MAX_SIZE;
+            /// 最も大きい型サイズです。
+            static constexpr USize MAX_SIZE = 0;
         };
-        
-        /// 複数の型で最も大きいの型サイズを返す関数オブジェクトのTs=Void特殊化です。
-        template<typename T, typename U>
-        struct _MaxSizeOf<T, U, Void>
+
+        /// 複数の型で最も大きい型サイズを求める関数オブジェクトの特殊化です。
+        template<typename T, typename...Ts>
+        struct _MaxSizeOf<T, Ts...>
         {
-            static constexpr USize MAX_SIZE = sizeof(T) > sizeof(U) ? sizeof(T) : sizeof(U);
+            /// 最も大きい型サイズです。
+            static constexpr USize MAX_SIZE = sizeof(T) > _MaxSizeOf<Ts...>::MAX_SIZE ? sizeof(T) : _MaxSizeOf<Ts...>::MAX_SIZE;
         };
 
-        /// 複数の型で最も大きいの型サイズを返す関数オブジェクトのU=Void特殊化です。
-        template<typename T>
-        struct _MaxSizeOf<T, Void, Void>
+        /// 複数の型で最も大きいアライメントを求める関数オブジェクトです。
+        template<typename...Ts>
+        struct _MaxAlignOf
         {
-            static constexpr USize MAX_SIZE = sizeof(T);
+            /// 最も大きいアライメントです。
+            static constexpr USize MAX_ALIGN = 1;
         };
 
-        /// 可変長テンプレートから指定の型の位置を求める関数オブジェクト特殊化です。
-        template<typename T, typename U, typename...Ts>
+        /// 複数の型で最も大きいアライメントを求める関数オブジェクトの特殊化です。
+        template<typename T, typename...Ts>
+        struct _MaxAlignOf<T, Ts...>
+        {
+            /// 最も大きいアライメントです。
+            static constexpr USize MAX_ALIGN = alignof(T) > _MaxAlignOf<Ts...>::MAX_ALIGN ? alignof(T) : _MaxAlignOf<Ts...>::MAX_ALIGN;
+        };
+
+        /// 可変長テンプレートから指定の型の位置をコンパイル時に求める関数オブジェクトです。
+        /// 見つからない場合の位置は型の数になります。
+        template<typename T, typename...Ts>
         struct _TypeIndexOf
         {
-            /// 位置を求めます。
-            /// @param index 求めた位置です。
-            /// @return 存在したかどうかの判定値です。
-            Bool operator()(USize &index) const noexcept
-            {
-                if (typeid(T) == typeid(U))
-                {
-                    return YES;
-                }
-                else
-                {
-                    return _TypeIndexOf<T, Ts...>{}(++index);
-                }
-            }
+            /// 指定の型の位置です。
+            static constexpr USize INDEX = 0;
         };
 
-        /// 可変長テンプレートから指定の型の位置を求める関数オブジェクトのTs=Void特殊化です。
-        template<typename T, typename U>
-        struct _TypeIndexOf<T, U, Void>
+        /// 可変長テンプレートから指定の型の位置をコンパイル時に求める関数オブジェクトの特殊化です。
+        template<typename T, typename U, typename...Ts>
+        struct _TypeIndexOf<T, U, Ts...>
         {
-            /// 位置を求めます。
-            /// @param index 求めた位置です。
-            /// @return 存在したかどうかの判定値です。
-            Bool operator()(USize &index) const noexcept
-            {
-                if (typeid(T) == typeid(U))
-                {
-                    return YES;
-                }
-                else
-                {
-                    return NO;
-                }
-            }
+            /// 指定の型の位置です。
+            static constexpr USize INDEX = std::is_same_v<T, U> ? 0 : 1 + _TypeIndexOf<T, Ts...>::INDEX;
         };
 
-        /// 指定位置の型を返す関数オブジェクト特殊化です。
+        /// 指定位置の型を返す関数オブジェクトです。
         template<USize I, typename T, typename...Ts>
         struct _TypeAt
         {
             /// 指定位置の型です。
-            using TTarget = _TypeAt<I - 1, T, Ts...>::TTarget;
+            using TTarget = typename _TypeAt<I - 1, Ts...>::TTarget;
         };
 
         /// 指定位置の型を返す関数オブジェクトのI=0特殊化です。
@@ -187,14 +179,28 @@ namespace LeyEngine
             using TTarget = T;
         };
 
-        /// 指定位置の型を返す関数オブジェクトのT=Void特殊化です。
-        template<USize I>
-        struct _TypeAt<I, Void, Void>
+        /// 指定数の値を表現できる最小の符号無し整数型を返す関数オブジェクトです。
+        template<USize COUNT, Bool IS_U8 = (COUNT <= U8_MAX), Bool IS_U16 = (COUNT <= U16_MAX)>
+        struct _MinimumIndexOf
+        {
+            /// 最小の符号無し整数型です。
+            using TIndex = U32;
+        };
+
+        /// 指定数の値を表現できる最小の符号無し整数型を返す関数オブジェクトのU8特殊化です。
+        template<USize COUNT, Bool IS_U16>
+        struct _MinimumIndexOf<COUNT, YES, IS_U16>
         {
-            static_assert(NO, "Out of range.");
+            /// 最小の符号無し整数型です。
+            using TIndex = U8;
+        };
 
-            /// 指定位置の型です。
-            using TTarget = Void;
+        /// 指定数の値を表現できる最小の符号無し整数型を返す関数オブジェクトのU16特殊化です。
+        template<USize COUNT>
+        struct _MinimumIndexOf<COUNT, NO, YES>
+        {
+            /// 最小の符号無し整数型です。
+            using TIndex = U16;
         };
     }
     /// @endcond
@@ -206,7 +212,7 @@ namespace LeyEngine
     template<typename T, typename U>
     T Cast(U value) noexcept
     {
-        return _Internal::_Cast<T, U>{}(Forward(value));
+        return _Internal::_Cast<T, U>{}(Forward<U>(value));
     }
 
     /// 成功を表現する型です。
@@ -219,68 +225,381 @@ namespace LeyEngine
     /// 失敗を表現する値です。
     constexpr Failure FAILURE = (Failure)NO;
 
+    /// 成功値をその場で構築することを指定するタグ型です。
+    struct InPlaceSuccess
+    {
+        /// コンストラクタです。
+        explicit constexpr InPlaceSuccess() noexcept = default;
+    };
+
+    /// 失敗値をその場で構築することを指定するタグ型です。
+    struct InPlaceFailure
+    {
+        /// コンストラクタです。
+        explicit constexpr InPlaceFailure() noexcept = default;
+    };
+
+    /// 成功値をその場で構築することを指定するタグ値です。
+    constexpr InPlaceSuccess IN_PLACE_SUCCESS = InPlaceSuccess();
+    /// 失敗値をその場で構築することを指定するタグ値です。
+    constexpr InPlaceFailure IN_PLACE_FAILURE = InPlaceFailure();
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
+    {
+        /// Resultの値を保持する共用体です。
+        /// S、Fのどちらかが自明にコピーできない場合の特殊化です。
+        /// @tparam S 成功時の型です。
+        /// @tparam F 失敗時の型です。
+        /// @tparam IS_TRIVIAL S、Fが共に自明にコピー可能かの判定です。
+        template<typename S, typename F, Bool IS_TRIVIAL = std::is_trivially_copyable_v<S> && std::is_trivially_copyable_v<F>>
+        struct _ResultStorage
+        {
+            union
+            {
+                S success;  // 成功時の値
+                F failure;  // 失敗時の値
+            };
+            Bool isSuccess; // 判定値
+
+            /// 成功値をその場で構築します。
+            /// @param args 成功値のコンストラクタ引数です。
+            template<typename...Args>
+            constexpr _ResultStorage(InPlaceSuccess, Args &&...args) noexcept
+                : success(Forward<Args>(args)...)
+                , isSuccess(YES)
+            {}
+
+            /// 失敗値をその場で構築します。
+            /// @param args 失敗値のコンストラクタ引数です。
+            template<typename...Args>
+            constexpr _ResultStorage(InPlaceFailure, Args &&...args) noexcept
+                : failure(Forward<Args>(args)...)
+                , isSuccess(NO)
+            {}
+
+            /// コピーします。
+            /// @param origin コピー元です。
+            _ResultStorage(const _ResultStorage &origin) noexcept
+                : isSuccess(origin.isSuccess)
+            {
+                if (this->isSuccess) new(&this->success) S(origin.success);
+                else                 new(&this->failure) F(origin.failure);
+            }
+
+            /// ムーブします。
+            /// @param origin ムーブ元です。
+            _ResultStorage(_ResultStorage &&origin) noexcept
+                : isSuccess(origin.isSuccess)
+            {
+                if (this->isSuccess) new(&this->success) S(Move(origin.success));
+                else                 new(&this->failure) F(Move(origin.failure));
+            }
+
+            /// コピー代入します。
+            /// @param origin コピー元です。
+            /// @return 自身の参照です。
+            _ResultStorage &operator=(const _ResultStorage &origin) noexcept
+            {
+                if (this == &origin) return *this;
+                if (this->isSuccess && origin.isSuccess)
+                {
+                    this->success = origin.success;
+                }
+                else if (!this->isSuccess && !origin.isSuccess)
+                {
+                    this->failure = origin.failure;
+                }
+                else
+                {
+                    this->Destroy();
+                    this->isSuccess = origin.isSuccess;
+                    if (this->isSuccess) new(&this->success) S(origin.success);
+                    else                 new(&this->failure) F(origin.failure);
+                }
+                return *this;
+            }
+
+            /// ムーブ代入します。
+            /// @param origin ムーブ元です。
+            /// @return 自身の参照です。
+            _ResultStorage &operator=(_ResultStorage &&origin) noexcept
+            {
+                if (this == &origin) return *this;
+                if (this->isSuccess && origin.isSuccess)
+                {
+                    this->success = Move(origin.success);
+                }
+                else if (!this->isSuccess && !origin.isSuccess)
+                {
+                    this->failure = Move(origin.failure);
+                }
+                else
+                {
+                    this->Destroy();
+                    this->isSuccess = origin.isSuccess;
+                    if (this->isSuccess) new(&this->success) S(Move(origin.success));
+                    else                 new(&this->failure) F(Move(origin.failure));
+                }
+                return *this;
+            }
+
+            /// デストラクタです。
+            ~_ResultStorage() noexcept
+            {
+                this->Destroy();
+            }
+
+            /// 保持している値を破棄します。
+            Void Destroy() noexcept
+            {
+                if (this->isSuccess) this->success.~S();
+                else                 this->failure.~F();
+            }
+        };
+
+        /// Resultの値を保持する共用体です。
+        /// S、Fが共に自明にコピーできる場合の特殊化です。
+        /// コピー、ムーブ、破棄が自明となり、小さな値はレジスタで受け渡されます。
+        /// @tparam S 成功時の型です。
+        /// @tparam F 失敗時の型です。
+        template<typename S, typename F>
+        struct _ResultStorage<S, F, YES>
+        {
+            union
+            {
+                S success;  // 成功時の値
+                F failure;  // 失敗時の値
+            };
+            Bool isSuccess; // 判定値
+
+            /// 成功値をその場で構築します。
+            /// @param args 成功値のコンストラクタ引数です。
+            template<typename...Args>
+            constexpr _ResultStorage(InPlaceSuccess, Args &&...args) noexcept
+                : success(Forward<Args>(args)...)
+                , isSuccess(YES)
+            {}
+
+            /// 失敗値をその場で構築します。
+            /// @param args 失敗値のコンストラクタ引数です。
+            template<typename...Args>
+            constexpr _ResultStorage(InPlaceFailure, Args &&...args) noexcept
+                : failure(Forward<Args>(args)...)
+                , isSuccess(NO)
+            {}
+        };
+    }
+    /// @endcond
+
     /// 関数の戻り値とエラーを同時に返すための型です。
+    /// 値はその場で構築され、S、Fが共に自明にコピー可能な場合はResultも自明にコピー可能です。
     /// @tparam S 成功時の型です。
     /// @tparam F 失敗時の型です。
     template<typename S, typename F>
     struct Result
     {
+        static_assert(!std::is_reference_v<S> && !std::is_reference_v<F>, "Result cannot hold a reference. Use a pointer instead.");
+
+        /// 成功時の型です。
+        using TSuccess = S;
+
+        /// 失敗時の型です。
+        using TFailure = F;
+
     private:
-        union UResult
-        {
-            U8 ready;   // 初期値
-            S success;  // 成功時の値
-            F failure;  // 失敗時の値
 
-            UResult()
-                : ready(0)
-            {}
+        _Internal::_ResultStorage<S, F> m_storage; // 値と判定値
 
-        }m_value;       // 共用値
-        Bool m_isSuccess; // 判定値
-        
     public:
 
         /// コンストラクタです。
         /// @param value 成功時の値です。
-        Result(S &&value) noexcept
-            : m_value()
-            , m_isSuccess(YES)
-        {
-            this->m_value.success = Move(value);
-        }
+        constexpr Result(const S &value) noexcept
+            : m_storage(IN_PLACE_SUCCESS, value)
+        {}
+
+        /// コンストラクタです。
+        /// @param value 成功時の値です。
+        constexpr Result(S &&value) noexcept
+            : m_storage(IN_PLACE_SUCCESS, Move(value))
+        {}
+
+        /// コンストラクタです。
+        /// @param value 失敗時の値です。
+        constexpr Result(const F &value) noexcept
+            : m_storage(IN_PLACE_FAILURE, value)
+        {}
 
         /// コンストラクタです。
         /// @param value 失敗時の値です。
-        Result(F &&value) noexcept
-            : m_value()
-            , m_isSuccess(NO)
+        constexpr Result(F &&value) noexcept
+            : m_storage(IN_PLACE_FAILURE, Move(value))
+        {}
+
+        /// 成功値をその場で構築します。
+        /// @param args 成功値のコンストラクタ引数です。
+        template<typename...Args>
+        constexpr explicit Result(InPlaceSuccess, Args &&...args) noexcept
+            : m_storage(IN_PLACE_SUCCESS, Forward<Args>(args)...)
+        {}
+
+        /// 失敗値をその場で構築します。
+        /// @param args 失敗値のコンストラクタ引数です。
+        template<typename...Args>
+        constexpr explicit Result(InPlaceFailure, Args &&...args) noexcept
+            : m_storage(IN_PLACE_FAILURE, Forward<Args>(args)...)
+        {}
+
+        /// 成功か判定します。
+        /// @retval true 成功です。
+        /// @retval false 失敗です。
+        [[nodiscard]] constexpr Bool IsSuccess() const noexcept
         {
-            this->m_value.failure = Move(value);
+            return this->m_storage.isSuccess;
         }
 
-        /// ムーブ代入します。
-        /// @param origin ムーブ元です。
-        /// @return 自身の参照です。
-        Result<S, F> &operator=(Result<S, F> &&origin) noexcept
+        /// 失敗か判定します。
+        /// @retval true 失敗です。
+        /// @retval false 成功です。
+        [[nodiscard]] constexpr Bool IsFailure() const noexcept
         {
-            if (this != origin)
-            {
-                Var tmpState = Move(this->m_state);
-                Var tmpValue = Move(this->m_value);
-                this->m_state = Move(origin.m_state);
-                this->m_value = Move(origin.m_value);
-                origin.m_state = Move(tmpState);
-                origin.m_value = Move(tmpValue);
-            }
-            return *this;
+            return !this->m_storage.isSuccess;
+        }
+
+        /// 成功値を返します。
+        /// 成功である場合のみ呼び出せます。
+        /// @return 成功値です。
+        [[nodiscard]] constexpr S &Value() & noexcept
+        {
+            return this->m_storage.success;
+        }
+
+        /// 成功値を返します。
+        /// 成功である場合のみ呼び出せます。
+        /// @return 成功値です。
+        [[nodiscard]] constexpr const S &Value() const & noexcept
+        {
+            return this->m_storage.success;
+        }
+
+        /// 成功値を返します。
+        /// 成功である場合のみ呼び出せます。
+        /// @return 成功値です。
+        [[nodiscard]] constexpr S &&Value() && noexcept
+        {
+            return Move(this->m_storage.success);
+        }
+
+        /// 失敗値を返します。
+        /// 失敗である場合のみ呼び出せます。
+        /// @return 失敗値です。
+        [[nodiscard]] constexpr F &Error() & noexcept
+        {
+            return this->m_storage.failure;
         }
 
-        /// ムーブします。
-        /// @param origin ムーブ元です。
-        Result(Result<S, F> &&origin) noexcept
+        /// 失敗値を返します。
+        /// 失敗である場合のみ呼び出せます。
+        /// @return 失敗値です。
+        [[nodiscard]] constexpr const F &Error() const & noexcept
         {
-            *this = Move(origin);
+            return this->m_storage.failure;
+        }
+
+        /// 失敗値を返します。
+        /// 失敗である場合のみ呼び出せます。
+        /// @return 失敗値です。
+        [[nodiscard]] constexpr F &&Error() && noexcept
+        {
+            return Move(this->m_storage.failure);
+        }
+
+        /// 成功値、または、失敗時の代替値を返します。
+        /// @param other 失敗時の代替値です。
+        /// @return 成功値、または、代替値です。
+        template<typename U>
+        [[nodiscard]] constexpr S ValueOr(U &&other) const & noexcept
+        {
+            return this->m_storage.isSuccess ? this->m_storage.success : static_cast<S>(Forward<U>(other));
+        }
+
+        /// 成功値、または、失敗時の代替値を返します。
+        /// @param other 失敗時の代替値です。
+        /// @return 成功値、または、代替値です。
+        template<typename U>
+        [[nodiscard]] constexpr S ValueOr(U &&other) && noexcept
+        {
+            return this->m_storage.isSuccess ? Move(this->m_storage.success) : static_cast<S>(Forward<U>(other));
+        }
+
+        /// 成功値を変換します。失敗値はそのまま引き継ぎます。
+        /// @param function 成功値を受け取り変換後の値を返す関数です。
+        /// @return 変換後の値、または、失敗値です。
+        template<typename Fn>
+        [[nodiscard]] constexpr Result<std::invoke_result_t<Fn, const S&>, F> Map(Fn &&function) const & noexcept
+        {
+            using TMapped = Result<std::invoke_result_t<Fn, const S&>, F>;
+            if (this->m_storage.isSuccess) return TMapped(IN_PLACE_SUCCESS, Forward<Fn>(function)(this->m_storage.success));
+            else                           return TMapped(IN_PLACE_FAILURE, this->m_storage.failure);
+        }
+
+        /// 成功値を変換します。失敗値はそのまま引き継ぎます。
+        /// @param function 成功値を受け取り変換後の値を返す関数です。
+        /// @return 変換後の値、または、失敗値です。
+        template<typename Fn>
+        [[nodiscard]] constexpr Result<std::invoke_result_t<Fn, S&&>, F> Map(Fn &&function) && noexcept
+        {
+            using TMapped = Result<std::invoke_result_t<Fn, S&&>, F>;
+            if (this->m_storage.isSuccess) return TMapped(IN_PLACE_SUCCESS, Forward<Fn>(function)(Move(this->m_storage.success)));
+            else                           return TMapped(IN_PLACE_FAILURE, Move(this->m_storage.failure));
+        }
+
+        /// 失敗値を変換します。成功値はそのまま引き継ぎます。
+        /// @param function 失敗値を受け取り変換後の値を返す関数です。
+        /// @return 成功値、または、変換後の失敗値です。
+        template<typename Fn>
+        [[nodiscard]] constexpr Result<S, std::invoke_result_t<Fn, const F&>> MapError(Fn &&function) const & noexcept
+        {
+            using TMapped = Result<S, std::invoke_result_t<Fn, const F&>>;
+            if (this->m_storage.isSuccess) return TMapped(IN_PLACE_SUCCESS, this->m_storage.success);
+            else                           return TMapped(IN_PLACE_FAILURE, Forward<Fn>(function)(this->m_storage.failure));
+        }
+
+        /// 失敗値を変換します。成功値はそのまま引き継ぎます。
+        /// @param function 失敗値を受け取り変換後の値を返す関数です。
+        /// @return 成功値、または、変換後の失敗値です。
+        template<typename Fn>
+        [[nodiscard]] constexpr Result<S, std::invoke_result_t<Fn, F&&>> MapError(Fn &&function) && noexcept
+        {
+            using TMapped = Result<S, std::invoke_result_t<Fn, F&&>>;
+            if (this->m_storage.isSuccess) return TMapped(IN_PLACE_SUCCESS, Move(this->m_storage.success));
+            else                           return TMapped(IN_PLACE_FAILURE, Forward<Fn>(function)(Move(this->m_storage.failure)));
+        }
+
+        /// 成功値を受け取りResultを返す処理を連結します。失敗値はそのまま引き継ぎます。
+        /// @param function 成功値を受け取り、失敗型がFのResultを返す関数です。
+        /// @return 連結した処理の結果、または、失敗値です。
+        template<typename Fn>
+        [[nodiscard]] constexpr std::invoke_result_t<Fn, const S&> AndThen(Fn &&function) const & noexcept
+        {
+            using TChained = std::invoke_result_t<Fn, const S&>;
+            static_assert(std::is_same_v<typename TChained::TFailure, F>, "AndThen requires the same failure type.");
+            if (this->m_storage.isSuccess) return Forward<Fn>(function)(this->m_storage.success);
+            else                           return TChained(IN_PLACE_FAILURE, this->m_storage.failure);
+        }
+
+        /// 成功値を受け取りResultを返す処理を連結します。失敗値はそのまま引き継ぎます。
+        /// @param function 成功値を受け取り、失敗型がFのResultを返す関数です。
+        /// @return 連結した処理の結果、または、失敗値です。
+        template<typename Fn>
+        [[nodiscard]] constexpr std::invoke_result_t<Fn, S&&> AndThen(Fn &&function) && noexcept
+        {
+            using TChained = std::invoke_result_t<Fn, S&&>;
+            static_assert(std::is_same_v<typename TChained::TFailure, F>, "AndThen requires the same failure type.");
+            if (this->m_storage.isSuccess) return Forward<Fn>(function)(Move(this->m_storage.success));
+            else                           return TChained(IN_PLACE_FAILURE, Move(this->m_storage.failure));
         }
 
         /// 成功、失敗を判定して値を参照渡しで返します。
@@ -289,14 +608,14 @@ namespace LeyEngine
         /// @return 判定値です。
         Bool IsSuccess(S &success, F &failure) noexcept
         {
-            if (this->m_isSuccess)
+            if (this->m_storage.isSuccess)
             {
-                success = Move(this->m_value.success);
+                success = Move(this->m_storage.success);
                 return YES;
             }
             else
             {
-                failure = Move(this->m_value.failure);
+                failure = Move(this->m_storage.failure);
                 return NO;
             }
         }
@@ -306,9 +625,9 @@ namespace LeyEngine
         /// @return 判定値です。
         Bool IsSuccess(S &success) noexcept
         {
-            if (this->m_isSuccess)
+            if (this->m_storage.isSuccess)
             {
-                success = Move(this->m_value.success);
+                success = Move(this->m_storage.success);
                 return YES;
             }
             else
@@ -322,140 +641,422 @@ namespace LeyEngine
         /// @return 判定値です。
         Bool IsFailure(F &failure) noexcept
         {
-            if (this->m_isSuccess)
+            if (this->m_storage.isSuccess)
             {
-                return YES;
+                return NO;
             }
             else
             {
-                failure = Move(this->m_value.failure);
-                return NO;
+                failure = Move(this->m_storage.failure);
+                return YES;
             }
         }
     };
 
-    /// 複数の型で最も大きいの型サイズを返します。
+    /// 複数の型で最も大きい型サイズを返します。
     template<typename...Ts>
     constexpr USize MaxSizeOf() noexcept
     {
         return _Internal::_MaxSizeOf<Ts...>::MAX_SIZE;
     }
 
-    /// 可変長テンプレートから指定の型の位置を求めます。
+    /// 複数の型で最も大きいアライメントを返します。
+    template<typename...Ts>
+    constexpr USize MaxAlignOf() noexcept
+    {
+        return _Internal::_MaxAlignOf<Ts...>::MAX_ALIGN;
+    }
+
+    /// 可変長テンプレートから指定の型の位置をコンパイル時に求めます。
+    /// @return 指定の型の位置です。存在しない場合は型の数です。
+    template<typename T, typename...Ts>
+    constexpr USize TypeIndexOf() noexcept
+    {
+        return _Internal::_TypeIndexOf<T, Ts...>::INDEX;
+    }
+
+    /// 可変長テンプレートに指定の型が含まれるかコンパイル時に判定します。
+    /// @retval true 含まれます。
+    /// @retval false 含まれません。
     template<typename T, typename...Ts>
-    Result<USize, None> TypeIndexOf() noexcept
+    constexpr Bool ContainsType() noexcept
+    {
+        return _Internal::_TypeIndexOf<T, Ts...>::INDEX < sizeof...(Ts);
+    }
+
+    /// 指定位置の型を返します。
+    template<USize I, typename...Ts>
+    using TypeAt = typename _Internal::_TypeAt<I, Ts...>::TTarget;
+
+    /// 指定数の値を表現できる最小の符号無し整数型です。
+    template<USize COUNT>
+    using MinimumIndexOf = typename _Internal::_MinimumIndexOf<COUNT>::TIndex;
+
+    /// @cond LEYDOC_INTERNAL
+    /// 外部非公開の機能を含む名前空間です。
+    namespace _Internal
     {
-        USize index = 0;
-        if (_Internal::_TypeIndexOf<T, Ts...>{}(index))
+        /// バッファ上の値を破棄します。
+        template<typename T>
+        Void _DestroyAlternative(Void *buffer) noexcept
         {
-            return index;
+            std::launder(Cast<T*>(buffer))->~T();
         }
-        else
+
+        /// バッファ上の値をコピー構築します。
+        template<typename T>
+        Void _CopyAlternative(Void *buffer, const Void *origin) noexcept
         {
-            return NONE;
+            new(buffer) T(*std::launder(Cast<const T*>(origin)));
         }
-    }
 
-    /// 指定位置の型を返します。
-    template<USize I, typename...Ts>
-    using TypeAt = _Internal::_TypeAt<I,Ts...>::TTarget;
+        /// バッファ上の値をムーブ構築します。
+        template<typename T>
+        Void _MoveAlternative(Void *buffer, Void *origin) noexcept
+        {
+            new(buffer) T(Move(*std::launder(Cast<T*>(origin))));
+        }
+
+        /// バッファ上の値を関数に渡します。
+        template<typename T, typename R, typename Fn>
+        R _VisitAlternative(Void *buffer, Fn &&function)
+        {
+            return Forward<Fn>(function)(*std::launder(Cast<T*>(buffer)));
+        }
+
+        /// バッファ上の値を関数に渡します。
+        template<typename T, typename R, typename Fn>
+        R _VisitConstAlternative(const Void *buffer, Fn &&function)
+        {
+            return Forward<Fn>(function)(*std::launder(Cast<const T*>(buffer)));
+        }
+
+        /// Variantの値を保持するバッファです。
+        /// どれかの型が自明にコピーできない場合の特殊化です。
+        /// 型毎の処理はコンパイル時に生成した関数テーブルで分岐します。
+        /// @tparam IS_TRIVIAL すべての型が自明にコピー可能かの判定です。
+        /// @tparam Ts 保持する型です。
+        template<Bool IS_TRIVIAL, typename...Ts>
+        struct _VariantStorage
+        {
+            /// 添え字の型です。
+            using TIndex = MinimumIndexOf<sizeof...(Ts)>;
+
+            /// 値が無いことを表す添え字です。
+            static constexpr TIndex EMPTY_INDEX = static_cast<TIndex>(sizeof...(Ts));
+
+            alignas(MaxAlignOf<Ts...>()) U8 buffer[MaxSizeOf<Ts...>()]; // バッファ
+            TIndex activeIndex;                                          // 現在有効な値の型の位置
+
+            /// コンストラクタです。
+            _VariantStorage() noexcept
+                : activeIndex(EMPTY_INDEX)
+            {}
+
+            /// コピーします。
+            /// @param origin コピー元です。
+            _VariantStorage(const _VariantStorage &origin) noexcept
+                : activeIndex(origin.activeIndex)
+            {
+                this->CopyFrom(origin);
+            }
+
+            /// ムーブします。
+            /// @param origin ムーブ元です。
+            _VariantStorage(_VariantStorage &&origin) noexcept
+                : activeIndex(origin.activeIndex)
+            {
+                this->MoveFrom(origin);
+            }
+
+            /// コピー代入します。
+            /// @param origin コピー元です。
+            /// @return 自身の参照です。
+            _VariantStorage &operator=(const _VariantStorage &origin) noexcept
+            {
+                if (this != &origin)
+                {
+                    this->Destroy();
+                    this->activeIndex = origin.activeIndex;
+                    this->CopyFrom(origin);
+                }
+                return *this;
+            }
+
+            /// ムーブ代入します。
+            /// @param origin ムーブ元です。
+            /// @return 自身の参照です。
+            _VariantStorage &operator=(_VariantStorage &&origin) noexcept
+            {
+                if (this != &origin)
+                {
+                    this->Destroy();
+                    this->activeIndex = origin.activeIndex;
+                    this->MoveFrom(origin);
+                }
+                return *this;
+            }
+
+            /// デストラクタです。
+            ~_VariantStorage() noexcept
+            {
+                this->Destroy();
+            }
+
+            /// 保持している値を破棄します。
+            Void Destroy() noexcept
+            {
+                constexpr Void (*TABLE[])(Void*) = { &_DestroyAlternative<Ts>... };
+                if (this->activeIndex != EMPTY_INDEX)
+                {
+                    TABLE[this->activeIndex](this->buffer);
+                    this->activeIndex = EMPTY_INDEX;
+                }
+            }
+
+        private:
+
+            // コピー元の値をコピー構築します
+            Void CopyFrom(const _VariantStorage &origin) noexcept
+            {
+                constexpr Void (*TABLE[])(Void*, const Void*) = { &_CopyAlternative<Ts>... };
+                if (this->activeIndex != EMPTY_INDEX)
+                {
+                    TABLE[this->activeIndex](this->buffer, origin.buffer);
+                }
+            }
+
+            // ムーブ元の値をムーブ構築します
+            Void MoveFrom(_VariantStorage &origin) noexcept
+            {
+                constexpr Void (*TABLE[])(Void*, Void*) = { &_MoveAlternative<Ts>... };
+                if (this->activeIndex != EMPTY_INDEX)
+                {
+                    TABLE[this->activeIndex](this->buffer, origin.buffer);
+                }
+            }
+        };
+
+        /// Variantの値を保持するバッファです。
+        /// すべての型が自明にコピーできる場合の特殊化です。
+        /// コピー、ムーブ、破棄が自明となり、memcpyでの受け渡しが可能です。
+        /// @tparam Ts 保持する型です。
+        template<typename...Ts>
+        struct _VariantStorage<YES, Ts...>
+        {
+            /// 添え字の型です。
+            using TIndex = MinimumIndexOf<sizeof...(Ts)>;
+
+            /// 値が無いことを表す添え字です。
+            static constexpr TIndex EMPTY_INDEX = static_cast<TIndex>(sizeof...(Ts));
+
+            alignas(MaxAlignOf<Ts...>()) U8 buffer[MaxSizeOf<Ts...>()]; // バッファ
+            TIndex activeIndex;                                          // 現在有効な値の型の位置
+
+            /// コンストラクタです。
+            _VariantStorage() noexcept
+                : activeIndex(EMPTY_INDEX)
+            {}
+
+            /// 保持している値を破棄します。
+            Void Destroy() noexcept
+            {
+                this->activeIndex = EMPTY_INDEX;
+            }
+        };
+    }
+    /// @endcond
 
     /// どれか1つの型を保持します。
+    /// 型の位置はコンパイル時に決まり、判別値は型の数を表現できる最小の整数型です。
+    /// すべての型が自明にコピー可能な場合はVariantも自明にコピー可能です。
+    /// @tparam Ts 保持する型です。
     template<typename...Ts>
     struct Variant
     {
+        static_assert(sizeof...(Ts) > 0, "Variant requires at least one type.");
+        static_assert(sizeof...(Ts) < U32_MAX, "Too many types.");
+
+        /// 保持できる型の数です。
+        static constexpr USize COUNT = sizeof...(Ts);
+
         /// 値を保持するバッファのサイズです。
-        static constexpr SIZE = MaxSizeOf<Ts...>();
+        static constexpr USize SIZE = MaxSizeOf<Ts...>();
+
+        /// 値を保持するバッファのアライメントです。
+        static constexpr USize ALIGN = MaxAlignOf<Ts...>();
+
+        /// 判別値の型です。
+        using TIndex = MinimumIndexOf<COUNT>;
+
+        /// 値が無いことを表す判別値です。
+        static constexpr TIndex EMPTY_INDEX = static_cast<TIndex>(COUNT);
 
     private:
 
-        USize m_activeIndex; // 現在有能な値の型を表す数値です。
-        U8 m_buffer[MaxSizeOf<Ts...>()];   // バッファです。
-    
+        _Internal::_VariantStorage<(std::is_trivially_copyable_v<Ts> && ...), Ts...> m_storage; // バッファと判別値
+
     public:
 
         /// コンストラクタです。
-        Variant()
-            : m_activeIndex(SIZE)
+        Variant() noexcept
+            : m_storage()
         {}
 
+        /// 値を指定して構築します。
+        /// @tparam U 値の型です。Tsのどれかである必要があります。
+        /// @param value 値です。
+        template<typename U, typename = std::enable_if_t<ContainsType<std::decay_t<U>, Ts...>()>>
+        Variant(U &&value) noexcept
+            : m_storage()
+        {
+            this->Emplace<std::decay_t<U>>(Forward<U>(value));
+        }
+
         /// 値を代入します。
-        /// @tparam U 代入する値の型です。
+        /// @tparam U 代入する値の型です。Tsのどれかである必要があります。
         /// @param value 代入する値です。
-        /// @return 自身、または、失敗です。
-        template<typename U>
-        Result<Variant<Ts...>&, Failure> operator=(U &&value) noexcept
+        /// @return 自身の参照です。
+        template<typename U, typename = std::enable_if_t<ContainsType<std::decay_t<U>, Ts...>()>>
+        Variant<Ts...> &operator=(U &&value) noexcept
         {
-            USize index = 0;
-            Var res = TypeIndexOf<U, Ts...>();
-            if (res.IsSuccess(index))
-            {
-                this->m_activeIndex = index;
-                Var ptr = Cast<U*>(this->m_buffer);
-                *ptr = Move(value);
-                return *this;
-            }
-            else
+            this->Emplace<std::decay_t<U>>(Forward<U>(value));
+            return *this;
+        }
+
+        /// 値をその場で構築します。保持していた値は破棄されます。
+        /// @tparam U 構築する値の型です。Tsのどれかである必要があります。
+        /// @param args コンストラクタ引数です。
+        /// @return 構築した値の参照です。
+        template<typename U, typename...Args>
+        U &Emplace(Args &&...args) noexcept
+        {
+            static_assert(ContainsType<U, Ts...>(), "The type is not an alternative of this variant.");
+            this->m_storage.Destroy();
+            Var ptr = new(this->m_storage.buffer) U(Forward<Args>(args)...);
+            this->m_storage.activeIndex = static_cast<TIndex>(TypeIndexOf<U, Ts...>());
+            return *ptr;
+        }
+
+        /// 保持している値を破棄します。
+        Void Reset() noexcept
+        {
+            this->m_storage.Destroy();
+        }
+
+        /// 現在有効な値の型の位置を返します。
+        /// @return 型の位置、または、EMPTY_INDEXです。
+        TIndex Index() const noexcept
+        {
+            return this->m_storage.activeIndex;
+        }
+
+        /// 現在有効な値の型の識別子を返します。
+        /// @return 型の識別子、または、値を保持していない場合は型無しです。
+        TypeId ActiveTypeId() const noexcept
+        {
+            constexpr TypeId TABLE[] = { TypeIdOf<Ts>()..., TypeId() };
+            return TABLE[this->m_storage.activeIndex];
+        }
+
+        /// 型の識別子から判別値を求めます。
+        /// 保存した識別子から型を復元する場合などに、文字列を比較せずに分岐できます。
+        /// @param typeId 型の識別子です。
+        /// @return 判別値、または、どの型にも一致しない場合はEMPTY_INDEXです。
+        static constexpr TIndex IndexOf(TypeId typeId) noexcept
+        {
+            constexpr TypeId TABLE[] = { TypeIdOf<Ts>()... };
+            for (USize i = 0; i < COUNT; i++)
             {
-                return FAILURE;
+                if (TABLE[i] == typeId) return static_cast<TIndex>(i);
             }
+            return EMPTY_INDEX;
         }
 
-        /// ムーブ代入します。
-        /// @param origin ムーブ元です。
-        /// @return 自身です。
-        Variant<Ts...> &operator=(Variant<Ts...> &&origin) noexcept
+        /// 値を保持していないか判定します。
+        /// @retval true 値を保持していません。
+        /// @retval false 値を保持しています。
+        Bool IsEmpty() const noexcept
         {
-            if (this != origin)
-            {
-                // 交換します
+            return this->m_storage.activeIndex == EMPTY_INDEX;
+        }
 
-                Var tmpIndex = this->m_activeIndex;
-                U8 tmpBuffer[MaxSizeOf<Ts...>()];
-                for (USize i = 0; i < SIZE; i++)
-                {
-                    tmpBuffer[i] = this->m_buffer[i];
-                }
-                
-                this->m_activeIndex = origin.m_activeIndex;
-                for (USize i = 0; i < SIZE; i++)
-                {
-                    this->m_buffer[i] = origin.m_buffer[i];
-                }
+        /// 指定の型の値を保持しているか判定します。
+        /// @tparam U 判定する型です。
+        /// @retval true 保持しています。
+        /// @retval false 保持していません。
+        template<typename U>
+        Bool Is() const noexcept
+        {
+            static_assert(ContainsType<U, Ts...>(), "The type is not an alternative of this variant.");
+            return this->m_storage.activeIndex == TypeIndexOf<U, Ts...>();
+        }
 
-                origin.m_activeIndex = tmpIndex;
-                for (USize i = 0; i < SIZE; i++)
-                {
-                    origin.m_buffer[i] = tmpBuffer[i];
-                }
-            }
-            return *this;
+        /// 指定の型の値を保持している場合にポインタを返します。
+        /// @tparam U 取得する型です。
+        /// @return 値のポインタ、または、NONEです。
+        template<typename U>
+        U *TryGet() noexcept
+        {
+            return this->Is<U>() ? std::launder(Cast<U*>(this->m_storage.buffer)) : NONE;
         }
 
-        /// ムーブします。
-        /// @param origin ムーブ元です。
-        Variant(Variant<Ts...> &&origin) noexcept
+        /// 指定の型の値を保持している場合にポインタを返します。
+        /// @tparam U 取得する型です。
+        /// @return 値のポインタ、または、NONEです。
+        template<typename U>
+        const U *TryGet() const noexcept
         {
-            *this = Move(origin);
+            return this->Is<U>() ? std::launder(Cast<const U*>(this->m_storage.buffer)) : NONE;
         }
 
-        /// 指定位置の型が有効な場合に返します。
+        /// 指定位置の型が有効な場合に値をムーブして返します。
+        /// 値を返した後は値を保持しない状態になります。
         /// @tparam I 指定位置です。
         /// @return 値、または、失敗です。
         template<USize I>
-        Result<TypeAt<I, Ts...>&&, Failure> At() noexcept
+        Result<TypeAt<I, Ts...>, Failure> At() noexcept
         {
-            if (this->m_activeIndex == TypeIndexOf<TypeAt<I, Ts...>, Ts...>())
+            using TTarget = TypeAt<I, Ts...>;
+            if (this->m_storage.activeIndex == I)
             {
-                Var ptr = Cast<TypeAt<I, Ts...>*>(this->m_buffer);
-                this->m_activeIndex = SIZE;
-                return Move(*ptr);
+                Result<TTarget, Failure> res(IN_PLACE_SUCCESS, Move(*std::launder(Cast<TTarget*>(this->m_storage.buffer))));
+                this->m_storage.Destroy();
+                return res;
             }
             else
             {
-                return FAILURE;
+                return Result<TTarget, Failure>(IN_PLACE_FAILURE, FAILURE);
             }
         }
+
+        /// 保持している値を関数に渡します。
+        /// 分岐はコンパイル時に生成した関数テーブルで行います。値を保持している場合のみ呼び出せ、保持していない場合はアサートします。
+        /// @param function すべての型を受け取れる関数です。戻り値の型はすべての型で同じである必要があります。
+        /// @return 関数の戻り値です。
+        template<typename Fn>
+        decltype(auto) Visit(Fn &&function)
+        {
+            using TReturn = std::invoke_result_t<Fn, TypeAt<0, Ts...>&>;
+            constexpr TReturn (*TABLE[])(Void*, Fn&&) = { &_Internal::_VisitAlternative<Ts, TReturn, Fn>... };
+            // 値を保持していない場合は表の範囲外になります
+            assert(!this->IsEmpty() && "Visit requires a variant holding a value.");
+            return TABLE[this->m_storage.activeIndex](this->m_storage.buffer, Forward<Fn>(function));
+        }
+
+        /// 保持している値を関数に渡します。
+        /// 分岐はコンパイル時に生成した関数テーブルで行います。値を保持している場合のみ呼び出せ、保持していない場合はアサートします。
+        /// @param function すべての型を受け取れる関数です。戻り値の型はすべての型で同じである必要があります。
+        /// @return 関数の戻り値です。
+        template<typename Fn>
+        decltype(auto) Visit(Fn &&function) const
+        {
+            using TReturn = std::invoke_result_t<Fn, const TypeAt<0, Ts...>&>;
+            constexpr TReturn (*TABLE[])(const Void*, Fn&&) = { &_Internal::_VisitConstAlternative<Ts, TReturn, Fn>... };
+            // 値を保持していない場合は表の範囲外になります
+            assert(!this->IsEmpty() && "Visit requires a variant holding a value.");
+            return TABLE[this->m_storage.activeIndex](this->m_storage.buffer, Forward<Fn>(function));
+        }
     };
 }
 
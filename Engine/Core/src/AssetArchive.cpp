@@ -0,0 +1,480 @@
+// AssetArchive.cpp
+// (C) 2022 LeyCommunity.
+// author Taichi Ito.
+
+#include <cstdio>
+#include <cstring>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "LeyEngine/AssetArchive.hpp"
+#include "LeyEngine/Compression.hpp"
+#include "LeyEngine/Hash.hpp"
+
+using namespace LeyEngine;
+
+// --------------------
+//
+// 名前
+//
+// ====================
+
+// 名前のFNV-1aハッシュ値を求めます。
+// 形式の一部のため、FNV-1aから変更してはいけません。
+U64 HashAssetName(const Char *name, USize nameSize) noexcept
+{
+    return HashFnv1a64(name, nameSize);
+}
+
+// 名前を比較します。
+int CompareAssetName(U64 leftHash, const Char *left, USize leftSize, U64 rightHash, const Char *right, USize rightSize) noexcept
+{
+    if (leftHash != rightHash) return leftHash < rightHash ? -1 : 1;
+    Var size = leftSize < rightSize ? leftSize : rightSize;
+    // 空の名前はポインタがNONEの場合があるため比較しません
+    if (size != 0)
+    {
+        Var result = std::memcmp(left, right, size);
+        if (result != 0) return result;
+    }
+    if (leftSize != rightSize) return leftSize < rightSize ? -1 : 1;
+    return 0;
+}
+
+// LZ4の展開関数です。
+Result<USize, EAssetError> DecompressLz4(const U8 *pSource, USize sourceSize, U8 *pDestination, USize destinationSize)
+{
+    Var result = Lz4Decompress(pSource, sourceSize, pDestination, destinationSize);
+    if (result.IsFailure()) return EAssetError::DECOMPRESS_FAILED;
+    return result.Value();
+}
+
+// --------------------
+//
+// 書き込み
+//
+// ====================
+
+// 書き込むアセットの情報です。
+struct AssetWriteItem
+{
+    const AssetSource *pSource; // アセット
+    U64 nameHash;               // 名前のハッシュ値
+    const Void *pData;          // 格納するデータ
+    USize size;                 // 格納するデータのバイトサイズ
+    U8 *pCompressed;            // 圧縮したデータ
+    USize compressedCapacity;   // 圧縮したデータのバッファサイズ
+    EAssetCompression compression;  // 圧縮形式
+};
+
+// 0で埋めてアライメントを揃えます。
+Bool WritePadding(std::FILE *pFile, U64 &position, USize alignment) noexcept
+{
+    static const U8 ZEROS[ASSET_ARCHIVE_ALIGNMENT] = {};
+    Var padding = static_cast<USize>(AlignUp(static_cast<USize>(position), alignment) - position);
+    if (padding != 0 && std::fwrite(ZEROS, 1, padding, pFile) != padding) return NO;
+    position += padding;
+    return YES;
+}
+
+// 書き込むアセットを名前の順に比較します。
+int CompareAssetWriteItem(const AssetWriteItem &left, const AssetWriteItem &right) noexcept
+{
+    return CompareAssetName(left.nameHash, left.pSource->name, left.pSource->nameSize, right.nameHash, right.pSource->name, right.pSource->nameSize);
+}
+
+// ヒープの根から要素を下ろし、ヒープの条件を満たすようにします。
+Void SiftDownAssetWriteItems(AssetWriteItem *pItems, USize root, USize count) noexcept
+{
+    Var item = pItems[root];
+    for (;;)
+    {
+        Var child = root * 2 + 1;
+        if (child >= count) break;
+        if (child + 1 < count && CompareAssetWriteItem(pItems[child], pItems[child + 1]) < 0) child++;
+        if (CompareAssetWriteItem(item, pItems[child]) >= 0) break;
+        pItems[root] = pItems[child];
+        root = child;
+    }
+    pItems[root] = item;
+}
+
+// 書き込むアセットを名前のハッシュ値、名前の順にヒープソートで整列します。
+// 低レベルの書き込み処理がジョブシステムに依存しないよう、並列の整列は使用しません。
+Void SortAssetWriteItems(AssetWriteItem *pItems, USize count) noexcept
+{
+    for (USize i = count / 2; i > 0; i--) SiftDownAssetWriteItems(pItems, i - 1, count);
+    for (USize end = count; end > 1; end--)
+    {
+        Var item = pItems[0];
+        pItems[0] = pItems[end - 1];
+        pItems[end - 1] = item;
+        SiftDownAssetWriteItems(pItems, 0, end - 1);
+    }
+}
+
+// アセットアーカイブを書き込みます。
+Result<Success, EAssetError> WriteAssetArchiveItems(std::FILE *pFile, AssetWriteItem *pItems, USize count) noexcept
+{
+    // 名前のハッシュ値、名前の順に整列します
+    SortAssetWriteItems(pItems, count);
+    // 配置を決めます
+    AssetArchiveHeader header = {};
+    header.magic = ASSET_ARCHIVE_MAGIC;
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.entryCount = count;
+    header.entriesOffset = AlignUp(sizeof(AssetArchiveHeader), ASSET_ARCHIVE_ALIGNMENT);
+    header.namesOffset = header.entriesOffset + count * sizeof(AssetArchiveEntry);
+    for (USize i = 0; i < count; i++)
+    {
+        header.namesSize += pItems[i].pSource->nameSize;
+    }
+    U64 position = AlignUp(static_cast<USize>(header.namesOffset + header.namesSize), ASSET_ARCHIVE_ALIGNMENT);
+    for (USize i = 0; i < count; i++)
+    {
+        position = AlignUp(static_cast<USize>(position), ASSET_ARCHIVE_ALIGNMENT) + pItems[i].size;
+    }
+    header.fileSize = position;
+    // ヘッダー、目次、名前を書き込みます
+    position = 0;
+    if (std::fwrite(&header, sizeof(header), 1, pFile) != 1) return EAssetError::WRITE_FAILED;
+    position += sizeof(header);
+    if (!WritePadding(pFile, position, ASSET_ARCHIVE_ALIGNMENT)) return EAssetError::WRITE_FAILED;
+    U32 nameOffset = 0;
+    U64 dataOffset = AlignUp(static_cast<USize>(header.namesOffset + header.namesSize), ASSET_ARCHIVE_ALIGNMENT);
+    for (USize i = 0; i < count; i++)
+    {
+        const Var &item = pItems[i];
+        AssetArchiveEntry entry = {};
+        entry.nameHash = item.nameHash;
+        entry.nameOffset = nameOffset;
+        entry.nameSize = static_cast<U32>(item.pSource->nameSize);
+        entry.offset = dataOffset;
+        entry.size = item.size;
+        entry.originalSize = item.compression == EAssetCompression::UNCOMPRESSED || !item.pSource->isPrecompressed ? item.pSource->size : item.pSource->originalSize;
+        entry.compression = item.compression;
+        entry.checksum = Crc32c(item.pData, item.size);
+        if (std::fwrite(&entry, sizeof(entry), 1, pFile) != 1) return EAssetError::WRITE_FAILED;
+        nameOffset += entry.nameSize;
+        dataOffset = AlignUp(static_cast<USize>(dataOffset + item.size), ASSET_ARCHIVE_ALIGNMENT);
+    }
+    position += count * sizeof(AssetArchiveEntry);
+    for (USize i = 0; i < count; i++)
+    {
+        Var pSource = pItems[i].pSource;
+        if (pSource->nameSize != 0 && std::fwrite(pSource->name, 1, pSource->nameSize, pFile) != pSource->nameSize) return EAssetError::WRITE_FAILED;
+        position += pSource->nameSize;
+    }
+    // データを書き込みます
+    for (USize i = 0; i < count; i++)
+    {
+        if (!WritePadding(pFile, position, ASSET_ARCHIVE_ALIGNMENT)) return EAssetError::WRITE_FAILED;
+        if (pItems[i].size != 0 && std::fwrite(pItems[i].pData, 1, pItems[i].size, pFile) != pItems[i].size) return EAssetError::WRITE_FAILED;
+        position += pItems[i].size;
+    }
+    return SUCCESS;
+}
+
+// アセットアーカイブを書き込みます。
+Result<Success, EAssetError> LeyEngine::WriteAssetArchive(const Char *path, const AssetSource *pSources, USize count) noexcept
+{
+    if (path == NONE || (pSources == NONE && count != 0)) return EAssetError::INVALID_ARGUMENT;
+    AssetWriteItem *pItems = NONE;
+    if (count != 0)
+    {
+        Var itemsResult = Allocate(count * sizeof(AssetWriteItem));
+        if (itemsResult.IsFailure()) return EAssetError::BAD_ALLOCATE;
+        pItems = Cast<AssetWriteItem*>(itemsResult.Value());
+    }
+    // 必要に応じて圧縮します
+    Result<Success, EAssetError> result = SUCCESS;
+    USize preparedCount = 0;
+    for (; preparedCount < count; preparedCount++)
+    {
+        const Var &source = pSources[preparedCount];
+        Var &item = pItems[preparedCount];
+        item = AssetWriteItem{ &source, HashAssetName(source.name, source.nameSize), source.pData, source.size, NONE, 0, source.compression };
+        if (source.nameSize > 0xFFFFFFFF || (source.pData == NONE && source.size != 0)
+            || static_cast<USize>(source.compression) >= ASSET_COMPRESSION_COUNT)
+        {
+            result = EAssetError::INVALID_ARGUMENT;
+            break;
+        }
+        if (source.compression == EAssetCompression::UNCOMPRESSED || source.isPrecompressed) continue;
+        if (source.compression != EAssetCompression::LZ4 || source.size == 0)
+        {
+            // ZSTDの圧縮は呼び出し側で行う必要があります
+            if (source.compression != EAssetCompression::LZ4)
+            {
+                result = EAssetError::UNSUPPORTED_COMPRESSION;
+                break;
+            }
+            item.compression = EAssetCompression::UNCOMPRESSED;
+            continue;
+        }
+        item.compressedCapacity = Lz4CompressBound(source.size);
+        Var bufferResult = Allocate(item.compressedCapacity);
+        if (bufferResult.IsFailure())
+        {
+            result = EAssetError::BAD_ALLOCATE;
+            break;
+        }
+        item.pCompressed = Cast<U8*>(bufferResult.Value());
+        Var compressResult = Lz4Compress(source.pData, source.size, item.pCompressed, item.compressedCapacity);
+        if (compressResult.IsSuccess() && compressResult.Value() < source.size)
+        {
+            item.pData = item.pCompressed;
+            item.size = compressResult.Value();
+        }
+        else
+        {
+            // 縮まない場合は圧縮せずに格納します
+            item.compression = EAssetCompression::UNCOMPRESSED;
+        }
+    }
+    if (result.IsSuccess())
+    {
+        Var pFile = std::fopen(Cast<const char*>(path), "wb");
+        if (pFile != NONE)
+        {
+            result = WriteAssetArchiveItems(pFile, pItems, count);
+            if (std::fclose(pFile) != 0 && result.IsSuccess()) result = EAssetError::WRITE_FAILED;
+        }
+        else
+        {
+            result = EAssetError::OPEN_FAILED;
+        }
+    }
+    for (USize i = 0; i < preparedCount; i++)
+    {
+        if (pItems[i].pCompressed != NONE) (Void)Deallocate(pItems[i].compressedCapacity, pItems[i].pCompressed);
+    }
+    if (pItems != NONE) (Void)Deallocate(count * sizeof(AssetWriteItem), pItems);
+    return result;
+}
+
+// --------------------
+//
+// 読み込み
+//
+// ====================
+
+// 作成します。
+AssetArchive::AssetArchive(Void *pMapping, USize mappingSize, ISize mappingHandle) noexcept
+    : m_pMapping(pMapping)
+    , m_mappingSize(mappingSize)
+    , m_mappingHandle(mappingHandle)
+    , m_pEntries(NONE)
+    , m_entryCount(0)
+    , m_pNames(NONE)
+    , m_decompressors{ NONE, &DecompressLz4, NONE }
+{
+    Var pHeader = Cast<const AssetArchiveHeader*>(pMapping);
+    this->m_pEntries = Cast<const AssetArchiveEntry*>(Cast<const U8*>(pMapping) + pHeader->entriesOffset);
+    this->m_entryCount = static_cast<USize>(pHeader->entryCount);
+    this->m_pNames = Cast<const Char*>(Cast<const U8*>(pMapping) + pHeader->namesOffset);
+}
+
+// ファイルの内容を検証します。
+Bool ValidateAssetArchive(const U8 *pData, USize size) noexcept
+{
+    if (size < sizeof(AssetArchiveHeader)) return NO;
+    Var pHeader = Cast<const AssetArchiveHeader*>(pData);
+    if (pHeader->magic != ASSET_ARCHIVE_MAGIC || pHeader->version != ASSET_ARCHIVE_VERSION || pHeader->fileSize != size) return NO;
+    if (pHeader->entriesOffset % alignof(AssetArchiveEntry) != 0 || pHeader->entriesOffset > size) return NO;
+    if (pHeader->entryCount > (size - pHeader->entriesOffset) / sizeof(AssetArchiveEntry)) return NO;
+    if (pHeader->namesOffset > size || pHeader->namesSize > size - pHeader->namesOffset) return NO;
+    // 目次の範囲を検証するため、以降の読み込みは範囲内であることが保証されます
+    Var pEntries = Cast<const AssetArchiveEntry*>(pData + pHeader->entriesOffset);
+    for (U64 i = 0; i < pHeader->entryCount; i++)
+    {
+        const Var &entry = pEntries[i];
+        if (static_cast<U64>(entry.nameOffset) + entry.nameSize > pHeader->namesSize) return NO;
+        if (entry.offset > size || entry.size > size - entry.offset) return NO;
+        if (static_cast<USize>(entry.compression) >= ASSET_COMPRESSION_COUNT) return NO;
+        if (entry.compression == EAssetCompression::UNCOMPRESSED && entry.size != entry.originalSize) return NO;
+    }
+    return YES;
+}
+
+// アセットアーカイブを開き、メモリにマップします。
+Result<AssetArchive, EAssetError> AssetArchive::Open(const Char *path) noexcept
+{
+    if (path == NONE) return EAssetError::INVALID_ARGUMENT;
+#if defined(_WIN32)
+    Var length = MultiByteToWideChar(CP_UTF8, 0, Cast<const char*>(path), -1, NONE, 0);
+    if (length <= 0) return EAssetError::INVALID_ARGUMENT;
+    Var pathSize = static_cast<USize>(length) * sizeof(wchar_t);
+    Var pathResult = Allocate(pathSize);
+    if (pathResult.IsFailure()) return EAssetError::BAD_ALLOCATE;
+    Var pPath = Cast<wchar_t*>(pathResult.Value());
+    MultiByteToWideChar(CP_UTF8, 0, Cast<const char*>(path), -1, pPath, length);
+    Var file = CreateFileW(pPath, GENERIC_READ, FILE_SHARE_READ, NONE, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NONE);
+    (Void)Deallocate(pathSize, pPath);
+    if (file == INVALID_HANDLE_VALUE) return EAssetError::OPEN_FAILED;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        return EAssetError::INVALID_FORMAT;
+    }
+    // マッピングはファイルハンドルを閉じても有効です
+    Var mapping = CreateFileMappingW(file, NONE, PAGE_READONLY, 0, 0, NONE);
+    CloseHandle(file);
+    if (mapping == NONE) return EAssetError::MAPPING_FAILED;
+    Var pMapping = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (pMapping == NONE)
+    {
+        CloseHandle(mapping);
+        return EAssetError::MAPPING_FAILED;
+    }
+    Var size = static_cast<USize>(fileSize.QuadPart);
+    if (!ValidateAssetArchive(Cast<const U8*>(pMapping), size))
+    {
+        UnmapViewOfFile(pMapping);
+        CloseHandle(mapping);
+        return EAssetError::INVALID_FORMAT;
+    }
+    return AssetArchive(pMapping, size, Cast<ISize>(mapping));
+#else
+    Var fd = open(Cast<const char*>(path), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return EAssetError::OPEN_FAILED;
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size <= 0)
+    {
+        close(fd);
+        return EAssetError::INVALID_FORMAT;
+    }
+    // マップはファイルディスクリプタを閉じても有効です
+    Var size = static_cast<USize>(status.st_size);
+    Var pMapping = mmap(NONE, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pMapping == MAP_FAILED) return EAssetError::MAPPING_FAILED;
+    if (!ValidateAssetArchive(Cast<const U8*>(pMapping), size))
+    {
+        munmap(pMapping, size);
+        return EAssetError::INVALID_FORMAT;
+    }
+    return AssetArchive(pMapping, size, -1);
+#endif
+}
+
+// ムーブコンストラクタです。
+AssetArchive::AssetArchive(AssetArchive &&origin) noexcept
+    : m_pMapping(origin.m_pMapping)
+    , m_mappingSize(origin.m_mappingSize)
+    , m_mappingHandle(origin.m_mappingHandle)
+    , m_pEntries(origin.m_pEntries)
+    , m_entryCount(origin.m_entryCount)
+    , m_pNames(origin.m_pNames)
+{
+    for (USize i = 0; i < ASSET_COMPRESSION_COUNT; i++)
+    {
+        this->m_decompressors[i] = origin.m_decompressors[i];
+    }
+    origin.m_pMapping = NONE;
+    origin.m_mappingSize = 0;
+    origin.m_mappingHandle = -1;
+    origin.m_pEntries = NONE;
+    origin.m_entryCount = 0;
+    origin.m_pNames = NONE;
+}
+
+// デストラクタです。
+AssetArchive::~AssetArchive() noexcept
+{
+    if (this->m_pMapping == NONE) return;
+#if defined(_WIN32)
+    UnmapViewOfFile(this->m_pMapping);
+    CloseHandle(Cast<HANDLE>(this->m_mappingHandle));
+#else
+    munmap(this->m_pMapping, this->m_mappingSize);
+#endif
+}
+
+// 圧縮形式の展開関数を登録します。
+Void AssetArchive::SetDecompressor(EAssetCompression compression, AssetDecompressor decompressor) noexcept
+{
+    if (static_cast<USize>(compression) >= ASSET_COMPRESSION_COUNT) return;
+    this->m_decompressors[static_cast<USize>(compression)] = decompressor;
+}
+
+// アセットの数を返します。
+USize AssetArchive::Count() const noexcept
+{
+    return this->m_entryCount;
+}
+
+// 目次の項目を返します。
+const AssetArchiveEntry &AssetArchive::EntryAt(USize index) const noexcept
+{
+    return this->m_pEntries[index];
+}
+
+// アセットの名前を返します。
+AssetView AssetArchive::NameOf(const AssetArchiveEntry &entry) const noexcept
+{
+    return AssetView{ Cast<const U8*>(this->m_pNames + entry.nameOffset), entry.nameSize };
+}
+
+// 名前からアセットを検索します。
+Result<const AssetArchiveEntry*, EAssetError> AssetArchive::Find(const Char *name, USize nameSize) const noexcept
+{
+    if (name == NONE && nameSize != 0) return EAssetError::INVALID_ARGUMENT;
+    Var hash = HashAssetName(name, nameSize);
+    // 目次は整列しているため二分探索します
+    USize first = 0;
+    USize last = this->m_entryCount;
+    while (first < last)
+    {
+        Var middle = first + (last - first) / 2;
+        const Var &entry = this->m_pEntries[middle];
+        Var order = CompareAssetName(entry.nameHash, this->m_pNames + entry.nameOffset, entry.nameSize, hash, name, nameSize);
+        if (order == 0) return &entry;
+        if (order < 0) first = middle + 1;
+        else last = middle;
+    }
+    return EAssetError::NOT_FOUND;
+}
+
+// 圧縮していないアセットのデータを参照します。
+Result<AssetView, EAssetError> AssetArchive::View(const AssetArchiveEntry &entry) const noexcept
+{
+    if (entry.compression != EAssetCompression::UNCOMPRESSED) return EAssetError::COMPRESSED;
+    return AssetView{ Cast<const U8*>(this->m_pMapping) + entry.offset, static_cast<USize>(entry.size) };
+}
+
+// 格納しているデータをチェックサムで検証します。
+Result<Success, EAssetError> AssetArchive::Verify(const AssetArchiveEntry &entry) const noexcept
+{
+    Var pData = Cast<const U8*>(this->m_pMapping) + entry.offset;
+    if (Crc32c(pData, static_cast<USize>(entry.size)) != entry.checksum) return EAssetError::CHECKSUM_MISMATCH;
+    return SUCCESS;
+}
+
+// アセットのデータを標準メモリから確保したバッファに展開します。
+Result<AssetBuffer, EAssetError> AssetArchive::Load(const AssetArchiveEntry &entry) const noexcept
+{
+    Var decompressor = this->m_decompressors[static_cast<USize>(entry.compression)];
+    if (entry.compression != EAssetCompression::UNCOMPRESSED && decompressor == NONE) return EAssetError::UNSUPPORTED_COMPRESSION;
+    Var size = static_cast<USize>(entry.originalSize);
+    if (size == 0) return AssetBuffer(NONE, 0);
+    Var bufferResult = Allocate(size);
+    if (bufferResult.IsFailure()) return EAssetError::BAD_ALLOCATE;
+    AssetBuffer buffer(Cast<U8*>(bufferResult.Value()), size);
+    Var pSource = Cast<const U8*>(this->m_pMapping) + entry.offset;
+    if (entry.compression == EAssetCompression::UNCOMPRESSED)
+    {
+        std::memcpy(buffer.Data(), pSource, size);
+        return Move(buffer);
+    }
+    Var result = decompressor(pSource, static_cast<USize>(entry.size), buffer.Data(), size);
+    if (result.IsFailure()) return result.Error();
+    if (result.Value() != size) return EAssetError::DECOMPRESS_FAILED;
+    return Move(buffer);
+}
\ No newline at end of file
@@ -0,0 +1,903 @@
+// AsyncIO.cpp
+// (C) 2022 LeyCommunity.
+// author Taichi Ito.
+
+#include <mutex>
+#ifdef LEYENGINE_CORE_MODULE
+#include <atomic>
+#include <condition_variable>
+#include <new>
+#include <thread>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+// io_uringを使用します
+#define _LEYENGINE_IO_URING
+#include <cstring>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+#endif
+#include "LeyEngine/AsyncIO.hpp"
+#include "LeyEngine/Job.hpp"
+
+using namespace LeyEngine;
+
+#ifdef LEYENGINE_CORE_MODULE
+
+// --------------------
+//
+// 設定
+//
+// ====================
+
+// io_uringを使用できない場合に読み込みを行うワーカースレッドの数
+constexpr USize IO_WORKER_COUNT = 2;
+// 一度にジョブシステムに渡す完了の数
+constexpr USize IO_COMPLETION_JOB_BATCH = 32;
+#ifdef _LEYENGINE_IO_URING
+// io_uringのサブミッションキューのエントリ数
+constexpr U32 IO_URING_ENTRY_COUNT = 256;
+// 読み込み以外の操作のために空けておくエントリ数
+constexpr U32 IO_URING_RESERVED_ENTRY_COUNT = 8;
+// イベントファイルの監視を表すユーザーデータ
+constexpr U64 IO_URING_WAKE_USER_DATA = 0;
+// キャンセル操作を表すユーザーデータ
+constexpr U64 IO_URING_CANCEL_USER_DATA = 1;
+#endif
+
+// --------------------
+//
+// 読み込み要求
+//
+// ====================
+
+// 読み込み要求の管理情報です。
+struct IORequestNode
+{
+    IORequestNode *pPrevious;   // リストの前のノード
+    IORequestNode *pNext;       // リストの次のノード
+    U64 id;                     // 識別子
+    IOReadRequest request;      // 読み込み要求
+    USize readLength;           // ファイルから読み込むバイトサイズ
+    USize readSize;             // 読み込んだバイトサイズ
+    EIOError error;             // エラー
+    Bool isFailure;             // 失敗したか
+    Bool isBufferOwned;         // バッファを確保したか
+    Bool isCanceled;            // キャンセルを要求されたか
+    Bool isCancelSubmitted;     // キャンセル操作を発行したか
+};
+
+// 読み込み要求の双方向リストです。
+struct IORequestList
+{
+    IORequestNode *pFirst = NONE;   // 先頭のノード
+    IORequestNode *pLast = NONE;    // 末尾のノード
+
+    // 末尾にノードを追加します。
+    Void PushBack(IORequestNode *pNode) noexcept
+    {
+        pNode->pPrevious = this->pLast;
+        pNode->pNext = NONE;
+        if (this->pLast != NONE) this->pLast->pNext = pNode;
+        else this->pFirst = pNode;
+        this->pLast = pNode;
+    }
+
+    // 先頭にノードを追加します。
+    Void PushFront(IORequestNode *pNode) noexcept
+    {
+        pNode->pPrevious = NONE;
+        pNode->pNext = this->pFirst;
+        if (this->pFirst != NONE) this->pFirst->pPrevious = pNode;
+        else this->pLast = pNode;
+        this->pFirst = pNode;
+    }
+
+    // ノードを取り除きます。
+    Void Remove(IORequestNode *pNode) noexcept
+    {
+        if (pNode->pPrevious != NONE) pNode->pPrevious->pNext = pNode->pNext;
+        else this->pFirst = pNode->pNext;
+        if (pNode->pNext != NONE) pNode->pNext->pPrevious = pNode->pPrevious;
+        else this->pLast = pNode->pPrevious;
+        pNode->pPrevious = NONE;
+        pNode->pNext = NONE;
+    }
+
+    // 先頭のノードを取り出します。
+    IORequestNode *PopFront() noexcept
+    {
+        Var pNode = this->pFirst;
+        if (pNode != NONE) this->Remove(pNode);
+        return pNode;
+    }
+
+    // 識別子からノードを検索します。
+    IORequestNode *Find(U64 id) const noexcept
+    {
+        for (Var pNode = this->pFirst; pNode != NONE; pNode = pNode->pNext)
+        {
+            if (pNode->id == id) return pNode;
+        }
+        return NONE;
+    }
+};
+
+// 読み込み要求を作成します。
+Result<IORequestNode*, EIOError> NewRequestNode(const IOReadRequest &request) noexcept
+{
+    if (request.size == 0 || request.file.handle < 0) return EIOError::INVALID_ARGUMENT;
+    if (static_cast<USize>(request.priority) >= IO_PRIORITY_COUNT) return EIOError::INVALID_ARGUMENT;
+    // ダイレクト入出力ではオフセット、バッファ、サイズのアライメントが必要です
+    if (request.file.isDirect)
+    {
+        if (request.offset % IO_DIRECT_ALIGNMENT != 0) return EIOError::INVALID_ARGUMENT;
+        if (request.pBuffer != NONE
+            && (Cast<USize>(request.pBuffer) % IO_DIRECT_ALIGNMENT != 0 || request.size % IO_DIRECT_ALIGNMENT != 0))
+        {
+            return EIOError::INVALID_ARGUMENT;
+        }
+    }
+    Var nodeResult = Allocate(sizeof(IORequestNode));
+    if (nodeResult.IsFailure()) return EIOError::BAD_ALLOCATE;
+    Var pNode = new(nodeResult.Value()) IORequestNode();
+    pNode->request = request;
+    pNode->readLength = request.file.isDirect ? AlignUp(request.size, IO_DIRECT_ALIGNMENT) : request.size;
+    if (request.pBuffer == NONE)
+    {
+        Var bufferResult = AllocateIOBuffer(request.size);
+        if (bufferResult.IsFailure())
+        {
+            (Void)Deallocate(sizeof(IORequestNode), pNode);
+            return EIOError::BAD_ALLOCATE;
+        }
+        pNode->request.pBuffer = bufferResult.Value();
+        pNode->isBufferOwned = YES;
+    }
+    return pNode;
+}
+
+// 読み込み要求を破棄します。
+Void DeleteRequestNode(IORequestNode *pNode, Bool isBufferReleased) noexcept
+{
+    if (isBufferReleased && pNode->isBufferOwned)
+    {
+        (Void)DeallocateIOBuffer(pNode->request.size, pNode->request.pBuffer);
+    }
+    pNode->~IORequestNode();
+    (Void)Deallocate(sizeof(IORequestNode), pNode);
+}
+
+// 完了した読み込み要求のコールバックを呼び出し、要求を破棄します。
+Void DeliverCompletion(IORequestNode *pNode) noexcept
+{
+    // キャンセルした要求のバッファは通知せずに解放します
+    Var isBufferReleased = pNode->isFailure && pNode->error == EIOError::CANCELED;
+    Var readSize = pNode->readSize < pNode->request.size ? pNode->readSize : pNode->request.size;
+    IOCompletion completion =
+    {
+        pNode->id,
+        isBufferReleased && pNode->isBufferOwned ? NONE : pNode->request.pBuffer,
+        pNode->request.size,
+        pNode->isBufferOwned && !isBufferReleased,
+        pNode->isFailure ? Result<USize, EIOError>(pNode->error) : Result<USize, EIOError>(readSize),
+        pNode->request.pUserData,
+    };
+    if (pNode->request.callback != NONE) pNode->request.callback(completion);
+    DeleteRequestNode(pNode, isBufferReleased);
+}
+
+// 完了した読み込み要求をジョブとして通知します。
+Void RunCompletionJob(Void *pData) noexcept
+{
+    DeliverCompletion(Cast<IORequestNode*>(pData));
+}
+
+// --------------------
+//
+// ファイル
+//
+// ====================
+
+// ファイルの指定位置からブロッキングで読み込みます。
+// 読み込みが終わるか、ファイルの終端に達するまで繰り返します。
+Bool ReadBlocking(IORequestNode *pNode) noexcept
+{
+    Var pBuffer = Cast<U8*>(pNode->request.pBuffer);
+    while (pNode->readSize < pNode->readLength)
+    {
+        Var offset = pNode->request.offset + pNode->readSize;
+        Var length = pNode->readLength - pNode->readSize;
+#if defined(_WIN32)
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD readSize = 0;
+        Var chunkLength = static_cast<DWORD>(length > 0x40000000 ? 0x40000000 : length);
+        if (!ReadFile(Cast<HANDLE>(pNode->request.file.handle), pBuffer + pNode->readSize, chunkLength, &readSize, &overlapped))
+        {
+            if (GetLastError() == ERROR_HANDLE_EOF) break;
+            return NO;
+        }
+#else
+        Var readSize = pread(static_cast<int>(pNode->request.file.handle), pBuffer + pNode->readSize, length, static_cast<off_t>(offset));
+        if (readSize < 0)
+        {
+            if (errno == EINTR) continue;
+            return NO;
+        }
+#endif
+        if (readSize == 0) break;
+        pNode->readSize += static_cast<USize>(readSize);
+    }
+    return YES;
+}
+
+// 非同期ファイル入出力で読み込むファイルを開きます。
+Result<IOFile, EIOError> LeyEngine::OpenIOFile(const Char *path, Bool isDirect) noexcept
+{
+    if (path == NONE) return EIOError::INVALID_ARGUMENT;
+#if defined(_WIN32)
+    // UTF-8のパスをUTF-16に変換します
+    Var length = MultiByteToWideChar(CP_UTF8, 0, Cast<const char*>(path), -1, NONE, 0);
+    if (length <= 0) return EIOError::INVALID_ARGUMENT;
+    Var size = static_cast<USize>(length) * sizeof(wchar_t);
+    Var pathResult = Allocate(size);
+    if (pathResult.IsFailure()) return EIOError::BAD_ALLOCATE;
+    Var pPath = Cast<wchar_t*>(pathResult.Value());
+    MultiByteToWideChar(CP_UTF8, 0, Cast<const char*>(path), -1, pPath, length);
+    Var flags = static_cast<DWORD>(FILE_ATTRIBUTE_NORMAL | (isDirect ? FILE_FLAG_NO_BUFFERING : 0));
+    Var handle = CreateFileW(pPath, GENERIC_READ, FILE_SHARE_READ, NONE, OPEN_EXISTING, flags, NONE);
+    (Void)Deallocate(size, pPath);
+    if (handle == INVALID_HANDLE_VALUE) return EIOError::OPEN_FAILED;
+    return IOFile{ Cast<ISize>(handle), isDirect };
+#else
+    Var flags = O_RDONLY | O_CLOEXEC;
+#ifdef O_DIRECT
+    if (isDirect) flags |= O_DIRECT;
+#endif
+    Var fd = open(Cast<const char*>(path), flags);
+    if (fd < 0) return EIOError::OPEN_FAILED;
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    if (isDirect) fcntl(fd, F_NOCACHE, 1);
+#endif
+    return IOFile{ static_cast<ISize>(fd), isDirect };
+#endif
+}
+
+// OpenIOFileで開いたファイルを閉じます。
+Void LeyEngine::CloseIOFile(IOFile file) noexcept
+{
+    if (file.handle < 0) return;
+#if defined(_WIN32)
+    CloseHandle(Cast<HANDLE>(file.handle));
+#else
+    close(static_cast<int>(file.handle));
+#endif
+}
+
+// --------------------
+//
+// 非同期ファイル入出力システム
+//
+// ====================
+
+#ifdef _LEYENGINE_IO_URING
+// io_uringのリングです。
+struct IOUring
+{
+    int fd = -1;                        // io_uringのファイルディスクリプタ
+    Void *pSqRing = MAP_FAILED;         // サブミッションキューのリング
+    USize sqRingSize = 0;               // サブミッションキューのリングのサイズ
+    Void *pCqRing = MAP_FAILED;         // コンプリーションキューのリング
+    USize cqRingSize = 0;               // コンプリーションキューのリングのサイズ
+    io_uring_sqe *pSqes = static_cast<io_uring_sqe*>(MAP_FAILED);   // サブミッションキューのエントリ
+    USize sqesSize = 0;                 // サブミッションキューのエントリのサイズ
+    U32 *pSqHead = NONE;                // サブミッションキューの先頭
+    U32 *pSqTail = NONE;                // サブミッションキューの末尾
+    U32 sqMask = 0;                     // サブミッションキューのマスク
+    U32 sqEntryCount = 0;               // サブミッションキューのエントリ数
+    U32 *pSqArray = NONE;               // サブミッションキューのインデックス配列
+    U32 *pCqHead = NONE;                // コンプリーションキューの先頭
+    U32 *pCqTail = NONE;                // コンプリーションキューの末尾
+    U32 cqMask = 0;                     // コンプリーションキューのマスク
+    io_uring_cqe *pCqes = NONE;         // コンプリーションキューのエントリ
+    U32 sqLocalTail = 0;                // まだ公開していないサブミッションキューの末尾
+
+    // リングを作成します。
+    Bool Setup(U32 entryCount) noexcept
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        this->fd = static_cast<int>(syscall(__NR_io_uring_setup, entryCount, &params));
+        if (this->fd < 0) return NO;
+        this->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(U32);
+        this->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            if (this->cqRingSize > this->sqRingSize) this->sqRingSize = this->cqRingSize;
+            this->cqRingSize = 0;
+        }
+        this->pSqRing = mmap(NONE, this->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_SQ_RING);
+        if (this->pSqRing == MAP_FAILED) return NO;
+        Var pCqRing = this->pSqRing;
+        if (this->cqRingSize != 0)
+        {
+            this->pCqRing = mmap(NONE, this->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_CQ_RING);
+            if (this->pCqRing == MAP_FAILED) return NO;
+            pCqRing = this->pCqRing;
+        }
+        this->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        this->pSqes = static_cast<io_uring_sqe*>(mmap(NONE, this->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->fd, IORING_OFF_SQES));
+        if (this->pSqes == MAP_FAILED) return NO;
+        Var pSq = Cast<U8*>(this->pSqRing);
+        this->pSqHead = Cast<U32*>(pSq + params.sq_off.head);
+        this->pSqTail = Cast<U32*>(pSq + params.sq_off.tail);
+        this->sqMask = *Cast<U32*>(pSq + params.sq_off.ring_mask);
+        this->sqEntryCount = *Cast<U32*>(pSq + params.sq_off.ring_entries);
+        this->pSqArray = Cast<U32*>(pSq + params.sq_off.array);
+        Var pCq = Cast<U8*>(pCqRing);
+        this->pCqHead = Cast<U32*>(pCq + params.cq_off.head);
+        this->pCqTail = Cast<U32*>(pCq + params.cq_off.tail);
+        this->cqMask = *Cast<U32*>(pCq + params.cq_off.ring_mask);
+        this->pCqes = Cast<io_uring_cqe*>(pCq + params.cq_off.cqes);
+        this->sqLocalTail = *this->pSqTail;
+        return YES;
+    }
+
+    // リングを破棄します。
+    Void Close() noexcept
+    {
+        if (this->pSqes != MAP_FAILED) munmap(this->pSqes, this->sqesSize);
+        if (this->pCqRing != MAP_FAILED) munmap(this->pCqRing, this->cqRingSize);
+        if (this->pSqRing != MAP_FAILED) munmap(this->pSqRing, this->sqRingSize);
+        if (this->fd >= 0) close(this->fd);
+        this->fd = -1;
+        this->pSqRing = MAP_FAILED;
+        this->pCqRing = MAP_FAILED;
+        this->pSqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    }
+
+    // サブミッションキューの空きエントリ数を返します。
+    U32 FreeCount() const noexcept
+    {
+        return this->sqEntryCount - (this->sqLocalTail - __atomic_load_n(this->pSqHead, __ATOMIC_ACQUIRE));
+    }
+
+    // サブミッションキューのエントリを取得します。
+    io_uring_sqe *Next() noexcept
+    {
+        Var index = this->sqLocalTail & this->sqMask;
+        Var pSqe = &this->pSqes[index];
+        std::memset(pSqe, 0, sizeof(io_uring_sqe));
+        this->pSqArray[index] = index;
+        this->sqLocalTail++;
+        return pSqe;
+    }
+
+    // サブミッションキューのエントリを発行し、完了を待機します。
+    // シグナルで中断された場合はやり直し、リングを使用できなくなった場合は失敗します。
+    Bool Enter(Bool isWaiting) noexcept
+    {
+        __atomic_store_n(this->pSqTail, this->sqLocalTail, __ATOMIC_RELEASE);
+        for (;;)
+        {
+            Var submitCount = this->sqLocalTail - __atomic_load_n(this->pSqHead, __ATOMIC_ACQUIRE);
+            Var result = syscall(__NR_io_uring_enter, this->fd, submitCount, isWaiting ? 1 : 0, isWaiting ? IORING_ENTER_GETEVENTS : 0, NONE, 0);
+            if (result >= 0) return YES;
+            if (errno == EINTR) continue;
+            // 完了キューが一杯、または、一時的に資源が不足している場合は先に完了を回収します
+            return errno == EAGAIN || errno == EBUSY;
+        }
+    }
+};
+#endif
+
+// 非同期ファイル入出力システムです。
+// io_uringを使用できる場合は1つのスレッドがリングへの発行と完了の回収を行い、
+// 使用できない場合はワーカースレッドがブロッキングで読み込みます。
+struct IOSystem
+{
+    std::mutex mutex;                               // リストを保護するミューテックス
+    std::condition_variable condition;              // ワーカースレッドを起床させる条件変数
+    IORequestList pendingLists[IO_PRIORITY_COUNT];  // 優先度毎の発行待ちの要求
+    IORequestList inflightList;                     // 読み込み中の要求
+    IORequestList completedList;                    // 完了した要求
+    std::atomic<U64> nextId;                        // 次に割り当てる識別子
+    Bool isRunning = YES;                           // 実行中か
+    Bool isJobDelivery = YES;                       // 完了をジョブシステムに渡すか
+    std::thread threads[IO_WORKER_COUNT];           // スレッド
+    USize threadCount = 0;                          // 起動したスレッド数
+#ifdef _LEYENGINE_IO_URING
+    IOUring ring;                                   // io_uringのリング
+    int eventFd = -1;                               // io_uringのスレッドを起床させるイベントファイル
+    Bool isUring = NO;                              // io_uringを使用するか
+    Bool isUringFailed = NO;                        // io_uringを使用できなくなったか
+#endif
+
+    IOSystem() noexcept
+        : nextId(1)
+    {
+        // 完了を渡すジョブシステムが先に破棄されないよう、先に作成します
+        (Void)JobWorkerCount();
+#ifdef _LEYENGINE_IO_URING
+        this->eventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (this->eventFd >= 0 && this->ring.Setup(IO_URING_ENTRY_COUNT))
+        {
+            this->isUring = YES;
+            this->threads[this->threadCount++] = std::thread([this]() { this->RunUring(); });
+            return;
+        }
+        this->ring.Close();
+#endif
+        for (USize i = 0; i < IO_WORKER_COUNT; i++)
+        {
+            this->threads[this->threadCount++] = std::thread([this]() { this->RunWorker(); });
+        }
+    }
+
+    ~IOSystem() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->isRunning = NO;
+        }
+        this->Wake();
+        for (USize i = 0; i < this->threadCount; i++)
+        {
+            this->threads[i].join();
+        }
+        // io_uringのスレッドは読み込み中の操作の完了をすべて回収してから終了します
+#ifdef _LEYENGINE_IO_URING
+        this->ring.Close();
+        if (this->eventFd >= 0) close(this->eventFd);
+#endif
+        for (Var &list : this->pendingLists)
+        {
+            while (Var pNode = list.PopFront()) DeleteRequestNode(pNode, YES);
+        }
+        // リングを使用できなくなった場合に残った要求は、カーネルが書き込む可能性があるため解放しません
+#ifdef _LEYENGINE_IO_URING
+        if (!this->isUringFailed)
+#endif
+        {
+            while (Var pNode = this->inflightList.PopFront()) DeleteRequestNode(pNode, YES);
+        }
+        while (Var pNode = this->completedList.PopFront()) DeleteRequestNode(pNode, YES);
+    }
+
+    // 読み込みを行うスレッドを起床させます。
+    Void Wake() noexcept
+    {
+#ifdef _LEYENGINE_IO_URING
+        if (this->isUring)
+        {
+            U64 value = 1;
+            (Void)!write(this->eventFd, &value, sizeof(value));
+        }
+#endif
+        // io_uringを使用できなくなった後は条件変数で待機するため、常に通知します
+        this->condition.notify_all();
+    }
+
+    // 優先度の高い順に発行待ちの要求を取り出します。
+    IORequestNode *PopPending() noexcept
+    {
+        for (Var &list : this->pendingLists)
+        {
+            if (Var pNode = list.PopFront()) return pNode;
+        }
+        return NONE;
+    }
+
+    // 要求を完了させます。ミューテックスをロックしている必要があります。
+    Void Complete(IORequestNode *pNode, Bool isFailure, EIOError error) noexcept
+    {
+        if (pNode->isCanceled)
+        {
+            isFailure = YES;
+            error = EIOError::CANCELED;
+        }
+        pNode->isFailure = isFailure;
+        pNode->error = error;
+        this->completedList.PushBack(pNode);
+    }
+
+    // 完了した要求をジョブシステムに渡します。ミューテックスをロックせずに呼び出します。
+    // ジョブシステムを使用できない場合は、DispatchIOCompletionsで通知するため完了キューに残します。
+    Void PostCompletions() noexcept
+    {
+        IORequestNode *pNodes[IO_COMPLETION_JOB_BATCH];
+        JobDeclaration jobs[IO_COMPLETION_JOB_BATCH];
+        for (;;)
+        {
+            USize count = 0;
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                if (!this->isJobDelivery) return;
+                while (count < IO_COMPLETION_JOB_BATCH)
+                {
+                    Var pNode = this->completedList.PopFront();
+                    if (pNode == NONE) break;
+                    pNodes[count] = pNode;
+                    jobs[count] = JobDeclaration{ &RunCompletionJob, pNode };
+                    count++;
+                }
+            }
+            if (count == 0) return;
+            if (RunJobs(jobs, count, NONE).IsFailure())
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                while (count != 0) this->completedList.PushFront(pNodes[--count]);
+                this->isJobDelivery = NO;
+                return;
+            }
+        }
+    }
+
+    // ワーカースレッドでブロッキングで読み込みます。
+    Void RunWorker() noexcept
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        for (;;)
+        {
+            IORequestNode *pNode = NONE;
+            this->condition.wait(lock, [this, &pNode]() { return !this->isRunning || (pNode = this->PopPending()) != NONE; });
+            if (!this->isRunning) return;
+            this->inflightList.PushBack(pNode);
+            lock.unlock();
+            Var isSuccess = ReadBlocking(pNode);
+            lock.lock();
+            this->inflightList.Remove(pNode);
+            this->Complete(pNode, !isSuccess, EIOError::READ_FAILED);
+            lock.unlock();
+            this->PostCompletions();
+            lock.lock();
+        }
+    }
+
+#ifdef _LEYENGINE_IO_URING
+    // io_uringへの発行と完了の回収を行います。
+    Void RunUring() noexcept
+    {
+        U32 readCount = 0;          // リングで読み込み中の要求数
+        Bool isWakeArmed = NO;      // イベントファイルを監視しているか
+        for (;;)
+        {
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                // 終了時は読み込み中の要求をすべて取り消し、完了を回収してからリングを閉じます
+                if (!this->isRunning)
+                {
+                    if (readCount == 0) return;
+                    for (Var pNode = this->inflightList.pFirst; pNode != NONE; pNode = pNode->pNext)
+                    {
+                        pNode->isCanceled = YES;
+                    }
+                }
+                // キャンセルを要求された読み込みを取り消します
+                for (Var pNode = this->inflightList.pFirst; pNode != NONE; pNode = pNode->pNext)
+                {
+                    if (!pNode->isCanceled || pNode->isCancelSubmitted || this->ring.FreeCount() <= 1) continue;
+                    Var pSqe = this->ring.Next();
+                    pSqe->opcode = IORING_OP_ASYNC_CANCEL;
+                    pSqe->fd = -1;
+                    pSqe->addr = Cast<USize>(pNode);
+                    pSqe->user_data = IO_URING_CANCEL_USER_DATA;
+                    pNode->isCancelSubmitted = YES;
+                }
+                // 優先度の高い順に読み込みを発行します
+                while (this->isRunning && readCount < this->ring.sqEntryCount - IO_URING_RESERVED_ENTRY_COUNT && this->ring.FreeCount() > 1)
+                {
+                    Var pNode = this->PopPending();
+                    if (pNode == NONE) break;
+                    this->inflightList.PushBack(pNode);
+                    Var pSqe = this->ring.Next();
+                    pSqe->opcode = IORING_OP_READ;
+                    pSqe->fd = static_cast<int>(pNode->request.file.handle);
+                    pSqe->off = pNode->request.offset + pNode->readSize;
+                    pSqe->addr = Cast<USize>(Cast<U8*>(pNode->request.pBuffer) + pNode->readSize);
+                    pSqe->len = static_cast<U32>(pNode->readLength - pNode->readSize);
+                    pSqe->user_data = Cast<USize>(pNode);
+                    readCount++;
+                }
+            }
+            // 要求の追加とキャンセルをイベントファイルで受け取ります
+            if (!isWakeArmed)
+            {
+                Var pSqe = this->ring.Next();
+                pSqe->opcode = IORING_OP_POLL_ADD;
+                pSqe->fd = this->eventFd;
+                pSqe->poll32_events = POLLIN;
+                pSqe->user_data = IO_URING_WAKE_USER_DATA;
+                isWakeArmed = YES;
+            }
+            if (!this->ring.Enter(YES))
+            {
+                this->RunFailed();
+                return;
+            }
+            // 完了を回収します
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                Var head = *this->ring.pCqHead;
+                Var tail = __atomic_load_n(this->ring.pCqTail, __ATOMIC_ACQUIRE);
+                for (; head != tail; head++)
+                {
+                    Var &cqe = this->ring.pCqes[head & this->ring.cqMask];
+                    if (cqe.user_data == IO_URING_WAKE_USER_DATA)
+                    {
+                        U64 value;
+                        (Void)!read(this->eventFd, &value, sizeof(value));
+                        isWakeArmed = NO;
+                        continue;
+                    }
+                    if (cqe.user_data == IO_URING_CANCEL_USER_DATA) continue;
+                    Var pNode = Cast<IORequestNode*>(static_cast<USize>(cqe.user_data));
+                    readCount--;
+                    this->inflightList.Remove(pNode);
+                    if (cqe.res < 0)
+                    {
+                        this->Complete(pNode, YES, cqe.res == -ECANCELED ? EIOError::CANCELED : EIOError::READ_FAILED);
+                        continue;
+                    }
+                    pNode->readSize += static_cast<USize>(cqe.res);
+                    if (cqe.res == 0 || pNode->readSize >= pNode->readLength || pNode->isCanceled)
+                    {
+                        this->Complete(pNode, NO, EIOError::READ_FAILED);
+                    }
+                    else
+                    {
+                        // 途中までしか読み込めなかった場合は残りを優先して発行します
+                        pNode->isCancelSubmitted = NO;
+                        this->pendingLists[static_cast<USize>(pNode->request.priority)].PushFront(pNode);
+                    }
+                }
+                __atomic_store_n(this->ring.pCqHead, head, __ATOMIC_RELEASE);
+            }
+            // コールバックはジョブとしてワーカースレッドで呼び出します
+            this->PostCompletions();
+        }
+    }
+
+    // io_uringを使用できなくなった後、発行待ちの要求をエラーで完了させます。
+    // 読み込み中の要求はカーネルが書き込む可能性があるため、そのまま残します。
+    Void RunFailed() noexcept
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->isUringFailed = YES;
+        for (;;)
+        {
+            IORequestNode *pNode = NONE;
+            this->condition.wait(lock, [this, &pNode]() { return !this->isRunning || (pNode = this->PopPending()) != NONE; });
+            if (!this->isRunning) return;
+            this->Complete(pNode, YES, EIOError::READ_FAILED);
+            lock.unlock();
+            this->PostCompletions();
+            lock.lock();
+        }
+    }
+#endif
+};
+
+// 非同期ファイル入出力システムを返します。
+// 最初の呼び出しでスレッドを起動し、プログラムの終了時に停止します。
+IOSystem &GetIOSystem() noexcept
+{
+    static IOSystem system;
+    return system;
+}
+
+// 要求をまとめて発行待ちのキューに追加します。
+USize SubmitRequests(const IOReadRequest *pRequests, USize count, U64 *pRequestIds) noexcept
+{
+    Var &system = GetIOSystem();
+    // メモリ確保はロックの外で済ませ、ロック中はキューへの追加だけを行います
+    IORequestList acceptedList;
+    USize acceptedCount = 0;
+    for (USize i = 0; i < count; i++)
+    {
+        Var nodeResult = NewRequestNode(pRequests[i]);
+        if (nodeResult.IsFailure())
+        {
+            if (pRequestIds != NONE) pRequestIds[i] = 0;
+            continue;
+        }
+        Var pNode = nodeResult.Value();
+        pNode->id = system.nextId.fetch_add(1, std::memory_order_relaxed);
+        acceptedList.PushBack(pNode);
+        if (pRequestIds != NONE) pRequestIds[i] = pNode->id;
+        acceptedCount++;
+    }
+    if (acceptedCount == 0) return 0;
+    {
+        std::lock_guard<std::mutex> lock(system.mutex);
+        while (Var pNode = acceptedList.PopFront())
+        {
+            system.pendingLists[static_cast<USize>(pNode->request.priority)].PushBack(pNode);
+        }
+    }
+    system.Wake();
+    return acceptedCount;
+}
+
+// 読み込みを要求します。
+Result<U64, EIOError> LeyEngine::SubmitRead(const IOReadRequest &request) noexcept
+{
+    // エラーを返すために先に検証します
+    Var nodeResult = NewRequestNode(request);
+    if (nodeResult.IsFailure()) return nodeResult.Error();
+    Var pNode = nodeResult.Value();
+    Var &system = GetIOSystem();
+    Var id = system.nextId.fetch_add(1, std::memory_order_relaxed);
+    pNode->id = id;
+    {
+        std::lock_guard<std::mutex> lock(system.mutex);
+        system.pendingLists[static_cast<USize>(pNode->request.priority)].PushBack(pNode);
+    }
+    system.Wake();
+    return id;
+}
+
+// 複数の読み込みをまとめて要求します。
+USize LeyEngine::SubmitReadBatch(const IOReadRequest *pRequests, USize count, U64 *pRequestIds) noexcept
+{
+    if (pRequests == NONE || count == 0) return 0;
+    return SubmitRequests(pRequests, count, pRequestIds);
+}
+
+// 読み込み要求をキャンセルします。
+Bool LeyEngine::CancelRead(U64 requestId) noexcept
+{
+    Var &system = GetIOSystem();
+    {
+        std::unique_lock<std::mutex> lock(system.mutex);
+        // 発行前の要求はその場で完了させます
+        for (Var &list : system.pendingLists)
+        {
+            if (Var pNode = list.Find(requestId))
+            {
+                list.Remove(pNode);
+                pNode->isCanceled = YES;
+                system.Complete(pNode, YES, EIOError::CANCELED);
+                lock.unlock();
+                system.PostCompletions();
+                return YES;
+            }
+        }
+        // 読み込み中の要求は読み込みを行うスレッドが取り消します
+        Var pNode = system.inflightList.Find(requestId);
+        if (pNode == NONE) return NO;
+        pNode->isCanceled = YES;
+    }
+    system.Wake();
+    return YES;
+}
+
+// 完了した読み込み要求のコールバックを呼び出します。
+USize LeyEngine::DispatchIOCompletions(USize maxCount) noexcept
+{
+    Var &system = GetIOSystem();
+    USize count = 0;
+    while (count < maxCount)
+    {
+        IORequestNode *pNode;
+        {
+            std::lock_guard<std::mutex> lock(system.mutex);
+            pNode = system.completedList.PopFront();
+        }
+        if (pNode == NONE) break;
+        DeliverCompletion(pNode);
+        count++;
+    }
+    return count;
+}
+
+#else
+
+Result<IOFile, EIOError> (*g_openIOFile)(const Char*, Bool);
+Void (*g_closeIOFile)(IOFile);
+Result<U64, EIOError> (*g_submitRead)(const IOReadRequest&);
+USize (*g_submitReadBatch)(const IOReadRequest*, USize, U64*);
+Bool (*g_cancelRead)(U64);
+USize (*g_dispatchIOCompletions)(USize);
+Result<IOFile, EIOError> GlobalOpenIOFile(const Char*, Bool) noexcept
+{
+    return EIOError::NOT_INITIALIZED;
+}
+Void GlobalCloseIOFile(IOFile) noexcept
+{
+}
+Result<U64, EIOError> GlobalSubmitRead(const IOReadRequest&) noexcept
+{
+    return EIOError::NOT_INITIALIZED;
+}
+USize GlobalSubmitReadBatch(const IOReadRequest*, USize count, U64 *pRequestIds) noexcept
+{
+    if (pRequestIds != NONE)
+    {
+        for (USize i = 0; i < count; i++) pRequestIds[i] = 0;
+    }
+    return 0;
+}
+Bool GlobalCancelRead(U64) noexcept
+{
+    return NO;
+}
+USize GlobalDispatchIOCompletions(USize) noexcept
+{
+    return 0;
+}
+std::once_flag g_initAsyncIOSystemOnceFlag;
+Void InitAsyncIOSystem()
+{
+    g_openIOFile = &GlobalOpenIOFile;
+    g_closeIOFile = &GlobalCloseIOFile;
+    g_submitRead = &GlobalSubmitRead;
+    g_submitReadBatch = &GlobalSubmitReadBatch;
+    g_cancelRead = &GlobalCancelRead;
+    g_dispatchIOCompletions = &GlobalDispatchIOCompletions;
+}
+EXPORT Void SetAsyncIOSystem(Void *openFile, Void *closeFile, Void *submitRead, Void *submitReadBatch, Void *cancelRead, Void *dispatchCompletions)
+{
+    std::call_once(g_initAsyncIOSystemOnceFlag, InitAsyncIOSystem);
+    g_openIOFile = (Result<IOFile, EIOError> (*)(const Char*, Bool))openFile;
+    g_closeIOFile = (Void (*)(IOFile))closeFile;
+    g_submitRead = (Result<U64, EIOError> (*)(const IOReadRequest&))submitRead;
+    g_submitReadBatch = (USize (*)(const IOReadRequest*, USize, U64*))submitReadBatch;
+    g_cancelRead = (Bool (*)(U64))cancelRead;
+    g_dispatchIOCompletions = (USize (*)(USize))dispatchCompletions;
+}
+
+// 非同期ファイル入出力で読み込むファイルを開きます。
+Result<IOFile, EIOError> LeyEngine::OpenIOFile(const Char *path, Bool isDirect) noexcept
+{
+    std::call_once(g_initAsyncIOSystemOnceFlag, InitAsyncIOSystem);
+    return g_openIOFile(path, isDirect);
+}
+
+// OpenIOFileで開いたファイルを閉じます。
+Void LeyEngine::CloseIOFile(IOFile file) noexcept
+{
+    std::call_once(g_initAsyncIOSystemOnceFlag, InitAsyncIOSystem);
+    g_closeIOFile(file);
+}
+
+// 読み込みを要求します。
+Result<U64, EIOError> LeyEngine::SubmitRead(const IOReadRequest &request) noexcept
+{
+    std::call_once(g_initAsyncIOSystemOnceFlag, InitAsyncIOSystem);
+    return g_submitRead(request);
+}
+
+// 複数の読み込みをまとめて要求します。
+USize LeyEngine::SubmitReadBatch(const IOReadRequest *pRequests, USize count, U64 *pRequestIds) noexcept
+{
+    std::call_once(g_initAsyncIOSystemOnceFlag, InitAsyncIOSystem);
+    return g_submitReadBatch(pRequests, count, pRequestIds);
+}
+
+// 読み込み要求をキャンセルします。
+Bool LeyEngine::CancelRead(U64 requestId) noexcept
+{
+    std::call_once(g_initAsyncIOSystemOnceFlag, InitAsyncIOSystem);
+    return g_cancelRead(requestId);
+}
+
+// 完了した読み込み要求のコールバックを呼び出します。
+USize LeyEngine::DispatchIOCompletions(USize maxCount) noexcept
+{
+    std::call_once(g_initAsyncIOSystemOnceFlag, InitAsyncIOSystem);
+    return g_dispatchIOCompletions(maxCount);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,618 @@
+// Compression.cpp
+// (C) 2022 LeyCommunity.
+// author Taichi Ito.
+
+#include <cstring>
+#include "LeyEngine/Compression.hpp"
+#include "LeyEngine/Math.hpp"
+
+using namespace LeyEngine;
+
+// --------------------
+//
+// LZ4
+//
+// ====================
+
+// 一致とみなす最小のバイト数
+constexpr USize LZ4_MIN_MATCH = 4;
+// 末尾でリテラルとして出力するバイト数
+constexpr USize LZ4_LAST_LITERALS = 5;
+// 最後の一致を開始できる末尾からのバイト数
+constexpr USize LZ4_MATCH_FIND_LIMIT = 12;
+// 一致を参照できる最大の距離
+constexpr USize LZ4_MAX_DISTANCE = 65535;
+// ハッシュテーブルのビット数
+constexpr U32 LZ4_HASH_BITS = 12;
+
+// 4バイトを読み込みます。
+inline U32 Lz4Read32(const U8 *pointer) noexcept
+{
+    U32 value;
+    std::memcpy(&value, pointer, sizeof(value));
+    return value;
+}
+
+// 4バイトからハッシュテーブルのインデックスを求めます。
+inline U32 Lz4Hash(U32 sequence) noexcept
+{
+    return (sequence * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+// 長さの延長部分を書き込みます。
+inline U8 *Lz4WriteLength(U8 *pOutput, USize length) noexcept
+{
+    for (; length >= 255; length -= 255)
+    {
+        *pOutput++ = 255;
+    }
+    *pOutput++ = static_cast<U8>(length);
+    return pOutput;
+}
+
+// LZ4ブロック形式で圧縮します。
+Result<USize, ECompressionError> LeyEngine::Lz4Compress(const Void *pSource, USize sourceSize, Void *pDestination, USize destinationSize) noexcept
+{
+    Var pInput = Cast<const U8*>(pSource);
+    Var pOutput = Cast<U8*>(pDestination);
+    Var pOutputEnd = pOutput + destinationSize;
+    // ハッシュテーブルには位置+1を格納し、0を未使用とします
+    U32 table[1 << LZ4_HASH_BITS] = {};
+    USize anchor = 0;
+    USize position = 0;
+    if (sourceSize >= LZ4_MATCH_FIND_LIMIT + 1)
+    {
+        Var matchFindLimit = sourceSize - LZ4_MATCH_FIND_LIMIT;
+        Var matchLimit = sourceSize - LZ4_LAST_LITERALS;
+        while (position < matchFindLimit)
+        {
+            Var sequence = Lz4Read32(pInput + position);
+            Var hash = Lz4Hash(sequence);
+            Var reference = static_cast<USize>(table[hash]);
+            table[hash] = static_cast<U32>(position + 1);
+            if (reference == 0 || position + 1 - reference > LZ4_MAX_DISTANCE || Lz4Read32(pInput + reference - 1) != sequence)
+            {
+                position++;
+                continue;
+            }
+            reference--;
+            Var matchLength = LZ4_MIN_MATCH;
+            while (position + matchLength < matchLimit && pInput[reference + matchLength] == pInput[position + matchLength])
+            {
+                matchLength++;
+            }
+            // トークン、リテラル、オフセット、一致長を書き込みます
+            Var literalLength = position - anchor;
+            if (static_cast<USize>(pOutputEnd - pOutput) < 1 + literalLength + literalLength / 255 + 2 + matchLength / 255 + 2)
+            {
+                return ECompressionError::BUFFER_TOO_SMALL;
+            }
+            Var pToken = pOutput++;
+            Var extraMatchLength = matchLength - LZ4_MIN_MATCH;
+            *pToken = static_cast<U8>(((literalLength < 15 ? literalLength : 15) << 4) | (extraMatchLength < 15 ? extraMatchLength : 15));
+            if (literalLength >= 15) pOutput = Lz4WriteLength(pOutput, literalLength - 15);
+            std::memcpy(pOutput, pInput + anchor, literalLength);
+            pOutput += literalLength;
+            Var offset = position - reference;
+            *pOutput++ = static_cast<U8>(offset);
+            *pOutput++ = static_cast<U8>(offset >> 8);
+            if (extraMatchLength >= 15) pOutput = Lz4WriteLength(pOutput, extraMatchLength - 15);
+            position += matchLength;
+            anchor = position;
+        }
+    }
+    // 残りをリテラルとして書き込みます
+    Var literalLength = sourceSize - anchor;
+    if (static_cast<USize>(pOutputEnd - pOutput) < 1 + literalLength + literalLength / 255 + 1)
+    {
+        return ECompressionError::BUFFER_TOO_SMALL;
+    }
+    Var pToken = pOutput++;
+    *pToken = static_cast<U8>((literalLength < 15 ? literalLength : 15) << 4);
+    if (literalLength >= 15) pOutput = Lz4WriteLength(pOutput, literalLength - 15);
+    // 空の入力はポインタがNONEの場合があるためコピーしません
+    if (literalLength != 0) std::memcpy(pOutput, pInput + anchor, literalLength);
+    pOutput += literalLength;
+    return static_cast<USize>(pOutput - Cast<U8*>(pDestination));
+}
+
+// LZ4ブロック形式のデータを展開します。
+Result<USize, ECompressionError> LeyEngine::Lz4Decompress(const Void *pSource, USize sourceSize, Void *pDestination, USize destinationSize) noexcept
+{
+    Var pInput = Cast<const U8*>(pSource);
+    Var pInputEnd = pInput + sourceSize;
+    Var pOutput = Cast<U8*>(pDestination);
+    Var pOutputBegin = pOutput;
+    Var pOutputEnd = pOutput + destinationSize;
+    while (pInput < pInputEnd)
+    {
+        Var token = *pInput++;
+        // リテラルをコピーします
+        USize literalLength = token >> 4;
+        if (literalLength == 15)
+        {
+            U8 value;
+            do
+            {
+                if (pInput >= pInputEnd) return ECompressionError::CORRUPTED;
+                value = *pInput++;
+                literalLength += value;
+            } while (value == 255);
+        }
+        if (static_cast<USize>(pInputEnd - pInput) < literalLength) return ECompressionError::CORRUPTED;
+        if (static_cast<USize>(pOutputEnd - pOutput) < literalLength) return ECompressionError::BUFFER_TOO_SMALL;
+        // 出力先が空の場合はポインタがNONEの場合があるためコピーしません
+        if (literalLength != 0) std::memcpy(pOutput, pInput, literalLength);
+        pInput += literalLength;
+        pOutput += literalLength;
+        // 最後のシーケンスは一致を持ちません
+        if (pInput == pInputEnd) break;
+        // 一致をコピーします
+        if (pInputEnd - pInput < 2) return ECompressionError::CORRUPTED;
+        Var offset = static_cast<USize>(pInput[0]) | (static_cast<USize>(pInput[1]) << 8);
+        pInput += 2;
+        if (offset == 0 || offset > static_cast<USize>(pOutput - pOutputBegin)) return ECompressionError::CORRUPTED;
+        USize matchLength = token & 15;
+        if (matchLength == 15)
+        {
+            U8 value;
+            do
+            {
+                if (pInput >= pInputEnd) return ECompressionError::CORRUPTED;
+                value = *pInput++;
+                matchLength += value;
+            } while (value == 255);
+        }
+        matchLength += LZ4_MIN_MATCH;
+        if (static_cast<USize>(pOutputEnd - pOutput) < matchLength) return ECompressionError::BUFFER_TOO_SMALL;
+        Var pMatch = pOutput - offset;
+        if (offset >= matchLength)
+        {
+            std::memcpy(pOutput, pMatch, matchLength);
+            pOutput += matchLength;
+        }
+        else
+        {
+            // 重なる場合は1バイトずつコピーして繰り返しを展開します
+            for (USize i = 0; i < matchLength; i++)
+            {
+                *pOutput++ = *pMatch++;
+            }
+        }
+    }
+    return static_cast<USize>(pOutput - pOutputBegin);
+}
+
+// --------------------
+//
+// 差分
+//
+// ====================
+
+// ヘッダの最大のバイト数
+constexpr USize DELTA_HEADER_MAX_SIZE = 20;
+// 末尾の制御ビット列のバイトサイズのバイト数
+constexpr USize DELTA_TRAILER_SIZE = 4;
+
+// 可変長整数を書き込みます。
+inline U8 *DeltaWriteVarint(U8 *pOutput, U64 value) noexcept
+{
+    for (; value >= 0x80; value >>= 7)
+    {
+        *pOutput++ = static_cast<U8>(value | 0x80);
+    }
+    *pOutput++ = static_cast<U8>(value);
+    return pOutput;
+}
+
+// 可変長整数を読み込みます。
+inline Bool DeltaReadVarint(const U8 *&pInput, const U8 *pInputEnd, U64 &value) noexcept
+{
+    value = 0;
+    for (U32 shift = 0; shift < 64; shift += 7)
+    {
+        if (pInput >= pInputEnd) return NO;
+        Var byte = *pInput++;
+        value |= static_cast<U64>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return YES;
+    }
+    return NO;
+}
+
+// 位置から最初に異なるバイトの位置を探します。見つからない場合はsizeを返します。
+inline USize DeltaFindDifference(const U8 *pLeft, const U8 *pRight, USize position, USize size) noexcept
+{
+#if defined(LEYENGINE_SIMD_SSE)
+    for (; position + 16 <= size; position += 16)
+    {
+        Var equal = _mm_cmpeq_epi8(_mm_loadu_si128(Cast<const __m128i*>(pLeft + position)), _mm_loadu_si128(Cast<const __m128i*>(pRight + position)));
+        Var mask = static_cast<U32>(_mm_movemask_epi8(equal)) ^ 0xFFFF;
+        if (mask != 0) return position + CountTrailingZeros(mask);
+    }
+#elif defined(LEYENGINE_SIMD_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+    for (; position + 16 <= size; position += 16)
+    {
+        if (vminvq_u8(vceqq_u8(vld1q_u8(pLeft + position), vld1q_u8(pRight + position))) != 0xFF) break;
+    }
+#endif
+    // 異なる8バイトの中の位置はバイト単位で求めます
+    for (; position + 8 <= size; position += 8)
+    {
+        U64 left, right;
+        std::memcpy(&left, pLeft + position, sizeof(left));
+        std::memcpy(&right, pRight + position, sizeof(right));
+        if (left != right) break;
+    }
+    for (; position < size; position++)
+    {
+        if (pLeft[position] != pRight[position]) return position;
+    }
+    return size;
+}
+
+// 2つのバイト列の排他的論理和を出力します。出力は入力と同じ位置でも構いません。
+inline Void DeltaXor(U8 *pOutput, const U8 *pLeft, const U8 *pRight, USize size) noexcept
+{
+    USize position = 0;
+#if defined(LEYENGINE_SIMD_SSE)
+    for (; position + 16 <= size; position += 16)
+    {
+        Var value = _mm_xor_si128(_mm_loadu_si128(Cast<const __m128i*>(pLeft + position)), _mm_loadu_si128(Cast<const __m128i*>(pRight + position)));
+        _mm_storeu_si128(Cast<__m128i*>(pOutput + position), value);
+    }
+#elif defined(LEYENGINE_SIMD_NEON)
+    for (; position + 16 <= size; position += 16)
+    {
+        vst1q_u8(pOutput + position, veorq_u8(vld1q_u8(pLeft + position), vld1q_u8(pRight + position)));
+    }
+#endif
+    for (; position < size; position++)
+    {
+        pOutput[position] = pLeft[position] ^ pRight[position];
+    }
+}
+
+// 制御ビット列を出力先の末尾から先頭へ向けて書き込みます。
+struct DeltaBitWriter
+{
+    U8 *pCurrent;       // 最後に書き込んだバイト
+    const U8 *pLimit;   // 書き込める先頭
+    U64 bits;           // 書き込み待ちのビット
+    U32 count;          // 書き込み待ちのビット数
+
+    // 32ビット以下の値を書き込みます。
+    Bool Write(U64 value, U32 bitCount) noexcept
+    {
+        this->bits |= value << this->count;
+        this->count += bitCount;
+        for (; this->count >= 8; this->count -= 8)
+        {
+            if (this->pCurrent <= this->pLimit) return NO;
+            *--this->pCurrent = static_cast<U8>(this->bits);
+            this->bits >>= 8;
+        }
+        return YES;
+    }
+
+    // 1以上の値を指数ゴロム符号で書き込みます。
+    // 上位ビットの位置を0の連続と1で表し、続けて残りの下位ビットを書き込みます。
+    Bool WriteGamma(U64 value) noexcept
+    {
+        Var length = 63 - CountLeadingZeros(value);
+        for (Var rest = length; rest > 0; rest -= rest < 32 ? rest : 32)
+        {
+            if (!this->Write(0, rest < 32 ? rest : 32)) return NO;
+        }
+        if (!this->Write(1, 1)) return NO;
+        Var field = value ^ (U64(1) << length);
+        if (length <= 32) return this->Write(field, length);
+        return this->Write(field & 0xFFFFFFFF, 32) && this->Write(field >> 32, length - 32);
+    }
+
+    // 書き込み待ちのビットを書き込みます。
+    Bool Flush() noexcept
+    {
+        return this->count == 0 || this->Write(0, 8 - this->count);
+    }
+};
+
+// 制御ビット列を末尾から先頭へ向けて読み込みます。
+struct DeltaBitReader
+{
+    const U8 *pCurrent; // 最後に読み込んだバイト
+    const U8 *pBegin;   // 制御ビット列の先頭
+    U64 bits;           // 読み込み済みのビット
+    U32 count;          // 読み込み済みのビット数
+
+    // 読み込み済みのビットを補充します。
+    Void Refill() noexcept
+    {
+        for (; this->count <= 56 && this->pCurrent > this->pBegin; this->count += 8)
+        {
+            this->bits |= static_cast<U64>(*--this->pCurrent) << this->count;
+        }
+    }
+
+    // 32ビット以下の値を読み込みます。
+    Bool Read(U32 bitCount, U64 &value) noexcept
+    {
+        if (this->count < bitCount)
+        {
+            this->Refill();
+            if (this->count < bitCount) return NO;
+        }
+        value = this->bits & ((U64(1) << bitCount) - 1);
+        this->bits >>= bitCount;
+        this->count -= bitCount;
+        return YES;
+    }
+
+    // 指数ゴロム符号の値を読み込みます。
+    Bool ReadGamma(U64 &value) noexcept
+    {
+        U32 length = 0;
+        while (YES)
+        {
+            if (this->count == 0)
+            {
+                this->Refill();
+                if (this->count == 0) return NO;
+            }
+            if (this->bits != 0) break;
+            length += this->count;
+            this->count = 0;
+            if (length > 63) return NO;
+        }
+        Var zeros = CountTrailingZeros(this->bits);
+        length += zeros;
+        if (length > 63) return NO;
+        this->bits >>= zeros + 1;
+        this->count -= zeros + 1;
+        U64 low = 0;
+        U64 high = 0;
+        if (!this->Read(length < 32 ? length : 32, low)) return NO;
+        if (length > 32 && !this->Read(length - 32, high)) return NO;
+        value = (U64(1) << length) | (high << 32) | low;
+        return YES;
+    }
+};
+
+// 変更前と変更後のバイト列の差分を作成します。
+Result<USize, ECompressionError> LeyEngine::DeltaEncode(const Void *pBase, USize baseSize, const Void *pTarget, USize targetSize, USize unitSize, Void *pDestination, USize destinationSize) noexcept
+{
+    if (unitSize == 0) unitSize = 1;
+    U8 header[DELTA_HEADER_MAX_SIZE];
+    Var headerSize = static_cast<USize>(DeltaWriteVarint(DeltaWriteVarint(header, targetSize), unitSize) - header);
+    if (destinationSize < headerSize + DELTA_TRAILER_SIZE) return ECompressionError::BUFFER_TOO_SMALL;
+    Var pBaseBytes = Cast<const U8*>(pBase);
+    Var pTargetBytes = Cast<const U8*>(pTarget);
+    Var pOutput = Cast<U8*>(pDestination);
+    std::memcpy(pOutput, header, headerSize);
+    Var pPayload = pOutput + headerSize;
+    // 単位を詰めたペイロードは先頭から、制御ビット列は末尾から書き込み、最後に詰めます
+    DeltaBitWriter control{ pOutput + destinationSize - DELTA_TRAILER_SIZE, pPayload, 0, 0 };
+    Var commonSize = baseSize < targetSize ? baseSize : targetSize;
+    Var unitCount = targetSize / unitSize + (targetSize % unitSize != 0 ? 1 : 0);
+    USize unit = 0;
+    while (YES)
+    {
+        // 次に変更された単位を探します
+        Var position = DeltaFindDifference(pBaseBytes, pTargetBytes, unit * unitSize, commonSize);
+        if (position >= targetSize) break;
+        Var first = position / unitSize;
+        Var last = first + 1;
+        for (; last < unitCount; last++)
+        {
+            Var begin = last * unitSize;
+            Var end = begin + unitSize < targetSize ? begin + unitSize : targetSize;
+            if (end <= commonSize && std::memcmp(pBaseBytes + begin, pTargetBytes + begin, end - begin) == 0) break;
+        }
+        if (!control.WriteGamma(first - unit + 1) || !control.WriteGamma(last - first + 1)) return ECompressionError::BUFFER_TOO_SMALL;
+        // 変更前との排他的論理和を書き込みます
+        Var begin = first * unitSize;
+        Var end = last < unitCount ? last * unitSize : targetSize;
+        if (static_cast<USize>(control.pCurrent - pPayload) < end - begin) return ECompressionError::BUFFER_TOO_SMALL;
+        Var xorEnd = end < commonSize ? end : commonSize;
+        if (begin < xorEnd) DeltaXor(pPayload, pBaseBytes + begin, pTargetBytes + begin, xorEnd - begin);
+        if (xorEnd < end) std::memcpy(pPayload + (xorEnd - begin), pTargetBytes + xorEnd, end - xorEnd);
+        pPayload += end - begin;
+        control.pLimit = pPayload;
+        unit = last;
+        if (unit >= unitCount) break;
+    }
+    // 変更された単位数0で終端します
+    if (!control.WriteGamma(1) || !control.WriteGamma(1) || !control.Flush()) return ECompressionError::BUFFER_TOO_SMALL;
+    Var controlSize = static_cast<USize>(pOutput + destinationSize - DELTA_TRAILER_SIZE - control.pCurrent);
+    std::memmove(pPayload, control.pCurrent, controlSize);
+    Var pTrailer = pPayload + controlSize;
+    for (USize i = 0; i < DELTA_TRAILER_SIZE; i++)
+    {
+        pTrailer[i] = static_cast<U8>(controlSize >> (i * 8));
+    }
+    return static_cast<USize>(pTrailer + DELTA_TRAILER_SIZE - pOutput);
+}
+
+// 差分が表す変更後のバイトサイズを返します。
+Result<USize, ECompressionError> LeyEngine::DeltaTargetSize(const Void *pDelta, USize deltaSize) noexcept
+{
+    Var pInput = Cast<const U8*>(pDelta);
+    U64 targetSize;
+    if (!DeltaReadVarint(pInput, pInput + deltaSize, targetSize)) return ECompressionError::CORRUPTED;
+    return static_cast<USize>(targetSize);
+}
+
+// 変更前のデータに差分を適用します。
+Result<USize, ECompressionError> LeyEngine::DeltaApply(const Void *pDelta, USize deltaSize, Void *pData, USize dataSize) noexcept
+{
+    Var pInput = Cast<const U8*>(pDelta);
+    Var pInputEnd = pInput + deltaSize;
+    Var pBytes = Cast<U8*>(pData);
+    U64 targetSize;
+    U64 unitSize;
+    if (!DeltaReadVarint(pInput, pInputEnd, targetSize) || !DeltaReadVarint(pInput, pInputEnd, unitSize) || unitSize == 0) return ECompressionError::CORRUPTED;
+    if (static_cast<USize>(pInputEnd - pInput) < DELTA_TRAILER_SIZE) return ECompressionError::CORRUPTED;
+    if (targetSize > dataSize) return ECompressionError::BUFFER_TOO_SMALL;
+    Var pTrailer = pInputEnd - DELTA_TRAILER_SIZE;
+    USize controlSize = 0;
+    for (USize i = 0; i < DELTA_TRAILER_SIZE; i++)
+    {
+        controlSize |= static_cast<USize>(pTrailer[i]) << (i * 8);
+    }
+    if (static_cast<USize>(pTrailer - pInput) < controlSize) return ECompressionError::CORRUPTED;
+    Var pPayloadEnd = pTrailer - controlSize;
+    DeltaBitReader control{ pTrailer, pPayloadEnd, 0, 0 };
+    Var unitCount = targetSize / unitSize + (targetSize % unitSize != 0 ? 1 : 0);
+    U64 unit = 0;
+    while (YES)
+    {
+        U64 skip;
+        U64 length;
+        if (!control.ReadGamma(skip) || !control.ReadGamma(length)) return ECompressionError::CORRUPTED;
+        if (--length == 0) break;
+        skip--;
+        if (skip > unitCount - unit || length > unitCount - unit - skip) return ECompressionError::CORRUPTED;
+        Var first = unit + skip;
+        Var last = first + length;
+        Var begin = static_cast<USize>(first * unitSize);
+        Var end = static_cast<USize>(last < unitCount ? last * unitSize : targetSize);
+        if (static_cast<USize>(pPayloadEnd - pInput) < end - begin) return ECompressionError::CORRUPTED;
+        DeltaXor(pBytes + begin, pBytes + begin, pInput, end - begin);
+        pInput += end - begin;
+        unit = last;
+    }
+    if (pInput != pPayloadEnd) return ECompressionError::CORRUPTED;
+    return static_cast<USize>(targetSize);
+}
+
+#ifdef LEYENGINE_TEST
+
+// --------------------
+//
+// テスト
+//
+// ====================
+
+// テストで扱う最大のバイトサイズ
+constexpr USize DELTA_TEST_MAX_SIZE = 1024;
+
+// テストのデータを作る疑似乱数です。
+struct DeltaTestRandom
+{
+    U64 state;  // 状態
+
+    // 次の値を返します。
+    U64 Next() noexcept
+    {
+        this->state ^= this->state << 13;
+        this->state ^= this->state >> 7;
+        this->state ^= this->state << 17;
+        return this->state;
+    }
+
+    // 0以上count未満の値を返します。
+    USize Below(USize count) noexcept
+    {
+        return static_cast<USize>(this->Next() % count);
+    }
+};
+
+// 1つの組み合わせで差分を作成して適用し、変更後と一致するかを返します。
+Bool TestDeltaCase(const U8 *pBase, USize baseSize, const U8 *pTarget, USize targetSize, USize unitSize) noexcept
+{
+    U8 delta[DeltaEncodeBound(DELTA_TEST_MAX_SIZE)];
+    U8 data[DELTA_TEST_MAX_SIZE + 1];
+    Var encodeResult = DeltaEncode(pBase, baseSize, pTarget, targetSize, unitSize, delta, sizeof(delta));
+    if (encodeResult.IsFailure()) return NO;
+    Var deltaSize = encodeResult.Value();
+    // 変更前より長い部分は0で埋めてから適用します
+    std::memset(data, 0, sizeof(data));
+    if (baseSize != 0) std::memcpy(data, pBase, baseSize);
+    Var sizeResult = DeltaTargetSize(delta, deltaSize);
+    if (sizeResult.IsFailure() || sizeResult.Value() != targetSize) return NO;
+    Var applyResult = DeltaApply(delta, deltaSize, data, sizeof(data));
+    if (applyResult.IsFailure() || applyResult.Value() != targetSize) return NO;
+    if (targetSize != 0 && std::memcmp(data, pTarget, targetSize) != 0) return NO;
+    // ちょうどの大きさの出力先でも作成でき、1バイト足りない場合は失敗します
+    if (DeltaEncode(pBase, baseSize, pTarget, targetSize, unitSize, delta, deltaSize).IsFailure()) return NO;
+    if (DeltaEncode(pBase, baseSize, pTarget, targetSize, unitSize, delta, deltaSize - 1).IsSuccess()) return NO;
+    // 途中で切れた差分は範囲外にアクセスせずに失敗します
+    for (USize size = 0; size < deltaSize; size++)
+    {
+        if (DeltaApply(delta, size, data, sizeof(data)).IsSuccess()) return NO;
+    }
+    return YES;
+}
+
+// 差分を作成して適用し、変更後のデータに戻るかを検証します。
+Bool LeyEngine::TestDeltaRoundTrip() noexcept
+{
+    static const USize sizes[] = { 0, 1, 7, 16, 63, 64, 65, 257, DELTA_TEST_MAX_SIZE };
+    static const USize unitSizes[] = { 1, 2, 3, 4, 8, 12 };
+    static const USize changeRates[] = { 0, 1, 8, 100 };
+    DeltaTestRandom random{ 0x9E3779B97F4A7C15 };
+    U8 base[DELTA_TEST_MAX_SIZE];
+    U8 target[DELTA_TEST_MAX_SIZE];
+    for (Var baseSize : sizes)
+    {
+        for (Var targetSize : sizes)
+        {
+            for (Var unitSize : unitSizes)
+            {
+                for (Var changeRate : changeRates)
+                {
+                    // 変更前から百分率で指定した割合のバイトを書き換えます
+                    for (USize i = 0; i < baseSize; i++) base[i] = static_cast<U8>(random.Next());
+                    for (USize i = 0; i < targetSize; i++)
+                    {
+                        Var isChanged = i >= baseSize || random.Below(100) < changeRate;
+                        target[i] = isChanged ? static_cast<U8>(random.Next()) : base[i];
+                    }
+                    if (!TestDeltaCase(base, baseSize, target, targetSize, unitSize)) return NO;
+                }
+            }
+        }
+    }
+    // 配列の差分では、前回の配列に適用して次の配列と一致するかを確かめます
+    struct Element
+    {
+        F32 position[3];
+        U32 flags;
+        U16 health;
+        U8 team;
+    };
+    Var previousResult = Array<Element>::Create(1);
+    Var currentResult = Array<Element>::Create(1);
+    Var deltaResult = Array<U8>::Create(1);
+    if (previousResult.IsFailure() || currentResult.IsFailure() || deltaResult.IsFailure()) return NO;
+    Var &previous = previousResult.Value();
+    Var &current = currentResult.Value();
+    Var &delta = deltaResult.Value();
+    for (USize frame = 0; frame < 64; frame++)
+    {
+        Var received = Array<Element>::Create(1);
+        if (received.IsFailure() || received.Value().Resize(previous.Count()).IsFailure()) return NO;
+        if (previous.Count() != 0) std::memcpy(Cast<Void*>(received.Value().Data()), previous.Data(), previous.Count() * sizeof(Element));
+        // 要素の追加、削除、一部のフィールドの変更を行います
+        Var count = random.Below(48);
+        if (current.Resize(count).IsFailure()) return NO;
+        for (USize i = 0; i < count; i++)
+        {
+            Var &element = current[i];
+            if (i >= previous.Count())
+            {
+                std::memset(Cast<Void*>(&element), 0, sizeof(Element));
+                element.team = static_cast<U8>(random.Below(4));
+            }
+            if (random.Below(4) == 0) element.position[random.Below(3)] += 1.0f;
+            if (random.Below(8) == 0) element.health = static_cast<U16>(random.Next());
+        }
+        if (DeltaEncode(previous, current, delta).IsFailure()) return NO;
+        if (DeltaApply(delta, received.Value()).IsFailure()) return NO;
+        if (received.Value().Count() != current.Count()) return NO;
+        if (count != 0 && std::memcmp(received.Value().Data(), current.Data(), count * sizeof(Element)) != 0) return NO;
+        if (previous.Resize(count).IsFailure()) return NO;
+        if (count != 0) std::memcpy(Cast<Void*>(previous.Data()), current.Data(), count * sizeof(Element));
+    }
+    return YES;
+}
+#endif
\ No newline at end of file
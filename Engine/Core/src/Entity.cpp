@@ -0,0 +1,420 @@
+// Entity.cpp
+// (C) 2022 LeyCommunity.
+// author Taichi Ito.
+
+#include <cstring>
+#include <new>
+#include "LeyEngine/Entity.hpp"
+
+using namespace LeyEngine;
+
+// --------------------
+//
+// 配列
+//
+// ====================
+
+// 配列の容量を確保します。
+template<typename T>
+Bool ReserveArray(T *&pArray, USize count, USize &capacity, USize required) noexcept
+{
+    if (required <= capacity) return YES;
+    Var newCapacity = capacity == 0 ? 8 : capacity * 2;
+    while (newCapacity < required) newCapacity *= 2;
+    Var result = Allocate(sizeof(T) * newCapacity);
+    if (result.IsFailure()) return NO;
+    Var pNewArray = Cast<T*>(result.Value());
+    if (count != 0) std::memcpy(pNewArray, pArray, sizeof(T) * count);
+    if (pArray != NONE) (Void)Deallocate(sizeof(T) * capacity, pArray);
+    pArray = pNewArray;
+    capacity = newCapacity;
+    return YES;
+}
+
+// --------------------
+//
+// ワールド
+//
+// ====================
+
+// 空のワールドを作成します。
+LeyEngine::EntityWorld::EntityWorld() noexcept
+    : m_chunkPool()
+    , m_components()
+    , m_componentSlots()
+    , m_componentCount(0)
+    , m_ppArchetypes(NONE)
+    , m_archetypeCount(0)
+    , m_archetypeCapacity(0)
+    , m_pRecords(NONE)
+    , m_recordCount(0)
+    , m_recordCapacity(0)
+    , m_freeRecord(U32_MAX)
+    , m_entityCount(0)
+{
+}
+
+// デストラクタです。
+// チャンクはプールの破棄で解放されます。
+LeyEngine::EntityWorld::~EntityWorld() noexcept
+{
+    for (USize i = 0; i < this->m_archetypeCount; i++)
+    {
+        Var pArchetype = this->m_ppArchetypes[i];
+        if (pArchetype->pColumns != NONE) (Void)Deallocate(sizeof(EntityColumn) * pArchetype->columnCount, pArchetype->pColumns);
+        if (pArchetype->ppChunks != NONE) (Void)Deallocate(sizeof(EntityChunk*) * pArchetype->chunkCapacity, pArchetype->ppChunks);
+        (Void)Deallocate(sizeof(EntityArchetype), pArchetype);
+    }
+    if (this->m_ppArchetypes != NONE) (Void)Deallocate(sizeof(EntityArchetype*) * this->m_archetypeCapacity, this->m_ppArchetypes);
+    if (this->m_pRecords != NONE) (Void)Deallocate(sizeof(Record) * this->m_recordCapacity, this->m_pRecords);
+}
+
+// コンポーネントの種類を登録します。
+Result<ComponentId, EEntityError> LeyEngine::EntityWorld::RegisterComponent(const ComponentInfo &info) noexcept
+{
+    Var hash = info.typeId.Hash();
+    for (USize probe = 0; probe < COMPONENT_SLOT_COUNT; probe++)
+    {
+        Var &slot = this->m_componentSlots[(hash + probe) % COMPONENT_SLOT_COUNT];
+        if (slot.idPlusOne != 0)
+        {
+            if (slot.typeHash == hash) return slot.idPlusOne - 1;
+            continue;
+        }
+        if (this->m_componentCount == MAX_COMPONENT_COUNT) return EEntityError::TOO_MANY_COMPONENTS;
+        Var id = this->m_componentCount++;
+        this->m_components[id] = info;
+        slot.typeHash = hash;
+        slot.idPlusOne = id + 1;
+        return id;
+    }
+    return EEntityError::TOO_MANY_COMPONENTS;
+}
+
+// 登録済みのコンポーネントの種類の番号を返します。
+Result<ComponentId, EEntityError> LeyEngine::EntityWorld::FindComponent(TypeId typeId) const noexcept
+{
+    Var hash = typeId.Hash();
+    for (USize probe = 0; probe < COMPONENT_SLOT_COUNT; probe++)
+    {
+        const Var &slot = this->m_componentSlots[(hash + probe) % COMPONENT_SLOT_COUNT];
+        if (slot.idPlusOne == 0) break;
+        if (slot.typeHash == hash) return slot.idPlusOne - 1;
+    }
+    return EEntityError::NOT_FOUND;
+}
+
+// 種類の集合に一致するアーキタイプを返し、無ければ作成します。
+Result<EntityArchetype*, EEntityError> LeyEngine::EntityWorld::FindOrCreateArchetype(const ComponentMask &mask) noexcept
+{
+    // アーキタイプの数は少ないため線形に探します
+    for (USize i = 0; i < this->m_archetypeCount; i++)
+    {
+        if (this->m_ppArchetypes[i]->mask == mask) return this->m_ppArchetypes[i];
+    }
+    if (!ReserveArray(this->m_ppArchetypes, this->m_archetypeCount, this->m_archetypeCapacity, this->m_archetypeCount + 1)) return EEntityError::BAD_ALLOCATE;
+
+    U32 columnCount = 0;
+    USize entitySize = sizeof(Entity);
+    USize paddingSize = 0;
+    for (ComponentId id = 0; id < this->m_componentCount; id++)
+    {
+        if (!mask.Test(id)) continue;
+        columnCount++;
+        entitySize += this->m_components[id].size;
+        paddingSize += this->m_components[id].alignment;
+    }
+    Var entitiesOffset = AlignUp(sizeof(EntityChunk), alignof(Entity));
+    if (entitiesOffset + paddingSize + entitySize > ENTITY_CHUNK_SIZE) return EEntityError::TOO_LARGE;
+
+    Var archetypeResult = Allocate(sizeof(EntityArchetype));
+    if (archetypeResult.IsFailure()) return EEntityError::BAD_ALLOCATE;
+    Var pArchetype = new(archetypeResult.Value()) EntityArchetype();
+    if (columnCount != 0)
+    {
+        Var columnsResult = Allocate(sizeof(EntityColumn) * columnCount);
+        if (columnsResult.IsFailure())
+        {
+            (Void)Deallocate(sizeof(EntityArchetype), pArchetype);
+            return EEntityError::BAD_ALLOCATE;
+        }
+        pArchetype->pColumns = Cast<EntityColumn*>(columnsResult.Value());
+    }
+    pArchetype->mask = mask;
+    pArchetype->columnCount = columnCount;
+    pArchetype->entitiesOffset = static_cast<U32>(entitiesOffset);
+    for (USize i = 0; i < MAX_COMPONENT_COUNT; i++) pArchetype->columnOf[i] = EntityArchetype::NO_COLUMN;
+    U32 column = 0;
+    for (ComponentId id = 0; id < this->m_componentCount; id++)
+    {
+        if (!mask.Test(id)) continue;
+        pArchetype->columnOf[id] = static_cast<U16>(column);
+        pArchetype->pColumns[column++] = EntityColumn{ id, 0, this->m_components[id].size };
+    }
+
+    // アライメントの余白を見込んで見積もり、収まるまで減らします
+    Var capacity = (ENTITY_CHUNK_SIZE - entitiesOffset - paddingSize) / entitySize;
+    while (YES)
+    {
+        Var offset = entitiesOffset + sizeof(Entity) * capacity;
+        for (U32 i = 0; i < columnCount; i++)
+        {
+            Var &info = this->m_components[pArchetype->pColumns[i].id];
+            offset = AlignUp(offset, info.alignment);
+            pArchetype->pColumns[i].offset = static_cast<U32>(offset);
+            offset += static_cast<USize>(info.size) * capacity;
+        }
+        if (offset <= ENTITY_CHUNK_SIZE) break;
+        capacity--;
+    }
+    pArchetype->capacity = static_cast<U32>(capacity);
+    this->m_ppArchetypes[this->m_archetypeCount++] = pArchetype;
+    return pArchetype;
+}
+
+// アーキタイプの末尾にエンティティの行を追加します。
+Result<Success, EEntityError> LeyEngine::EntityWorld::AppendRow(EntityArchetype *pArchetype, Entity entity, EntityChunk **ppChunk, U32 *pRow) noexcept
+{
+    if (pArchetype->chunkCount == 0 || pArchetype->ppChunks[pArchetype->chunkCount - 1]->count == pArchetype->capacity)
+    {
+        if (!ReserveArray(pArchetype->ppChunks, pArchetype->chunkCount, pArchetype->chunkCapacity, pArchetype->chunkCount + 1)) return EEntityError::BAD_ALLOCATE;
+        Var memoryResult = this->m_chunkPool.Allocate();
+        if (memoryResult.IsFailure()) return EEntityError::BAD_ALLOCATE;
+        Var pChunk = new(memoryResult.Value()) EntityChunk{ pArchetype, 0, static_cast<U32>(pArchetype->chunkCount) };
+        pArchetype->ppChunks[pArchetype->chunkCount++] = pChunk;
+    }
+    Var pChunk = pArchetype->ppChunks[pArchetype->chunkCount - 1];
+    Var row = pChunk->count++;
+    pArchetype->EntitiesOf(pChunk)[row] = entity;
+    pArchetype->entityCount++;
+    *ppChunk = pChunk;
+    *pRow = row;
+    return SUCCESS;
+}
+
+// 行を取り除き、最後の行で埋めます。
+Void LeyEngine::EntityWorld::RemoveRow(EntityArchetype *pArchetype, EntityChunk *pChunk, U32 row) noexcept
+{
+    Var pLast = pArchetype->ppChunks[pArchetype->chunkCount - 1];
+    Var lastRow = pLast->count - 1;
+    if (pChunk != pLast || row != lastRow)
+    {
+        Var moved = pArchetype->EntitiesOf(pLast)[lastRow];
+        pArchetype->EntitiesOf(pChunk)[row] = moved;
+        for (U32 i = 0; i < pArchetype->columnCount; i++)
+        {
+            const Var &column = pArchetype->pColumns[i];
+            std::memcpy(Cast<U8*>(pChunk) + column.offset + static_cast<USize>(column.size) * row,
+                Cast<U8*>(pLast) + column.offset + static_cast<USize>(column.size) * lastRow, column.size);
+        }
+        this->m_pRecords[moved.index].pChunk = pChunk;
+        this->m_pRecords[moved.index].row = row;
+    }
+    pLast->count--;
+    pArchetype->entityCount--;
+    if (pLast->count == 0)
+    {
+        (Void)this->m_chunkPool.Deallocate(Cast<EntityChunkMemory*>(pLast));
+        pArchetype->chunkCount--;
+    }
+}
+
+// 有効なエンティティの格納位置を返します。
+EntityWorld::Record *LeyEngine::EntityWorld::FindRecord(Entity entity) const noexcept
+{
+    if (entity.index >= this->m_recordCount) return NONE;
+    Var pRecord = &this->m_pRecords[entity.index];
+    if (pRecord->pArchetype == NONE || pRecord->generation != entity.generation) return NONE;
+    return pRecord;
+}
+
+// エンティティを別のアーキタイプへ移動します。
+Result<Success, EEntityError> LeyEngine::EntityWorld::MoveEntity(Record &record, const ComponentMask &mask) noexcept
+{
+    Var targetResult = this->FindOrCreateArchetype(mask);
+    if (targetResult.IsFailure()) return targetResult.Error();
+    Var pTarget = targetResult.Value();
+    Var pSource = record.pArchetype;
+    Var pSourceChunk = record.pChunk;
+    Var sourceRow = record.row;
+    EntityChunk *pChunk;
+    U32 row;
+    Var appendResult = this->AppendRow(pTarget, pSource->EntitiesOf(pSourceChunk)[sourceRow], &pChunk, &row);
+    if (appendResult.IsFailure()) return appendResult;
+    for (U32 i = 0; i < pTarget->columnCount; i++)
+    {
+        const Var &column = pTarget->pColumns[i];
+        Var pDestination = Cast<U8*>(pChunk) + column.offset + static_cast<USize>(column.size) * row;
+        Var pSourceColumn = pSource->ColumnOf(pSourceChunk, column.id);
+        if (pSourceColumn != NONE) std::memcpy(pDestination, pSourceColumn + static_cast<USize>(column.size) * sourceRow, column.size);
+        else std::memset(pDestination, 0, column.size);
+    }
+    this->RemoveRow(pSource, pSourceChunk, sourceRow);
+    record.pArchetype = pTarget;
+    record.pChunk = pChunk;
+    record.row = row;
+    return SUCCESS;
+}
+
+// コンポーネントの集合を指定してエンティティを作成します。
+Result<Entity, EEntityError> LeyEngine::EntityWorld::CreateEntity(const ComponentMask &mask) noexcept
+{
+    Var archetypeResult = this->FindOrCreateArchetype(mask);
+    if (archetypeResult.IsFailure()) return archetypeResult.Error();
+    Var pArchetype = archetypeResult.Value();
+
+    // 破棄したエンティティの位置を優先して再利用します
+    U32 index;
+    if (this->m_freeRecord != U32_MAX)
+    {
+        index = this->m_freeRecord;
+    }
+    else
+    {
+        if (this->m_recordCount == U32_MAX) return EEntityError::BAD_ALLOCATE;
+        if (!ReserveArray(this->m_pRecords, this->m_recordCount, this->m_recordCapacity, this->m_recordCount + 1)) return EEntityError::BAD_ALLOCATE;
+        index = static_cast<U32>(this->m_recordCount);
+        this->m_pRecords[index] = Record{ NONE, NONE, U32_MAX, 1 };
+    }
+    Var &record = this->m_pRecords[index];
+    Entity entity = { index, record.generation };
+    EntityChunk *pChunk;
+    U32 row;
+    Var appendResult = this->AppendRow(pArchetype, entity, &pChunk, &row);
+    if (appendResult.IsFailure()) return appendResult.Error();
+    if (index == this->m_freeRecord) this->m_freeRecord = record.row;
+    else this->m_recordCount++;
+    for (U32 i = 0; i < pArchetype->columnCount; i++)
+    {
+        const Var &column = pArchetype->pColumns[i];
+        std::memset(Cast<U8*>(pChunk) + column.offset + static_cast<USize>(column.size) * row, 0, column.size);
+    }
+    record.pArchetype = pArchetype;
+    record.pChunk = pChunk;
+    record.row = row;
+    this->m_entityCount++;
+    return entity;
+}
+
+// エンティティを破棄します。
+Result<Success, EEntityError> LeyEngine::EntityWorld::DestroyEntity(Entity entity) noexcept
+{
+    Var pRecord = this->FindRecord(entity);
+    if (pRecord == NONE) return EEntityError::NOT_FOUND;
+    this->RemoveRow(pRecord->pArchetype, pRecord->pChunk, pRecord->row);
+    pRecord->pArchetype = NONE;
+    pRecord->pChunk = NONE;
+    pRecord->generation = pRecord->generation == U32_MAX ? 1 : pRecord->generation + 1;
+    pRecord->row = this->m_freeRecord;
+    this->m_freeRecord = entity.index;
+    this->m_entityCount--;
+    return SUCCESS;
+}
+
+// エンティティのコンポーネントを返します。
+Void *LeyEngine::EntityWorld::GetComponent(Entity entity, ComponentId id) const noexcept
+{
+    Var pRecord = this->FindRecord(entity);
+    if (pRecord == NONE || id >= MAX_COMPONENT_COUNT) return NONE;
+    Var pColumn = pRecord->pArchetype->ColumnOf(pRecord->pChunk, id);
+    if (pColumn == NONE) return NONE;
+    return pColumn + static_cast<USize>(this->m_components[id].size) * pRecord->row;
+}
+
+// エンティティにコンポーネントを追加します。
+Result<Success, EEntityError> LeyEngine::EntityWorld::AddComponent(Entity entity, ComponentId id) noexcept
+{
+    Var pRecord = this->FindRecord(entity);
+    if (pRecord == NONE || id >= this->m_componentCount) return EEntityError::NOT_FOUND;
+    if (pRecord->pArchetype->mask.Test(id)) return SUCCESS;
+    Var mask = pRecord->pArchetype->mask;
+    mask.Set(id);
+    return this->MoveEntity(*pRecord, mask);
+}
+
+// エンティティからコンポーネントを取り除きます。
+Result<Success, EEntityError> LeyEngine::EntityWorld::RemoveComponent(Entity entity, ComponentId id) noexcept
+{
+    Var pRecord = this->FindRecord(entity);
+    if (pRecord == NONE || id >= this->m_componentCount || !pRecord->pArchetype->mask.Test(id)) return EEntityError::NOT_FOUND;
+    Var mask = pRecord->pArchetype->mask;
+    mask.Reset(id);
+    return this->MoveEntity(*pRecord, mask);
+}
+
+// --------------------
+//
+// クエリ
+//
+// ====================
+
+// 作成します。
+LeyEngine::_Internal::_EntityQueryBase::_EntityQueryBase(EntityWorld *pWorld) noexcept
+    : pWorld(pWorld)
+    , include()
+    , exclude()
+    , ppArchetypes(NONE)
+    , archetypeCount(0)
+    , archetypeCapacity(0)
+    , checkedCount(0)
+    , ppChunks(NONE)
+    , chunkCapacity(0)
+{
+}
+
+// ムーブします。
+LeyEngine::_Internal::_EntityQueryBase::_EntityQueryBase(_EntityQueryBase &&origin) noexcept
+    : pWorld(origin.pWorld)
+    , include(origin.include)
+    , exclude(origin.exclude)
+    , ppArchetypes(origin.ppArchetypes)
+    , archetypeCount(origin.archetypeCount)
+    , archetypeCapacity(origin.archetypeCapacity)
+    , checkedCount(origin.checkedCount)
+    , ppChunks(origin.ppChunks)
+    , chunkCapacity(origin.chunkCapacity)
+{
+    origin.ppArchetypes = NONE;
+    origin.archetypeCount = 0;
+    origin.archetypeCapacity = 0;
+    origin.checkedCount = 0;
+    origin.ppChunks = NONE;
+    origin.chunkCapacity = 0;
+}
+
+// デストラクタです。
+LeyEngine::_Internal::_EntityQueryBase::~_EntityQueryBase() noexcept
+{
+    if (this->ppArchetypes != NONE) (Void)Deallocate(sizeof(EntityArchetype*) * this->archetypeCapacity, this->ppArchetypes);
+    if (this->ppChunks != NONE) (Void)Deallocate(sizeof(EntityChunk*) * this->chunkCapacity, this->ppChunks);
+}
+
+// ワールドに追加されたアーキタイプを照合します。
+Void LeyEngine::_Internal::_EntityQueryBase::Update() noexcept
+{
+    Var count = this->pWorld->ArchetypeCount();
+    for (; this->checkedCount < count; this->checkedCount++)
+    {
+        Var pArchetype = this->pWorld->ArchetypeAt(this->checkedCount);
+        if (!pArchetype->mask.ContainsAll(this->include) || pArchetype->mask.Intersects(this->exclude)) continue;
+        // 確保に失敗した場合は次回に照合し直します
+        if (!ReserveArray(this->ppArchetypes, this->archetypeCount, this->archetypeCapacity, this->archetypeCount + 1)) return;
+        this->ppArchetypes[this->archetypeCount++] = pArchetype;
+    }
+}
+
+// 一致したアーキタイプのチャンクを集めます。
+USize LeyEngine::_Internal::_EntityQueryBase::CollectChunks() noexcept
+{
+    USize count = 0;
+    for (USize i = 0; i < this->archetypeCount; i++) count += this->ppArchetypes[i]->chunkCount;
+    // 前回の内容は不要なため、コピーせずに確保し直します
+    if (!ReserveArray(this->ppChunks, 0, this->chunkCapacity, count)) return 0;
+    count = 0;
+    for (USize i = 0; i < this->archetypeCount; i++)
+    {
+        Var pArchetype = this->ppArchetypes[i];
+        for (USize c = 0; c < pArchetype->chunkCount; c++) this->ppChunks[count++] = pArchetype->ppChunks[c];
+    }
+    return count;
+}
\ No newline at end of file
@@ -0,0 +1,651 @@
+// Job.cpp
+// (C) 2022 LeyCommunity.
+// author Taichi Ito.
+
+#include <mutex>
+#include <thread>
+#ifdef LEYENGINE_CORE_MODULE
+#include <atomic>
+#include <condition_variable>
+#include <new>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <ucontext.h>
+#endif
+#include "LeyEngine/Collections/RingQueue.hpp"
+#endif
+#include "LeyEngine/Job.hpp"
+
+using namespace LeyEngine;
+
+#ifdef LEYENGINE_CORE_MODULE
+
+// --------------------
+//
+// 設定
+//
+// ====================
+
+// ジョブキューの容量、溢れたジョブは要求したスレッドで実行します
+constexpr USize JOB_QUEUE_CAPACITY = 4096;
+// ファイバーの数、すべて待機中の場合はジョブをワーカースレッドで直接実行します
+constexpr USize FIBER_COUNT = 128;
+// ファイバーのスタックのバイトサイズ
+constexpr USize FIBER_STACK_SIZE = 64 * 1024;
+// ワーカースレッドの最大数
+constexpr USize MAX_JOB_WORKER_COUNT = 64;
+// 眠る前にジョブを探す回数
+constexpr USize JOB_SPIN_COUNT = 64;
+
+// --------------------
+//
+// ファイバー
+//
+// ====================
+
+// ファイバーの状態です。
+enum class EFiberState : U8
+{
+    RUNNING,    // 実行中
+    WAITING,    // カウンタを待機中
+    FINISHED,   // ジョブが完了
+};
+
+// キューに積まれたジョブです。
+struct JobEntry
+{
+    JobFunction function;   // 関数
+    Void *pData;            // 関数に渡すポインタ
+    JobCounter *pCounter;   // 完了を数えるカウンタ
+};
+
+// ジョブを実行するファイバーです。
+// ジョブが完了しても破棄せず、次のジョブで再利用します。
+struct Fiber
+{
+#if defined(_WIN32)
+    LPVOID handle;              // ファイバーのハンドル
+#else
+    ucontext_t context;         // 中断したコンテキスト
+#endif
+    JobEntry job;               // 実行中のジョブ
+    EFiberState state;          // 状態
+    JobCounter *pWaitCounter;   // 待機しているカウンタ
+    Fiber *pNextWaiting;        // 待機リストの次のファイバー
+};
+
+// ワーカースレッドの状態です。
+struct JobWorker
+{
+#if defined(_WIN32)
+    LPVOID schedulerHandle;     // スケジューラのファイバーのハンドル
+#else
+    ucontext_t schedulerContext;    // スケジューラのコンテキスト
+#endif
+    Fiber *pCurrent;            // 実行中のファイバー
+};
+
+// 現在のスレッドのワーカーです。
+thread_local JobWorker *t_pWorker = NONE;
+
+// 現在のスレッドのワーカーを返します。
+// ファイバーは中断したスレッドと異なるスレッドで再開するため、スレッドローカル変数のアドレスを使い回さないようにインライン化しません。
+#if defined(_MSC_VER)
+__declspec(noinline)
+#else
+__attribute__((noinline))
+#endif
+JobWorker *CurrentWorker() noexcept
+{
+    return t_pWorker;
+}
+
+// ファイバーに切り替えます。
+inline Void ResumeFiber(JobWorker *pWorker, Fiber *pFiber) noexcept
+{
+    pWorker->pCurrent = pFiber;
+#if defined(_WIN32)
+    SwitchToFiber(pFiber->handle);
+#else
+    swapcontext(&pWorker->schedulerContext, &pFiber->context);
+#endif
+}
+
+// ファイバーを中断してスケジューラに戻ります。
+inline Void SuspendFiber(Fiber *pFiber, JobWorker *pWorker) noexcept
+{
+#if defined(_WIN32)
+    (Void)pFiber;
+    SwitchToFiber(pWorker->schedulerHandle);
+#else
+    swapcontext(&pFiber->context, &pWorker->schedulerContext);
+#endif
+}
+
+// --------------------
+//
+// ジョブシステム
+//
+// ====================
+
+// ジョブシステムです。
+struct JobSystem
+{
+    Result<RingQueue<JobEntry>, EAllocateError> jobs;       // 実行待ちのジョブ
+    Result<RingQueue<Fiber*>, EAllocateError> readyFibers;  // 再開できるファイバー
+    Result<RingQueue<Fiber*>, EAllocateError> freeFibers;   // 未使用のファイバー
+    Fiber *pFibers = NONE;                  // ファイバー
+    U8 *pStacks = NONE;                     // ファイバーのスタック
+    std::mutex waitMutex;                   // 待機リストを保護するミューテックス
+    Fiber *pWaiting = NONE;                 // カウンタを待機中のファイバー
+    std::mutex sleepMutex;                  // 眠っているワーカースレッドのミューテックス
+    std::condition_variable sleepCondition; // ワーカースレッドを起床させる条件変数
+    std::atomic<USize> sleepingCount;       // 眠っているワーカースレッドの数
+    std::atomic<Bool> isRunning;            // 実行中か
+    std::mutex frameMutex;                  // 次のフレームのジョブを保護するミューテックス
+    JobEntry *pFrameJobs = NONE;            // 次のフレームで実行するジョブ
+    USize frameJobsCount = 0;               // 次のフレームで実行するジョブの数
+    USize frameJobsCapacity = 0;            // 次のフレームで実行するジョブの配列長
+    std::thread threads[MAX_JOB_WORKER_COUNT];  // ワーカースレッド
+    USize workerCount = 0;                  // ワーカースレッドの数
+    Bool isInitialized = NO;                // 初期化に成功したか
+
+    JobSystem() noexcept
+        : jobs(RingQueue<JobEntry>::Create(JOB_QUEUE_CAPACITY))
+        , readyFibers(RingQueue<Fiber*>::Create(FIBER_COUNT))
+        , freeFibers(RingQueue<Fiber*>::Create(FIBER_COUNT))
+        , sleepingCount(0)
+        , isRunning(YES)
+    {
+        if (this->jobs.IsFailure() || this->readyFibers.IsFailure() || this->freeFibers.IsFailure()) return;
+        // ファイバーとスタックはメモリシステムからまとめて確保します
+        Var fibersResult = Allocate(sizeof(Fiber) * FIBER_COUNT);
+        if (fibersResult.IsFailure()) return;
+        this->pFibers = Cast<Fiber*>(fibersResult.Value());
+#if !defined(_WIN32)
+        Var stacksResult = AllocateAligned(FIBER_STACK_SIZE * FIBER_COUNT, CACHE_LINE_SIZE);
+        if (stacksResult.IsFailure()) return;
+        this->pStacks = Cast<U8*>(stacksResult.Value());
+#endif
+        for (USize i = 0; i < FIBER_COUNT; i++)
+        {
+            Var pFiber = new(&this->pFibers[i]) Fiber();
+#if defined(_WIN32)
+            // Windowsのファイバーはスタックを自身で確保します
+            pFiber->handle = CreateFiberEx(0, FIBER_STACK_SIZE, 0, &JobSystem::RunFiberWindows, pFiber);
+            if (pFiber->handle == NONE) return;
+#else
+            getcontext(&pFiber->context);
+            pFiber->context.uc_stack.ss_sp = this->pStacks + FIBER_STACK_SIZE * i;
+            pFiber->context.uc_stack.ss_size = FIBER_STACK_SIZE;
+            pFiber->context.uc_link = NONE;
+            makecontext(&pFiber->context, &JobSystem::RunFiber, 0);
+#endif
+            (Void)this->freeFibers.Value().TryPush(pFiber);
+        }
+        Var concurrency = static_cast<USize>(std::thread::hardware_concurrency());
+        this->workerCount = concurrency > 1 ? concurrency - 1 : 1;
+        if (this->workerCount > MAX_JOB_WORKER_COUNT) this->workerCount = MAX_JOB_WORKER_COUNT;
+        for (USize i = 0; i < this->workerCount; i++)
+        {
+            this->threads[i] = std::thread([this]() { this->RunWorker(); });
+        }
+        this->isInitialized = YES;
+    }
+
+    ~JobSystem() noexcept
+    {
+        this->isRunning.store(NO, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(this->sleepMutex);
+            this->sleepCondition.notify_all();
+        }
+        for (USize i = 0; i < this->workerCount; i++)
+        {
+            this->threads[i].join();
+        }
+        // 待機中のファイバーは再開せずに破棄します
+        if (this->pFibers != NONE)
+        {
+#if defined(_WIN32)
+            for (USize i = 0; i < FIBER_COUNT; i++)
+            {
+                if (this->pFibers[i].handle != NONE) DeleteFiber(this->pFibers[i].handle);
+            }
+#endif
+            (Void)Deallocate(sizeof(Fiber) * FIBER_COUNT, this->pFibers);
+        }
+        if (this->pStacks != NONE) (Void)DeallocateAligned(FIBER_STACK_SIZE * FIBER_COUNT, CACHE_LINE_SIZE, this->pStacks);
+        if (this->pFrameJobs != NONE) (Void)Deallocate(sizeof(JobEntry) * this->frameJobsCapacity, this->pFrameJobs);
+    }
+
+    // 眠っているワーカースレッドを起床させます。
+    // キューへの追加の後に呼び出します。
+    Void Notify(Bool isAll) noexcept
+    {
+        // キューへの追加と眠る数の読み込みの順序を保証し、眠る側のキューの確認と合わせて通知を取りこぼさないようにします
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->sleepingCount.load(std::memory_order_relaxed) == 0) return;
+        std::lock_guard<std::mutex> lock(this->sleepMutex);
+        if (isAll) this->sleepCondition.notify_all();
+        else this->sleepCondition.notify_one();
+    }
+
+    // ジョブの完了をカウンタに反映します。
+    Void Finish(JobCounter *pCounter) noexcept
+    {
+        if (pCounter == NONE) return;
+        // 0になった時だけ待機リストを確認します
+        // 待機側はカウンタが0になると破棄する可能性があるため、以降はアドレスの比較にのみ使用します
+        if (pCounter->value.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        Bool isWoken = NO;
+        {
+            std::lock_guard<std::mutex> lock(this->waitMutex);
+            for (Var ppFiber = &this->pWaiting; *ppFiber != NONE;)
+            {
+                Var pFiber = *ppFiber;
+                if (pFiber->pWaitCounter != pCounter)
+                {
+                    ppFiber = &pFiber->pNextWaiting;
+                    continue;
+                }
+                *ppFiber = pFiber->pNextWaiting;
+                (Void)this->readyFibers.Value().TryPush(pFiber);
+                isWoken = YES;
+            }
+        }
+        if (isWoken) this->Notify(YES);
+    }
+
+    // 中断したファイバーを待機リストに追加します。
+    // ファイバーのスタックから離れた後にワーカースレッドで呼び出します。
+    Void Park(Fiber *pFiber) noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->waitMutex);
+            // 待機リストのロック中に確認するため、カウンタが0になった通知を取りこぼしません
+            if (pFiber->pWaitCounter->Value() != 0)
+            {
+                pFiber->pNextWaiting = this->pWaiting;
+                this->pWaiting = pFiber;
+                return;
+            }
+        }
+        (Void)this->readyFibers.Value().TryPush(pFiber);
+    }
+
+    // ジョブをキューに積みます。満杯の場合は呼び出したスレッドで実行します。
+    Void Push(const JobEntry *pJobs, USize count) noexcept
+    {
+        USize pushedCount = 0;
+        for (USize i = 0; i < count; i++)
+        {
+            if (this->jobs.Value().TryPush(pJobs[i]))
+            {
+                pushedCount++;
+                continue;
+            }
+            // 起床させてから自身で実行します
+            this->Notify(YES);
+            this->RunInline(pJobs[i]);
+        }
+        if (pushedCount != 0) this->Notify(pushedCount > 1);
+    }
+
+    // ジョブを呼び出したスレッドで実行します。
+    Void RunInline(const JobEntry &job) noexcept
+    {
+        job.function(job.pData);
+        this->Finish(job.pCounter);
+    }
+
+    // 再開できるファイバー、または、実行待ちのジョブを1つ実行します。
+    // ファイバー外のワーカースレッドで呼び出します。
+    // @return 実行するものがあったかです。
+    Bool RunNext(JobWorker *pWorker) noexcept
+    {
+        Fiber *pFiber = NONE;
+        // 中断から再開できるファイバーを優先します
+        if (!this->readyFibers.Value().TryPop(pFiber))
+        {
+            JobEntry job;
+            if (!this->jobs.Value().TryPop(job)) return NO;
+            if (!this->freeFibers.Value().TryPop(pFiber))
+            {
+                // すべてのファイバーが待機中の場合はワーカースレッドで直接実行します
+                // 直接実行したジョブが待機する間は、このスレッドで他のファイバーとジョブを実行します
+                this->RunInline(job);
+                return YES;
+            }
+            pFiber->job = job;
+        }
+        pFiber->state = EFiberState::RUNNING;
+        ResumeFiber(pWorker, pFiber);
+        pWorker->pCurrent = NONE;
+        if (pFiber->state == EFiberState::FINISHED)
+        {
+            (Void)this->freeFibers.Value().TryPush(pFiber);
+        }
+        else
+        {
+            this->Park(pFiber);
+        }
+        return YES;
+    }
+
+    // ワーカースレッドでファイバーを切り替えながらジョブを実行します。
+    Void RunWorker() noexcept
+    {
+        JobWorker worker = {};
+#if defined(_WIN32)
+        worker.schedulerHandle = ConvertThreadToFiber(NONE);
+#endif
+        t_pWorker = &worker;
+        USize idleCount = 0;
+        while (this->isRunning.load(std::memory_order_acquire))
+        {
+            if (!this->RunNext(&worker))
+            {
+                this->Idle(idleCount++);
+                continue;
+            }
+            idleCount = 0;
+        }
+        t_pWorker = NONE;
+#if defined(_WIN32)
+        ConvertFiberToThread();
+#endif
+    }
+
+    // 実行するものがない間に待機します。
+    Void Idle(USize idleCount) noexcept
+    {
+        if (idleCount < JOB_SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            return;
+        }
+        std::unique_lock<std::mutex> lock(this->sleepMutex);
+        // 眠る数を増やしてからキューを確認します
+        // 追加側はキューへの追加の後に眠る数を確認し、0でなければこのミューテックスを取って通知するため、
+        // 確認から待機までの間の通知は待機に入るまで遅れ、取りこぼしません
+        this->sleepingCount.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        this->sleepCondition.wait(lock, [this]()
+        {
+            return !this->isRunning.load(std::memory_order_acquire)
+                || this->jobs.Value().ApproximateCount() != 0
+                || this->readyFibers.Value().ApproximateCount() != 0;
+        });
+        this->sleepingCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // ファイバーの本体です。ジョブを実行してはスケジューラに戻ることを繰り返します。
+    static Void RunFiber() noexcept;
+
+#if defined(_WIN32)
+    // Windowsのファイバーの本体です。
+    static Void WINAPI RunFiberWindows(LPVOID) noexcept
+    {
+        RunFiber();
+    }
+#endif
+};
+
+// ジョブシステムを返します。
+// 最初の呼び出しでワーカースレッドを起動し、プログラムの終了時に停止します。
+JobSystem &GetJobSystem() noexcept
+{
+    static JobSystem system;
+    return system;
+}
+
+// ファイバーの本体です。
+Void JobSystem::RunFiber() noexcept
+{
+    Var &system = GetJobSystem();
+    for (;;)
+    {
+        Var pFiber = CurrentWorker()->pCurrent;
+        pFiber->job.function(pFiber->job.pData);
+        system.Finish(pFiber->job.pCounter);
+        pFiber->state = EFiberState::FINISHED;
+        // 待機を挟むと別のワーカースレッドに移っているため、改めて取得します
+        SuspendFiber(pFiber, CurrentWorker());
+    }
+}
+
+// ジョブを実行します。
+Result<Success, EJobError> LeyEngine::RunJobs(const JobDeclaration *pJobs, USize count, JobCounter *pCounter) noexcept
+{
+    if (pJobs == NONE && count != 0) return EJobError::INVALID_ARGUMENT;
+    if (count == 0) return SUCCESS;
+    Var &system = GetJobSystem();
+    if (!system.isInitialized) return EJobError::NOT_INITIALIZED;
+    if (pCounter != NONE) pCounter->value.fetch_add(static_cast<U32>(count), std::memory_order_acq_rel);
+    for (USize i = 0; i < count; i++)
+    {
+        JobEntry job = { pJobs[i].function, pJobs[i].pData, pCounter };
+        system.Push(&job, 1);
+    }
+    return SUCCESS;
+}
+
+// ジョブを次のフレームで実行します。
+Result<Success, EJobError> LeyEngine::RunJobsNextFrame(const JobDeclaration *pJobs, USize count, JobCounter *pCounter) noexcept
+{
+    if (pJobs == NONE && count != 0) return EJobError::INVALID_ARGUMENT;
+    if (count == 0) return SUCCESS;
+    Var &system = GetJobSystem();
+    if (!system.isInitialized) return EJobError::NOT_INITIALIZED;
+    {
+        std::lock_guard<std::mutex> lock(system.frameMutex);
+        if (system.frameJobsCount + count > system.frameJobsCapacity)
+        {
+            Var capacity = system.frameJobsCapacity == 0 ? 64 : system.frameJobsCapacity * 2;
+            while (capacity < system.frameJobsCount + count) capacity *= 2;
+            Var result = Allocate(sizeof(JobEntry) * capacity);
+            if (result.IsFailure()) return EJobError::BAD_ALLOCATE;
+            Var pFrameJobs = Cast<JobEntry*>(result.Value());
+            for (USize i = 0; i < system.frameJobsCount; i++)
+            {
+                pFrameJobs[i] = system.pFrameJobs[i];
+            }
+            if (system.pFrameJobs != NONE) (Void)Deallocate(sizeof(JobEntry) * system.frameJobsCapacity, system.pFrameJobs);
+            system.pFrameJobs = pFrameJobs;
+            system.frameJobsCapacity = capacity;
+        }
+        for (USize i = 0; i < count; i++)
+        {
+            system.pFrameJobs[system.frameJobsCount++] = JobEntry{ pJobs[i].function, pJobs[i].pData, pCounter };
+        }
+    }
+    if (pCounter != NONE) pCounter->value.fetch_add(static_cast<U32>(count), std::memory_order_acq_rel);
+    return SUCCESS;
+}
+
+// フレームを進め、RunJobsNextFrameで予約したジョブの実行を開始します。
+USize LeyEngine::AdvanceJobFrame() noexcept
+{
+    Var &system = GetJobSystem();
+    if (!system.isInitialized) return 0;
+    // 実行中のジョブが次のフレームのジョブを予約できるよう、配列ごと取り出してから積みます
+    JobEntry *pFrameJobs;
+    USize count;
+    USize capacity;
+    {
+        std::lock_guard<std::mutex> lock(system.frameMutex);
+        pFrameJobs = system.pFrameJobs;
+        count = system.frameJobsCount;
+        capacity = system.frameJobsCapacity;
+        system.pFrameJobs = NONE;
+        system.frameJobsCount = 0;
+        system.frameJobsCapacity = 0;
+    }
+    if (pFrameJobs == NONE) return 0;
+    system.Push(pFrameJobs, count);
+    (Void)Deallocate(sizeof(JobEntry) * capacity, pFrameJobs);
+    return count;
+}
+
+// カウンタが0になるまで待機します。
+Void LeyEngine::WaitForCounter(JobCounter &counter) noexcept
+{
+    Var &system = GetJobSystem();
+    Var pWorker = CurrentWorker();
+    if (pWorker != NONE && pWorker->pCurrent != NONE)
+    {
+        // ファイバーを中断し、再開後に改めて確認します
+        Var pFiber = pWorker->pCurrent;
+        while (counter.Value() != 0)
+        {
+            pFiber->pWaitCounter = &counter;
+            pFiber->state = EFiberState::WAITING;
+            SuspendFiber(pFiber, CurrentWorker());
+        }
+        pFiber->pWaitCounter = NONE;
+        return;
+    }
+    // ワーカースレッドで直接実行しているジョブは、待機中に他のファイバーとジョブを実行します
+    if (pWorker != NONE)
+    {
+        while (counter.Value() != 0)
+        {
+            if (!system.RunNext(pWorker)) std::this_thread::yield();
+        }
+        return;
+    }
+    // ファイバー外では待機中にジョブを実行します
+    while (counter.Value() != 0)
+    {
+        JobEntry job;
+        if (system.isInitialized && system.jobs.Value().TryPop(job))
+        {
+            system.RunInline(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// ジョブを実行しているファイバー内かを返します。
+Bool LeyEngine::IsInJob() noexcept
+{
+    Var pWorker = CurrentWorker();
+    return pWorker != NONE && pWorker->pCurrent != NONE;
+}
+
+// ジョブを実行するワーカースレッドの数を返します。
+USize LeyEngine::JobWorkerCount() noexcept
+{
+    return GetJobSystem().workerCount;
+}
+
+#else
+
+Result<Success, EJobError> (*g_runJobs)(const JobDeclaration*, USize, JobCounter*);
+Result<Success, EJobError> (*g_runJobsNextFrame)(const JobDeclaration*, USize, JobCounter*);
+USize (*g_advanceJobFrame)();
+Void (*g_waitForCounter)(JobCounter&);
+Bool (*g_isInJob)();
+USize (*g_jobWorkerCount)();
+Result<Success, EJobError> GlobalRunJobs(const JobDeclaration *pJobs, USize count, JobCounter*) noexcept
+{
+    // コアモジュールと接続するまでは呼び出したスレッドで順に実行します
+    if (pJobs == NONE && count != 0) return EJobError::INVALID_ARGUMENT;
+    for (USize i = 0; i < count; i++)
+    {
+        pJobs[i].function(pJobs[i].pData);
+    }
+    return SUCCESS;
+}
+Result<Success, EJobError> GlobalRunJobsNextFrame(const JobDeclaration*, USize, JobCounter*) noexcept
+{
+    return EJobError::NOT_INITIALIZED;
+}
+USize GlobalAdvanceJobFrame() noexcept
+{
+    return 0;
+}
+Void GlobalWaitForCounter(JobCounter &counter) noexcept
+{
+    while (counter.Value() != 0)
+    {
+        std::this_thread::yield();
+    }
+}
+Bool GlobalIsInJob() noexcept
+{
+    return NO;
+}
+USize GlobalJobWorkerCount() noexcept
+{
+    return 0;
+}
+std::once_flag g_initJobSystemOnceFlag;
+Void InitJobSystem()
+{
+    g_runJobs = &GlobalRunJobs;
+    g_runJobsNextFrame = &GlobalRunJobsNextFrame;
+    g_advanceJobFrame = &GlobalAdvanceJobFrame;
+    g_waitForCounter = &GlobalWaitForCounter;
+    g_isInJob = &GlobalIsInJob;
+    g_jobWorkerCount = &GlobalJobWorkerCount;
+}
+EXPORT Void SetJobSystem(Void *runJobs, Void *runJobsNextFrame, Void *advanceJobFrame, Void *waitForCounter, Void *isInJob, Void *jobWorkerCount)
+{
+    std::call_once(g_initJobSystemOnceFlag, InitJobSystem);
+    g_runJobs = (Result<Success, EJobError> (*)(const JobDeclaration*, USize, JobCounter*))runJobs;
+    g_runJobsNextFrame = (Result<Success, EJobError> (*)(const JobDeclaration*, USize, JobCounter*))runJobsNextFrame;
+    g_advanceJobFrame = (USize (*)())advanceJobFrame;
+    g_waitForCounter = (Void (*)(JobCounter&))waitForCounter;
+    g_isInJob = (Bool (*)())isInJob;
+    g_jobWorkerCount = (USize (*)())jobWorkerCount;
+}
+
+// ジョブを実行します。
+Result<Success, EJobError> LeyEngine::RunJobs(const JobDeclaration *pJobs, USize count, JobCounter *pCounter) noexcept
+{
+    std::call_once(g_initJobSystemOnceFlag, InitJobSystem);
+    return g_runJobs(pJobs, count, pCounter);
+}
+
+// ジョブを次のフレームで実行します。
+Result<Success, EJobError> LeyEngine::RunJobsNextFrame(const JobDeclaration *pJobs, USize count, JobCounter *pCounter) noexcept
+{
+    std::call_once(g_initJobSystemOnceFlag, InitJobSystem);
+    return g_runJobsNextFrame(pJobs, count, pCounter);
+}
+
+// フレームを進め、RunJobsNextFrameで予約したジョブの実行を開始します。
+USize LeyEngine::AdvanceJobFrame() noexcept
+{
+    std::call_once(g_initJobSystemOnceFlag, InitJobSystem);
+    return g_advanceJobFrame();
+}
+
+// カウンタが0になるまで待機します。
+Void LeyEngine::WaitForCounter(JobCounter &counter) noexcept
+{
+    std::call_once(g_initJobSystemOnceFlag, InitJobSystem);
+    g_waitForCounter(counter);
+}
+
+// ジョブを実行しているファイバー内かを返します。
+Bool LeyEngine::IsInJob() noexcept
+{
+    std::call_once(g_initJobSystemOnceFlag, InitJobSystem);
+    return g_isInJob();
+}
+
+// ジョブを実行するワーカースレッドの数を返します。
+USize LeyEngine::JobWorkerCount() noexcept
+{
+    std::call_once(g_initJobSystemOnceFlag, InitJobSystem);
+    return g_jobWorkerCount();
+}
+
+#endif
\ No newline at end of file
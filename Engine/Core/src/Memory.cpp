@@ -2,9 +2,21 @@
 // (C) 2022 LeyCommunity.
 // author Taichi Ito.
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <mutex>
 #ifdef LEYENGINE_CORE_MODULE
+#include <algorithm>
+#include <atomic>
 #include <new>
+#include <thread>
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #endif
 #include "LeyEngine/Memory.hpp"
 
@@ -13,35 +25,357 @@ using namespace LeyEngine;
 #ifdef LEYENGINE_CORE_MODULE
 
 // --------------------
-// 
+//
+// 設定
+//
+// ====================
+
+// 最小のサイズクラスの要素サイズ
+constexpr USize MIN_ELEMENT_SIZE = 8;
+// 最大のサイズクラスの要素サイズ、これより大きいメモリはプールを経由せず確保します
+constexpr USize MAX_ELEMENT_SIZE = MIN_ELEMENT_SIZE << (MEMORY_SIZE_CLASS_COUNT - 1);
+// 最初に作成するプールのバッファサイズ
+constexpr USize FIRST_POOL_BUFFER_SIZE = 64 * 1024;
+// プールのバッファサイズの最大値
+constexpr USize MAX_POOL_BUFFER_SIZE = 4 * 1024 * 1024;
+
+#ifdef LEYENGINE_MEMORY_GUARD
+// 要素の前後に置くガード領域のサイズ
+constexpr USize GUARD_SIZE = 16;
+// 確保した直後の要素を埋める値
+constexpr U8 ALLOCATED_PATTERN = 0xCD;
+// 解放した要素を埋める値
+constexpr U8 FREED_PATTERN = 0xDD;
+// ガード領域を埋める値
+constexpr U8 CANARY_PATTERN = 0xFD;
+#else
+// 要素の前後に置くガード領域のサイズ
+constexpr USize GUARD_SIZE = 0;
+#endif
+
+// --------------------
+//
+// 統計
+//
+// ====================
+
+std::atomic<USize> g_allocateCount(0);          // 確保に成功した回数
+std::atomic<USize> g_deallocateCount(0);        // 解放に成功した回数
+std::atomic<USize> g_usedSize(0);               // 使用中のバイトサイズ
+std::atomic<USize> g_peakUsedSize(0);           // 使用中のバイトサイズの最大値
+std::atomic<USize> g_largeUsedSize(0);          // プールを経由しない使用中のバイトサイズ
+std::atomic<USize> g_invalidDeallocateCount(0); // 不正なポインタの解放回数
+std::atomic<USize> g_doubleDeallocateCount(0);  // 二重解放の回数
+std::atomic<USize> g_corruptionCount(0);        // 範囲外への書き込みの検出回数
+std::atomic<USize> g_useAfterFreeCount(0);      // 解放済みメモリへの書き込みの検出回数
+
+// 確保を記録します
+Void RecordAllocate(USize size) noexcept
+{
+    g_allocateCount.fetch_add(1, std::memory_order_relaxed);
+    Var used = g_usedSize.fetch_add(size, std::memory_order_relaxed) + size;
+    Var peak = g_peakUsedSize.load(std::memory_order_relaxed);
+    while (peak < used && !g_peakUsedSize.compare_exchange_weak(peak, used, std::memory_order_relaxed));
+}
+
+// 解放を記録します
+Void RecordDeallocate(USize size) noexcept
+{
+    g_deallocateCount.fetch_add(1, std::memory_order_relaxed);
+    g_usedSize.fetch_sub(size, std::memory_order_relaxed);
+}
+
+// --------------------
+//
+// 追跡
+//
+// ====================
+
+std::atomic<U64> g_memoryFrame(0);  // 以降に確保するメモリに記録するフレーム番号
+thread_local MemoryTag t_memoryTag = {}; // 現在のスレッドのタグ
+
+std::mutex g_tagNamesMutex;         // タグの名前の排他制御
+MemoryTagName *g_pTagNames = NONE;  // タグの名前の配列
+USize g_tagNameCount = 0;           // タグの名前の数
+USize g_tagNameCapacity = 0;        // タグの名前の配列の長さ
+Char *g_pTagNameText = NONE;        // 名前の領域
+USize g_tagNameTextSize = 0;        // 名前の領域の使用中のバイトサイズ
+USize g_tagNameTextCapacity = 0;    // 名前の領域のバイトサイズ
+
+#ifdef LEYENGINE_MEMORY_TRACKING
+// 確保したブロックの記録、sizeが0の場合は未使用です
+struct BlockRecord
+{
+    U64 serial;     // 確保した順の通し番号
+    U64 frame;      // 確保したフレーム番号
+    U64 size;       // 確保を要求したバイトサイズ
+    MemoryTag tag;  // 確保元のタグ
+};
+
+std::atomic<U64> g_allocationSerial(0); // 確保した順の通し番号
+
+// 現在のスレッドで確保するブロックの記録を作成します
+BlockRecord MakeBlockRecord(USize size) noexcept
+{
+    return BlockRecord
+    {
+        g_allocationSerial.fetch_add(1, std::memory_order_relaxed),
+        g_memoryFrame.load(std::memory_order_relaxed),
+        size,
+        t_memoryTag,
+    };
+}
+
+// スナップショットに記録するブロックを集めます
+// 集めている間はプールをロックしているため、標準メモリではなくmallocで確保します
+class BlockCollector
+{
+    MemoryBlockInfo *m_pBlocks; // ブロック
+    USize m_count;              // ブロック数
+    USize m_capacity;           // 配列の長さ
+    Bool m_isFailed;            // 確保に失敗したか
+
+public:
+
+    // コンストラクタ
+    BlockCollector() noexcept
+        : m_pBlocks(NONE)
+        , m_count(0)
+        , m_capacity(0)
+        , m_isFailed(NO)
+    {}
+
+    BlockCollector(const BlockCollector&) = delete;
+    BlockCollector &operator=(const BlockCollector&) = delete;
+
+    // デストラクタ
+    ~BlockCollector() noexcept
+    {
+        std::free(this->m_pBlocks);
+    }
+
+    // ブロックを追加します。
+    Void Add(USize address, USize sizeClass, const BlockRecord &record) noexcept
+    {
+        if (this->m_count == this->m_capacity)
+        {
+            Var capacity = this->m_capacity == 0 ? 1024 : this->m_capacity * 2;
+            Var blocks = Cast<MemoryBlockInfo*>(std::realloc(this->m_pBlocks, sizeof(MemoryBlockInfo) * capacity));
+            if (blocks == NONE)
+            {
+                this->m_isFailed = YES;
+                return;
+            }
+            this->m_pBlocks = blocks;
+            this->m_capacity = capacity;
+        }
+        this->m_pBlocks[this->m_count] = MemoryBlockInfo
+        {
+            address,
+            record.serial,
+            record.frame,
+            record.size,
+            static_cast<U32>(sizeClass),
+            record.tag.module,
+            record.tag.callsite,
+            0,
+        };
+        this->m_count += 1;
+    }
+
+    // ブロックを返します。
+    MemoryBlockInfo *Blocks() noexcept
+    {
+        return this->m_pBlocks;
+    }
+
+    // ブロック数を返します。
+    USize Count() const noexcept
+    {
+        return this->m_count;
+    }
+
+    // 確保に失敗したか判定します。
+    Bool IsFailed() const noexcept
+    {
+        return this->m_isFailed;
+    }
+};
+
+// プールを経由しないブロックの前に置くヘッダー
+struct alignas(16) LargeBlockHeader
+{
+    LargeBlockHeader *pPrevious;    // 前のブロック
+    LargeBlockHeader *pNext;        // 次のブロック
+    BlockRecord record;             // 記録
+};
+
+std::mutex g_largeBlocksMutex;              // プールを経由しないブロックの排他制御
+LargeBlockHeader *g_pLargeBlocks = NONE;    // プールを経由しないブロックのリストの先頭
+#endif
+
+// --------------------
+//
+// NUMA
+//
+// ====================
+
+// NUMAノード数を求めます
+USize DetectNumaNodeCount() noexcept
+{
+#if defined(__linux__)
+    // 有効なノードが "0-1" や "0,2-3" の形式で列挙されています
+    Var file = std::fopen("/sys/devices/system/node/online", "r");
+    if (file == NONE) return 1;
+    char text[256] = {};
+    Var length = std::fread(text, 1, sizeof(text) - 1, file);
+    std::fclose(file);
+
+    USize maxNode = 0;
+    USize value = 0;
+    for (USize i = 0; i < length; i++)
+    {
+        if ('0' <= text[i] && text[i] <= '9')
+        {
+            value = value * 10 + static_cast<USize>(text[i] - '0');
+        }
+        else
+        {
+            if (maxNode < value) maxNode = value;
+            value = 0;
+        }
+    }
+    if (maxNode < value) maxNode = value;
+    return maxNode + 1 < MEMORY_NUMA_NODE_CAPACITY ? maxNode + 1 : MEMORY_NUMA_NODE_CAPACITY;
+#else
+    return 1;
+#endif
+}
+
+// NUMAノード数を返します
+USize NumaNodeCount() noexcept
+{
+    static const USize s_count = DetectNumaNodeCount();
+    return s_count;
+}
+
+// 現在のスレッドが動作しているNUMAノードを返します
+// スレッド毎に最初に呼び出した時点のノードを使用し続けます
+USize CurrentNumaNode() noexcept
+{
+    if (NumaNodeCount() == 1) return 0;
+#if defined(__linux__)
+    thread_local USize t_node = USIZE_MAX;
+    if (t_node == USIZE_MAX)
+    {
+        unsigned int cpu = 0;
+        unsigned int node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, NONE) == 0 && node < NumaNodeCount()) t_node = node;
+        else                                                                      t_node = 0;
+    }
+    return t_node;
+#else
+    return 0;
+#endif
+}
+
+// プールのバッファを確保します
+// Linuxではmmapで確保し、NUMAノードが複数ある場合は物理ページの割り当て前に指定ノードを優先させます
+// isPopulatedがYESの場合は確保と同時に物理ページを割り当てます
+// NUMAノードが複数ある場合はノードの指定が割り当てに間に合わないため、プールの構築時の書き込みで割り当てます
+U8 *AllocateSlab(USize size, USize node, Bool isPopulated) noexcept
+{
+#if defined(__linux__)
+    Var flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if (isPopulated && NumaNodeCount() == 1) flags |= MAP_POPULATE;
+    Var ptr = mmap(NONE, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (ptr == MAP_FAILED) return NONE;
+    if (NumaNodeCount() > 1)
+    {
+        unsigned long mask = 1UL << node;
+        (Void)syscall(SYS_mbind, ptr, size, MPOL_PREFERRED, &mask, sizeof(mask) * 8, 0);
+    }
+    return Cast<U8*>(ptr);
+#else
+    (Void)node;
+    (Void)isPopulated;
+    return Cast<U8*>(std::malloc(size));
+#endif
+}
+
+// プールのバッファを解放します
+Void FreeSlab(U8 *pointer, USize size) noexcept
+{
+#if defined(__linux__)
+    munmap(pointer, size);
+#else
+    (Void)size;
+    std::free(pointer);
+#endif
+}
+
+#ifdef LEYENGINE_MEMORY_GUARD
+// メモリが指定の値で埋められているか判定します
+Bool IsFilled(const U8 *pointer, USize size, U8 pattern) noexcept
+{
+    for (USize i = 0; i < size; i++)
+    {
+        if (pointer[i] != pattern) return NO;
+    }
+    return YES;
+}
+#endif
+
+// --------------------
+//
 // メモリプール
-// 
+//
 // ====================
 
 template<USize SIZE>
 class MemoryPool
 {
+public:
+
+    // 要素1つあたりのバイトサイズ、ガード領域を含みます
+    static constexpr USize STRIDE = SIZE + GUARD_SIZE * 2;
+
+private:
+
     USize m_elementsCount;     // プールが管理するすべての要素数
     U8 *m_pBuffer;             // バッファ
     USize m_bufferRangeMin;    // バッファの最小アドレス
     USize m_bufferRangeMax;    // バッファの最大アドレス
     USize m_freeElementsCount; // 使用可能な要素数
-    U8 **m_ppListTop;
+    U8 **m_ppListTop;          // 使用可能な要素のリストの先頭
+#ifdef LEYENGINE_MEMORY_GUARD
+    U64 *m_pAllocatedBits;     // 使用中の要素のビットマップ
+#endif
+#ifdef LEYENGINE_MEMORY_TRACKING
+    BlockRecord *m_pRecords;   // 要素毎の記録
+#endif
 
     // コンストラクタ
     // 引数 count 要素数
-    // 引数 buffer SIZE * count 分のバッファ
+    // 引数 buffer STRIDE * count 分のバッファ
     MemoryPool(USize count, U8* buffer) noexcept
         : m_elementsCount(count)
         , m_pBuffer(buffer)
-        , m_freeElementsCount(this->m_elementsCount)
+        , m_freeElementsCount(count)
         , m_ppListTop(NONE)
     {
         // バッファの最小、最大アドレスを設定します
-        Var top = Cast<USize>(&this->m_buffer[0]);
-        Var end = Cast<USize>(&this->m_buffer[(SIZE * this->m_elementsCount)]);
-        this->m_bufferRangeMin = top < end ? top : end;
-        this->m_bufferRangeMax = top > end ? top : end;
+        this->m_bufferRangeMin = Cast<USize>(&this->m_pBuffer[0]);
+        this->m_bufferRangeMax = Cast<USize>(&this->m_pBuffer[STRIDE * this->m_elementsCount]);
+
+#ifdef LEYENGINE_MEMORY_GUARD
+        // ガード領域と解放済みの値で埋めます
+        std::memset(this->m_pBuffer, CANARY_PATTERN, STRIDE * this->m_elementsCount);
+        for (USize i = 0; i < this->m_elementsCount; i++)
+        {
+            std::memset(&this->m_pBuffer[STRIDE * i + GUARD_SIZE], FREED_PATTERN, SIZE);
+        }
+#endif
 
         // 要素のリストを作成します
         //
@@ -49,61 +383,186 @@ class MemoryPool
         //            |  ^  |  ^  |  ^
         //    NONE <--'  '--'  '--'  '-- m_ppListTop
         //
-        auto step = SIZE;
-        auto length = step * this->m_elementsCount;
-        for (USize i = 0; i < length; i += step)
+        for (USize i = 0; i < this->m_elementsCount; i++)
         {
-            Var ptr = Cast<U8**>(&this->m_pBuffer[i]);
+            Var ptr = Cast<U8**>(&this->m_pBuffer[STRIDE * i + GUARD_SIZE]);
             *ptr = Cast<U8*>(this->m_ppListTop);
-            this->m_freeElementListTop = ptr;
+            this->m_ppListTop = ptr;
         }
     }
 
 public:
 
     // 生成します。
-    static Result<MemoryPool<SIZE>*, EAllocateError> New(USize count) noexcept
+    // 引数 count 要素数
+    // 引数 node バッファを配置するNUMAノード
+    // 引数 isPopulated バッファの物理ページを確保時に割り当てるか
+    static Result<MemoryPool<SIZE>*, EAllocateError> New(USize count, USize node, Bool isPopulated) noexcept
     {
         Var ptr = std::malloc(sizeof(MemoryPool<SIZE>));
         if (ptr == NONE) return EAllocateError::BAD_ALLOCATE;
 
-        Var buffer = Cast<U8*>(std::malloc(SIZE * count));
-        if (buffer == NONE) return EAllocateError::BAD_ALLOCATE;
+        Var buffer = AllocateSlab(STRIDE * count, node, isPopulated);
+        if (buffer == NONE)
+        {
+            std::free(ptr);
+            return EAllocateError::BAD_ALLOCATE;
+        }
+
+#ifdef LEYENGINE_MEMORY_GUARD
+        Var bits = Cast<U64*>(std::calloc((count + 63) / 64, sizeof(U64)));
+        if (bits == NONE)
+        {
+            FreeSlab(buffer, STRIDE * count);
+            std::free(ptr);
+            return EAllocateError::BAD_ALLOCATE;
+        }
+#endif
+#ifdef LEYENGINE_MEMORY_TRACKING
+        Var records = Cast<BlockRecord*>(std::calloc(count, sizeof(BlockRecord)));
+        if (records == NONE)
+        {
+#ifdef LEYENGINE_MEMORY_GUARD
+            std::free(bits);
+#endif
+            FreeSlab(buffer, STRIDE * count);
+            std::free(ptr);
+            return EAllocateError::BAD_ALLOCATE;
+        }
+#endif
 
-        return new(ptr) MemoryPool<SIZE>(count, buffer);
+        Var pool = new(ptr) MemoryPool<SIZE>(count, buffer);
+#ifdef LEYENGINE_MEMORY_GUARD
+        pool->m_pAllocatedBits = bits;
+#endif
+#ifdef LEYENGINE_MEMORY_TRACKING
+        pool->m_pRecords = records;
+#endif
+        return pool;
     }
 
     // 削除します。
     static Void Delete(MemoryPool<SIZE> *pool) noexcept
     {
-        std::free(pool->m_pBuffer);
+#ifdef LEYENGINE_MEMORY_GUARD
+        std::free(pool->m_pAllocatedBits);
+#endif
+#ifdef LEYENGINE_MEMORY_TRACKING
+        std::free(pool->m_pRecords);
+#endif
+        FreeSlab(pool->m_pBuffer, STRIDE * pool->m_elementsCount);
         std::free(pool);
     }
 
     // 要素を取得します。
-    Void *Allocate() noexcept
+    // 引数 size 要素のうち使用するバイトサイズ
+    Void *Allocate(USize size) noexcept
     {
         Var ptr = this->m_ppListTop;
         this->m_freeElementsCount -= 1;
         this->m_ppListTop = Cast<U8**>(*ptr);
+
+#ifdef LEYENGINE_MEMORY_GUARD
+        // リストのポインタ以外が解放時の値のままか検査します
+        Var bytes = Cast<U8*>(ptr);
+        if (!IsFilled(bytes + sizeof(U8*), SIZE - sizeof(U8*), FREED_PATTERN))
+        {
+            g_useAfterFreeCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::memset(bytes, ALLOCATED_PATTERN, SIZE);
+
+        Var index = (Cast<USize>(ptr) - this->m_bufferRangeMin) / STRIDE;
+        this->m_pAllocatedBits[index / 64] |= U64(1) << (index % 64);
+#endif
+#ifdef LEYENGINE_MEMORY_TRACKING
+        this->m_pRecords[(Cast<USize>(ptr) - this->m_bufferRangeMin) / STRIDE] = MakeBlockRecord(size);
+#else
+        (Void)size;
+#endif
+
         return Cast<Void*>(ptr);
     }
 
     // 要素を戻します。
-    Bool Deallocate(Void *pointer) noexcept
+    // 引数 size 要素のうち使用していたバイトサイズ
+    Result<Success, EDeallocateError> Deallocate(USize size, Void *pointer) noexcept
     {
         Var ptr = Cast<U8**>(pointer);
-        Var adr = Cast<USize>(pointer);
-        if (this->m_bufferRangeMin <= adr && adr < this->m_bufferRangeMax)
+
+#ifdef LEYENGINE_MEMORY_GUARD
+        // 要素の先頭を指しているか検査します
+        Var offset = Cast<USize>(pointer) - this->m_bufferRangeMin;
+        if (offset % STRIDE != GUARD_SIZE)
         {
-            this->m_freeElementsCount += 1;
-            *ptr = Cast<U8*>(this->m_ppListTop);
-            this->m_ppListTop = ptr;
+            g_invalidDeallocateCount.fetch_add(1, std::memory_order_relaxed);
+            return EDeallocateError::INVALID_POINTER;
         }
-        else
+
+        // 使用中か検査します
+        Var index = offset / STRIDE;
+        Var &bits = this->m_pAllocatedBits[index / 64];
+        Var mask = U64(1) << (index % 64);
+        if ((bits & mask) == 0)
         {
-            return NO;
+            g_doubleDeallocateCount.fetch_add(1, std::memory_order_relaxed);
+            return EDeallocateError::DOUBLE_DEALLOCATE;
         }
+        bits &= ~mask;
+
+        // ガード領域と未使用部分が書き換えられていないか検査します
+        Var bytes = Cast<U8*>(pointer);
+        Var isCorrupted =
+            !IsFilled(bytes - GUARD_SIZE, GUARD_SIZE, CANARY_PATTERN) ||
+            !IsFilled(bytes + SIZE, GUARD_SIZE, CANARY_PATTERN) ||
+            !IsFilled(bytes + size, SIZE - size, ALLOCATED_PATTERN);
+        if (isCorrupted)
+        {
+            g_corruptionCount.fetch_add(1, std::memory_order_relaxed);
+            std::memset(bytes - GUARD_SIZE, CANARY_PATTERN, GUARD_SIZE);
+            std::memset(bytes + SIZE, CANARY_PATTERN, GUARD_SIZE);
+        }
+        std::memset(bytes, FREED_PATTERN, SIZE);
+#else
+        (Void)size;
+#endif
+#ifdef LEYENGINE_MEMORY_TRACKING
+        this->m_pRecords[(Cast<USize>(pointer) - this->m_bufferRangeMin) / STRIDE].size = 0;
+#endif
+
+        this->m_freeElementsCount += 1;
+        *ptr = Cast<U8*>(this->m_ppListTop);
+        this->m_ppListTop = ptr;
+
+#ifdef LEYENGINE_MEMORY_GUARD
+        if (isCorrupted) return EDeallocateError::CORRUPTED;
+#endif
+        return SUCCESS;
+    }
+
+    // ポインタがバッファの範囲内か判定します。
+    Bool Contains(Void *pointer) const noexcept
+    {
+        Var adr = Cast<USize>(pointer);
+        return this->m_bufferRangeMin <= adr && adr < this->m_bufferRangeMax;
+    }
+
+#ifdef LEYENGINE_MEMORY_TRACKING
+    // 使用中の要素を集めます。
+    // 引数 sizeClass サイズクラスの位置
+    Void CollectBlocks(BlockCollector &collector, USize sizeClass) const noexcept
+    {
+        for (USize i = 0; i < this->m_elementsCount; i++)
+        {
+            const Var &record = this->m_pRecords[i];
+            if (record.size != 0) collector.Add(this->m_bufferRangeMin + STRIDE * i + GUARD_SIZE, sizeClass, record);
+        }
+    }
+#endif
+
+    // 管理する要素数を返します。
+    USize Count() const noexcept
+    {
+        return this->m_elementsCount;
     }
 
     // 使用可能な要素が無いか判定します。
@@ -113,7 +572,7 @@ public:
     }
 
     // すべての要素が使用されていないか判定します。
-    Bool IsFull() const noexcept 
+    Bool IsFull() const noexcept
     {
         return this->m_freeElementsCount == this->m_elementsCount;
     }
@@ -128,25 +587,604 @@ public:
 template<USize SIZE>
 class MemoryPoolManager
 {
-    USize m_poolCount;                  // プールの
-    MemoryPool **m_ppMemoryPools;
-    USize m_allocatableMemoryPoolIndex;
+    std::mutex m_mutex;                   // 排他制御
+    USize m_node;                         // プールを配置するNUMAノード
+    USize m_poolCount;                    // プールの数
+    USize m_poolCapacity;                 // プール配列の長さ
+    MemoryPool<SIZE> **m_ppMemoryPools;   // プール配列
+    USize m_allocatableMemoryPoolIndex;   // 最後に確保できたプールの位置
+    USize m_elementsCount;                // すべてのプールが管理する要素数
+    USize m_usedCount;                    // 使用中の要素数
+    USize m_peakUsedCount;                // 使用中の要素数の最大値
+
+    // 作成したプールを登録します
+    // 登録できなかった場合はプールを削除します
+    Result<MemoryPool<SIZE>*, EAllocateError> InsertPool(MemoryPool<SIZE> *pool) noexcept
+    {
+        if (this->m_poolCount == this->m_poolCapacity)
+        {
+            Var capacity = this->m_poolCapacity == 0 ? 8 : this->m_poolCapacity * 2;
+            Var pools = Cast<MemoryPool<SIZE>**>(std::realloc(this->m_ppMemoryPools, sizeof(MemoryPool<SIZE>*) * capacity));
+            if (pools == NONE)
+            {
+                MemoryPool<SIZE>::Delete(pool);
+                return EAllocateError::BAD_ALLOCATE;
+            }
+            this->m_ppMemoryPools = pools;
+            this->m_poolCapacity = capacity;
+        }
+
+        this->m_ppMemoryPools[this->m_poolCount] = pool;
+        this->m_allocatableMemoryPoolIndex = this->m_poolCount;
+        this->m_poolCount += 1;
+        this->m_elementsCount += pool->Count();
+        return pool;
+    }
+
+    // プールを追加します
+    Result<MemoryPool<SIZE>*, EAllocateError> AddPool() noexcept
+    {
+        // プールを追加する毎にバッファサイズを倍にします
+        Var bufferSize = FIRST_POOL_BUFFER_SIZE;
+        for (USize i = 0; i < this->m_poolCount && bufferSize < MAX_POOL_BUFFER_SIZE; i++) bufferSize *= 2;
+        Var count = bufferSize / MemoryPool<SIZE>::STRIDE;
+
+        Var res = MemoryPool<SIZE>::New(count, this->m_node, NO);
+        if (res.IsFailure()) return res;
+        return this->InsertPool(res.Value());
+    }
+
+public:
+
+    // コンストラクタ
+    // 引数 node プールを配置するNUMAノード
+    MemoryPoolManager(USize node) noexcept
+        : m_node(node)
+        , m_poolCount(0)
+        , m_poolCapacity(0)
+        , m_ppMemoryPools(NONE)
+        , m_allocatableMemoryPoolIndex(0)
+        , m_elementsCount(0)
+        , m_usedCount(0)
+        , m_peakUsedCount(0)
+    {}
+
+    // 要素を確保します。
+    // 引数 size 要素のうち使用するバイトサイズ
+    Result<Void*, EAllocateError> Allocate(USize size) noexcept
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+
+        MemoryPool<SIZE> *pool = NONE;
+        if (this->m_poolCount > 0 && !this->m_ppMemoryPools[this->m_allocatableMemoryPoolIndex]->IsEmpty())
+        {
+            pool = this->m_ppMemoryPools[this->m_allocatableMemoryPoolIndex];
+        }
+        else
+        {
+            for (USize i = 0; i < this->m_poolCount; i++)
+            {
+                if (!this->m_ppMemoryPools[i]->IsEmpty())
+                {
+                    pool = this->m_ppMemoryPools[i];
+                    this->m_allocatableMemoryPoolIndex = i;
+                    break;
+                }
+            }
+            if (pool == NONE)
+            {
+                Var res = this->AddPool();
+                if (res.IsFailure()) return res.Error();
+                pool = res.Value();
+            }
+        }
+
+        this->m_usedCount += 1;
+        if (this->m_peakUsedCount < this->m_usedCount) this->m_peakUsedCount = this->m_usedCount;
+        return pool->Allocate(size);
+    }
+
+    // 要素を解放します。
+    Result<Success, EDeallocateError> Deallocate(USize size, Void *pointer) noexcept
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+
+        for (USize i = 0; i < this->m_poolCount; i++)
+        {
+            Var pool = this->m_ppMemoryPools[i];
+            if (pool->Contains(pointer))
+            {
+                Var res = pool->Deallocate(size, pointer);
+                if (res.IsSuccess() || res.Error() == EDeallocateError::CORRUPTED)
+                {
+                    this->m_usedCount -= 1;
+                    this->m_allocatableMemoryPoolIndex = i;
+                }
+                return res;
+            }
+        }
+        return EDeallocateError::BAD_DEALLOCATE;
+    }
+
+    // 要素数が指定数に満たない場合、足りない分のプールを物理ページを割り当てて追加します。
+    // プールの作成はページの割り当てとリストの作成に時間がかかるため、ロックの外で行います。
+    // 引数 count 要素数
+    Result<Success, EAllocateError> Warm(USize count) noexcept
+    {
+        USize shortage = 0;
+        {
+            std::lock_guard<std::mutex> lock(this->m_mutex);
+            if (count <= this->m_elementsCount) return SUCCESS;
+            shortage = count - this->m_elementsCount;
+        }
+
+        // 最初のプールのバッファサイズの倍数に切り上げます
+        Var bufferSize = AlignUp(MemoryPool<SIZE>::STRIDE * shortage, FIRST_POOL_BUFFER_SIZE);
+        Var res = MemoryPool<SIZE>::New(bufferSize / MemoryPool<SIZE>::STRIDE, this->m_node, YES);
+        if (res.IsFailure()) return res.Error();
+
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        Var insertRes = this->InsertPool(res.Value());
+        if (insertRes.IsFailure()) return insertRes.Error();
+        return SUCCESS;
+    }
+
+    // 統計情報を加算します。
+    Void AddStats(MemorySizeClassStats &stats) noexcept
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        stats.elementSize = SIZE;
+        stats.poolCount += this->m_poolCount;
+        stats.elementsCount += this->m_elementsCount;
+        stats.usedCount += this->m_usedCount;
+        stats.peakUsedCount += this->m_peakUsedCount;
+        stats.nodePeakUsedCounts[this->m_node] = this->m_peakUsedCount;
+    }
+
+#ifdef LEYENGINE_MEMORY_TRACKING
+    // 使用中の要素を集めます。
+    // 引数 sizeClass サイズクラスの位置
+    Void CollectBlocks(BlockCollector &collector, USize sizeClass) noexcept
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        for (USize i = 0; i < this->m_poolCount; i++)
+        {
+            this->m_ppMemoryPools[i]->CollectBlocks(collector, sizeClass);
+        }
+    }
+#endif
+};
+
+// 指定位置のサイズクラスの、指定NUMAノードのマネージャを返します
+// マネージャは終了時に破棄されるメモリからの解放に備え、破棄しません
+template<USize INDEX>
+MemoryPoolManager<(MIN_ELEMENT_SIZE << INDEX)> &PoolManagerAt(USize node) noexcept
+{
+    using TManager = MemoryPoolManager<(MIN_ELEMENT_SIZE << INDEX)>;
+    alignas(TManager) static U8 s_storage[sizeof(TManager) * MEMORY_NUMA_NODE_CAPACITY];
+    static TManager *s_pManagers = []() noexcept
+    {
+        Var pManagers = Cast<TManager*>(&s_storage[0]);
+        for (USize i = 0; i < NumaNodeCount(); i++) new(&pManagers[i]) TManager(i);
+        return pManagers;
+    }();
+    return s_pManagers[node];
+}
+
+// 指定位置のサイズクラスから、現在のスレッドのNUMAノードのプールで確保します
+template<USize INDEX>
+Result<Void*, EAllocateError> PoolAllocate(USize size) noexcept
+{
+    return PoolManagerAt<INDEX>(CurrentNumaNode()).Allocate(size);
+}
+
+// 指定位置のサイズクラスへ解放します
+// 他のスレッドが確保したメモリに備え、現在のノードから順にすべてのノードを探します
+template<USize INDEX>
+Result<Success, EDeallocateError> PoolDeallocate(USize size, Void *pointer) noexcept
+{
+    Var node = CurrentNumaNode();
+    Var count = NumaNodeCount();
+    for (USize i = 0; i < count; i++)
+    {
+        Var res = PoolManagerAt<INDEX>((node + i) % count).Deallocate(size, pointer);
+        if (res.IsSuccess() || res.Error() != EDeallocateError::BAD_DEALLOCATE) return res;
+    }
+#ifdef LEYENGINE_MEMORY_GUARD
+    g_invalidDeallocateCount.fetch_add(1, std::memory_order_relaxed);
+#endif
+    return EDeallocateError::BAD_DEALLOCATE;
+}
+
+// 指定位置のサイズクラスの、すべてのNUMAノードの統計情報を取得します
+template<USize INDEX>
+Void PoolStats(MemorySizeClassStats &stats) noexcept
+{
+    for (USize i = 0; i < NumaNodeCount(); i++)
+    {
+        PoolManagerAt<INDEX>(i).AddStats(stats);
+    }
+}
+
+// 指定位置のサイズクラスの、指定NUMAノードのプールを事前に作成します
+template<USize INDEX>
+Result<Success, EAllocateError> PoolWarm(USize count, USize node) noexcept
+{
+    return PoolManagerAt<INDEX>(node).Warm(count);
+}
+
+#ifdef LEYENGINE_MEMORY_TRACKING
+// 指定位置のサイズクラスの、すべてのNUMAノードの使用中の要素を集めます
+template<USize INDEX>
+Void PoolCollectBlocks(BlockCollector &collector) noexcept
+{
+    for (USize i = 0; i < NumaNodeCount(); i++)
+    {
+        PoolManagerAt<INDEX>(i).CollectBlocks(collector, INDEX);
+    }
+}
+#endif
+
+// サイズクラス毎の確保関数です
+Result<Void*, EAllocateError> (*const POOL_ALLOCATE_TABLE[MEMORY_SIZE_CLASS_COUNT])(USize) =
+{
+    &PoolAllocate<0>, &PoolAllocate<1>, &PoolAllocate<2>, &PoolAllocate<3>, &PoolAllocate<4>,
+    &PoolAllocate<5>, &PoolAllocate<6>, &PoolAllocate<7>, &PoolAllocate<8>,
+};
+
+// サイズクラス毎の解放関数です
+Result<Success, EDeallocateError> (*const POOL_DEALLOCATE_TABLE[MEMORY_SIZE_CLASS_COUNT])(USize, Void*) =
+{
+    &PoolDeallocate<0>, &PoolDeallocate<1>, &PoolDeallocate<2>, &PoolDeallocate<3>, &PoolDeallocate<4>,
+    &PoolDeallocate<5>, &PoolDeallocate<6>, &PoolDeallocate<7>, &PoolDeallocate<8>,
+};
+
+// サイズクラス毎の統計情報取得関数です
+Void (*const POOL_STATS_TABLE[MEMORY_SIZE_CLASS_COUNT])(MemorySizeClassStats&) =
+{
+    &PoolStats<0>, &PoolStats<1>, &PoolStats<2>, &PoolStats<3>, &PoolStats<4>,
+    &PoolStats<5>, &PoolStats<6>, &PoolStats<7>, &PoolStats<8>,
+};
+
+// サイズクラス毎の事前作成関数です
+Result<Success, EAllocateError> (*const POOL_WARM_TABLE[MEMORY_SIZE_CLASS_COUNT])(USize, USize) =
+{
+    &PoolWarm<0>, &PoolWarm<1>, &PoolWarm<2>, &PoolWarm<3>, &PoolWarm<4>,
+    &PoolWarm<5>, &PoolWarm<6>, &PoolWarm<7>, &PoolWarm<8>,
+};
+
+#ifdef LEYENGINE_MEMORY_TRACKING
+// サイズクラス毎の使用中の要素の収集関数です
+Void (*const POOL_COLLECT_BLOCKS_TABLE[MEMORY_SIZE_CLASS_COUNT])(BlockCollector&) =
+{
+    &PoolCollectBlocks<0>, &PoolCollectBlocks<1>, &PoolCollectBlocks<2>, &PoolCollectBlocks<3>, &PoolCollectBlocks<4>,
+    &PoolCollectBlocks<5>, &PoolCollectBlocks<6>, &PoolCollectBlocks<7>, &PoolCollectBlocks<8>,
 };
+#endif
+
+// バイトサイズからサイズクラスの位置を求めます
+USize SizeClassOf(USize size) noexcept
+{
+    USize index = 0;
+    USize elementSize = MIN_ELEMENT_SIZE;
+    while (elementSize < size)
+    {
+        elementSize <<= 1;
+        index += 1;
+    }
+    return index;
+}
 
 // 標準メモリからメモリを確保します。
 Result<Void*, EAllocateError> LeyEngine::Allocate(USize size) noexcept
 {
+    if (size == 0) return EAllocateError::ZERO_SIZE;
+
+    if (size > MAX_ELEMENT_SIZE)
+    {
+#ifdef LEYENGINE_MEMORY_TRACKING
+        // 先頭に記録を置き、リストに繋ぎます
+        Var header = Cast<LargeBlockHeader*>(std::malloc(sizeof(LargeBlockHeader) + size));
+        if (header == NONE) return EAllocateError::BAD_ALLOCATE;
+        header->record = MakeBlockRecord(size);
+        {
+            std::lock_guard<std::mutex> lock(g_largeBlocksMutex);
+            header->pPrevious = NONE;
+            header->pNext = g_pLargeBlocks;
+            if (g_pLargeBlocks != NONE) g_pLargeBlocks->pPrevious = header;
+            g_pLargeBlocks = header;
+        }
+        Var ptr = Cast<Void*>(header + 1);
+#else
+        Var ptr = std::malloc(size);
+        if (ptr == NONE) return EAllocateError::BAD_ALLOCATE;
+#endif
+        g_largeUsedSize.fetch_add(size, std::memory_order_relaxed);
+        RecordAllocate(size);
+        return ptr;
+    }
+
+    Var res = POOL_ALLOCATE_TABLE[SizeClassOf(size)](size);
+    if (res.IsSuccess()) RecordAllocate(size);
+    return res;
 }
 
 // 標準メモリのメモリを解放します。
 Result<Success, EDeallocateError> LeyEngine::Deallocate(USize size, Void *pointer) noexcept
 {
+    if (size == 0) return EDeallocateError::ZERO_SIZE;
+    if (pointer == NONE) return EDeallocateError::BAD_DEALLOCATE;
+
+    if (size > MAX_ELEMENT_SIZE)
+    {
+#ifdef LEYENGINE_MEMORY_TRACKING
+        Var header = Cast<LargeBlockHeader*>(pointer) - 1;
+        {
+            std::lock_guard<std::mutex> lock(g_largeBlocksMutex);
+            if (header->pPrevious != NONE) header->pPrevious->pNext = header->pNext;
+            else                           g_pLargeBlocks = header->pNext;
+            if (header->pNext != NONE) header->pNext->pPrevious = header->pPrevious;
+        }
+        std::free(header);
+#else
+        std::free(pointer);
+#endif
+        g_largeUsedSize.fetch_sub(size, std::memory_order_relaxed);
+        RecordDeallocate(size);
+        return SUCCESS;
+    }
+
+    Var res = POOL_DEALLOCATE_TABLE[SizeClassOf(size)](size, pointer);
+    if (res.IsSuccess() || res.Error() == EDeallocateError::CORRUPTED) RecordDeallocate(size);
+    return res;
+}
+
+// メモリシステムの統計情報を返します。
+MemoryStats LeyEngine::GetMemoryStats() noexcept
+{
+    MemoryStats stats = {};
+    stats.allocateCount = g_allocateCount.load(std::memory_order_relaxed);
+    stats.deallocateCount = g_deallocateCount.load(std::memory_order_relaxed);
+    stats.usedSize = g_usedSize.load(std::memory_order_relaxed);
+    stats.peakUsedSize = g_peakUsedSize.load(std::memory_order_relaxed);
+    stats.largeUsedSize = g_largeUsedSize.load(std::memory_order_relaxed);
+    for (USize i = 0; i < MEMORY_SIZE_CLASS_COUNT; i++)
+    {
+        POOL_STATS_TABLE[i](stats.sizeClasses[i]);
+    }
+    stats.numaNodeCount = NumaNodeCount();
+    stats.invalidDeallocateCount = g_invalidDeallocateCount.load(std::memory_order_relaxed);
+    stats.doubleDeallocateCount = g_doubleDeallocateCount.load(std::memory_order_relaxed);
+    stats.corruptionCount = g_corruptionCount.load(std::memory_order_relaxed);
+    stats.useAfterFreeCount = g_useAfterFreeCount.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// プロファイルの要素数のプールを作成します
+// NUMAノード数が取得時と同じ場合は各ノードにそのノードの最大値で作成し、異なる場合は合計を指定ノードに作成します
+// 中断を要求された場合は残りを作成せずに戻ります
+Result<Success, EAllocateError> WarmPools(const MemoryPoolProfile &profile, USize node, const std::atomic<Bool> *pIsStopping) noexcept
+{
+    Var isPerNode = profile.numaNodeCount == NumaNodeCount();
+    Var nodeCount = isPerNode ? NumaNodeCount() : 1;
+    Var isFailed = NO;
+    Var error = EAllocateError::BAD_ALLOCATE;
+    for (USize n = 0; n < nodeCount; n++)
+    {
+        for (USize i = 0; i < MEMORY_SIZE_CLASS_COUNT; i++)
+        {
+            if (pIsStopping != NONE && pIsStopping->load(std::memory_order_relaxed)) return SUCCESS;
+            Var count = isPerNode ? profile.nodeElementsCounts[n][i] : profile.elementsCounts[i];
+            if (profile.elementSizes[i] != (MIN_ELEMENT_SIZE << i) || count == 0) continue;
+            Var res = POOL_WARM_TABLE[i](static_cast<USize>(count), isPerNode ? n : node);
+            if (res.IsFailure() && !isFailed)
+            {
+                isFailed = YES;
+                error = res.Error();
+            }
+        }
+    }
+    if (isFailed) return error;
+    return SUCCESS;
+}
+
+// バックグラウンドでプールを作成するスレッドを所有します
+// DLLの解放時にローダーロック中で待機しないよう、終了時には待たずに切り離し、終了前のStopで明示的に待ちます
+class MemoryPoolWarmer
+{
+    std::mutex m_mutex;                 // 排他制御
+    std::thread m_thread;               // プールを作成するスレッド
+    std::atomic<Bool> m_isStopping;     // 中断を要求されたか
+
+public:
+
+    // コンストラクタ
+    MemoryPoolWarmer() noexcept
+        : m_mutex()
+        , m_thread()
+        , m_isStopping(NO)
+    {}
+
+    // デストラクタ
+    ~MemoryPoolWarmer() noexcept
+    {
+        if (this->m_thread.joinable()) this->m_thread.detach();
+    }
+
+    // プールの作成を開始します。
+    // 前回の作成が終わっていない場合は完了を待ちます。
+    Void Start(const MemoryPoolProfile &profile, USize node) noexcept
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        if (this->m_thread.joinable()) this->m_thread.join();
+        this->m_isStopping.store(NO, std::memory_order_relaxed);
+        Var pIsStopping = &this->m_isStopping;
+        this->m_thread = std::thread([profile, node, pIsStopping]() noexcept { (Void)WarmPools(profile, node, pIsStopping); });
+    }
+
+    // 作成の完了を待ちます。
+    Void Wait() noexcept
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        if (this->m_thread.joinable()) this->m_thread.join();
+    }
+
+    // 作成を中断し、スレッドの終了を待ちます。
+    Void Stop() noexcept
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        if (!this->m_thread.joinable()) return;
+        this->m_isStopping.store(YES, std::memory_order_relaxed);
+        this->m_thread.join();
+    }
+};
+
+// プールを作成するスレッドの所有者を返します
+MemoryPoolWarmer &GetMemoryPoolWarmer() noexcept
+{
+    static MemoryPoolWarmer s_warmer;
+    return s_warmer;
+}
+
+// プロファイルの要素数に足りない分のメモリプールを事前に作成します。
+Result<Success, EAllocateError> LeyEngine::WarmMemoryPools(const MemoryPoolProfile &profile, Bool isBackground) noexcept
+{
+    // ノード毎に作成できない場合は呼び出したスレッドのノードに作成します
+    Var node = CurrentNumaNode();
+    if (!isBackground) return WarmPools(profile, node, NONE);
+    GetMemoryPoolWarmer().Start(profile, node);
+    return SUCCESS;
+}
+
+// バックグラウンドでのメモリプールの作成の完了を待ちます。
+Void LeyEngine::WaitMemoryPoolsWarmed() noexcept
+{
+    GetMemoryPoolWarmer().Wait();
+}
+
+// バックグラウンドでのメモリプールの作成を中断し、作成するスレッドの終了を待ちます。
+Void LeyEngine::StopMemoryPoolWarming() noexcept
+{
+    GetMemoryPoolWarmer().Stop();
+}
+
+// 現在のスレッドで以降に確保するメモリのタグを設定します。
+MemoryTag LeyEngine::SetMemoryTag(MemoryTag tag) noexcept
+{
+    Var previous = t_memoryTag;
+    t_memoryTag = tag;
+    return previous;
+}
+
+// 以降に確保するメモリに記録するフレーム番号を設定します。
+Void LeyEngine::SetMemoryFrame(U64 frame) noexcept
+{
+    g_memoryFrame.store(frame, std::memory_order_relaxed);
+}
+
+// タグの識別子に名前を登録します。
+Result<Success, EMemorySnapshotError> LeyEngine::NameMemoryTag(U32 id, const Char *name, USize nameSize) noexcept
+{
+    if ((name == NONE && nameSize != 0) || nameSize > 0xFFFFFFFF) return EMemorySnapshotError::INVALID_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(g_tagNamesMutex);
+
+    // 同じ名前が登録済みの場合は何もしません
+    for (USize i = 0; i < g_tagNameCount; i++)
+    {
+        const Var &tagName = g_pTagNames[i];
+        if (tagName.id == id && tagName.nameSize == nameSize && std::memcmp(&g_pTagNameText[tagName.nameOffset], name, nameSize) == 0)
+        {
+            return SUCCESS;
+        }
+    }
+
+    // 名前を変更した場合も追加し、後に登録した名前を優先します
+    if (g_tagNameCount == g_tagNameCapacity)
+    {
+        Var capacity = g_tagNameCapacity == 0 ? 64 : g_tagNameCapacity * 2;
+        Var names = Cast<MemoryTagName*>(std::realloc(g_pTagNames, sizeof(MemoryTagName) * capacity));
+        if (names == NONE) return EMemorySnapshotError::BAD_ALLOCATE;
+        g_pTagNames = names;
+        g_tagNameCapacity = capacity;
+    }
+    if (g_tagNameTextSize + nameSize > g_tagNameTextCapacity)
+    {
+        Var capacity = g_tagNameTextCapacity == 0 ? 1024 : g_tagNameTextCapacity;
+        while (capacity < g_tagNameTextSize + nameSize) capacity *= 2;
+        Var text = Cast<Char*>(std::realloc(g_pTagNameText, capacity));
+        if (text == NONE) return EMemorySnapshotError::BAD_ALLOCATE;
+        g_pTagNameText = text;
+        g_tagNameTextCapacity = capacity;
+    }
+    if (nameSize != 0) std::memcpy(&g_pTagNameText[g_tagNameTextSize], name, nameSize);
+    g_pTagNames[g_tagNameCount] = MemoryTagName{ id, static_cast<U32>(nameSize), g_tagNameTextSize };
+    g_tagNameCount += 1;
+    g_tagNameTextSize += nameSize;
+    return SUCCESS;
+}
+
+// 現在使用中のすべてのメモリブロックを記録します。
+Result<MemorySnapshot, EMemorySnapshotError> MemorySnapshot::Take() noexcept
+{
+#ifdef LEYENGINE_MEMORY_TRACKING
+    Var frame = g_memoryFrame.load(std::memory_order_relaxed);
+
+    // サイズクラス毎にロックしながら集めるため、サイズクラス間で厳密に同時点ではありません
+    BlockCollector collector;
+    for (USize i = 0; i < MEMORY_SIZE_CLASS_COUNT; i++)
+    {
+        POOL_COLLECT_BLOCKS_TABLE[i](collector);
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_largeBlocksMutex);
+        for (Var header = g_pLargeBlocks; header != NONE; header = header->pNext)
+        {
+            collector.Add(Cast<USize>(header + 1), MEMORY_SIZE_CLASS_COUNT, header->record);
+        }
+    }
+    if (collector.IsFailed()) return EMemorySnapshotError::BAD_ALLOCATE;
+
+    // 差分を順に比較できるよう、確保した順に整列します
+    // 確保処理からジョブシステムへ依存しないよう、標準の整列を使用します
+    std::sort(collector.Blocks(), collector.Blocks() + collector.Count(), [](const MemoryBlockInfo &a, const MemoryBlockInfo &b) noexcept
+    {
+        return a.serial < b.serial;
+    });
+
+    std::lock_guard<std::mutex> lock(g_tagNamesMutex);
+    MemorySnapshotHeader header = {};
+    header.magic = MEMORY_SNAPSHOT_MAGIC;
+    header.version = MEMORY_SNAPSHOT_VERSION;
+    header.frame = frame;
+    header.baseFrame = frame;
+    header.blockCount = collector.Count();
+    header.nameCount = g_tagNameCount;
+    header.nameTextSize = g_tagNameTextSize;
+    Var res = Create(header);
+    if (res.IsFailure()) return res;
+    Var &snapshot = res.Value();
+    if (collector.Count() != 0) std::memcpy(snapshot.m_pBlocks, collector.Blocks(), sizeof(MemoryBlockInfo) * collector.Count());
+    if (g_tagNameCount != 0) std::memcpy(snapshot.m_pNames, g_pTagNames, sizeof(MemoryTagName) * g_tagNameCount);
+    if (g_tagNameTextSize != 0) std::memcpy(snapshot.m_pNames + g_tagNameCount, g_pTagNameText, g_tagNameTextSize);
+    return res;
+#else
+    return EMemorySnapshotError::NOT_TRACKED;
+#endif
 }
 
 #else
 
 Result<Void*, EAllocateError> (*g_allocate)(USize);
 Result<Success, EDeallocateError> (*g_deallocate)(USize, Void*);
+MemoryStats (*g_getMemoryStats)();
+MemoryTag (*g_setMemoryTag)(MemoryTag);
+Void (*g_setMemoryFrame)(U64);
+Result<Success, EMemorySnapshotError> (*g_nameMemoryTag)(U32, const Char*, USize);
+Result<MemorySnapshot, EMemorySnapshotError> (*g_takeMemorySnapshot)();
+Result<Success, EAllocateError> (*g_warmMemoryPools)(const MemoryPoolProfile&, Bool);
+Void (*g_waitMemoryPoolsWarmed)();
+Void (*g_stopMemoryPoolWarming)();
 Result<Void*, EAllocateError> GlobalAllocate(USize size) noexcept
 {
     if (size == 0) return EAllocateError::ZERO_SIZE;
@@ -164,17 +1202,75 @@ Result<Success, EDeallocateError> GlobalDeallocate(USize size, Void *pointer) no
 {
     if (size == 0) return EDeallocateError::ZERO_SIZE;
     std::free(pointer);
-} 
+    return SUCCESS;
+}
+MemoryStats GlobalGetMemoryStats() noexcept
+{
+    return MemoryStats();
+}
+thread_local MemoryTag t_memoryTag = {};
+MemoryTag GlobalSetMemoryTag(MemoryTag tag) noexcept
+{
+    Var previous = t_memoryTag;
+    t_memoryTag = tag;
+    return previous;
+}
+Void GlobalSetMemoryFrame(U64) noexcept
+{
+}
+Result<Success, EMemorySnapshotError> GlobalNameMemoryTag(U32, const Char*, USize) noexcept
+{
+    return SUCCESS;
+}
+Result<MemorySnapshot, EMemorySnapshotError> GlobalTakeMemorySnapshot() noexcept
+{
+    return EMemorySnapshotError::NOT_TRACKED;
+}
+Result<Success, EAllocateError> GlobalWarmMemoryPools(const MemoryPoolProfile&, Bool) noexcept
+{
+    return SUCCESS;
+}
+Void GlobalWaitMemoryPoolsWarmed() noexcept
+{
+}
+Void GlobalStopMemoryPoolWarming() noexcept
+{
+}
 std::once_flag g_initMemorySystemOnceFlag;
 Void InitMemorySystem()
 {
     g_allocate = &GlobalAllocate;
     g_deallocate = &GlobalDeallocate;
+    g_getMemoryStats = &GlobalGetMemoryStats;
+    g_setMemoryTag = &GlobalSetMemoryTag;
+    g_setMemoryFrame = &GlobalSetMemoryFrame;
+    g_nameMemoryTag = &GlobalNameMemoryTag;
+    g_takeMemorySnapshot = &GlobalTakeMemorySnapshot;
+    g_warmMemoryPools = &GlobalWarmMemoryPools;
+    g_waitMemoryPoolsWarmed = &GlobalWaitMemoryPoolsWarmed;
+    g_stopMemoryPoolWarming = &GlobalStopMemoryPoolWarming;
 }
-EXPORT Void SetMemorySystem(Void *allocator, Void *deallocator)
+EXPORT Void SetMemorySystem(Void *allocator, Void *deallocator, Void *statistics)
 {
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
     g_allocate = (Result<Void*, EAllocateError> (*)(USize)) allocator;
     g_deallocate = (Result<Success, EDeallocateError> (*)(USize, Void*))deallocator;
+    g_getMemoryStats = (MemoryStats (*)())statistics;
+}
+EXPORT Void SetMemoryTrackingSystem(Void *tagSetter, Void *frameSetter, Void *tagNamer, Void *snapshotTaker)
+{
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
+    g_setMemoryTag = (MemoryTag (*)(MemoryTag))tagSetter;
+    g_setMemoryFrame = (Void (*)(U64))frameSetter;
+    g_nameMemoryTag = (Result<Success, EMemorySnapshotError> (*)(U32, const Char*, USize))tagNamer;
+    g_takeMemorySnapshot = (Result<MemorySnapshot, EMemorySnapshotError> (*)())snapshotTaker;
+}
+EXPORT Void SetMemoryPoolWarmingSystem(Void *warmer, Void *waiter, Void *stopper)
+{
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
+    g_warmMemoryPools = (Result<Success, EAllocateError> (*)(const MemoryPoolProfile&, Bool))warmer;
+    g_waitMemoryPoolsWarmed = (Void (*)())waiter;
+    g_stopMemoryPoolWarming = (Void (*)())stopper;
 }
 
 // 標準メモリからメモリを確保します。
@@ -191,4 +1287,305 @@ Result<Success, EDeallocateError> LeyEngine::Deallocate(USize size, Void *pointe
     return g_deallocate(size, pointer);
 }
 
-#endif
\ No newline at end of file
+// メモリシステムの統計情報を返します。
+MemoryStats LeyEngine::GetMemoryStats() noexcept
+{
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
+    return g_getMemoryStats();
+}
+
+// 現在のスレッドで以降に確保するメモリのタグを設定します。
+MemoryTag LeyEngine::SetMemoryTag(MemoryTag tag) noexcept
+{
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
+    return g_setMemoryTag(tag);
+}
+
+// 以降に確保するメモリに記録するフレーム番号を設定します。
+Void LeyEngine::SetMemoryFrame(U64 frame) noexcept
+{
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
+    g_setMemoryFrame(frame);
+}
+
+// タグの識別子に名前を登録します。
+Result<Success, EMemorySnapshotError> LeyEngine::NameMemoryTag(U32 id, const Char *name, USize nameSize) noexcept
+{
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
+    return g_nameMemoryTag(id, name, nameSize);
+}
+
+// 現在使用中のすべてのメモリブロックを記録します。
+Result<MemorySnapshot, EMemorySnapshotError> MemorySnapshot::Take() noexcept
+{
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
+    return g_takeMemorySnapshot();
+}
+
+// プロファイルの要素数に足りない分のメモリプールを事前に作成します。
+Result<Success, EAllocateError> LeyEngine::WarmMemoryPools(const MemoryPoolProfile &profile, Bool isBackground) noexcept
+{
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
+    return g_warmMemoryPools(profile, isBackground);
+}
+
+// バックグラウンドでのメモリプールの作成の完了を待ちます。
+Void LeyEngine::WaitMemoryPoolsWarmed() noexcept
+{
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
+    g_waitMemoryPoolsWarmed();
+}
+
+// バックグラウンドでのメモリプールの作成を中断し、作成するスレッドの終了を待ちます。
+Void LeyEngine::StopMemoryPoolWarming() noexcept
+{
+    std::call_once(g_initMemorySystemOnceFlag, InitMemorySystem);
+    g_stopMemoryPoolWarming();
+}
+
+#endif
+
+// --------------------
+//
+// スナップショット
+//
+// ====================
+
+// 作成します。
+MemorySnapshot::MemorySnapshot(U8 *pBuffer, USize bufferSize, const MemorySnapshotHeader &header) noexcept
+    : m_pBuffer(pBuffer)
+    , m_bufferSize(bufferSize)
+    , m_flags(header.flags)
+    , m_frame(header.frame)
+    , m_baseFrame(header.baseFrame)
+    , m_pBlocks(Cast<MemoryBlockInfo*>(pBuffer))
+    , m_blockCount(header.blockCount)
+    , m_pFreedBlocks(Cast<MemoryBlockInfo*>(pBuffer) + header.blockCount)
+    , m_freedBlockCount(header.freedBlockCount)
+    , m_pNames(Cast<MemoryTagName*>(Cast<MemoryBlockInfo*>(pBuffer) + header.blockCount + header.freedBlockCount))
+    , m_nameCount(header.nameCount)
+    , m_pNameText(Cast<const Char*>(Cast<MemoryTagName*>(Cast<MemoryBlockInfo*>(pBuffer) + header.blockCount + header.freedBlockCount) + header.nameCount))
+    , m_nameTextSize(header.nameTextSize)
+{
+}
+
+// ヘッダーの要素数に合わせてバッファを確保し、作成します。
+Result<MemorySnapshot, EMemorySnapshotError> MemorySnapshot::Create(const MemorySnapshotHeader &header) noexcept
+{
+    // バッファはファイルのヘッダー以降と同じ配置です
+    Var size = sizeof(MemoryBlockInfo) * (header.blockCount + header.freedBlockCount)
+        + sizeof(MemoryTagName) * header.nameCount + header.nameTextSize;
+    U8 *pBuffer = NONE;
+    if (size != 0)
+    {
+        Var res = Allocate(size);
+        if (res.IsFailure()) return EMemorySnapshotError::BAD_ALLOCATE;
+        pBuffer = Cast<U8*>(res.Value());
+    }
+    return MemorySnapshot(pBuffer, size, header);
+}
+
+// 2つのスナップショットの差分を求めます。
+Result<MemorySnapshot, EMemorySnapshotError> MemorySnapshot::Diff(const MemorySnapshot &before, const MemorySnapshot &after) noexcept
+{
+    if (before.IsDiff() || after.IsDiff()) return EMemorySnapshotError::INVALID_ARGUMENT;
+
+    // どちらも確保した順に整列しているため、通し番号を順に比較します
+    // 片方にのみ含まれるブロックを、確保されたブロックと解放されたブロックに分けて渡します
+    Var visit = [&before, &after](auto onAllocated, auto onFreed) noexcept
+    {
+        USize i = 0;
+        USize j = 0;
+        while (i < before.m_blockCount || j < after.m_blockCount)
+        {
+            if (j == after.m_blockCount || (i < before.m_blockCount && before.m_pBlocks[i].serial < after.m_pBlocks[j].serial))
+            {
+                onFreed(before.m_pBlocks[i++]);
+            }
+            else if (i == before.m_blockCount || after.m_pBlocks[j].serial < before.m_pBlocks[i].serial)
+            {
+                onAllocated(after.m_pBlocks[j++]);
+            }
+            else
+            {
+                i++;
+                j++;
+            }
+        }
+    };
+
+    MemorySnapshotHeader header = {};
+    header.magic = MEMORY_SNAPSHOT_MAGIC;
+    header.version = MEMORY_SNAPSHOT_VERSION;
+    header.flags = MEMORY_SNAPSHOT_DIFF;
+    header.frame = after.m_frame;
+    header.baseFrame = before.m_frame;
+    visit([&header](const MemoryBlockInfo&) noexcept { header.blockCount += 1; },
+          [&header](const MemoryBlockInfo&) noexcept { header.freedBlockCount += 1; });
+    // タグの名前は追加されるのみのため、比較先の名前を使用します
+    header.nameCount = after.m_nameCount;
+    header.nameTextSize = after.m_nameTextSize;
+
+    Var res = Create(header);
+    if (res.IsFailure()) return res;
+    Var &diff = res.Value();
+    Var pAllocated = diff.m_pBlocks;
+    Var pFreed = diff.m_pFreedBlocks;
+    visit([&pAllocated](const MemoryBlockInfo &block) noexcept { *pAllocated++ = block; },
+          [&pFreed](const MemoryBlockInfo &block) noexcept { *pFreed++ = block; });
+    if (after.m_nameCount != 0) std::memcpy(diff.m_pNames, after.m_pNames, sizeof(MemoryTagName) * after.m_nameCount);
+    if (after.m_nameTextSize != 0) std::memcpy(diff.m_pNames + after.m_nameCount, after.m_pNameText, after.m_nameTextSize);
+    return res;
+}
+
+// ムーブコンストラクタです。
+MemorySnapshot::MemorySnapshot(MemorySnapshot &&origin) noexcept
+    : m_pBuffer(origin.m_pBuffer)
+    , m_bufferSize(origin.m_bufferSize)
+    , m_flags(origin.m_flags)
+    , m_frame(origin.m_frame)
+    , m_baseFrame(origin.m_baseFrame)
+    , m_pBlocks(origin.m_pBlocks)
+    , m_blockCount(origin.m_blockCount)
+    , m_pFreedBlocks(origin.m_pFreedBlocks)
+    , m_freedBlockCount(origin.m_freedBlockCount)
+    , m_pNames(origin.m_pNames)
+    , m_nameCount(origin.m_nameCount)
+    , m_pNameText(origin.m_pNameText)
+    , m_nameTextSize(origin.m_nameTextSize)
+{
+    origin.m_pBuffer = NONE;
+    origin.m_bufferSize = 0;
+    origin.m_blockCount = 0;
+    origin.m_freedBlockCount = 0;
+    origin.m_nameCount = 0;
+    origin.m_nameTextSize = 0;
+}
+
+// デストラクタです。
+MemorySnapshot::~MemorySnapshot() noexcept
+{
+    if (this->m_pBuffer != NONE)
+    {
+        (Void)Deallocate(this->m_bufferSize, this->m_pBuffer);
+    }
+}
+
+// 差分か判定します。
+Bool MemorySnapshot::IsDiff() const noexcept
+{
+    return (this->m_flags & MEMORY_SNAPSHOT_DIFF) != 0;
+}
+
+// 取得したフレーム番号を返します。
+U64 MemorySnapshot::Frame() const noexcept
+{
+    return this->m_frame;
+}
+
+// 差分の場合、比較元のフレーム番号を返します。
+U64 MemorySnapshot::BaseFrame() const noexcept
+{
+    return this->m_baseFrame;
+}
+
+// 使用中、または、差分で新たに確保されたブロック数を返します。
+USize MemorySnapshot::BlockCount() const noexcept
+{
+    return this->m_blockCount;
+}
+
+// 使用中、または、差分で新たに確保されたブロックを返します。
+const MemoryBlockInfo &MemorySnapshot::BlockAt(USize index) const noexcept
+{
+    return this->m_pBlocks[index];
+}
+
+// 差分で解放されたブロック数を返します。
+USize MemorySnapshot::FreedBlockCount() const noexcept
+{
+    return this->m_freedBlockCount;
+}
+
+// 差分で解放されたブロックを返します。
+const MemoryBlockInfo &MemorySnapshot::FreedBlockAt(USize index) const noexcept
+{
+    return this->m_pFreedBlocks[index];
+}
+
+// タグの名前を検索します。
+const Char *MemorySnapshot::NameOf(U32 id, USize &nameSize) const noexcept
+{
+    // 後に登録した名前を優先します
+    for (USize i = this->m_nameCount; i > 0; i--)
+    {
+        const Var &tagName = this->m_pNames[i - 1];
+        if (tagName.id == id)
+        {
+            nameSize = tagName.nameSize;
+            return &this->m_pNameText[tagName.nameOffset];
+        }
+    }
+    nameSize = 0;
+    return NONE;
+}
+
+// オフラインのビューアで読み込めるファイルに書き込みます。
+Result<Success, EMemorySnapshotError> MemorySnapshot::Write(const Char *path) const noexcept
+{
+    if (path == NONE) return EMemorySnapshotError::INVALID_ARGUMENT;
+
+    MemorySnapshotHeader header = {};
+    header.magic = MEMORY_SNAPSHOT_MAGIC;
+    header.version = MEMORY_SNAPSHOT_VERSION;
+    header.flags = this->m_flags;
+    header.frame = this->m_frame;
+    header.baseFrame = this->m_baseFrame;
+    header.blockCount = this->m_blockCount;
+    header.freedBlockCount = this->m_freedBlockCount;
+    header.nameCount = this->m_nameCount;
+    header.nameTextSize = this->m_nameTextSize;
+
+    Var pFile = std::fopen(Cast<const char*>(path), "wb");
+    if (pFile == NONE) return EMemorySnapshotError::OPEN_FAILED;
+    Var isWritten = std::fwrite(&header, sizeof(header), 1, pFile) == 1
+        && (this->m_bufferSize == 0 || std::fwrite(this->m_pBuffer, 1, this->m_bufferSize, pFile) == this->m_bufferSize);
+    if (std::fclose(pFile) != 0) isWritten = NO;
+    if (!isWritten) return EMemorySnapshotError::WRITE_FAILED;
+    return SUCCESS;
+}
+
+// --------------------
+//
+// プロファイル
+//
+// ====================
+
+// メモリプールのプロファイルをファイルに書き込みます。
+Result<Success, EMemoryPoolProfileError> LeyEngine::WriteMemoryPoolProfile(const MemoryPoolProfile &profile, const Char *path) noexcept
+{
+    if (path == NONE) return EMemoryPoolProfileError::INVALID_ARGUMENT;
+
+    Var pFile = std::fopen(Cast<const char*>(path), "wb");
+    if (pFile == NONE) return EMemoryPoolProfileError::OPEN_FAILED;
+    Var isWritten = std::fwrite(&profile, sizeof(profile), 1, pFile) == 1;
+    if (std::fclose(pFile) != 0) isWritten = NO;
+    if (!isWritten) return EMemoryPoolProfileError::WRITE_FAILED;
+    return SUCCESS;
+}
+
+// メモリプールのプロファイルをファイルから読み込みます。
+Result<MemoryPoolProfile, EMemoryPoolProfileError> LeyEngine::ReadMemoryPoolProfile(const Char *path) noexcept
+{
+    if (path == NONE) return EMemoryPoolProfileError::INVALID_ARGUMENT;
+
+    Var pFile = std::fopen(Cast<const char*>(path), "rb");
+    if (pFile == NONE) return EMemoryPoolProfileError::OPEN_FAILED;
+    MemoryPoolProfile profile = {};
+    Var isRead = std::fread(&profile, sizeof(profile), 1, pFile) == 1;
+    std::fclose(pFile);
+    if (!isRead) return EMemoryPoolProfileError::READ_FAILED;
+    if (profile.magic != MEMORY_POOL_PROFILE_MAGIC || profile.version != MEMORY_POOL_PROFILE_VERSION) return EMemoryPoolProfileError::INVALID_FORMAT;
+    if (profile.numaNodeCount > MEMORY_NUMA_NODE_CAPACITY) return EMemoryPoolProfileError::INVALID_FORMAT;
+    return profile;
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+// String.cpp
+// (C) 2022 LeyCommunity.
+// author Taichi Ito.
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "LeyEngine/String.hpp"
+
+using namespace LeyEngine;
+
+#ifdef LEYENGINE_CORE_MODULE
+
+// --------------------
+//
+// 設定
+//
+// ====================
+
+// 名前のテーブルの分割数のビット数
+constexpr U32 NAME_SHARD_BITS = 6;
+// 名前のテーブルの分割数
+constexpr U32 NAME_SHARD_COUNT = 1 << NAME_SHARD_BITS;
+// 分割したテーブル毎のスロット数、2の累乗
+constexpr U32 NAME_SLOT_COUNT = 8192;
+// 分割したテーブル毎に格納できる名前の数、スロット数の3/4
+constexpr U32 NAME_SHARD_CAPACITY = NAME_SLOT_COUNT / 4 * 3;
+// 名前を書き込み中のスロット
+constexpr U32 NAME_SLOT_BUSY = 0xFFFFFFFF;
+
+// --------------------
+//
+// 名前のテーブル
+//
+// ====================
+
+// 分割した名前のテーブルです。
+// スロットは項目のインデックス+1を格納する開番地法のハッシュテーブルで、ロックを取らずに検索、追加します。
+struct NameShard
+{
+    std::atomic<U32> slots[NAME_SLOT_COUNT];                        // 項目のインデックス+1、0は空
+    std::atomic<const _Internal::_NameEntry*> entries[NAME_SHARD_CAPACITY]; // 項目
+    std::atomic<U32> count;                                         // 項目の数
+};
+
+// 名前のテーブルです。
+// 項目は解放せず、プロセスの終了まで保持します。
+NameShard g_nameShards[NAME_SHARD_COUNT];
+
+// 項目の文字列を返します。
+inline const Char *EntryData(const _Internal::_NameEntry *pEntry) noexcept
+{
+    return Cast<const Char*>(pEntry + 1);
+}
+
+// 項目が文字列と一致するかを返します。
+inline Bool IsEntryEqual(const _Internal::_NameEntry *pEntry, const Char *pData, USize size, U64 hash) noexcept
+{
+    if (pEntry->hash != hash || pEntry->size != size) return NO;
+    return StringView(EntryData(pEntry), size) == StringView(pData, size);
+}
+
+// 名前をインターンし、識別子を返します。
+Result<U32, ENameError> LeyEngine::_Internal::_InternName(const Char *pData, USize size, U64 hash) noexcept
+{
+    // 下位ビットで分割したテーブルを、残りのビットでスロットを選びます
+    Var shardIndex = static_cast<U32>(hash & (NAME_SHARD_COUNT - 1));
+    Var &shard = g_nameShards[shardIndex];
+    Var slotIndex = static_cast<U32>(hash >> NAME_SHARD_BITS) & (NAME_SLOT_COUNT - 1);
+    for (U32 probe = 0; probe < NAME_SLOT_COUNT; probe++, slotIndex = (slotIndex + 1) & (NAME_SLOT_COUNT - 1))
+    {
+        Var &slot = shard.slots[slotIndex];
+        Var value = slot.load(std::memory_order_acquire);
+        if (value == 0)
+        {
+            // スロットを予約してから項目を作ります
+            if (!slot.compare_exchange_strong(value, NAME_SLOT_BUSY, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                if (value == 0) continue;
+            }
+            else
+            {
+                // 確保に失敗してもインデックスを失わないよう、確保してからインデックスを割り当てます
+                Var entrySize = sizeof(_Internal::_NameEntry) + size + 1;
+                Var result = Allocate(entrySize);
+                if (result.IsFailure())
+                {
+                    slot.store(0, std::memory_order_release);
+                    return ENameError::BAD_ALLOCATE;
+                }
+                Var index = shard.count.fetch_add(1, std::memory_order_relaxed);
+                if (index >= NAME_SHARD_CAPACITY)
+                {
+                    shard.count.fetch_sub(1, std::memory_order_relaxed);
+                    (Void)Deallocate(entrySize, result.Value());
+                    slot.store(0, std::memory_order_release);
+                    return ENameError::TABLE_FULL;
+                }
+                Var pEntry = Cast<_Internal::_NameEntry*>(result.Value());
+                pEntry->hash = hash;
+                pEntry->size = size;
+                Var pEntryData = Cast<Char*>(pEntry + 1);
+                for (USize i = 0; i < size; i++) pEntryData[i] = pData[i];
+                pEntryData[size] = 0;
+                shard.entries[index].store(pEntry, std::memory_order_release);
+                slot.store(index + 1, std::memory_order_release);
+                return ((index + 1) << NAME_SHARD_BITS) | shardIndex;
+            }
+        }
+        // 他のスレッドが書き込み中の場合は完了を待ちます
+        while (value == NAME_SLOT_BUSY)
+        {
+            std::this_thread::yield();
+            value = slot.load(std::memory_order_acquire);
+        }
+        if (value == 0)
+        {
+            // 書き込みに失敗して戻されたスロットを再度確認します
+            slotIndex = (slotIndex - 1) & (NAME_SLOT_COUNT - 1);
+            probe--;
+            continue;
+        }
+        Var pEntry = shard.entries[value - 1].load(std::memory_order_acquire);
+        if (IsEntryEqual(pEntry, pData, size, hash)) return (value << NAME_SHARD_BITS) | shardIndex;
+    }
+    return ENameError::TABLE_FULL;
+}
+
+// 識別子から名前の項目を返します。
+const _Internal::_NameEntry *LeyEngine::_Internal::_FindNameEntry(U32 id) noexcept
+{
+    Var &shard = g_nameShards[id & (NAME_SHARD_COUNT - 1)];
+    return shard.entries[(id >> NAME_SHARD_BITS) - 1].load(std::memory_order_acquire);
+}
+
+#else
+
+Result<U32, ENameError> (*g_internName)(const Char*, USize, U64);
+const _Internal::_NameEntry *(*g_findNameEntry)(U32);
+Result<U32, ENameError> GlobalInternName(const Char*, USize, U64) noexcept
+{
+    // 識別子はコアモジュールのテーブルで共有する必要があるため、接続するまではインターンしません
+    return ENameError::NOT_INITIALIZED;
+}
+const _Internal::_NameEntry *GlobalFindNameEntry(U32) noexcept
+{
+    return NONE;
+}
+std::once_flag g_initNameSystemOnceFlag;
+Void InitNameSystem()
+{
+    g_internName = &GlobalInternName;
+    g_findNameEntry = &GlobalFindNameEntry;
+}
+EXPORT Void SetNameSystem(Void *internName, Void *findNameEntry)
+{
+    std::call_once(g_initNameSystemOnceFlag, InitNameSystem);
+    g_internName = (Result<U32, ENameError> (*)(const Char*, USize, U64))internName;
+    g_findNameEntry = (const _Internal::_NameEntry *(*)(U32))findNameEntry;
+}
+
+// 名前をインターンし、識別子を返します。
+Result<U32, ENameError> LeyEngine::_Internal::_InternName(const Char *pData, USize size, U64 hash) noexcept
+{
+    std::call_once(g_initNameSystemOnceFlag, InitNameSystem);
+    return g_internName(pData, size, hash);
+}
+
+// 識別子から名前の項目を返します。
+const _Internal::_NameEntry *LeyEngine::_Internal::_FindNameEntry(U32 id) noexcept
+{
+    std::call_once(g_initNameSystemOnceFlag, InitNameSystem);
+    return g_findNameEntry(id);
+}
+
+#endif
\ No newline at end of file